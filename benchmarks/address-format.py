@@ -0,0 +1,134 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Compare the cost of getting prefixes and addresses out of elems in each of
+# the address formats supported by BGPStream.set_address_format, e.g.:
+#   ./address-format.py --upd-file updates.20200501.0000.bz2
+#
+# The elems of the file are read once (using get_next_records) before
+# timing starts, so only the attribute access and conversion are measured.
+#
+
+import argparse
+import ipaddress
+import time
+
+import _pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def load_elems(args, address_format):
+    stream = _pybgpstream.BGPStream()
+    stream.set_data_interface("singlefile")
+    stream.set_data_interface_option("singlefile", "upd-file", args.upd_file)
+    stream.set_address_format(address_format)
+    stream.start()
+    elems = []
+    while True:
+        recs = stream.get_next_records(1024)
+        if not recs:
+            break
+        for rec in recs:
+            while True:
+                elem = rec.get_next_elem()
+                if elem is None:
+                    break
+                elems.append(elem)
+    return elems
+
+
+def access(elems):
+    for elem in elems:
+        elem.peer_address
+        fields = elem.fields
+        fields.get("prefix")
+        fields.get("next-hop")
+
+
+# ipaddress accepts both strings and packed bytes (with a prefix length)
+def to_ipaddress(elems):
+    for elem in elems:
+        ipaddress.ip_address(elem.peer_address)
+        pfx = elem.fields.get("prefix")
+        if pfx is not None:
+            ipaddress.ip_network(pfx, strict=False)
+
+
+def to_ipaddress_int(elems):
+    for elem in elems:
+        addr, version = elem.peer_address
+        if version == 4:
+            ipaddress.IPv4Address(addr)
+        else:
+            ipaddress.IPv6Address(addr)
+        pfx = elem.fields.get("prefix")
+        if pfx is not None:
+            if pfx[2] == 4:
+                ipaddress.IPv4Network(pfx[:2], strict=False)
+            else:
+                ipaddress.IPv6Network(pfx[:2], strict=False)
+
+
+CONVERTERS = {
+    "str": to_ipaddress,
+    "bytes": to_ipaddress,
+    "int": to_ipaddress_int,
+}
+
+
+def bench(func, elems):
+    start = time.time()
+    func(elems)
+    return time.time() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark the string, bytes and int address formats
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    args = parser.parse_args()
+
+    print("%-8s %10s %16s %20s" %
+          ("format", "elems", "access elems/s", "ipaddress elems/s"))
+    for address_format in ("str", "bytes", "int"):
+        # each pass builds the fields dict, so use fresh elems for each test
+        elems = load_elems(args, address_format)
+        acc = bench(access, elems)
+        elems = load_elems(args, address_format)
+        conv = bench(CONVERTERS[address_format], elems)
+        print("%-8s %10d %16.0f %20.0f" %
+              (address_format, len(elems),
+               len(elems) / acc if acc else 0,
+               len(elems) / conv if conv else 0))
+
+
+if __name__ == "__main__":
+    main()
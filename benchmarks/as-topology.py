@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Compare building the AS adjacency set with a Python loop over the elems
+# (as examples/topology.py used to) with BGPStream.get_as_topology, e.g.:
+#   ./as-topology.py --rib-file rib.20200501.0000.bz2
+#
+
+import argparse
+import time
+
+import pybgpstream
+
+DEFAULT_RIB_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/RIBS/rib.20200501.0000.bz2"
+
+
+def topology_python(stream):
+    edges = set()
+    for elem in stream:
+        ases = elem.get_as_path_asns(collapse_prepending=True)
+        for i in range(0, len(ases) - 1):
+            if isinstance(ases[i], int) and isinstance(ases[i + 1], int):
+                edges.add(tuple(sorted([ases[i], ases[i + 1]])))
+    return len(edges)
+
+
+def topology_native(stream):
+    return len(stream.get_as_topology())
+
+
+def topology_native_full(stream):
+    return len(stream.get_as_topology(counts=True, first_seen=True,
+                                      peers=True, as_buffers=True)["counts"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark AS topology extraction in Python and in C
+    """)
+    parser.add_argument('-r', '--rib-file', default=DEFAULT_RIB_FILE,
+                        help="MRT RIB file to read")
+    args = parser.parse_args()
+
+    print("%-12s %10s %10s" % ("extractor", "edges", "seconds"))
+    for name, func in (("python", topology_python),
+                       ("native", topology_native),
+                       ("native-full", topology_native_full)):
+        stream = pybgpstream.BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "rib-file",
+                                         args.rib_file)
+        start = time.time()
+        edges = func(stream)
+        print("%-12s %10d %10.3f" % (name, edges, time.time() - start))
+
+
+if __name__ == "__main__":
+    main()
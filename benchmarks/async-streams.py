@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Compare reading several streams concurrently in one asyncio event loop,
+# either with `async for` (waiting on the notification fd of each stream)
+# or by running the blocking iteration of each stream in the loop's
+# default executor, e.g.:
+#   ./async-streams.py --upd-file updates.20200501.0000.bz2 --streams 8
+#
+
+import argparse
+import asyncio
+import threading
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def new_stream(args):
+    stream = pybgpstream.BGPStream(data_interface="singlefile",
+                                   prefetch_depth=args.prefetch_depth)
+    stream.set_data_interface_option("singlefile", "upd-file", args.upd_file)
+    return stream
+
+
+async def count_async(args):
+    cnt = 0
+    async for elem in new_stream(args):
+        cnt += 1
+    return cnt
+
+
+def count_blocking(args):
+    cnt = 0
+    for elem in new_stream(args):
+        cnt += 1
+    return cnt
+
+
+async def run(args, mode):
+    loop = asyncio.get_event_loop()
+    if mode == "async":
+        coros = [count_async(args) for i in range(args.streams)]
+    else:
+        coros = [loop.run_in_executor(None, count_blocking, args)
+                 for i in range(args.streams)]
+    return sum(await asyncio.gather(*coros)), threading.active_count()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark reading streams with async iteration
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-s', '--streams', type=int, default=8,
+                        help="Number of streams to read concurrently")
+    parser.add_argument('-p', '--prefetch-depth', type=int, default=64,
+                        help="Number of records to read ahead per stream")
+    args = parser.parse_args()
+
+    print("%-9s %10s %10s %12s %14s" %
+          ("mode", "elems", "seconds", "elems/sec", "Python threads"))
+    for mode in ("executor", "async"):
+        loop = asyncio.new_event_loop()
+        start = time.time()
+        cnt, threads = loop.run_until_complete(run(args, mode))
+        secs = time.time() - start
+        loop.close()
+        print("%-9s %10d %10.3f %12.0f %14d" %
+              (mode, cnt, secs, cnt / secs if secs else 0, threads))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure per-elem access to the low-cardinality string attributes
+# (project, collector, router, record type/status/dump position and elem
+# type) with and without string interning, e.g.:
+#   ./attribute-access.py --upd-file updates.20200501.0000.bz2
+#
+
+import argparse
+import time
+
+import _pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def load_elems(args):
+    stream = _pybgpstream.BGPStream()
+    stream.set_data_interface("singlefile")
+    stream.set_data_interface_option("singlefile", "upd-file", args.upd_file)
+    stream.start()
+    elems = []
+    while True:
+        recs = stream.get_next_records(1024)
+        if not recs:
+            break
+        for rec in recs:
+            while True:
+                elem = rec.get_next_elem()
+                if elem is None:
+                    break
+                elems.append((rec, elem))
+    return elems
+
+
+def access(elems):
+    for rec, elem in elems:
+        rec.project
+        rec.collector
+        rec.router
+        rec.type
+        rec.status
+        rec.dump_position
+        elem.type
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark string attribute access with and without interning
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-n', '--repeat', type=int, default=3,
+                        help="Number of runs for each mode (best is reported)")
+    args = parser.parse_args()
+
+    elems = load_elems(args)
+
+    print("%-10s %10s %10s %12s" % ("interning", "elems", "seconds",
+                                    "elems/sec"))
+    for enabled in (False, True):
+        _pybgpstream.set_string_interning(enabled)
+        best = None
+        for _ in range(args.repeat):
+            start = time.time()
+            access(elems)
+            secs = time.time() - start
+            if best is None or secs < best:
+                best = secs
+        print("%-10s %10d %10.3f %12.0f" %
+              ("on" if enabled else "off", len(elems), best,
+               len(elems) / best if best else 0))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure the cost of taking checkpoints, and of resuming a stream from a
+# checkpoint at several positions (records consumed before the checkpoint
+# are skipped without decoding their elems), e.g.:
+#   ./checkpoint.py --upd-file updates.20200501.0000.bz2
+#
+
+import argparse
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def new_stream(args):
+    stream = pybgpstream.BGPStream(data_interface="singlefile")
+    stream.set_data_interface_option("singlefile", "upd-file", args.upd_file)
+    return stream
+
+
+def take_checkpoints(args):
+    """Read the whole stream, taking a checkpoint every N records"""
+    stream = new_stream(args)
+    tokens = []
+    cp_secs = 0
+    start = time.time()
+    for i, rec in enumerate(stream.records()):
+        for elem in rec:
+            pass
+        if i % args.interval == 0:
+            cp_start = time.time()
+            tokens.append(stream.checkpoint())
+            cp_secs += time.time() - cp_start
+    return i + 1, time.time() - start, cp_secs, tokens
+
+
+def resume(args, token):
+    stream = new_stream(args)
+    stream.resume(token)
+    cnt = 0
+    start = time.time()
+    for elem in stream:
+        cnt += 1
+    return cnt, time.time() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark checkpointing and resuming a stream
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-i', '--interval', type=int, default=1000,
+                        help="Number of records between checkpoints")
+    parser.add_argument('-p', '--positions', type=int, default=4,
+                        help="Number of positions to resume from")
+    args = parser.parse_args()
+
+    rec_cnt, secs, cp_secs, tokens = take_checkpoints(args)
+    print("read %d records in %.3fs, %d checkpoints took %.3fms each" %
+          (rec_cnt, secs, len(tokens), cp_secs * 1000 / len(tokens)))
+
+    print("%10s %10s %10s" % ("resumed at", "elems", "seconds"))
+    for p in range(args.positions):
+        idx = p * (len(tokens) - 1) // max(args.positions - 1, 1)
+        cnt, secs = resume(args, tokens[idx])
+        print("%10d %10d %10.3f" % (idx * args.interval, cnt, secs))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,87 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Compare reading a dump file without a cache, on the cold path (the first
+# read, which also writes the cache file) and on the warm path (later reads,
+# from the cache file), e.g.:
+#   ./elem-cache.py --upd-file updates.20200501.0000.bz2
+#
+# A temporary cache directory is used unless one is given.
+#
+
+import argparse
+import shutil
+import tempfile
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def run(args, cache_dir):
+    stream = pybgpstream.BGPStream(data_interface="singlefile",
+                                   cache_dir=cache_dir)
+    stream.set_data_interface_option("singlefile", "upd-file", args.upd_file)
+    cnt = 0
+    start = time.time()
+    for elem in stream:
+        cnt += 1
+    return cnt, time.time() - start, stream.get_cache_info()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark reading a stream through the decoded-elem cache
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-c', '--cache-dir', default=None,
+                        help="Directory to keep the cache file in")
+    parser.add_argument('-n', '--warm-runs', type=int, default=3,
+                        help="Number of warm reads")
+    args = parser.parse_args()
+
+    cache_dir = args.cache_dir or tempfile.mkdtemp()
+    try:
+        print("%-8s %10s %10s %12s %12s" %
+              ("path", "elems", "seconds", "elems/sec", "cache bytes"))
+        runs = [("uncached", None), ("cold", cache_dir)] + \
+            [("warm", cache_dir)] * args.warm_runs
+        for name, directory in runs:
+            cnt, secs, info = run(args, directory)
+            print("%-8s %10d %10.3f %12.0f %12s" %
+                  (name, cnt, secs, cnt / secs if secs else 0,
+                   info["size"] if info else "-"))
+    finally:
+        if args.cache_dir is None:
+            shutil.rmtree(cache_dir)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,88 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Compare filtering elems on fields that libbgpstream cannot filter on in
+# Python (after building every elem) with BGPStream.add_elem_filter, e.g.:
+#   ./elem-filter.py --upd-file updates.20200501.0000.bz2
+#
+
+import argparse
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+# (elem filter expression, equivalent Python predicate)
+FILTERS = [
+    ("prefix-len > 22",
+     lambda elem: elem.prefix is not None and
+     int(elem.prefix.split("/")[1]) > 22),
+    ("origin-asn in {3356, 174, 6939}",
+     lambda elem: elem.type in ("rib", "announcement") and
+     elem.as_path_asns and elem.as_path_asns[-1] in (3356, 174, 6939)),
+    ("path-len > 5",
+     lambda elem: elem.type in ("rib", "announcement") and
+     len(elem.get_as_path_asns(collapse_prepending=True)) > 5),
+    ("community in {*:666, 65535:*}",
+     lambda elem: elem.communities is not None and
+     any(c.endswith(":666") or c.startswith("65535:")
+         for c in elem.communities)),
+]
+
+
+def make_stream(args, **kwargs):
+    stream = pybgpstream.BGPStream(data_interface="singlefile", **kwargs)
+    stream.set_data_interface_option("singlefile", "upd-file",
+                                     args.upd_file)
+    return stream
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark elem filtering in Python and in C
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    args = parser.parse_args()
+
+    print("%-32s %-8s %8s %10s" % ("filter", "method", "elems", "seconds"))
+    for expression, predicate in FILTERS:
+        start = time.time()
+        cnt = sum(1 for elem in make_stream(args) if predicate(elem))
+        print("%-32s %-8s %8d %10.3f" %
+              (expression, "python", cnt, time.time() - start))
+
+        start = time.time()
+        cnt = sum(1 for _ in make_stream(args, elem_filter=expression))
+        print("%-32s %-8s %8d %10.3f" %
+              (expression, "native", cnt, time.time() - start))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure elem throughput of `for elem in stream` (and of reading a record
+# field through the elem), e.g.:
+#   ./elem-iteration.py --upd-file updates.20200501.0000.bz2
+#
+# Use a local MRT file to keep download time out of the measurements.
+#
+
+import argparse
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def iterate(stream):
+    cnt = 0
+    for _ in stream:
+        cnt += 1
+    return cnt
+
+
+def iterate_fields(stream):
+    cnt = 0
+    for elem in stream:
+        elem.prefix
+        elem.time
+        elem.collector
+        cnt += 1
+    return cnt
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark elem iteration over a stream
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    args = parser.parse_args()
+
+    print("%-18s %10s %10s %12s" % ("loop", "elems", "seconds", "elems/sec"))
+    for name, func in (("elems", iterate), ("elems+fields", iterate_fields)):
+        stream = pybgpstream.BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         args.upd_file)
+        start = time.time()
+        cnt = func(stream)
+        secs = time.time() - start
+        print("%-18s %10d %10.3f %12.0f" %
+              (name, cnt, secs, cnt / secs if secs else 0))
+
+
+if __name__ == "__main__":
+    main()
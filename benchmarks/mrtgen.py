@@ -0,0 +1,365 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Generate synthetic MRT files (a TABLE_DUMP_V2 RIB dump and/or a BGP4MP
+# updates file) with a configurable number of peers, prefixes, AS path
+# lengths and communities, so that benchmarks can run offline on inputs of
+# a known shape, e.g.:
+#   ./mrtgen.py --rib-file rib.mrt --upd-file updates.mrt --peers 20
+#
+
+import argparse
+import bz2
+import gzip
+import random
+import socket
+import struct
+
+# MRT types and subtypes (RFC 6396)
+MRT_TABLE_DUMP_V2 = 13
+MRT_PEER_INDEX_TABLE = 1
+MRT_RIB_IPV4_UNICAST = 2
+MRT_RIB_IPV6_UNICAST = 4
+MRT_BGP4MP = 16
+MRT_BGP4MP_STATE_CHANGE_AS4 = 5
+MRT_BGP4MP_MESSAGE_AS4 = 4
+
+AFI_IPV4 = 1
+AFI_IPV6 = 2
+SAFI_UNICAST = 1
+
+# BGP path attributes (RFC 4271, RFC 1997, RFC 4760)
+ATTR_FLAG_OPTIONAL = 0x80
+ATTR_FLAG_TRANSITIVE = 0x40
+ATTR_FLAG_EXTENDED = 0x10
+ATTR_ORIGIN = 1
+ATTR_AS_PATH = 2
+ATTR_NEXT_HOP = 3
+ATTR_COMMUNITIES = 8
+ATTR_MP_REACH_NLRI = 14
+ATTR_MP_UNREACH_NLRI = 15
+AS_SEQUENCE = 2
+
+BGP_UPDATE = 2
+BGP_STATE_IDLE = 1
+BGP_STATE_ESTABLISHED = 6
+
+COLLECTOR_ASN = 65000
+COLLECTOR_IP = "192.0.2.1"
+
+
+class Peer(object):
+
+    def __init__(self, idx, rnd, ipv6):
+        self.idx = idx
+        self.asn = rnd.randint(1, 400000)
+        if ipv6:
+            self.afi = AFI_IPV6
+            self.address = "2001:db8::%x" % (idx + 1)
+        else:
+            self.afi = AFI_IPV4
+            self.address = "198.51.%d.%d" % (idx // 250, idx % 250 + 1)
+        self.bgp_id = struct.pack("!I", 0x0a000000 + idx + 1)
+
+    @property
+    def packed_address(self):
+        family = socket.AF_INET6 if self.afi == AFI_IPV6 else socket.AF_INET
+        return socket.inet_pton(family, self.address)
+
+
+class Generator(object):
+    """Builds the peers and prefixes of a synthetic table and encodes MRT
+    records for them"""
+
+    def __init__(self, peers=10, prefixes=10000, path_len=(2, 8),
+                 communities=(0, 6), ipv6_fraction=0.2, seed=0,
+                 timestamp=1588291200):
+        self.rnd = random.Random(seed)
+        self.path_len = path_len
+        self.communities = communities
+        self.timestamp = timestamp
+        # peers are reached over IPv4 unless there are IPv6 prefixes only
+        self.peers = [Peer(i, self.rnd, ipv6_fraction >= 1)
+                      for i in range(peers)]
+        self.prefixes = self._make_prefixes(prefixes, ipv6_fraction)
+
+    def _make_prefixes(self, cnt, ipv6_fraction):
+        prefixes = set()
+        while len(prefixes) < cnt:
+            if self.rnd.random() < ipv6_fraction:
+                # global unicast (2000::/3)
+                plen = self.rnd.randint(32, 48)
+                addr = 0x2000 << 112 | self.rnd.getrandbits(125)
+                prefixes.add((AFI_IPV6, addr >> (128 - plen) << (128 - plen),
+                              plen))
+            else:
+                plen = self.rnd.randint(16, 24)
+                addr = self.rnd.randint(1, 223) << 24 | \
+                    self.rnd.getrandbits(24)
+                prefixes.add((AFI_IPV4, addr >> (32 - plen) << (32 - plen),
+                              plen))
+        return sorted(prefixes)
+
+    # ---------- encoding helpers ----------
+
+    @staticmethod
+    def mrt(timestamp, mtype, subtype, body):
+        return struct.pack("!IHHI", timestamp, mtype, subtype,
+                           len(body)) + body
+
+    @staticmethod
+    def attr(flags, atype, value):
+        if len(value) > 255:
+            return struct.pack("!BBH", flags | ATTR_FLAG_EXTENDED, atype,
+                               len(value)) + value
+        return struct.pack("!BBB", flags, atype, len(value)) + value
+
+    @staticmethod
+    def nlri(prefix):
+        afi, addr, plen = prefix
+        size = 16 if afi == AFI_IPV6 else 4
+        nbytes = (plen + 7) // 8
+        return struct.pack("!B", plen) + addr.to_bytes(size, "big")[:nbytes]
+
+    def _path_attrs(self, peer, ipv6_next_hop=None):
+        """Origin, AS path and communities of a route (the next hop is
+        added by the caller, as it is encoded differently for IPv4 and
+        IPv6)"""
+        hops = [peer.asn] + [self.rnd.randint(1, 400000)
+                             for _ in range(self.rnd.randint(
+                                 *self.path_len) - 1)]
+        # some prepending, as found in real tables
+        if self.rnd.random() < 0.1:
+            hops.append(hops[-1])
+        as_path = b""
+        for i in range(0, len(hops), 255):
+            seg = hops[i:i + 255]
+            as_path += struct.pack("!BB", AS_SEQUENCE, len(seg)) + \
+                struct.pack("!%dI" % len(seg), *seg)
+        attrs = self.attr(ATTR_FLAG_TRANSITIVE, ATTR_ORIGIN, b"\x00") + \
+            self.attr(ATTR_FLAG_TRANSITIVE, ATTR_AS_PATH, as_path)
+        ncomms = self.rnd.randint(*self.communities)
+        if ncomms:
+            comms = [(self.rnd.choice(hops) & 0xffff) << 16 |
+                     self.rnd.randint(0, 65535) for _ in range(ncomms)]
+            attrs += self.attr(ATTR_FLAG_OPTIONAL | ATTR_FLAG_TRANSITIVE,
+                               ATTR_COMMUNITIES,
+                               struct.pack("!%dI" % ncomms, *comms))
+        return attrs
+
+    def _next_hop(self, peer, afi):
+        if afi == AFI_IPV6:
+            return socket.inet_pton(socket.AF_INET6,
+                                    "2001:db8:ffff::%x" % (peer.idx + 1))
+        return socket.inet_pton(socket.AF_INET, "203.0.113.%d" %
+                                (peer.idx % 250 + 1))
+
+    # ---------- RIB dumps ----------
+
+    def rib(self, peer_fraction=1.0):
+        """Yield the records of a TABLE_DUMP_V2 RIB dump, with each prefix
+        seen by roughly peer_fraction of the peers"""
+        body = socket.inet_aton(COLLECTOR_IP) + struct.pack("!H", 0) + \
+            struct.pack("!H", len(self.peers))
+        for peer in self.peers:
+            peer_type = 0x02 | (0x01 if peer.afi == AFI_IPV6 else 0)
+            body += struct.pack("!B", peer_type) + peer.bgp_id + \
+                peer.packed_address + struct.pack("!I", peer.asn)
+        yield self.mrt(self.timestamp, MRT_TABLE_DUMP_V2,
+                       MRT_PEER_INDEX_TABLE, body)
+
+        for seq, prefix in enumerate(self.prefixes):
+            entries = b""
+            cnt = 0
+            for peer in self.peers:
+                if peer_fraction < 1 and self.rnd.random() >= peer_fraction:
+                    continue
+                attrs = self._path_attrs(peer)
+                nh = self._next_hop(peer, prefix[0])
+                if prefix[0] == AFI_IPV6:
+                    # abbreviated MP_REACH_NLRI (RFC 6396, section 4.3.4)
+                    attrs += self.attr(ATTR_FLAG_OPTIONAL, ATTR_MP_REACH_NLRI,
+                                       struct.pack("!B", len(nh)) + nh)
+                else:
+                    attrs += self.attr(ATTR_FLAG_TRANSITIVE, ATTR_NEXT_HOP, nh)
+                entries += struct.pack("!HIH", peer.idx, self.timestamp,
+                                       len(attrs)) + attrs
+                cnt += 1
+            subtype = MRT_RIB_IPV6_UNICAST if prefix[0] == AFI_IPV6 \
+                else MRT_RIB_IPV4_UNICAST
+            yield self.mrt(self.timestamp, MRT_TABLE_DUMP_V2, subtype,
+                           struct.pack("!I", seq) + self.nlri(prefix) +
+                           struct.pack("!H", cnt) + entries)
+
+    # ---------- updates ----------
+
+    def _bgp4mp_header(self, peer):
+        local = socket.inet_pton(
+            socket.AF_INET6 if peer.afi == AFI_IPV6 else socket.AF_INET,
+            "2001:db8::ffff" if peer.afi == AFI_IPV6 else COLLECTOR_IP)
+        return struct.pack("!IIHH", peer.asn, COLLECTOR_ASN, 0, peer.afi) + \
+            peer.packed_address + local
+
+    def _update(self, peer, prefixes, withdraw):
+        v4 = [p for p in prefixes if p[0] == AFI_IPV4]
+        v6 = [p for p in prefixes if p[0] == AFI_IPV6]
+        v4_nlri = b"".join(self.nlri(p) for p in v4)
+        v6_nlri = b"".join(self.nlri(p) for p in v6)
+        withdrawn = b""
+        attrs = b""
+        nlri = b""
+        if withdraw:
+            withdrawn = v4_nlri
+            if v6:
+                attrs = self.attr(ATTR_FLAG_OPTIONAL, ATTR_MP_UNREACH_NLRI,
+                                  struct.pack("!HB", AFI_IPV6, SAFI_UNICAST) +
+                                  v6_nlri)
+        else:
+            attrs = self._path_attrs(peer)
+            if v4:
+                attrs += self.attr(ATTR_FLAG_TRANSITIVE, ATTR_NEXT_HOP,
+                                   self._next_hop(peer, AFI_IPV4))
+                nlri = v4_nlri
+            if v6:
+                nh = self._next_hop(peer, AFI_IPV6)
+                attrs += self.attr(ATTR_FLAG_OPTIONAL, ATTR_MP_REACH_NLRI,
+                                   struct.pack("!HBB", AFI_IPV6, SAFI_UNICAST,
+                                               len(nh)) + nh + b"\x00" +
+                                   v6_nlri)
+        msg = struct.pack("!H", len(withdrawn)) + withdrawn + \
+            struct.pack("!H", len(attrs)) + attrs + nlri
+        return b"\xff" * 16 + struct.pack("!HB", 19 + len(msg), BGP_UPDATE) + \
+            msg
+
+    def updates(self, messages=10000, prefixes_per_update=(1, 4),
+                withdraw_fraction=0.2, state_changes=2):
+        """Yield the records of a BGP4MP updates file, with messages
+        announcing or withdrawing a few prefixes each (prefixes of both
+        address families in one message are split between NEXT_HOP/NLRI and
+        MP_(UN)REACH_NLRI), and a few peer state changes"""
+        state_at = set(self.rnd.randrange(messages)
+                       for _ in range(state_changes))
+        for i in range(messages):
+            ts = self.timestamp + i * 900 // max(messages, 1)
+            peer = self.rnd.choice(self.peers)
+            if i in state_at:
+                yield self.mrt(ts, MRT_BGP4MP, MRT_BGP4MP_STATE_CHANGE_AS4,
+                               self._bgp4mp_header(peer) +
+                               struct.pack("!HH", BGP_STATE_ESTABLISHED,
+                                           BGP_STATE_IDLE))
+            prefixes = self.rnd.sample(
+                self.prefixes, min(len(self.prefixes),
+                                   self.rnd.randint(*prefixes_per_update)))
+            withdraw = self.rnd.random() < withdraw_fraction
+            yield self.mrt(ts, MRT_BGP4MP, MRT_BGP4MP_MESSAGE_AS4,
+                           self._bgp4mp_header(peer) +
+                           self._update(peer, prefixes, withdraw))
+
+
+def open_output(path):
+    """Open path for writing, compressing it if it ends with .gz or .bz2"""
+    if path.endswith(".gz"):
+        return gzip.open(path, "wb")
+    if path.endswith(".bz2"):
+        return bz2.BZ2File(path, "wb")
+    return open(path, "wb")
+
+
+def write_records(path, records):
+    with open_output(path) as fh:
+        for rec in records:
+            fh.write(rec)
+
+
+def int_range(value):
+    """Parse 'N' or 'MIN-MAX' into a (min, max) tuple"""
+    lo, _, hi = value.partition("-")
+    lo = int(lo)
+    hi = int(hi) if hi else lo
+    if lo < 0 or hi < lo:
+        raise argparse.ArgumentTypeError("invalid range: %s" % value)
+    return lo, hi
+
+
+def add_arguments(parser):
+    """Add the options that shape the generated table to parser"""
+    parser.add_argument('--peers', type=int, default=10,
+                        help="Number of peers")
+    parser.add_argument('--prefixes', type=int, default=10000,
+                        help="Number of distinct prefixes")
+    parser.add_argument('--path-len', type=int_range, default=(2, 8),
+                        help="AS path length, as N or MIN-MAX")
+    parser.add_argument('--communities', type=int_range, default=(0, 6),
+                        help="Communities per route, as N or MIN-MAX")
+    parser.add_argument('--ipv6-fraction', type=float, default=0.2,
+                        help="Fraction of prefixes that are IPv6")
+    parser.add_argument('--rib-peer-fraction', type=float, default=1.0,
+                        help="Fraction of peers that each RIB prefix is seen "
+                        "by")
+    parser.add_argument('--updates', type=int, default=50000,
+                        help="Number of update messages")
+    parser.add_argument('--prefixes-per-update', type=int_range,
+                        default=(1, 4),
+                        help="Prefixes per update message, as N or MIN-MAX")
+    parser.add_argument('--withdraw-fraction', type=float, default=0.2,
+                        help="Fraction of update messages that are "
+                        "withdrawals")
+    parser.add_argument('--seed', type=int, default=0,
+                        help="Random seed (the same seed and options "
+                        "generate the same files)")
+
+
+def generate(args, rib_file=None, upd_file=None):
+    """Write the files described by args (see add_arguments)"""
+    gen = Generator(peers=args.peers, prefixes=args.prefixes,
+                    path_len=args.path_len, communities=args.communities,
+                    ipv6_fraction=args.ipv6_fraction, seed=args.seed)
+    if rib_file is not None:
+        write_records(rib_file, gen.rib(args.rib_peer_fraction))
+    if upd_file is not None:
+        write_records(upd_file, gen.updates(args.updates,
+                                            args.prefixes_per_update,
+                                            args.withdraw_fraction))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Generate synthetic MRT RIB and updates files
+    """)
+    parser.add_argument('-r', '--rib-file',
+                        help="RIB dump file to write (.gz/.bz2 to compress)")
+    parser.add_argument('-u', '--upd-file',
+                        help="Updates file to write (.gz/.bz2 to compress)")
+    add_arguments(parser)
+    args = parser.parse_args()
+    if args.rib_file is None and args.upd_file is None:
+        parser.error("at least one of --rib-file and --upd-file is needed")
+    generate(args, args.rib_file, args.upd_file)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,97 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Keep the prefix and AS path of every elem of a RIB dump, with and without
+# the prefix and AS path caches, and report the time taken, the memory held
+# by the kept values, and the hit rate and memory use of the caches, e.g.:
+#   ./object-cache.py --rib-file rib.20200501.0000.bz2 --sizes 0 65536
+#
+
+import argparse
+import time
+import tracemalloc
+
+import _pybgpstream
+import pybgpstream
+
+DEFAULT_RIB_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/RIBS/rib.20200501.0000.bz2"
+
+
+def keep_values(args):
+    stream = pybgpstream.BGPStream(data_interface="singlefile")
+    stream.set_data_interface_option("singlefile", "rib-file", args.rib_file)
+    values = []
+    for elem in stream:
+        if elem.type == "rib":
+            values.append((elem.prefix, elem.as_path))
+    return values
+
+
+def hit_rate(before, after):
+    hits = after["hits"] - before["hits"]
+    lookups = hits + after["misses"] - before["misses"]
+    return 100.0 * hits / lookups if lookups else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark sharing prefixes and AS paths between the elems of a RIB dump
+    """)
+    parser.add_argument('-r', '--rib-file', default=DEFAULT_RIB_FILE,
+                        help="MRT RIB file to read")
+    parser.add_argument('-s', '--sizes', type=int, nargs='+',
+                        default=[0, 65536],
+                        help="Cache sizes to compare (0 disables the caches)")
+    args = parser.parse_args()
+
+    print("%-8s %10s %10s %12s %10s %10s %12s" %
+          ("size", "elems", "seconds", "kept KiB", "pfx hits", "path hits",
+           "cache KiB"))
+    for size in args.sizes:
+        _pybgpstream.set_object_cache_size(prefixes=size, as_paths=size)
+        before = _pybgpstream.get_object_cache_stats()
+        tracemalloc.start()
+        start = time.time()
+        values = keep_values(args)
+        secs = time.time() - start
+        kept = tracemalloc.get_traced_memory()[0]
+        tracemalloc.stop()
+        after = _pybgpstream.get_object_cache_stats()
+        print("%-8d %10d %10.3f %12d %9.1f%% %9.1f%% %12d" %
+              (size, len(values), secs, kept // 1024,
+               hit_rate(before["prefixes"], after["prefixes"]),
+               hit_rate(before["as_paths"], after["as_paths"]),
+               (after["prefixes"]["memory"] +
+                after["as_paths"]["memory"]) // 1024))
+        del values
+        # release the cached values before the next run
+        _pybgpstream.set_object_cache_size(prefixes=0, as_paths=0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure the rate at which BGPElem/BGPRecord objects are created and
+# destroyed for different free list sizes, and report how many allocations
+# were served from the free lists, e.g.:
+#   ./object-pool.py --upd-file updates.20200501.0000.bz2 --sizes 0 16 256
+#
+
+import argparse
+import time
+
+import _pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def load_records(args):
+    stream = _pybgpstream.BGPStream()
+    stream.set_data_interface("singlefile")
+    stream.set_data_interface_option("singlefile", "upd-file", args.upd_file)
+    stream.start()
+    recs = []
+    while True:
+        batch = stream.get_next_records(1024)
+        if not batch:
+            break
+        recs.extend(batch)
+    return recs
+
+
+def walk(recs):
+    # records are decoded up front so that only elem object churn is timed
+    elems = 0
+    for rec in recs:
+        while True:
+            elem = rec.get_next_elem()
+            if elem is None:
+                break
+            elem.type
+            elems += 1
+    return elems
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark object allocation with different free list sizes
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-s', '--sizes', type=int, nargs='+',
+                        default=[0, 256],
+                        help="Free list sizes to compare")
+    args = parser.parse_args()
+
+    print("%-8s %10s %10s %12s %12s %12s" %
+          ("size", "elems", "seconds", "elems/sec", "hits", "misses"))
+    for size in args.sizes:
+        _pybgpstream.set_freelist_size(elem=size, record=size)
+        recs = load_records(args)
+        before = _pybgpstream.get_freelist_stats()["BGPElem"]
+        start = time.time()
+        elems = walk(recs)
+        secs = time.time() - start
+        after = _pybgpstream.get_freelist_stats()["BGPElem"]
+        print("%-8d %10d %10.3f %12.0f %12d %12d" %
+              (size, elems, secs, elems / secs if secs else 0,
+               after["hits"] - before["hits"],
+               after["misses"] - before["misses"]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,260 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure the throughput and memory use of the main API paths of the
+# bindings on synthetic MRT files (see mrtgen.py), without any network
+# access. Each path runs in its own process, once to measure elems/sec and
+# peak RSS and once more with tracemalloc to measure the peak memory
+# allocated by Python, e.g.:
+#   ./offline-suite.py --peers 20 --prefixes 50000 --json results.json
+#   ./offline-suite.py --peers 20 --prefixes 50000 --baseline results.json
+#
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import mrtgen
+
+
+def path_iterate(stream, args):
+    cnt = 0
+    for elem in stream:
+        cnt += 1
+    return cnt
+
+
+def path_fields(stream, args):
+    cnt = 0
+    for elem in stream:
+        elem.fields
+        cnt += 1
+    return cnt
+
+
+def path_strings(stream, args):
+    cnt = 0
+    for elem in stream:
+        elem.as_path
+        cnt += 1
+    return cnt
+
+
+def path_typed(stream, args):
+    cnt = 0
+    for elem in stream:
+        elem.as_path_asns
+        cnt += 1
+    return cnt
+
+
+def path_communities(stream, args):
+    cnt = 0
+    for elem in stream:
+        elem.communities
+        cnt += 1
+    return cnt
+
+
+def path_community_values(stream, args):
+    cnt = 0
+    for elem in stream:
+        elem.community_values
+        cnt += 1
+    return cnt
+
+
+def path_get_elems(stream, args):
+    cnt = 0
+    for rec in stream.records():
+        for elem in rec.get_elems():
+            cnt += 1
+    return cnt
+
+
+def path_batch(stream, args):
+    cnt = 0
+    for rec in stream.records(batch=args.batch):
+        for elem in rec:
+            cnt += 1
+    return cnt
+
+
+PATHS = [
+    ("iterate", path_iterate),
+    ("fields", path_fields),
+    ("strings", path_strings),
+    ("typed", path_typed),
+    ("communities", path_communities),
+    ("community_values", path_community_values),
+    ("get_elems", path_get_elems),
+    ("batch", path_batch),
+]
+
+
+def max_rss_kib():
+    import resource
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # bytes on macOS, KiB elsewhere
+    return rss // 1024 if sys.platform == "darwin" else rss
+
+
+def run_child(args):
+    """Run one path over one file and print the results as JSON"""
+    import pybgpstream
+
+    func = dict(PATHS)[args.child]
+
+    def run():
+        stream = pybgpstream.BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", args.file_type,
+                                         args.file)
+        return func(stream, args)
+
+    result = {}
+    if args.trace:
+        import tracemalloc
+        tracemalloc.start()
+        run()
+        result["alloc_peak_kib"] = tracemalloc.get_traced_memory()[1] // 1024
+        tracemalloc.stop()
+    else:
+        best = None
+        for _ in range(args.repeat):
+            start = time.time()
+            cnt = run()
+            secs = time.time() - start
+            if best is None or secs < best:
+                best = secs
+        result["elems"] = cnt
+        result["seconds"] = best
+        result["peak_rss_kib"] = max_rss_kib()
+    json.dump(result, sys.stdout)
+
+
+def spawn(args, path, file_type, filename, trace):
+    cmd = [sys.executable, os.path.abspath(__file__), "--child", path,
+           "--file-type", file_type, "--file", filename,
+           "--repeat", str(args.repeat), "--batch", str(args.batch)]
+    if trace:
+        cmd.append("--trace")
+    return json.loads(subprocess.check_output(cmd).decode())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark the API paths of the bindings on synthetic MRT files
+    """)
+    parser.add_argument('-d', '--data-dir',
+                        help="Directory to keep the generated files in (they "
+                        "are re-used if they exist, and written to a "
+                        "temporary directory otherwise)")
+    parser.add_argument('-p', '--paths',
+                        default=",".join(name for name, _ in PATHS),
+                        help="Comma-separated API paths to run")
+    parser.add_argument('-n', '--repeat', type=int, default=3,
+                        help="Number of runs for each path (best is "
+                        "reported)")
+    parser.add_argument('-b', '--batch', type=int, default=64,
+                        help="Records per batch for the batch path")
+    parser.add_argument('-j', '--json',
+                        help="File to write the results to")
+    parser.add_argument('--baseline',
+                        help="Results of an earlier run (see --json) to "
+                        "compare elems/sec with")
+    # internal: run a single path in a child process
+    parser.add_argument('--child', help=argparse.SUPPRESS)
+    parser.add_argument('--file-type', help=argparse.SUPPRESS)
+    parser.add_argument('--file', help=argparse.SUPPRESS)
+    parser.add_argument('--trace', action="store_true",
+                        help=argparse.SUPPRESS)
+    mrtgen.add_arguments(parser)
+    args = parser.parse_args()
+
+    if args.child is not None:
+        run_child(args)
+        return
+
+    paths = args.paths.split(",")
+    for path in paths:
+        if path not in dict(PATHS):
+            parser.error("unknown path: %s" % path)
+
+    data_dir = args.data_dir or tempfile.mkdtemp(prefix="pybgpstream-bench")
+    files = [("rib-file", os.path.join(data_dir, "rib.mrt")),
+             ("upd-file", os.path.join(data_dir, "updates.mrt"))]
+    try:
+        if not all(os.path.exists(f) for _, f in files):
+            if not os.path.isdir(data_dir):
+                os.makedirs(data_dir)
+            sys.stderr.write("generating MRT files in %s\n" % data_dir)
+            mrtgen.generate(args, files[0][1], files[1][1])
+
+        baseline = {}
+        if args.baseline is not None:
+            with open(args.baseline) as fh:
+                baseline = dict(((r["file"], r["path"]), r)
+                                for r in json.load(fh))
+
+        print("%-8s %-9s %9s %8s %11s %8s %11s %9s" %
+              ("file", "path", "elems", "seconds", "elems/sec", "change",
+               "alloc KiB", "RSS MiB"))
+        results = []
+        for file_type, filename in files:
+            for path in paths:
+                res = spawn(args, path, file_type, filename, False)
+                res.update(spawn(args, path, file_type, filename, True))
+                res["file"] = file_type.split("-")[0]
+                res["path"] = path
+                res["elems_per_sec"] = \
+                    res["elems"] / res["seconds"] if res["seconds"] else 0
+                base = baseline.get((res["file"], path))
+                change = "-"
+                if base and base["elems_per_sec"]:
+                    change = "%+.1f%%" % (100.0 * res["elems_per_sec"] /
+                                          base["elems_per_sec"] - 100)
+                print("%-8s %-9s %9d %8.3f %11.0f %8s %11d %9.1f" %
+                      (res["file"], path, res["elems"], res["seconds"],
+                       res["elems_per_sec"], change, res["alloc_peak_kib"],
+                       res["peak_rss_kib"] / 1024.0))
+                results.append(res)
+
+        if args.json is not None:
+            with open(args.json, "w") as fh:
+                json.dump(results, fh, indent=2)
+    finally:
+        if args.data_dir is None:
+            shutil.rmtree(data_dir)
+
+
+if __name__ == "__main__":
+    main()
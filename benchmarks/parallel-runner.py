@@ -0,0 +1,85 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure how elem counting over local MRT files scales with the number of
+# worker processes of the parallel runner, e.g.:
+#   ./parallel-runner.py -f updates.20200501.0000.bz2 updates.20200501.0015.bz2 ...
+#
+# There is one work unit per file, so use at least as many files as cores.
+#
+
+import argparse
+import multiprocessing
+import time
+
+from pybgpstream import parallel
+
+
+def count_elems(stream):
+    cnt = 0
+    for _ in stream:
+        cnt += 1
+    return cnt
+
+
+def add(x, y):
+    return x + y
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark the parallel runner for 1 to N processes
+    """)
+    parser.add_argument('-f', '--upd-files', nargs='+', required=True,
+                        help="MRT updates files to read")
+    parser.add_argument('-p', '--max-processes', type=int,
+                        default=multiprocessing.cpu_count(),
+                        help="Largest number of processes to test")
+    args = parser.parse_args()
+
+    units = parallel.make_work_units(upd_files=args.upd_files)
+
+    print("%-10s %10s %10s %12s %10s" %
+          ("processes", "elems", "seconds", "elems/sec", "speedup"))
+    base = None
+    procs = 1
+    while True:
+        start = time.time()
+        cnt = parallel.map_reduce(units, count_elems, add, processes=procs)
+        secs = time.time() - start
+        if base is None:
+            base = secs
+        print("%-10d %10d %10.3f %12.0f %10.2f" %
+              (procs, cnt, secs, cnt / secs if secs else 0,
+               base / secs if secs else 0))
+        if procs >= args.max_processes:
+            break
+        procs = min(procs * 2, args.max_processes)
+
+
+if __name__ == "__main__":
+    main()
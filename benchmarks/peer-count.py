@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Compare per-peer elem/record counting done with a Python loop over the
+# elems (as in examples/spark-recordcount.py) with BGPStream.count_peers,
+# e.g.:
+#   ./peer-count.py --upd-file updates.20200501.0000.bz2
+#
+
+import argparse
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def count_python(stream):
+    peers = {}
+    for rec in stream.records():
+        seen = set()
+        for elem in rec:
+            sig = (rec.project, rec.collector, elem.peer_asn,
+                   elem.peer_address)
+            if sig not in peers:
+                peers[sig] = [0, 0]
+            peers[sig][0] += 1
+            if sig not in seen:
+                seen.add(sig)
+                peers[sig][1] += 1
+    return len(peers)
+
+
+def count_native(stream):
+    return len(stream.count_peers()["peers"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark per-peer counting in Python and in C
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    args = parser.parse_args()
+
+    print("%-8s %10s %10s" % ("counter", "peers", "seconds"))
+    for name, func in (("python", count_python), ("native", count_native)):
+        stream = pybgpstream.BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         args.upd_file)
+        start = time.time()
+        peers = func(stream)
+        print("%-8s %10d %10.3f" % (name, peers, time.time() - start))
+
+
+if __name__ == "__main__":
+    main()
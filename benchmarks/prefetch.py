@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure how much of the decoding time is hidden behind Python-side
+# processing when records are read ahead in a background thread, e.g.:
+#   ./prefetch.py --upd-file updates.20200501.0000.bz2 --depths 0 16 256
+#
+# Each elem is "processed" by formatting it as a string, which stands in for
+# the work a real consumer would do.
+#
+
+import argparse
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def run(args, depth):
+    stream = pybgpstream.BGPStream(data_interface="singlefile",
+                                   prefetch_depth=depth)
+    stream.set_data_interface_option("singlefile", "upd-file", args.upd_file)
+    cnt = 0
+    start = time.time()
+    for elem in stream:
+        str(elem)
+        cnt += 1
+    return cnt, time.time() - start, stream.get_prefetch_stats()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark elem processing with and without a prefetch thread
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-d', '--depths', type=int, nargs='+',
+                        default=[0, 4, 64, 1024],
+                        help="Prefetch depths to compare (0 disables)")
+    args = parser.parse_args()
+
+    print("%-8s %10s %10s %12s %10s %10s" %
+          ("depth", "elems", "seconds", "elems/sec", "full", "empty"))
+    for depth in args.depths:
+        cnt, secs, stats = run(args, depth)
+        print("%-8d %10d %10.3f %12.0f %10s %10s" %
+              (depth, cnt, secs, cnt / secs if secs else 0,
+               stats["full"] if stats else "-",
+               stats["empty"] if stats else "-"))
+
+
+if __name__ == "__main__":
+    main()
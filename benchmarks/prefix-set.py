@@ -0,0 +1,141 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure how long it takes to build a PrefixSet of 1k, 100k and 1M random
+# prefixes (from a list and from a file), how much memory it uses, and how
+# fast a stream filtered with it runs compared with one prefix filter per
+# prefix added with add_filter, e.g.:
+#   ./prefix-set.py --upd-file updates.20200501.0000.bz2
+#
+
+import argparse
+import os
+import random
+import tempfile
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+SIZES = [1000, 100000, 1000000]
+
+
+def random_prefixes(cnt):
+    prefixes = []
+    for _ in range(cnt):
+        if random.random() < 0.8:
+            length = random.randint(8, 24)
+            addr = random.getrandbits(length) << (32 - length)
+            prefixes.append("%d.%d.%d.%d/%d" % (
+                addr >> 24, (addr >> 16) & 0xff, (addr >> 8) & 0xff,
+                addr & 0xff, length))
+        else:
+            length = random.randint(19, 48)
+            addr = (0x2000 << 112) | (random.getrandbits(length - 3)
+                                       << (128 - length))
+            groups = ["%x" % ((addr >> (112 - 16 * i)) & 0xffff)
+                      for i in range(8)]
+            prefixes.append("%s/%d" % (":".join(groups), length))
+    return prefixes
+
+
+def run_stream(args, **kwargs):
+    stream = pybgpstream.BGPStream(data_interface="singlefile", **kwargs)
+    stream.set_data_interface_option("singlefile", "upd-file",
+                                     args.upd_file)
+    return stream
+
+
+def count_elems(stream):
+    start = time.time()
+    cnt = sum(1 for _ in stream)
+    return cnt, time.time() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark building and filtering with large prefix sets
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-m', '--match', default="more",
+                        help="Match type of the prefixes")
+    parser.add_argument('-a', '--max-add-filter', type=int, default=100000,
+                        help="Largest set to also add with add_filter")
+    parser.add_argument('-s', '--seed', type=int, default=0,
+                        help="Seed of the random prefixes")
+    args = parser.parse_args()
+    random.seed(args.seed)
+
+    elems, secs = count_elems(run_stream(args))
+    print("unfiltered: %d elems in %.3fs" % (elems, secs))
+
+    print("%-8s %-10s %10s %10s %10s %8s %10s" %
+          ("size", "method", "build(s)", "memory(MB)", "filter(s)",
+           "elems", "elems/s"))
+    for size in SIZES:
+        prefixes = random_prefixes(size)
+        fd, path = tempfile.mkstemp()
+        with os.fdopen(fd, "w") as fh:
+            fh.write("\n".join(prefixes))
+
+        start = time.time()
+        from_list = pybgpstream.PrefixSet(prefixes, match=args.match)
+        build_list = time.time() - start
+
+        start = time.time()
+        from_file = pybgpstream.PrefixSet()
+        from_file.load(path, match=args.match)
+        build_file = time.time() - start
+        os.unlink(path)
+
+        results = [("list", build_list, from_list),
+                   ("file", build_file, from_file)]
+        if size <= args.max_add_filter:
+            results.append(("add_filter", None, None))
+
+        for method, build, pset in results:
+            if pset is not None:
+                stream = run_stream(args, prefix_filter=pset)
+                memory = "%10.1f" % (pset.memory / 1e6)
+            else:
+                start = time.time()
+                stream = run_stream(args)
+                for prefix in prefixes:
+                    stream.add_filter("prefix-" + args.match, prefix)
+                build = time.time() - start
+                memory = "%10s" % "-"
+            elems, secs = count_elems(stream)
+            print("%-8d %-10s %10.3f %s %10.3f %8d %10.0f" %
+                  (size, method, build, memory, secs, elems,
+                   elems / secs if secs else 0))
+
+
+if __name__ == "__main__":
+    main()
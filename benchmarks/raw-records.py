@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Compare copying the MRT encoding of each record through BGPRecord.raw
+# with writing it straight to a file from C with BGPStream.write_raw, e.g.:
+#   ./raw-records.py --upd-file updates.20200501.0000.bz2
+#
+
+import argparse
+import os
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def raw_python(stream, out):
+    size = 0
+    for rec in stream.records():
+        if rec.status == "valid":
+            size += out.write(rec.raw)
+    out.flush()
+    return size
+
+
+def raw_native(stream, out):
+    out.flush()
+    return stream.write_raw(out)["bytes"]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark writing the MRT encoding of records from Python and from C
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-o', '--output', default=os.devnull,
+                        help="File to write the records to")
+    args = parser.parse_args()
+
+    print("%-8s %12s %10s" % ("writer", "bytes", "seconds"))
+    for name, func in (("python", raw_python), ("native", raw_native)):
+        stream = pybgpstream.BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         args.upd_file)
+        with open(args.output, "wb") as out:
+            start = time.time()
+            size = func(stream, out)
+            print("%-8s %12d %10.3f" % (name, size, time.time() - start))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure record throughput of the batched record API for a range of batch
+# sizes, e.g.:
+#   ./record-batch.py --upd-file updates.20200501.0000.bz2
+#
+# Use a local MRT file to keep download time out of the measurements.
+#
+
+import argparse
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def make_stream(args):
+    stream = pybgpstream.BGPStream(data_interface="singlefile")
+    if args.rib_file:
+        stream.set_data_interface_option("singlefile", "rib-file",
+                                         args.rib_file)
+    else:
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         args.upd_file)
+    return stream
+
+
+def run(args, batch):
+    stream = make_stream(args)
+    stream.start()
+    rec_cnt = 0
+    elem_cnt = 0
+    start = time.time()
+    if batch is None:
+        while True:
+            rec = stream.get_next_record()
+            if rec is None:
+                break
+            rec_cnt += 1
+            if args.elems:
+                while rec.get_next_elem() is not None:
+                    elem_cnt += 1
+    else:
+        while True:
+            recs = stream.get_next_records(batch)
+            if not recs:
+                break
+            rec_cnt += len(recs)
+            if args.elems:
+                for rec in recs:
+                    while rec.get_next_elem() is not None:
+                        elem_cnt += 1
+    return rec_cnt, elem_cnt, time.time() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark get_next_record against get_next_records(N)
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-r', '--rib-file',
+                        help="MRT RIB file to read (instead of updates)")
+    parser.add_argument('-e', '--elems', action="store_true",
+                        help="Also read all elems of every record")
+    parser.add_argument('-m', '--max-batch', type=int, default=4096,
+                        help="Largest batch size to test")
+    args = parser.parse_args()
+
+    batches = [None]
+    batch = 1
+    while batch <= args.max_batch:
+        batches.append(batch)
+        batch *= 2
+
+    print("%-8s %10s %10s %10s %12s" %
+          ("batch", "records", "elems", "seconds", "records/sec"))
+    for batch in batches:
+        rec_cnt, elem_cnt, secs = run(args, batch)
+        print("%-8s %10d %10d %10.3f %12.0f" %
+              ("-" if batch is None else batch, rec_cnt, elem_cnt, secs,
+               rec_cnt / secs if secs else 0))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,93 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Compare getting the elems of each record one at a time (iterating over
+# the record) with getting them all at once with get_elems(), which decodes
+# them with the GIL released. A second Python thread counts how often it
+# gets to run meanwhile, e.g.:
+#   ./record-elems.py --rib-file rib.20200501.0000.bz2
+#
+
+import argparse
+import threading
+import time
+
+import pybgpstream
+
+DEFAULT_RIB_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/RIBS/rib.20200501.0000.bz2"
+
+
+def iterate(rec):
+    return sum(1 for elem in rec)
+
+
+def get_elems(rec):
+    return len(rec.get_elems())
+
+
+def run(args, func):
+    stream = pybgpstream.BGPStream(data_interface="singlefile")
+    stream.set_data_interface_option("singlefile", "rib-file", args.rib_file)
+
+    done = threading.Event()
+    ticks = [0]
+
+    def ticker():
+        while not done.is_set():
+            ticks[0] += 1
+
+    thread = threading.Thread(target=ticker)
+    thread.start()
+    start = time.time()
+    cnt = 0
+    for rec in stream.records():
+        cnt += func(rec)
+    secs = time.time() - start
+    done.set()
+    thread.join()
+    return cnt, secs, ticks[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark getting the elems of records in bulk
+    """)
+    parser.add_argument('-r', '--rib-file', default=DEFAULT_RIB_FILE,
+                        help="MRT RIB file to read")
+    args = parser.parse_args()
+
+    print("%-10s %10s %10s %12s %14s" %
+          ("mode", "elems", "seconds", "elems/sec", "other thread"))
+    for name, func in (("iterate", iterate), ("get_elems", get_elems)):
+        cnt, secs, ticks = run(args, func)
+        print("%-10s %10d %10.3f %12.0f %14d" %
+              (name, cnt, secs, cnt / secs if secs else 0, ticks))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,152 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Compare keeping the routes of each peer in Python dicts keyed by prefix
+# strings with keeping them in a RoutingTable, which applies the elems in C
+# and stores each distinct set of path attributes once. The dicts are built
+# twice: once timed, and once with tracemalloc to measure their size, e.g.:
+#   ./routing-table.py --rib-file rib.20200501.0000.bz2 \
+#       --upd-file updates.20200501.0000.bz2
+#
+
+import argparse
+import random
+import time
+import tracemalloc
+
+import pybgpstream
+
+DEFAULT_RIB_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/RIBS/rib.20200501.0000.bz2"
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def make_stream(args):
+    stream = pybgpstream.BGPStream(data_interface="singlefile")
+    stream.set_data_interface_option("singlefile", "rib-file", args.rib_file)
+    if args.upd_file:
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         args.upd_file)
+    return stream
+
+
+def build_dicts(args):
+    tables = {}
+    cnt = 0
+    for elem in make_stream(args):
+        cnt += 1
+        peer = (elem.collector, elem.peer_asn, elem.peer_address)
+        if elem.type in ("rib", "announcement"):
+            fields = elem.fields
+            tables.setdefault(peer, {})[fields["prefix"]] = (
+                fields["next-hop"], fields["as-path"],
+                frozenset(fields["communities"]), int(elem.time))
+        elif elem.type == "withdrawal":
+            tables.get(peer, {}).pop(elem.fields["prefix"], None)
+        elif elem.fields.get("new-state", "established") != "established":
+            tables.pop(peer, None)
+    return tables, cnt
+
+
+def run_dicts(args):
+    start = time.time()
+    tables, cnt = build_dicts(args)
+    secs = time.time() - start
+    routes = sum(len(t) for t in tables.values())
+    del tables
+
+    tracemalloc.start()
+    tables, _ = build_dicts(args)
+    memory = tracemalloc.get_traced_memory()[0]
+    tracemalloc.stop()
+    return cnt, routes, secs, memory
+
+
+def run_table(args):
+    table = pybgpstream.RoutingTable()
+    start = time.time()
+    cnt = make_stream(args).update_routing_table(table)
+    secs = time.time() - start
+    return table, cnt, secs
+
+
+def run_lookups(args, table):
+    rnd = random.Random(0)
+    addrs = ["%d.%d.%d.%d" % (rnd.randint(1, 223), rnd.randint(0, 255),
+                              rnd.randint(0, 255), rnd.randint(0, 255))
+             for _ in range(args.lookups)]
+    start = time.time()
+    found = 0
+    for addr in addrs:
+        found += len(table.longest_match(addr))
+    return found, time.time() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark per-peer routing tables
+    """)
+    parser.add_argument('-r', '--rib-file', default=DEFAULT_RIB_FILE,
+                        help="MRT RIB file to read")
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to apply after the RIB ('' "
+                        "for none)")
+    parser.add_argument('-l', '--lookups', type=int, default=10000,
+                        help="Number of longest-match lookups (all peers)")
+    parser.add_argument('--skip-dicts', action="store_true",
+                        help="Only build the RoutingTable")
+    args = parser.parse_args()
+
+    print("%-14s %10s %10s %10s %12s %12s" %
+          ("mode", "elems", "routes", "seconds", "elems/sec", "MiB"))
+    if not args.skip_dicts:
+        cnt, routes, secs, memory = run_dicts(args)
+        print("%-14s %10d %10d %10.3f %12.0f %12.1f" %
+              ("dicts", cnt, routes, secs, cnt / secs if secs else 0,
+               memory / 1048576.0))
+
+    table, cnt, secs = run_table(args)
+    print("%-14s %10d %10d %10.3f %12.0f %12.1f" %
+          ("RoutingTable", cnt, len(table), secs, cnt / secs if secs else 0,
+           table.memory / 1048576.0))
+
+    stats = table.get_stats()
+    print("\n%d peers, %d trie nodes, %d distinct attribute sets" %
+          (stats["peers"], stats["nodes"], stats["attributes"]))
+    for name, size in sorted(stats["memory"].items()):
+        print("  %-12s %10.1f MiB" % (name, size / 1048576.0))
+
+    if args.lookups > 0:
+        found, secs = run_lookups(args, table)
+        print("\n%d longest-match lookups (%d routes found): %.0f "
+              "lookups/sec" % (args.lookups, found,
+                               args.lookups / secs if secs else 0))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,88 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure the overhead of the stream counters and timers, and show where
+# the time of each access pattern goes (reading in libbgpstream vs building
+# Python objects), e.g.:
+#   ./stats.py --upd-file updates.20200501.0000.bz2
+#
+
+import argparse
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def run(args, enabled, fields):
+    stream = pybgpstream.BGPStream(data_interface="singlefile")
+    stream.set_data_interface_option("singlefile", "upd-file", args.upd_file)
+    stream.set_stats_enabled(enabled)
+    start = time.time()
+    for elem in stream:
+        if fields:
+            elem.fields
+    return time.time() - start, stream.get_stats()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark the overhead of stream statistics
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-n', '--repeat', type=int, default=3,
+                        help="Number of runs for each mode (best is reported)")
+    args = parser.parse_args()
+
+    print("%-8s %-6s %10s %10s %10s %12s %10s" %
+          ("access", "stats", "elems", "seconds", "overhead", "read secs",
+           "conv secs"))
+    for fields in (False, True):
+        base = None
+        for enabled in (False, True):
+            best = None
+            for _ in range(args.repeat):
+                secs, stats = run(args, enabled, fields)
+                if best is None or secs < best[0]:
+                    best = (secs, stats)
+            secs, stats = best
+            if base is None:
+                base = secs
+            print("%-8s %-6s %10s %10.3f %9.1f%% %12s %10s" %
+                  ("fields" if fields else "iterate",
+                   "on" if enabled else "off",
+                   stats["elems"] if stats else "-", secs,
+                   100.0 * (secs / base - 1) if base else 0,
+                   "%.3f" % stats["read_time"] if stats else "-",
+                   "%.3f" % stats["convert_time"] if stats else "-"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#
+# Measure how reading streams scales with the number of threads, with each
+# thread reading its own stream, e.g.:
+#   ./threads.py --upd-file updates.20200501.0000.bz2 --max-threads 8
+#
+# Throughput only scales (close to) linearly with the number of threads on
+# free-threaded (no-GIL) builds of Python, e.g. python3.13t.
+#
+
+import argparse
+import sys
+import threading
+import time
+
+import pybgpstream
+
+DEFAULT_UPD_FILE = \
+    "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+
+def count_elems(args, cnts, idx):
+    stream = pybgpstream.BGPStream(data_interface="singlefile")
+    stream.set_data_interface_option("singlefile", "upd-file", args.upd_file)
+    cnt = 0
+    for elem in stream:
+        if args.fields:
+            elem.fields
+        cnt += 1
+    cnts[idx] = cnt
+
+
+def run(args, nthreads):
+    cnts = [0] * nthreads
+    threads = [threading.Thread(target=count_elems, args=(args, cnts, i))
+               for i in range(nthreads)]
+    start = time.time()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return sum(cnts), time.time() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+    Benchmark reading one stream per thread
+    """)
+    parser.add_argument('-u', '--upd-file', default=DEFAULT_UPD_FILE,
+                        help="MRT updates file to read")
+    parser.add_argument('-t', '--max-threads', type=int, default=4,
+                        help="Maximum number of threads to run")
+    parser.add_argument('-f', '--fields', action="store_true",
+                        help="Access the fields of each elem")
+    args = parser.parse_args()
+
+    gil_enabled = getattr(sys, "_is_gil_enabled", lambda: True)()
+    print("GIL %s" % ("enabled" if gil_enabled else "disabled"))
+    print("%7s %10s %10s %12s %8s" %
+          ("threads", "elems", "seconds", "elems/sec", "speedup"))
+    base_rate = None
+    nthreads = 1
+    while nthreads <= args.max_threads:
+        cnt, secs = run(args, nthreads)
+        rate = cnt / secs if secs else 0
+        if base_rate is None:
+            base_rate = rate
+        print("%7d %10d %10.3f %12.0f %8.2f" %
+              (nthreads, cnt, secs, rate, rate / base_rate if base_rate else 0))
+        nthreads *= 2
+
+
+if __name__ == "__main__":
+    main()
@@ -68,12 +68,6 @@ def get_collectors():
     return results
 
 
-# takes a record and an elem and builds a peer signature string that is globally
-# unique.
-def peer_signature(record, elem):
-    return record.project, record.collector, elem.peer_asn, elem.peer_address
-
-
 def run_bgpstream(args):
     (collector, start_time, end_time, data_type) = args
 
@@ -85,34 +79,32 @@ def run_bgpstream(args):
         record_type=data_type
         )
 
-    # per-peer data
-    peers_data = {}
+    # count elems and records per peer in a single pass in C:
+    # (bucket, project, collector, peer_asn, peer_address) ->
+    #     (elem_cnt, peer_record_cnt)
+    counts = stream.count_peers()
 
-    # loop over all records in the stream
-    for rec in stream.records():
-        # to track the peers that have elems in this record
-        peer_signatures = set()
-        # loop over all elems in the record
-        for elem in rec:
-            # create a peer signature for this elem
-            sig = peer_signature(rec, elem)
-            peer_signatures.add(sig)
-            # if this is the first time we have ever seen this peer, create
-            # an empty result: (elem_cnt, peer_record_cnt, coll_record_cnt)
-            if sig not in peers_data:
-                peers_data[sig] = [0, 0, 0]
-            peers_data[sig][0] += 1  # increment elem cnt for this peer
-
-        # done with elems, increment the 'coll_record_cnt' field for just
-        # one peer that was present in this record (allows a true, per-collector
-        # count of records since each record can contain elems for many peers)
-        if len(peer_signatures):
-            first = True
-            for sig in peer_signatures:  # increment peer_record_cnt for all
-                if first:
-                    peers_data[sig][2] += 1  # increment the coll_record_cnt
-                    first = False
-                peers_data[sig][1] += 1
+    # per-peer data: (elem_cnt, peer_record_cnt, coll_record_cnt)
+    peers_data = {}
+    for (_, project, coll, peer_asn, peer_address), (elem_cnt, record_cnt) \
+            in counts["peers"].items():
+        peers_data[(project, coll, peer_asn, peer_address)] = \
+            [elem_cnt, record_cnt, 0]
+
+    # the 'coll_record_cnt' field is only set for one peer of each collector
+    # (allows a true, per-collector count of records since each record can
+    # contain elems for many peers). The peer with the lowest ASN and address
+    # is picked (the address can be None).
+    def peer_key(sig):
+        return sig[2], sig[3] or ""
+    first_peers = {}
+    for sig in peers_data:
+        first = first_peers.get(sig[:2])
+        if first is None or peer_key(sig) < peer_key(first):
+            first_peers[sig[:2]] = sig
+    for (_, project, coll), record_cnt in counts["collectors"].items():
+        if (project, coll) in first_peers:
+            peers_data[first_peers[(project, coll)]][2] += record_cnt
 
     # the time in the output row is truncated down to a multiple of
     # RESULT_GRANULARITY so that slices can be merged correctly
@@ -37,21 +37,9 @@ stream = pybgpstream.BGPStream(
      until_time="2015-04-01 00:05:00",
      )
 
-as_topology = set()
-rib_entries = 0
-
-# Process data
-for elem in stream:
-    rib_entries += 1
-    # get the AS path
-    path = elem.fields['as-path']
-    # get the list of ASes in the path
-    ases = path.split(" ")
-    for i in range(0, len(ases)-1):
-        # avoid multiple prepended ASes
-        if ases[i] != ases[i+1]:
-            as_topology.add(tuple(sorted([ases[i],ases[i+1]])))
+# extract the AS adjacencies (ignoring prepended ASes) from the AS paths
+# of all the RIB entries, as a set of (asn, asn) tuples
+as_topology = stream.get_as_topology()
 
 # Output results
-print("Processed", rib_entries, "rib entries")
 print("Found", len(as_topology), "AS adjacencies")
@@ -0,0 +1,86 @@
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+
+import asyncio
+
+
+def _set_done(future):
+    if not future.done():
+        future.set_result(None)
+
+
+async def _wait_readable(fd):
+    loop = asyncio.get_running_loop()
+    future = loop.create_future()
+    loop.add_reader(fd, _set_done, future)
+    try:
+        await future
+    finally:
+        loop.remove_reader(fd)
+
+
+class AsyncRecordIterator(object):
+    """Asynchronous iterator over the records of a stream
+
+    Records are read ahead by the prefetch thread of the stream (which is
+    started with a default prefetch depth if none was set), and the iterator
+    waits on its notification file descriptor in the event loop instead of
+    blocking a thread, so many (live) streams can share one event loop.
+    """
+
+    def __init__(self, stream):
+        self.stream = stream
+        self.fd = stream.get_notify_fd()
+
+    def __aiter__(self):
+        return self
+
+    async def __anext__(self):
+        while True:
+            try:
+                rec = self.stream.get_next_record(block=False)
+            except BlockingIOError:
+                await _wait_readable(self.fd)
+                continue
+            if rec is None:
+                raise StopAsyncIteration
+            return rec
+
+
+class AsyncElemIterator(AsyncRecordIterator):
+    """Asynchronous iterator over the elems of a stream"""
+
+    def __init__(self, stream):
+        super(AsyncElemIterator, self).__init__(stream)
+        self.elems = iter(())
+
+    async def __anext__(self):
+        while True:
+            elem = next(self.elems, None)
+            if elem is not None:
+                return elem
+            rec = await super(AsyncElemIterator, self).__anext__()
+            self.elems = iter(rec)
@@ -0,0 +1,147 @@
+#
+# Copyright (C) 2026 The Regents of the University of California.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+
+import collections
+import multiprocessing
+
+from .pybgpstream import BGPStream
+
+
+class WorkUnit(collections.namedtuple("WorkUnit", ["index", "stream_args",
+                                                   "data_interface_options"])):
+    """A part of a stream configuration that can be processed independently
+
+    `stream_args` are the keyword arguments used to create the BGPStream, and
+    `data_interface_options` is a list of (interface, option, value) tuples
+    to set on it.
+    """
+    __slots__ = ()
+
+    def make_stream(self):
+        stream = BGPStream(**self.stream_args)
+        for interface, option, value in self.data_interface_options:
+            stream.set_data_interface_option(interface, option, value)
+        # let the mapper know which part of the stream it is processing
+        stream.work_unit = self
+        return stream
+
+
+def make_work_units(from_time=None, until_time=None, collectors=None,
+                    record_types=None, slice_size=None, upd_files=None,
+                    rib_files=None, **stream_args):
+    """Split a stream configuration into work units
+
+    If local MRT files are given (`upd_files` and/or `rib_files`), there is
+    one unit per file. Otherwise there is one unit for each combination of
+    time slice, collector and record type. Slices are `slice_size` seconds
+    long (the whole interval if None) and do not overlap. Any other keyword
+    arguments (e.g. `filter` or `project`) are passed to every BGPStream.
+    """
+    units = []
+
+    if upd_files or rib_files:
+        for option, files in (("upd-file", upd_files), ("rib-file", rib_files)):
+            for path in files or []:
+                args = dict(stream_args, data_interface="singlefile")
+                units.append(WorkUnit(len(units), args,
+                                      [("singlefile", option, path)]))
+        return units
+
+    from_epoch = BGPStream._datestr_to_epoch(from_time)
+    until_epoch = BGPStream._datestr_to_epoch(until_time)
+    if slice_size is None:
+        slices = [(from_time, until_time)]
+    elif slice_size <= 0:
+        raise ValueError("Invalid slice size: %r" % slice_size)
+    elif not from_epoch or not until_epoch:
+        raise ValueError("Time slices need both from_time and until_time")
+    else:
+        # interval filters include both ends, so slices end one second
+        # before the next one starts
+        slices = []
+        start = from_epoch
+        while start <= until_epoch:
+            slices.append((start, min(start + slice_size - 1, until_epoch)))
+            start += slice_size
+
+    for start, until in slices:
+        for collector in collectors or [None]:
+            for record_type in record_types or [None]:
+                args = dict(stream_args, from_time=start, until_time=until,
+                            collector=collector, record_type=record_type)
+                units.append(WorkUnit(len(units), args, []))
+    return units
+
+
+def _run_unit(args):
+    mapper, unit = args
+    return mapper(unit.make_stream())
+
+
+def map_reduce(units, mapper, reducer=None, initial=None, processes=None):
+    """Run mapper over each work unit in a pool of processes
+
+    `mapper` is called with the (unstarted) BGPStream of a unit and returns a
+    partial result. It can be any picklable callable, e.g. a module-level
+    Python function or a C function. Partial results are merged with
+    `reducer(result, partial)` in the order of the units (starting from
+    `initial`, or from the first partial result), so the result does not
+    depend on which process finished first. Without a reducer, the list of
+    partial results is returned.
+
+    If `processes` is 1, units are run in the current process.
+    """
+    units = sorted(units, key=lambda unit: unit.index)
+    tasks = [(mapper, unit) for unit in units]
+
+    if processes == 1:
+        partials = map(_run_unit, tasks)
+        pool = None
+    else:
+        pool = multiprocessing.Pool(processes)
+        # imap yields results in submission order
+        partials = pool.imap(_run_unit, tasks, chunksize=1)
+
+    try:
+        if reducer is None:
+            result = list(partials)
+        else:
+            result = initial
+            first = initial is None
+            for partial in partials:
+                if first:
+                    result = partial
+                    first = False
+                else:
+                    result = reducer(result, partial)
+    except BaseException:
+        if pool is not None:
+            pool.terminate()
+        raise
+    if pool is not None:
+        pool.close()
+        pool.join()
+    return result
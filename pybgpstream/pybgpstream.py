@@ -25,13 +25,22 @@
 #
 
 import datetime
+import functools
+import itertools
 import time
 
 import dateutil.parser
 import _pybgpstream
 
+# records and elems are implemented (including iteration and the lookup of
+# record attributes from elems) by the C extension
+BGPRecord = _pybgpstream.BGPRecord
+BGPElem = _pybgpstream.BGPElem
+PrefixSet = _pybgpstream.PrefixSet
+RoutingTable = _pybgpstream.RoutingTable
 
-class BGPStream:
+
+class BGPStream(_pybgpstream.BGPStream):
 
     def __init__(self,
                  from_time=None,
@@ -44,10 +53,13 @@ class BGPStream:
                  record_type=None,
                  record_types=None,
                  filter=None,
+                 address_format=None,
+                 prefetch_depth=None,
+                 prefix_filter=None,
+                 elem_filter=None,
+                 cache_dir=None,
+                 cache_size=None,
                  ):
-        # create a low-level bgpstream instance
-        self.stream = _pybgpstream.BGPStream()
-
         # pass along any config options the user asked for
 
         # time interval (accepts date/times (str) or unix-time (int))
@@ -57,37 +69,63 @@ class BGPStream:
         from_epoch = self._datestr_to_epoch(from_time)
         until_epoch = self._datestr_to_epoch(until_time)
         if from_epoch or until_epoch:
-            self.stream.add_interval_filter(from_epoch, until_epoch)
+            self.add_interval_filter(from_epoch, until_epoch)
 
         if data_interface is not None:
-            self.stream.set_data_interface(data_interface)
+            self.set_data_interface(data_interface)
 
         self._maybe_add_filter("project", project, projects)
         self._maybe_add_filter("collector", collector, collectors)
         self._maybe_add_filter("record-type", record_type, record_types)
 
         if filter is not None:
-            self.stream.parse_filter_string(filter)
+            self.parse_filter_string(filter)
+
+        if address_format is not None:
+            self.set_address_format(address_format)
+
+        if prefetch_depth is not None:
+            self.set_prefetch_depth(prefetch_depth)
 
-        self.started = False
+        if prefix_filter is not None:
+            self.set_prefix_filter(prefix_filter)
 
-    def __iter__(self):
-        for _rec in self.records():
-            for _elem in _rec:
-                yield _elem
+        if elem_filter is not None:
+            self.add_elem_filter(elem_filter)
 
-    def __getattr__(self, attr):
-        return getattr(self.stream, attr)
+        if cache_dir is not None:
+            if cache_size is not None:
+                self.set_cache(cache_dir, cache_size)
+            else:
+                self.set_cache(cache_dir)
 
-    def records(self):
+    @property
+    def stream(self):
+        # the low-level stream used to be a separate object
+        return self
+
+    def records(self, batch=None):
+        if not self.started:
+            self.start()
+        if batch:
+            # fetch (and fully decode) up to `batch` records per call
+            return itertools.chain.from_iterable(
+                iter(functools.partial(self.get_next_records, batch), []))
+        return iter(self.get_next_record, None)
+
+    def __aiter__(self):
+        # async iteration needs Python 3, so it lives in its own module
+        from .aio import AsyncElemIterator
+        return AsyncElemIterator(self)
+
+    def async_records(self):
+        from .aio import AsyncRecordIterator
+        return AsyncRecordIterator(self)
+
+    def arrow_stream(self, columns=None, batch_size=65536):
         if not self.started:
-            self.stream.start()
-            self.started = True
-        while True:
-            _rec = self.stream.get_next_record()
-            if _rec is None:
-                return
-            yield BGPRecord(_rec)
+            self.start()
+        return BGPElemArrowStream(self, columns, batch_size)
 
     def _maybe_add_filter(self, fname, f_single, f_list):
         if f_list is None:
@@ -95,7 +133,7 @@ class BGPStream:
         if f_single is not None:
             f_list.append(f_single)
         for f in f_list:
-            self.stream.add_filter(fname, f)
+            self.add_filter(fname, f)
 
     @staticmethod
     def _datestr_to_epoch(datestr):
@@ -112,59 +150,14 @@ class BGPStream:
         return int((dt - datetime.datetime(1970, 1, 1)).total_seconds())
 
 
-class BGPRecord:
-
-    def __init__(self, rec):
-        self.rec = rec
-
-    def __iter__(self):
-        while True:
-            _elem = self.rec.get_next_elem()
-            if _elem is None:
-                return
-            yield BGPElem(self, _elem)
-
-    def __getattr__(self, attr):
-        return getattr(self.rec, attr)
-
-    def __str__(self):
-        return "%s|%s|%f|%s|%s|%s|%s|%s|%d" % (self.type, self.dump_position, self.time,
-                                               self.project, self.collector, self.router, self.router_ip,
-                                               self.status, self.dump_time)
-
-
-class BGPElem:
-
-    def __init__(self, rec, elem):
-        self.record = rec
-        self._elem = elem
-
-    def __getattr__(self, attr):
-        try:
-            return getattr(self._elem, attr)
-        except AttributeError:
-            if attr == "record_type":
-                attr = "type"
-            return getattr(self.record, attr)
-
-    def __str__(self):
-        return "%s|%s|%f|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s" % (
-            self.record_type,
-            self.type,
-            self.time,
-            self.project,
-            self.collector,
-            self.router,
-            self.router_ip,
-            self.peer_asn,
-            self.peer_address,
-            self._maybe_field("prefix"),
-            self._maybe_field("next-hop"),
-            self._maybe_field("as-path"),
-            " ".join(self.fields["communities"]) if "communities" in self.fields else None,
-            self._maybe_field("old-state"),
-            self._maybe_field("new-state")
-        )
-
-    def _maybe_field(self, field):
-        return self.fields[field] if field in self.fields else None
+class BGPElemArrowStream:
+
+    def __init__(self, stream, columns, batch_size):
+        self.stream = stream
+        self.columns = columns
+        self.batch_size = batch_size
+
+    def __arrow_c_stream__(self, requested_schema=None):
+        # the requested schema is only a hint, and we always export the same
+        # column types
+        return self.stream.get_arrow_stream(self.columns, self.batch_size)
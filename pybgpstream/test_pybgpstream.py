@@ -1,6 +1,17 @@
+import gc
+import ipaddress
+import itertools
+import os
+import re
+import shutil
+import tempfile
+import threading
+import time
+import weakref
 from unittest import TestCase
 
-from pybgpstream import BGPStream
+import _pybgpstream
+from pybgpstream import BGPStream, PrefixSet, RoutingTable, parallel
 
 
 class TestBGPStream(TestCase):
@@ -21,6 +32,81 @@ class TestBGPStream(TestCase):
             elem_cnt += 1
         self.assertEqual(213692, elem_cnt)
 
+    def test_batch_records(self):
+        """
+        Test batched record retrieval for PyBGPStream
+        """
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2")
+        elem_cnt = 0
+        for rec in stream.records(batch=64):
+            for _ in rec:
+                elem_cnt += 1
+        self.assertEqual(213692, elem_cnt)
+
+    def test_started(self):
+        """
+        Test setting the started attribute of a stream
+        """
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2")
+        self.assertFalse(stream.started)
+        stream.started = False
+        stream.start()
+        # code written for the former wrapper class set it after start()
+        stream.started = True
+        self.assertTrue(stream.started)
+        with self.assertRaises(ValueError):
+            stream.started = False
+        elem_cnt = 0
+        for _ in stream:
+            elem_cnt += 1
+        self.assertEqual(213692, elem_cnt)
+
+    def test_address_format(self):
+        """
+        Test getting addresses and prefixes as bytes and ints
+        """
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+        def get_addresses(address_format, parse_address, parse_prefix):
+            stream = BGPStream(data_interface="singlefile",
+                               address_format=address_format)
+            stream.set_data_interface_option("singlefile", "upd-file",
+                                             upd_file)
+            addresses = []
+            for elem in stream:
+                prefix = elem.fields.get("prefix")
+                next_hop = elem.fields.get("next-hop")
+                addresses.append((
+                    parse_address(elem.peer_address),
+                    None if prefix is None else parse_prefix(prefix),
+                    None if next_hop is None else parse_address(next_hop)))
+            return addresses
+
+        def parse_str_prefix(prefix):
+            address, mask_len = prefix.split("/")
+            return ipaddress.ip_address(address), int(mask_len)
+
+        def parse_int_address(address):
+            value, version = address
+            if version == 4:
+                return ipaddress.IPv4Address(value)
+            return ipaddress.IPv6Address(value)
+
+        addresses = get_addresses("str", ipaddress.ip_address,
+                                  parse_str_prefix)
+        self.assertEqual(213692, len(addresses))
+        self.assertEqual(addresses, get_addresses(
+            "bytes", ipaddress.ip_address,
+            lambda prefix: (ipaddress.ip_address(prefix[0]), prefix[1])))
+        self.assertEqual(addresses, get_addresses(
+            "int", parse_int_address,
+            lambda prefix: (parse_int_address((prefix[0], prefix[2])),
+                            prefix[1])))
+
     def test_filters(self):
         """
         Test filter strings for PyBGPStream
@@ -35,3 +121,669 @@ class TestBGPStream(TestCase):
         for _ in stream:
             elem_cnt += 1
         self.assertEqual(11, elem_cnt)
+
+    def test_work_units(self):
+        """
+        Test splitting a stream configuration into work units
+        """
+        units = parallel.make_work_units(
+            from_time=1000, until_time=1999, slice_size=300,
+            collectors=["route-views.sg", "route-views.eqix"],
+            record_types=["updates"], filter="peer 11666")
+        self.assertEqual(8, len(units))
+        self.assertEqual(list(range(8)), [unit.index for unit in units])
+        slices = sorted(set((unit.stream_args["from_time"],
+                             unit.stream_args["until_time"]) for unit in units))
+        self.assertEqual([(1000, 1299), (1300, 1599), (1600, 1899),
+                          (1900, 1999)], slices)
+        for unit in units:
+            self.assertEqual("peer 11666", unit.stream_args["filter"])
+
+        units = parallel.make_work_units(upd_files=["a.bz2", "b.bz2"])
+        self.assertEqual([[("singlefile", "upd-file", "a.bz2")],
+                          [("singlefile", "upd-file", "b.bz2")]],
+                         [unit.data_interface_options for unit in units])
+
+    def test_prefix_set(self):
+        """
+        Test prefix matching with a PrefixSet
+        """
+        prefixes = PrefixSet(["10.0.0.0/8", "2001:db8::/32"], match="more")
+        prefixes.add("192.0.2.0/24", match="less")
+        prefixes.add("198.51.100.0/24")
+        self.assertEqual(4, len(prefixes))
+        self.assertTrue(prefixes.match("10.1.0.0/16"))
+        self.assertFalse(prefixes.match("10.0.0.0/7"))
+        self.assertTrue(prefixes.match("2001:db8:1::/48"))
+        self.assertTrue(prefixes.match("192.0.0.0/16"))
+        self.assertFalse(prefixes.match("192.0.2.128/25"))
+        self.assertTrue(prefixes.match("198.51.100.0/24"))
+        self.assertFalse(prefixes.match("198.51.100.0/25"))
+        self.assertRaises(ValueError, prefixes.add, "10.0.0.0/33")
+
+        stream = BGPStream(data_interface="singlefile",
+                           prefix_filter=prefixes)
+        self.assertTrue(prefixes.frozen)
+        self.assertRaises(RuntimeError, prefixes.add, "10.0.0.0/8")
+
+        # the filter keeps the same elems as matching them in Python
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+        prefixes = PrefixSet(["1.0.0.0/8", "2400::/12"], match="more")
+        prefixes.add("8.8.8.0/24")
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        elem_cnt = 0
+        expected_cnt = 0
+        for elem in stream:
+            elem_cnt += 1
+            if "prefix" in elem.fields and \
+                    prefixes.match(elem.fields["prefix"]):
+                expected_cnt += 1
+        self.assertEqual(213692, elem_cnt)
+        self.assertTrue(0 < expected_cnt < elem_cnt)
+        stream = BGPStream(data_interface="singlefile",
+                           prefix_filter=prefixes)
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        filtered_cnt = 0
+        for elem in stream:
+            self.assertTrue(prefixes.match(elem.fields["prefix"]))
+            filtered_cnt += 1
+        self.assertEqual(expected_cnt, filtered_cnt)
+
+    def test_elem_filter(self):
+        """
+        Test compiling elem filter expressions
+        """
+        stream = BGPStream(data_interface="singlefile",
+                           elem_filter="origin-asn in {3356, 174}")
+        stream.add_elem_filter("not (path-len > 6 or prefix-len >= 25) and "
+                               "community in {65535:*, *:666}")
+        stream.add_elem_filter("path contains 3356 or type = withdrawal")
+        for expression in ["", "origin-asn", "prefix-len > x",
+                           "origin-asn in {3356", "community 65536:1",
+                           "type = bogus", "(peer-asn = 1"]:
+            self.assertRaises(ValueError, stream.add_elem_filter,
+                              expression)
+
+        # filtered streams keep the same elems as the filters written in
+        # Python over the unfiltered stream
+        def origin_asn(elem):
+            path = elem.as_path_asns
+            if path and isinstance(path[-1], int):
+                return path[-1]
+            return None
+
+        def path_len(elem):
+            path = elem.get_as_path_asns(collapse_prepending=True)
+            return None if path is None else len(path)
+
+        def has_community(elem):
+            return any(asn == 3356 or value == 666
+                       for asn, value in elem.community_values or ())
+
+        filters = [
+            ("origin-asn in {3356, 174, 13335}",
+             lambda elem: origin_asn(elem) in (3356, 174, 13335)),
+            ("path-len > 4",
+             lambda elem: path_len(elem) is not None and path_len(elem) > 4),
+            # elems without an AS path fail "path-len > 4", so they pass
+            # its negation
+            ("not path-len > 4",
+             lambda elem: path_len(elem) is None or path_len(elem) <= 4),
+            ("community in {3356:*, *:666}", has_community),
+            ("type = withdrawal or prefix-len >= 24 and peer-asn != 7660",
+             lambda elem: elem.type == "withdrawal" or
+             (elem.peer_asn != 7660 and "prefix" in elem.fields and
+              int(elem.fields["prefix"].split("/")[1]) >= 24)),
+        ]
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        expected_cnts = [0] * len(filters)
+        elem_cnt = 0
+        for elem in stream:
+            elem_cnt += 1
+            for i, (_, match) in enumerate(filters):
+                if match(elem):
+                    expected_cnts[i] += 1
+        self.assertEqual(213692, elem_cnt)
+        for (expression, _), expected_cnt in zip(filters, expected_cnts):
+            stream = BGPStream(data_interface="singlefile",
+                               elem_filter=expression)
+            stream.set_data_interface_option("singlefile", "upd-file",
+                                             upd_file)
+            self.assertEqual(expected_cnt, sum(1 for _ in stream),
+                             expression)
+
+    def test_arrow_stream(self):
+        """
+        Test exporting elems as an Arrow stream
+        """
+        try:
+            import pyarrow
+        except ImportError:
+            self.skipTest("pyarrow is not installed")
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        reader = pyarrow.RecordBatchReader.from_stream(
+            stream.arrow_stream(batch_size=10000))
+        self.assertEqual(pyarrow.schema([
+            pyarrow.field("time", pyarrow.timestamp("us", tz="UTC"),
+                          nullable=False),
+            pyarrow.field("type", pyarrow.string(), nullable=False),
+            pyarrow.field("peer_asn", pyarrow.uint32(), nullable=False),
+            pyarrow.field("peer_address", pyarrow.string(), nullable=False),
+            pyarrow.field("prefix", pyarrow.string()),
+            pyarrow.field("next_hop", pyarrow.string()),
+            pyarrow.field("as_path", pyarrow.string()),
+            pyarrow.field("communities", pyarrow.list_(
+                pyarrow.field("item", pyarrow.string(), nullable=False))),
+        ]), reader.schema)
+        row_cnt = 0
+        for batch in reader:
+            self.assertTrue(0 < batch.num_rows <= 10000)
+            row_cnt += batch.num_rows
+        self.assertEqual(213692, row_cnt)
+
+        # columns are built in the requested order
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        table = pyarrow.RecordBatchReader.from_stream(
+            stream.arrow_stream(columns=["collector", "prefix"])).read_all()
+        self.assertEqual(["collector", "prefix"], table.column_names)
+        self.assertEqual(213692, table.num_rows)
+
+    def test_count_peers(self):
+        """
+        Test counting elems and records per peer
+        """
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+        peers = {}
+        collectors = {}
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        for rec in stream.records():
+            if rec.status != "valid":
+                continue
+            bucket = int(rec.time) // 300 * 300
+            rec_peers = set()
+            for elem in rec:
+                sig = (bucket, rec.project, rec.collector, elem.peer_asn,
+                       elem.peer_address)
+                peers.setdefault(sig, [0, 0])[0] += 1
+                rec_peers.add(sig)
+            for sig in rec_peers:
+                peers[sig][1] += 1
+            if rec_peers:
+                sig = (bucket, rec.project, rec.collector)
+                collectors[sig] = collectors.get(sig, 0) + 1
+        self.assertEqual(213692, sum(cnt[0] for cnt in peers.values()))
+
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        counts = stream.count_peers(bucket_size=300)
+        self.assertEqual(dict((sig, tuple(cnt))
+                              for sig, cnt in peers.items()),
+                         counts["peers"])
+        self.assertEqual(collectors, counts["collectors"])
+
+    def test_as_topology(self):
+        """
+        Test extracting AS adjacencies
+        """
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+        def new_stream():
+            stream = BGPStream(data_interface="singlefile")
+            stream.set_data_interface_option("singlefile", "upd-file",
+                                             upd_file)
+            return stream
+
+        # (count, first_seen, peers) of each adjacency
+        edges = {}
+        for rec in new_stream().records():
+            if rec.status != "valid":
+                continue
+            for elem in rec:
+                if elem.type not in ("rib", "announcement"):
+                    continue
+                path = elem.get_as_path_asns(collapse_prepending=True)
+                for a, b in zip(path, path[1:]):
+                    if not isinstance(a, int) or not isinstance(b, int):
+                        continue
+                    edge = edges.setdefault((min(a, b), max(a, b)),
+                                            [0, int(rec.time), set()])
+                    edge[0] += 1
+                    edge[1] = min(edge[1], int(rec.time))
+                    edge[2].add(elem.peer_asn)
+        self.assertTrue(edges)
+
+        self.assertEqual(set(edges), new_stream().get_as_topology())
+        self.assertEqual(
+            dict((edge, (cnt, first_seen, frozenset(peers)))
+                 for edge, (cnt, first_seen, peers) in edges.items()),
+            new_stream().get_as_topology(counts=True, first_seen=True,
+                                         peers=True))
+        self.assertEqual(
+            dict((edge, (cnt, None, None))
+                 for edge, (cnt, _, _) in edges.items()),
+            new_stream().get_as_topology(counts=True))
+
+        buffers = new_stream().get_as_topology(counts=True, as_buffers=True)
+        edge_asns = buffers["edges"].tolist()
+        self.assertEqual(2 * len(edges), len(edge_asns))
+        self.assertEqual(len(edges), len(buffers["counts"]))
+        buffer_edges = dict(
+            ((edge_asns[2 * i], edge_asns[2 * i + 1]), cnt)
+            for i, cnt in enumerate(buffers["counts"].tolist()))
+        self.assertEqual(dict((edge, cnt) for edge, (cnt, _, _)
+                              in edges.items()), buffer_edges)
+
+    def test_mrt_encoding(self):
+        """
+        Test the MRT encoding of records
+        """
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        mrt_size = 0
+        for rec in stream.records():
+            if rec.status == "valid":
+                self.assertTrue(rec.mrt_encoding.readonly)
+                self.assertEqual(bytes(rec), rec.mrt_encoding.tobytes())
+                mrt_size += len(rec.mrt_encoding)
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        with tempfile.TemporaryFile() as out:
+            stats = stream.write_mrt(out)
+            self.assertEqual(mrt_size, out.seek(0, 2))
+        self.assertEqual(mrt_size, stats["bytes"])
+        self.assertEqual(213692, stats["elems"])
+
+        # elems that were already read cannot be encoded any more
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        rec = next(rec for rec in stream.records() if rec.status == "valid")
+        rec.get_next_elem()
+        self.assertRaises(BufferError, bytes, rec)
+
+    def test_mrt_round_trip(self):
+        """
+        Test reading back the MRT encoding of a stream
+        """
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+        def elems(path):
+            stream = BGPStream(data_interface="singlefile")
+            stream.set_data_interface_option("singlefile", "upd-file", path)
+            for elem in stream:
+                # the encoding only keeps the time in seconds
+                yield (elem.type, int(elem.time), elem.peer_asn,
+                       elem.peer_address, elem.fields)
+
+        tmp_dir = tempfile.mkdtemp()
+        try:
+            mrt_file = os.path.join(tmp_dir, "updates.mrt")
+            stream = BGPStream(data_interface="singlefile")
+            stream.set_data_interface_option("singlefile", "upd-file",
+                                             upd_file)
+            with open(mrt_file, "wb") as out:
+                stats = stream.write_mrt(out)
+            self.assertEqual(213692, stats["elems"])
+            elem_cnt = 0
+            for orig, copy in itertools.zip_longest(elems(upd_file),
+                                                    elems(mrt_file)):
+                self.assertEqual(orig, copy)
+                elem_cnt += 1
+            self.assertEqual(213692, elem_cnt)
+        finally:
+            shutil.rmtree(tmp_dir)
+
+    def test_elem_cache(self):
+        """
+        Test reading a stream through the decoded-elem cache
+        """
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+        cache_dir = tempfile.mkdtemp()
+        try:
+            elems = []
+            for hit in (False, True):
+                stream = BGPStream(data_interface="singlefile",
+                                   cache_dir=cache_dir)
+                stream.set_data_interface_option("singlefile", "upd-file",
+                                                 upd_file)
+                elems.append([str(elem) for elem in stream])
+                self.assertEqual(hit, stream.get_cache_info()["hit"])
+            self.assertEqual(213692, len(elems[0]))
+            self.assertEqual(elems[0], elems[1])
+        finally:
+            shutil.rmtree(cache_dir)
+
+    def test_checkpoint(self):
+        """
+        Test resuming a stream from a checkpoint
+        """
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        records = stream.records()
+        # the 1000th record is consumed once the next one is asked for
+        elem_cnt = sum(len(list(rec)) for rec in itertools.islice(records,
+                                                                   1000))
+        next(records)
+        token = stream.checkpoint()
+
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        stream.resume(token)
+        elem_cnt += sum(1 for elem in stream)
+        self.assertEqual(213692, elem_cnt)
+
+    def test_async_iteration(self):
+        """
+        Test iterating over the elems of a stream in an asyncio event loop
+        """
+        import asyncio
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", upd_file)
+        elems = stream.__aiter__()
+        loop = asyncio.new_event_loop()
+        elem_cnt = 0
+        try:
+            while True:
+                loop.run_until_complete(elems.__anext__())
+                elem_cnt += 1
+        except StopAsyncIteration:
+            pass
+        finally:
+            loop.close()
+        self.assertEqual(213692, elem_cnt)
+
+    def test_threads(self):
+        """
+        Test reading from one stream per thread and from a shared stream
+        """
+        upd_file = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+        def make_stream(**kwargs):
+            stream = BGPStream(data_interface="singlefile", **kwargs)
+            stream.set_data_interface_option("singlefile", "upd-file",
+                                             upd_file)
+            return stream
+
+        def count(elems, idx):
+            elem_cnts[idx] = sum(1 for elem in elems)
+
+        elem_cnts = [0] * 4
+        threads = [threading.Thread(target=count, args=(make_stream(), i))
+                   for i in range(len(elem_cnts))]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual([213692] * len(elem_cnts), elem_cnts)
+
+        # records of a shared stream must be detached from it
+        elems = iter(make_stream(prefetch_depth=16))
+        threads = [threading.Thread(target=count, args=(elems, i))
+                   for i in range(len(elem_cnts))]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(213692, sum(elem_cnts))
+
+    def test_threads_get_elems(self):
+        """
+        Test getting the elems of one record from two threads at once
+        """
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2")
+        stream.start()
+        barrier = threading.Barrier(3)
+        recs = [None]
+        results = [(), ()]
+
+        def get_elems(idx):
+            while True:
+                barrier.wait()
+                if recs[0] is None:
+                    return
+                results[idx] = recs[0].get_elems()
+                barrier.wait()
+
+        threads = [threading.Thread(target=get_elems, args=(i,))
+                   for i in range(len(results))]
+        for thread in threads:
+            thread.start()
+        elem_cnt = 0
+        try:
+            while True:
+                # the record is borrowed from the stream, so both threads
+                # decode it at once
+                recs[0] = stream.get_next_record()
+                barrier.wait()
+                if recs[0] is None:
+                    break
+                barrier.wait()
+                # one thread gets the elems, and the other none
+                self.assertEqual(0, min(len(elems) for elems in results))
+                elem_cnt += sum(len(elems) for elems in results)
+        except Exception:
+            barrier.abort()
+            raise
+        finally:
+            for thread in threads:
+                thread.join()
+        self.assertEqual(213692, elem_cnt)
+
+    def test_prefetch_shutdown(self):
+        """
+        Test dropping a prefetching stream while a read is pending
+        """
+        tmpdir = tempfile.mkdtemp()
+        fifo = os.path.join(tmpdir, "updates.mrt")
+        os.mkfifo(fifo)
+        try:
+            # nothing is ever written to the fifo, so the read of the
+            # prefetch thread blocks until the fifo is closed below
+            stream = _pybgpstream.BGPStream()
+            stream.set_data_interface("singlefile")
+            stream.set_data_interface_option("singlefile", "upd-file", fifo)
+            stream.set_prefetch_depth(4)
+            stream.start()
+            time.sleep(0.5)
+            streams = [stream]
+            del stream
+            thread = threading.Thread(target=streams.pop)
+            thread.start()
+            thread.join(10)
+            self.assertFalse(thread.is_alive())
+        finally:
+            # let the read return, so that the prefetch thread exits
+            try:
+                os.close(os.open(fifo, os.O_WRONLY | os.O_NONBLOCK))
+            except OSError:
+                pass
+            shutil.rmtree(tmpdir)
+
+    def test_stats(self):
+        """
+        Test the counters and timers of a stream
+        """
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2")
+        reports = []
+        stream.set_stats_callback(reports.append, interval=0.01)
+        for elem in stream:
+            elem.fields
+        stats = stream.get_stats()
+        self.assertEqual(213692, stats["elems"])
+        self.assertEqual(213692, stats["objects"]["elems"])
+        self.assertEqual(stats["records"], stats["objects"]["records"])
+        self.assertEqual(stats["records"],
+                         sum(stats["record_status"].values()))
+        self.assertTrue(len(reports) > 0)
+
+        # a callback bound to the owner of the stream must not keep it alive
+        class Owner(object):
+            def __init__(self):
+                self.stream = _pybgpstream.BGPStream()
+                self.stream.set_stats_callback(self.on_stats)
+
+            def on_stats(self, stats):
+                pass
+
+        owner = weakref.ref(Owner())
+        gc.collect()
+        self.assertIsNone(owner())
+
+    def test_get_elems(self):
+        """
+        Test getting all elems of each record at once
+        """
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2")
+        elem_cnt = 0
+        for rec in stream.records():
+            elems = rec.get_elems()
+            elem_cnt += len(elems)
+            self.assertEqual((), rec.get_elems())
+        self.assertEqual(213692, elem_cnt)
+
+    def test_community_values(self):
+        """
+        Test getting communities as shared (asn, value) tuples
+        """
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2")
+        elem_cnt = 0
+        for elem in stream:
+            elem_cnt += 1
+            if elem.type in ("rib", "announcement"):
+                self.assertEqual(elem.communities,
+                                 set("%d:%d" % c
+                                     for c in elem.community_values))
+                # fields gets a mutable copy of the cached frozenset
+                self.assertIsInstance(elem.communities, frozenset)
+                fields_communities = elem.fields["communities"]
+                self.assertEqual(elem.communities, fields_communities)
+                fields_communities.add("0:0")
+                self.assertNotIn("0:0", elem.communities)
+            else:
+                self.assertIsNone(elem.community_values)
+        self.assertEqual(213692, elem_cnt)
+        stats = _pybgpstream.get_object_cache_stats()["communities"]
+        self.assertTrue(stats["hits"] > 0)
+        self.assertTrue(stats["size"] <= stats["max_size"])
+
+    def test_as_path_asns(self):
+        """
+        Test getting AS paths as tuples of ASNs
+        """
+        seg_types = {"{": "set", "(": "confed-seq", "[": "confed-set"}
+
+        def parse_as_path(as_path):
+            hops = []
+            for hop in re.findall(r"[{(\[][^})\]]*[})\]]|\d+", as_path):
+                if hop[0] in seg_types:
+                    hops.append((seg_types[hop[0]],
+                                 tuple(int(asn) for asn in
+                                       re.findall(r"\d+", hop))))
+                else:
+                    hops.append(int(hop))
+            return tuple(hops)
+
+        def collapse(hops):
+            return tuple(hop for i, hop in enumerate(hops)
+                         if i == 0 or not isinstance(hop, int) or
+                         hop != hops[i - 1])
+
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file",
+                                         "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2")
+        elem_cnt = 0
+        collapsed_cnt = 0
+        for elem in stream:
+            elem_cnt += 1
+            if elem.type not in ("rib", "announcement"):
+                self.assertIsNone(elem.as_path_asns)
+                self.assertIsNone(
+                    elem.get_as_path_asns(collapse_prepending=True))
+                continue
+            hops = parse_as_path(elem.as_path)
+            self.assertEqual(hops, elem.as_path_asns)
+            self.assertEqual(hops, elem.get_as_path_asns())
+            collapsed = elem.get_as_path_asns(collapse_prepending=True)
+            self.assertEqual(collapse(hops), collapsed)
+            if len(collapsed) < len(hops):
+                collapsed_cnt += 1
+        self.assertEqual(213692, elem_cnt)
+        self.assertTrue(collapsed_cnt > 0)
+
+    def test_object_cache(self):
+        """
+        Test sharing prefixes and AS paths between elems
+        """
+        url = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+
+        def get_values():
+            stream = BGPStream(data_interface="singlefile")
+            stream.set_data_interface_option("singlefile", "upd-file", url)
+            return [(elem.prefix, elem.as_path, elem.as_path_asns)
+                    for elem in stream]
+
+        values = get_values()
+        _pybgpstream.set_object_cache_size(prefixes=65536, as_paths=65536)
+        try:
+            shared = get_values()
+            stats = _pybgpstream.get_object_cache_stats()
+        finally:
+            _pybgpstream.set_object_cache_size(prefixes=0, as_paths=0)
+        self.assertEqual(213692, len(shared))
+        self.assertEqual(values, shared)
+        for name in ("prefixes", "as_paths"):
+            self.assertTrue(stats[name]["hits"] > 0)
+            self.assertTrue(stats[name]["memory"] > 0)
+        prefixes = {}
+        for prefix, _, _ in shared[:1000]:
+            if prefix is not None:
+                self.assertIs(prefixes.setdefault(prefix, prefix), prefix)
+
+    def test_routing_table(self):
+        """
+        Test maintaining the routes of each peer
+        """
+        url = "http://routeviews.org/route-views.sg/bgpdata/2020.05/UPDATES/updates.20200501.0000.bz2"
+        routes = {}
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", url)
+        for elem in stream:
+            peer = (elem.collector, elem.peer_asn, elem.peer_address)
+            if elem.type == "announcement":
+                routes.setdefault(peer, {})[elem.fields["prefix"]] = \
+                    elem.fields["as-path"]
+            elif elem.type == "withdrawal":
+                routes.setdefault(peer, {}).pop(elem.fields["prefix"], None)
+            elif elem.fields.get("new-state", "established") != "established":
+                routes[peer] = {}
+
+        table = RoutingTable()
+        stream = BGPStream(data_interface="singlefile")
+        stream.set_data_interface_option("singlefile", "upd-file", url)
+        self.assertEqual(213692, stream.update_routing_table(table))
+        self.assertEqual(sum(len(r) for r in routes.values()), len(table))
+        for peer, peer_routes in routes.items():
+            self.assertEqual(peer_routes,
+                             dict((route["prefix"], route["as-path"])
+                                  for route in table.get_routes(peer)))
+            for prefix, as_path in itertools.islice(peer_routes.items(), 10):
+                self.assertEqual(as_path, table.lookup(prefix, peer)["as-path"])
+                self.assertEqual(prefix,
+                                 table.longest_match(prefix, peer)["prefix"])
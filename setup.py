@@ -32,7 +32,27 @@ _pybgpstream_module = Extension("_pybgpstream",
                                            "src/_pybgpstream_module.c",
                                            "src/_pybgpstream_bgpstream.c",
                                            "src/_pybgpstream_bgprecord.c",
-                                           "src/_pybgpstream_bgpelem.c"])
+                                           "src/_pybgpstream_bgpelem.c",
+                                           "src/_pybgpstream_detached.c",
+                                           "src/_pybgpstream_freelist.c",
+                                           "src/_pybgpstream_objcache.c",
+                                           "src/_pybgpstream_prefetch.c",
+                                           "src/_pybgpstream_cache.c",
+                                           "src/_pybgpstream_checkpoint.c",
+                                           "src/_pybgpstream_reader.c",
+                                           "src/_pybgpstream_peercount.c",
+                                           "src/_pybgpstream_utils.c",
+                                           "src/_pybgpstream_u64set.c",
+                                           "src/_pybgpstream_topology.c",
+                                           "src/_pybgpstream_pfxtrie.c",
+                                           "src/_pybgpstream_prefixset.c",
+                                           "src/_pybgpstream_pred.c",
+                                           "src/_pybgpstream_elemfilter.c",
+                                           "src/_pybgpstream_mrt.c",
+                                           "src/_pybgpstream_arrow.c",
+                                           "src/_pybgpstream_rib.c",
+                                           "src/_pybgpstream_routingtable.c",
+                                           "src/_pybgpstream_stats.c"])
 
 setup(name = "pybgpstream",
       description = "A Python interface to BGPStream",
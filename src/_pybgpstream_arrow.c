@@ -0,0 +1,1065 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_arrow.h"
+#include "_pybgpstream_reader.h"
+#include <Python.h>
+#include <bgpstream.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Arrow C data and C stream interfaces. These structures are ABI-stable and
+   are copied verbatim from the Arrow specification:
+   https://arrow.apache.org/docs/format/CDataInterface.html */
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  const char *format;
+  const char *name;
+  const char *metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema **children;
+  struct ArrowSchema *dictionary;
+  void (*release)(struct ArrowSchema *);
+  void *private_data;
+};
+
+struct ArrowArray {
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void **buffers;
+  struct ArrowArray **children;
+  struct ArrowArray *dictionary;
+  void (*release)(struct ArrowArray *);
+  void *private_data;
+};
+
+#endif /* ARROW_C_DATA_INTERFACE */
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+struct ArrowArrayStream {
+  int (*get_schema)(struct ArrowArrayStream *, struct ArrowSchema *out);
+  int (*get_next)(struct ArrowArrayStream *, struct ArrowArray *out);
+  const char *(*get_last_error)(struct ArrowArrayStream *);
+  void (*release)(struct ArrowArrayStream *);
+  void *private_data;
+};
+
+#endif /* ARROW_C_STREAM_INTERFACE */
+
+#define ARROW_STREAM_CAPSULE_NAME "arrow_array_stream"
+
+/* Stop filling a batch once a variable-length column gets this big so that
+   32-bit offsets can never overflow */
+#define MAX_VARDATA_LEN (1 << 30)
+
+typedef enum {
+  COL_TIME = 0,
+  COL_TYPE,
+  COL_PEER_ASN,
+  COL_PEER_ADDRESS,
+  COL_PREFIX,
+  COL_NEXT_HOP,
+  COL_AS_PATH,
+  COL_COMMUNITIES,
+  COL_PROJECT,
+  COL_COLLECTOR,
+  COL_CNT,
+} column_id_t;
+
+typedef enum {
+  KIND_INT64,
+  KIND_UINT32,
+  KIND_UTF8,
+  KIND_UTF8_LIST,
+} column_kind_t;
+
+static const struct {
+  const char *name;
+  const char *format;
+  column_kind_t kind;
+  int nullable;
+  int is_default;
+} column_info[] = {
+  {"time", "tsu:UTC", KIND_INT64, 0, 1},
+  {"type", "u", KIND_UTF8, 0, 1},
+  {"peer_asn", "I", KIND_UINT32, 0, 1},
+  {"peer_address", "u", KIND_UTF8, 0, 1},
+  {"prefix", "u", KIND_UTF8, 1, 1},
+  {"next_hop", "u", KIND_UTF8, 1, 1},
+  {"as_path", "u", KIND_UTF8, 1, 1},
+  {"communities", "+l", KIND_UTF8_LIST, 1, 1},
+  {"project", "u", KIND_UTF8, 1, 0},
+  {"collector", "u", KIND_UTF8, 1, 0},
+};
+
+/* ========== BUFFERS ========== */
+
+typedef struct {
+  uint8_t *data;
+  size_t len;
+  size_t alloc;
+} buf_t;
+
+static int buf_reserve(buf_t *buf, size_t extra)
+{
+  uint8_t *tmp;
+  size_t new_alloc;
+  if (buf->len + extra <= buf->alloc) {
+    return 0;
+  }
+  new_alloc = (buf->alloc == 0) ? 1024 : buf->alloc;
+  while (new_alloc < buf->len + extra) {
+    new_alloc *= 2;
+  }
+  if ((tmp = realloc(buf->data, new_alloc)) == NULL) {
+    return -1;
+  }
+  buf->data = tmp;
+  buf->alloc = new_alloc;
+  return 0;
+}
+
+static int buf_append(buf_t *buf, const void *data, size_t len)
+{
+  if (buf_reserve(buf, len) != 0) {
+    return -1;
+  }
+  memcpy(buf->data + buf->len, data, len);
+  buf->len += len;
+  return 0;
+}
+
+/* hand ownership of the buffer memory to the caller */
+static void *buf_steal(buf_t *buf)
+{
+  void *data = buf->data;
+  buf->data = NULL;
+  buf->len = 0;
+  buf->alloc = 0;
+  return data;
+}
+
+/* ========== COLUMN BUILDERS ========== */
+
+typedef struct {
+  column_id_t id;
+
+  /** Number of values appended */
+  int64_t length;
+
+  /** Number of null values appended */
+  int64_t null_cnt;
+
+  /** Validity bitmap (only used for nullable columns) */
+  buf_t validity;
+
+  /** Offsets for utf8 and list columns */
+  buf_t offsets;
+
+  /** Fixed-width values, or string bytes */
+  buf_t data;
+
+  /** Child offsets and string bytes for list<utf8> columns */
+  buf_t child_offsets;
+  buf_t child_data;
+  int64_t child_length;
+
+} col_builder_t;
+
+static void col_free(col_builder_t *col)
+{
+  free(col->validity.data);
+  free(col->offsets.data);
+  free(col->data.data);
+  free(col->child_offsets.data);
+  free(col->child_data.data);
+  memset(col, 0, sizeof(col_builder_t));
+}
+
+/* reset the builder for a new batch (buffers must already be free/stolen) */
+static int col_init(col_builder_t *col)
+{
+  int32_t zero = 0;
+  col->length = 0;
+  col->null_cnt = 0;
+  col->child_length = 0;
+
+  /* make sure every buffer we export is non-NULL, even when empty */
+  if (buf_reserve(&col->validity, 1) != 0 || buf_reserve(&col->data, 1) != 0) {
+    return -1;
+  }
+  switch (column_info[col->id].kind) {
+  case KIND_UTF8_LIST:
+    if (buf_append(&col->child_offsets, &zero, sizeof(zero)) != 0 ||
+        buf_reserve(&col->child_data, 1) != 0) {
+      return -1;
+    }
+    /* FALLTHROUGH */
+  case KIND_UTF8:
+    if (buf_append(&col->offsets, &zero, sizeof(zero)) != 0) {
+      return -1;
+    }
+    break;
+  default:
+    break;
+  }
+  return 0;
+}
+
+static int col_set_valid(col_builder_t *col, int valid)
+{
+  int64_t idx = col->length;
+  if (!column_info[col->id].nullable) {
+    return 0;
+  }
+  if ((idx % 8) == 0) {
+    uint8_t zero = 0;
+    if (buf_append(&col->validity, &zero, 1) != 0) {
+      return -1;
+    }
+  }
+  if (valid) {
+    col->validity.data[idx / 8] |= (uint8_t)(1 << (idx % 8));
+  } else {
+    col->null_cnt++;
+  }
+  return 0;
+}
+
+static int col_end_var_row(col_builder_t *col)
+{
+  int32_t off;
+  if (column_info[col->id].kind == KIND_UTF8_LIST) {
+    off = (int32_t)col->child_length;
+  } else {
+    off = (int32_t)col->data.len;
+  }
+  if (buf_append(&col->offsets, &off, sizeof(off)) != 0) {
+    return -1;
+  }
+  col->length++;
+  return 0;
+}
+
+static int col_append_null(col_builder_t *col)
+{
+  if (col_set_valid(col, 0) != 0) {
+    return -1;
+  }
+  switch (column_info[col->id].kind) {
+  case KIND_INT64: {
+    int64_t zero = 0;
+    if (buf_append(&col->data, &zero, sizeof(zero)) != 0) {
+      return -1;
+    }
+    col->length++;
+    return 0;
+  }
+  case KIND_UINT32: {
+    uint32_t zero = 0;
+    if (buf_append(&col->data, &zero, sizeof(zero)) != 0) {
+      return -1;
+    }
+    col->length++;
+    return 0;
+  }
+  default:
+    return col_end_var_row(col);
+  }
+}
+
+static int col_append_int64(col_builder_t *col, int64_t val)
+{
+  if (col_set_valid(col, 1) != 0 ||
+      buf_append(&col->data, &val, sizeof(val)) != 0) {
+    return -1;
+  }
+  col->length++;
+  return 0;
+}
+
+static int col_append_uint32(col_builder_t *col, uint32_t val)
+{
+  if (col_set_valid(col, 1) != 0 ||
+      buf_append(&col->data, &val, sizeof(val)) != 0) {
+    return -1;
+  }
+  col->length++;
+  return 0;
+}
+
+static int col_append_str(col_builder_t *col, const char *str)
+{
+  if (col_set_valid(col, 1) != 0 ||
+      buf_append(&col->data, str, strlen(str)) != 0) {
+    return -1;
+  }
+  return col_end_var_row(col);
+}
+
+/* ========== EXPORT ========== */
+
+typedef struct {
+  const void *buffers[3];
+  struct ArrowArray *children[1];
+  struct ArrowArray child;
+} col_array_private_t;
+
+static void col_array_release(struct ArrowArray *array)
+{
+  col_array_private_t *priv = array->private_data;
+  int i;
+
+  for (i = 0; i < array->n_buffers; i++) {
+    free((void *)priv->buffers[i]);
+  }
+  if (array->n_children > 0 && priv->child.release != NULL) {
+    priv->child.release(&priv->child);
+  }
+  free(priv);
+  array->release = NULL;
+}
+
+static void fill_var_array(struct ArrowArray *array, const void **buffers,
+                           int64_t length, int64_t null_cnt)
+{
+  array->length = length;
+  array->null_count = null_cnt;
+  array->offset = 0;
+  array->n_buffers = 3;
+  array->n_children = 0;
+  array->buffers = buffers;
+  array->children = NULL;
+  array->dictionary = NULL;
+}
+
+/* move the contents of the builder into the given ArrowArray */
+static int col_export(col_builder_t *col, struct ArrowArray *out)
+{
+  col_array_private_t *priv;
+  col_array_private_t *child_priv = NULL;
+  void *validity;
+
+  if ((priv = calloc(1, sizeof(col_array_private_t))) == NULL) {
+    return -1;
+  }
+
+  /* the validity bitmap may be NULL if there are no nulls */
+  validity = buf_steal(&col->validity);
+  if (col->null_cnt == 0) {
+    free(validity);
+    validity = NULL;
+  }
+  priv->buffers[0] = validity;
+
+  out->length = col->length;
+  out->null_count = col->null_cnt;
+  out->offset = 0;
+  out->n_children = 0;
+  out->buffers = priv->buffers;
+  out->children = NULL;
+  out->dictionary = NULL;
+  out->release = col_array_release;
+  out->private_data = priv;
+
+  switch (column_info[col->id].kind) {
+  case KIND_INT64:
+  case KIND_UINT32:
+    out->n_buffers = 2;
+    priv->buffers[1] = buf_steal(&col->data);
+    break;
+
+  case KIND_UTF8:
+    out->n_buffers = 3;
+    priv->buffers[1] = buf_steal(&col->offsets);
+    priv->buffers[2] = buf_steal(&col->data);
+    break;
+
+  case KIND_UTF8_LIST:
+    out->n_buffers = 2;
+    priv->buffers[1] = buf_steal(&col->offsets);
+    free(buf_steal(&col->data));
+
+    if ((child_priv = calloc(1, sizeof(col_array_private_t))) == NULL) {
+      col_array_release(out);
+      return -1;
+    }
+    child_priv->buffers[0] = NULL;
+    child_priv->buffers[1] = buf_steal(&col->child_offsets);
+    child_priv->buffers[2] = buf_steal(&col->child_data);
+    fill_var_array(&priv->child, child_priv->buffers, col->child_length, 0);
+    priv->child.release = col_array_release;
+    priv->child.private_data = child_priv;
+
+    priv->children[0] = &priv->child;
+    out->n_children = 1;
+    out->children = priv->children;
+    break;
+  }
+
+  return 0;
+}
+
+typedef struct {
+  const void *buffers[1];
+  int64_t n_children;
+  struct ArrowArray **children;
+} batch_private_t;
+
+static void batch_release(struct ArrowArray *array)
+{
+  batch_private_t *priv = array->private_data;
+  int i;
+
+  for (i = 0; i < priv->n_children; i++) {
+    if (priv->children[i]->release != NULL) {
+      priv->children[i]->release(priv->children[i]);
+    }
+    free(priv->children[i]);
+  }
+  free(priv->children);
+  free(priv);
+  array->release = NULL;
+}
+
+typedef struct {
+  struct ArrowSchema *children;
+  struct ArrowSchema **children_ptrs;
+  struct ArrowSchema list_item;
+  struct ArrowSchema *list_item_ptr;
+} schema_private_t;
+
+static void schema_release(struct ArrowSchema *schema)
+{
+  schema_private_t *priv = schema->private_data;
+  int i;
+
+  if (priv != NULL) {
+    for (i = 0; i < schema->n_children; i++) {
+      if (priv->children_ptrs[i]->release != NULL) {
+        priv->children_ptrs[i]->release(priv->children_ptrs[i]);
+      }
+    }
+    free(priv->children_ptrs);
+    free(priv->children);
+    free(priv);
+  }
+  schema->release = NULL;
+}
+
+/* The item schema of a list column is embedded in the private data of the
+   list schema, so there is nothing to free */
+static void list_item_schema_release(struct ArrowSchema *schema)
+{
+  schema->release = NULL;
+}
+
+static void list_schema_release(struct ArrowSchema *schema)
+{
+  schema_private_t *priv = schema->private_data;
+  if (priv->list_item.release != NULL) {
+    priv->list_item.release(&priv->list_item);
+  }
+  free(priv);
+  schema->release = NULL;
+}
+
+static void schema_fill(struct ArrowSchema *schema, const char *format,
+                        const char *name, int64_t flags)
+{
+  schema->format = format;
+  schema->name = name;
+  schema->metadata = NULL;
+  schema->flags = flags;
+  schema->n_children = 0;
+  schema->children = NULL;
+  schema->dictionary = NULL;
+  schema->release = schema_release;
+  schema->private_data = NULL;
+}
+
+/* ========== ELEM STREAM ========== */
+
+typedef struct {
+  /** Python object that owns bs */
+  PyObject *pystream;
+
+  /** Lock of pystream, held while reading from it */
+  pthread_mutex_t *lock;
+
+  /** Reader that records and elems are read from (reader.rec is the
+      record that elems are currently being read from) */
+  pybgpstream_reader_t reader;
+
+  /** Set once the end of the stream has been reached */
+  int eos;
+
+  /** Maximum number of elems per batch */
+  int batch_size;
+
+  /** Column builders, in output order */
+  col_builder_t *cols;
+  int cols_cnt;
+
+  /** Message describing the last error */
+  char last_error[256];
+
+} elem_stream_t;
+
+static int stream_get_schema(struct ArrowArrayStream *stream,
+                             struct ArrowSchema *out)
+{
+  elem_stream_t *es = stream->private_data;
+  schema_private_t *priv;
+  struct ArrowSchema *child;
+  int i;
+
+  if ((priv = calloc(1, sizeof(schema_private_t))) == NULL ||
+      (priv->children = calloc(es->cols_cnt, sizeof(struct ArrowSchema))) ==
+        NULL ||
+      (priv->children_ptrs = calloc(es->cols_cnt,
+                                    sizeof(struct ArrowSchema *))) == NULL) {
+    if (priv != NULL) {
+      free(priv->children);
+      free(priv);
+    }
+    snprintf(es->last_error, sizeof(es->last_error), "Out of memory");
+    return ENOMEM;
+  }
+
+  schema_fill(out, "+s", "", 0);
+  out->n_children = es->cols_cnt;
+  out->children = priv->children_ptrs;
+  out->private_data = priv;
+
+  for (i = 0; i < es->cols_cnt; i++) {
+    column_id_t id = es->cols[i].id;
+    child = &priv->children[i];
+    priv->children_ptrs[i] = child;
+    schema_fill(child, column_info[id].format, column_info[id].name,
+                column_info[id].nullable ? ARROW_FLAG_NULLABLE : 0);
+    if (column_info[id].kind == KIND_UTF8_LIST) {
+      /* the list item schema is released along with its parent */
+      schema_private_t *cpriv;
+      if ((cpriv = calloc(1, sizeof(schema_private_t))) == NULL) {
+        out->n_children = i;
+        schema_release(out);
+        snprintf(es->last_error, sizeof(es->last_error), "Out of memory");
+        return ENOMEM;
+      }
+      schema_fill(&cpriv->list_item, "u", "item", 0);
+      cpriv->list_item.release = list_item_schema_release;
+      cpriv->list_item_ptr = &cpriv->list_item;
+      child->n_children = 1;
+      child->children = &cpriv->list_item_ptr;
+      child->release = list_schema_release;
+      child->private_data = cpriv;
+    }
+  }
+
+  return 0;
+}
+
+static int append_elem(elem_stream_t *es, bgpstream_record_t *rec,
+                       bgpstream_elem_t *elem)
+{
+  char buf[INET6_ADDRSTRLEN + 4];
+  int has_attrs = (elem->type == BGPSTREAM_ELEM_TYPE_RIB ||
+                   elem->type == BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT);
+  int has_prefix = (has_attrs || elem->type == BGPSTREAM_ELEM_TYPE_WITHDRAWAL);
+  col_builder_t *col;
+  int i, j;
+
+  for (i = 0; i < es->cols_cnt; i++) {
+    col = &es->cols[i];
+    switch (col->id) {
+    case COL_TIME:
+      if (col_append_int64(col, (int64_t)rec->time_sec * 1000000 +
+                                  rec->time_usec) != 0) {
+        return -1;
+      }
+      break;
+
+    case COL_TYPE:
+      bgpstream_elem_type_snprintf(buf, sizeof(buf), elem->type);
+      if (col_append_str(col, buf) != 0) {
+        return -1;
+      }
+      break;
+
+    case COL_PEER_ASN:
+      if (col_append_uint32(col, elem->peer_asn) != 0) {
+        return -1;
+      }
+      break;
+
+    case COL_PEER_ADDRESS:
+      buf[0] = '\0';
+      bgpstream_addr_ntop(buf, sizeof(buf),
+                          (bgpstream_ip_addr_t *)&elem->peer_ip);
+      if (col_append_str(col, buf) != 0) {
+        return -1;
+      }
+      break;
+
+    case COL_PREFIX:
+      if (!has_prefix) {
+        if (col_append_null(col) != 0) {
+          return -1;
+        }
+        break;
+      }
+      if (bgpstream_pfx_snprintf(buf, sizeof(buf),
+                                 (bgpstream_pfx_t *)&elem->prefix) == NULL ||
+          col_append_str(col, buf) != 0) {
+        return -1;
+      }
+      break;
+
+    case COL_NEXT_HOP:
+      if (!has_attrs) {
+        if (col_append_null(col) != 0) {
+          return -1;
+        }
+        break;
+      }
+      buf[0] = '\0';
+      bgpstream_addr_ntop(buf, sizeof(buf),
+                          (bgpstream_ip_addr_t *)&elem->nexthop);
+      if (col_append_str(col, buf) != 0) {
+        return -1;
+      }
+      break;
+
+    case COL_AS_PATH: {
+      size_t avail;
+      int len;
+      if (!has_attrs || elem->as_path == NULL) {
+        if (col_append_null(col) != 0) {
+          return -1;
+        }
+        break;
+      }
+      /* format straight into the column data buffer */
+      if (col_set_valid(col, 1) != 0 || buf_reserve(&col->data, 1024) != 0) {
+        return -1;
+      }
+      avail = col->data.alloc - col->data.len;
+      len = bgpstream_as_path_snprintf((char *)col->data.data + col->data.len,
+                                       avail, elem->as_path);
+      if (len < 0) {
+        return -1;
+      }
+      if ((size_t)len >= avail) {
+        if (buf_reserve(&col->data, len + 1) != 0) {
+          return -1;
+        }
+        bgpstream_as_path_snprintf((char *)col->data.data + col->data.len,
+                                   len + 1, elem->as_path);
+      }
+      col->data.len += len;
+      if (col_end_var_row(col) != 0) {
+        return -1;
+      }
+      break;
+    }
+
+    case COL_COMMUNITIES: {
+      int cnt;
+      if (!has_attrs || elem->communities == NULL) {
+        if (col_append_null(col) != 0) {
+          return -1;
+        }
+        break;
+      }
+      if (col_set_valid(col, 1) != 0) {
+        return -1;
+      }
+      cnt = bgpstream_community_set_size(elem->communities);
+      for (j = 0; j < cnt; j++) {
+        int32_t off;
+        int len = bgpstream_community_snprintf(
+          buf, sizeof(buf), bgpstream_community_set_get(elem->communities, j));
+        if (len < 0 || (size_t)len >= sizeof(buf) ||
+            buf_append(&col->child_data, buf, len) != 0) {
+          return -1;
+        }
+        off = (int32_t)col->child_data.len;
+        if (buf_append(&col->child_offsets, &off, sizeof(off)) != 0) {
+          return -1;
+        }
+        col->child_length++;
+      }
+      if (col_end_var_row(col) != 0) {
+        return -1;
+      }
+      break;
+    }
+
+    case COL_PROJECT:
+    case COL_COLLECTOR: {
+      const char *str = (col->id == COL_PROJECT) ? rec->project_name
+                                                 : rec->collector_name;
+      if (str[0] == '\0') {
+        if (col_append_null(col) != 0) {
+          return -1;
+        }
+      } else if (col_append_str(col, str) != 0) {
+        return -1;
+      }
+      break;
+    }
+
+    default:
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int batch_full(elem_stream_t *es, int rows)
+{
+  int i;
+  if (rows >= es->batch_size) {
+    return 1;
+  }
+  for (i = 0; i < es->cols_cnt; i++) {
+    if (es->cols[i].data.len > MAX_VARDATA_LEN ||
+        es->cols[i].child_data.len > MAX_VARDATA_LEN) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* read elems from the stream until the batch is full (no Python API calls) */
+static int fill_batch(elem_stream_t *es)
+{
+  bgpstream_elem_t *elem = NULL;
+  int rows = 0;
+  int ret;
+
+  while (!es->eos && !batch_full(es, rows)) {
+    if (es->reader.rec == NULL) {
+      ret = pybgpstream_reader_next_record(&es->reader);
+      if (ret < 0) {
+        snprintf(es->last_error, sizeof(es->last_error),
+                 "Could not get next record (is the stream started?)");
+        return -1;
+      } else if (ret == 0) {
+        es->eos = 1;
+        break;
+      }
+    }
+
+    ret = pybgpstream_reader_next_elem(&es->reader, &elem);
+    if (ret < 0) {
+      snprintf(es->last_error, sizeof(es->last_error),
+               "Could not get next elem");
+      return -1;
+    } else if (ret == 0) {
+      /* done with this record */
+      pybgpstream_reader_clear(&es->reader);
+      continue;
+    }
+
+    if (append_elem(es, es->reader.rec, elem) != 0) {
+      snprintf(es->last_error, sizeof(es->last_error),
+               "Could not append elem to batch");
+      return -1;
+    }
+    rows++;
+  }
+
+  return rows;
+}
+
+static int stream_get_next(struct ArrowArrayStream *stream,
+                           struct ArrowArray *out)
+{
+  elem_stream_t *es = stream->private_data;
+  batch_private_t *priv = NULL;
+  int rows;
+  int i;
+#if PY_MAJOR_VERSION > 2
+  PyThreadState *save = NULL;
+
+  /* decoding may take a while, so let other threads run if we were called
+     with the GIL held */
+  if (PyGILState_Check()) {
+    save = PyEval_SaveThread();
+  }
+#endif
+
+  pthread_mutex_lock(es->lock);
+  rows = fill_batch(es);
+  pthread_mutex_unlock(es->lock);
+
+#if PY_MAJOR_VERSION > 2
+  if (save != NULL) {
+    PyEval_RestoreThread(save);
+  }
+#endif
+
+  if (rows < 0) {
+    goto err;
+  }
+  if (rows == 0 && es->eos) {
+    /* end of stream */
+    out->release = NULL;
+    return 0;
+  }
+
+  if ((priv = calloc(1, sizeof(batch_private_t))) == NULL ||
+      (priv->children = calloc(es->cols_cnt, sizeof(struct ArrowArray *))) ==
+        NULL) {
+    goto nomem;
+  }
+  for (i = 0; i < es->cols_cnt; i++) {
+    if ((priv->children[i] = calloc(1, sizeof(struct ArrowArray))) == NULL) {
+      goto nomem;
+    }
+    priv->n_children++;
+    if (col_export(&es->cols[i], priv->children[i]) != 0 ||
+        col_init(&es->cols[i]) != 0) {
+      goto nomem;
+    }
+  }
+
+  priv->buffers[0] = NULL;
+  out->length = rows;
+  out->null_count = 0;
+  out->offset = 0;
+  out->n_buffers = 1;
+  out->n_children = es->cols_cnt;
+  out->buffers = priv->buffers;
+  out->children = priv->children;
+  out->dictionary = NULL;
+  out->release = batch_release;
+  out->private_data = priv;
+  return 0;
+
+nomem:
+  snprintf(es->last_error, sizeof(es->last_error), "Out of memory");
+  if (priv != NULL) {
+    struct ArrowArray tmp;
+    tmp.private_data = priv;
+    batch_release(&tmp);
+  }
+err:
+  /* the builders may hold a partial batch, so they cannot be re-used */
+  es->eos = 1;
+  return EIO;
+}
+
+static const char *stream_get_last_error(struct ArrowArrayStream *stream)
+{
+  elem_stream_t *es = stream->private_data;
+  return es->last_error[0] == '\0' ? NULL : es->last_error;
+}
+
+static void elem_stream_destroy(elem_stream_t *es)
+{
+  int i;
+  if (es == NULL) {
+    return;
+  }
+  for (i = 0; i < es->cols_cnt; i++) {
+    col_free(&es->cols[i]);
+  }
+  free(es->cols);
+  pybgpstream_reader_clear(&es->reader);
+  free(es);
+}
+
+static void stream_release(struct ArrowArrayStream *stream)
+{
+  elem_stream_t *es = stream->private_data;
+  PyGILState_STATE gstate;
+
+  /* we may be called from a thread that does not hold the GIL */
+  gstate = PyGILState_Ensure();
+  Py_XDECREF(es->pystream);
+  PyGILState_Release(gstate);
+
+  elem_stream_destroy(es);
+  stream->release = NULL;
+}
+
+static void capsule_destructor(PyObject *capsule)
+{
+  struct ArrowArrayStream *stream =
+    PyCapsule_GetPointer(capsule, ARROW_STREAM_CAPSULE_NAME);
+  if (stream == NULL) {
+    return;
+  }
+  /* the consumer will have cleared release if it took ownership */
+  if (stream->release != NULL) {
+    stream->release(stream);
+  }
+  free(stream);
+}
+
+static int parse_columns(elem_stream_t *es, PyObject *columns)
+{
+  PyObject *seq = NULL;
+  PyObject *item;
+  const char *name;
+  Py_ssize_t cnt;
+  Py_ssize_t i;
+  int j;
+
+  if (columns == NULL || columns == Py_None) {
+    if ((es->cols = calloc(COL_CNT, sizeof(col_builder_t))) == NULL) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    for (j = 0; j < COL_CNT; j++) {
+      if (column_info[j].is_default) {
+        es->cols[es->cols_cnt++].id = j;
+      }
+    }
+    return 0;
+  }
+
+  if ((seq = PySequence_Fast(columns, "columns must be a sequence")) == NULL) {
+    return -1;
+  }
+  cnt = PySequence_Fast_GET_SIZE(seq);
+  if (cnt == 0) {
+    PyErr_SetString(PyExc_ValueError, "At least one column is required");
+    goto err;
+  }
+  if ((es->cols = calloc(cnt, sizeof(col_builder_t))) == NULL) {
+    PyErr_NoMemory();
+    goto err;
+  }
+  for (i = 0; i < cnt; i++) {
+    item = PySequence_Fast_GET_ITEM(seq, i);
+#if PY_MAJOR_VERSION > 2
+    name = PyUnicode_Check(item) ? PyUnicode_AsUTF8(item) : NULL;
+#else
+    name = PyString_Check(item) ? PyString_AsString(item) : NULL;
+#endif
+    if (name == NULL) {
+      PyErr_SetString(PyExc_TypeError, "Column names must be strings");
+      goto err;
+    }
+    for (j = 0; j < COL_CNT; j++) {
+      if (strcmp(column_info[j].name, name) == 0) {
+        break;
+      }
+    }
+    if (j == COL_CNT) {
+      PyErr_Format(PyExc_ValueError, "Invalid column: %s", name);
+      goto err;
+    }
+    es->cols[es->cols_cnt++].id = j;
+  }
+
+  Py_DECREF(seq);
+  return 0;
+
+err:
+  Py_XDECREF(seq);
+  return -1;
+}
+
+PyObject *_pybgpstream_arrow_stream_new(PyObject *pystream, bgpstream_t *bs,
+                                        pybgpstream_prefetch_t *pf,
+                                        pybgpstream_cache_t *cache,
+                                        pybgpstream_checkpoint_t *cp,
+                                        const pybgpstream_elemfilter_t *filter,
+                                        pthread_mutex_t *lock,
+                                        pybgpstream_stats_t *stats,
+                                        PyObject *columns, int batch_size)
+{
+  elem_stream_t *es;
+  struct ArrowArrayStream *stream;
+  PyObject *capsule;
+  int i;
+
+  if (batch_size <= 0) {
+    return PyErr_Format(PyExc_ValueError, "Invalid batch size: %d",
+                        batch_size);
+  }
+
+  if ((es = calloc(1, sizeof(elem_stream_t))) == NULL) {
+    return PyErr_NoMemory();
+  }
+  pybgpstream_reader_init(&es->reader, bs, pf, cache, cp, filter, stats);
+  es->batch_size = batch_size;
+
+  if (parse_columns(es, columns) != 0) {
+    elem_stream_destroy(es);
+    return NULL;
+  }
+  for (i = 0; i < es->cols_cnt; i++) {
+    if (col_init(&es->cols[i]) != 0) {
+      elem_stream_destroy(es);
+      return PyErr_NoMemory();
+    }
+  }
+
+  if ((stream = malloc(sizeof(struct ArrowArrayStream))) == NULL) {
+    elem_stream_destroy(es);
+    return PyErr_NoMemory();
+  }
+  stream->get_schema = stream_get_schema;
+  stream->get_next = stream_get_next;
+  stream->get_last_error = stream_get_last_error;
+  stream->release = stream_release;
+  stream->private_data = es;
+
+  Py_INCREF(pystream);
+  es->pystream = pystream;
+  es->lock = lock;
+
+  if ((capsule = PyCapsule_New(stream, ARROW_STREAM_CAPSULE_NAME,
+                               capsule_destructor)) == NULL) {
+    stream->release(stream);
+    free(stream);
+    return NULL;
+  }
+
+  return capsule;
+}
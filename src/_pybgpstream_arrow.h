@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_ARROW_H
+#define ___PYBGPSTREAM_ARROW_H
+
+#include "_pybgpstream_prefetch.h"
+#include "_pybgpstream_stats.h"
+#include <Python.h>
+#include <bgpstream.h>
+#include <pthread.h>
+
+/** Create an Arrow C stream capsule that drains elems from a started stream
+ *
+ * @param pystream      stream object that owns bs (a reference is kept until
+ *                      the Arrow stream is released)
+ * @param bs            pointer to the libbgpstream instance to read from
+ * @param pf            pointer to the prefetcher to read records from
+ *                      instead of bs, or NULL
+ * @param cache         pointer to the cache of the stream to read records
+ *                      through instead of bs, or NULL
+ * @param cp            pointer to the checkpoint tracker of the stream
+ * @param filter        filter that elems must pass, or NULL
+ * @param lock          lock of pystream, held while reading from it
+ * @param stats         pointer to the statistics of the stream, or NULL
+ * @param columns       sequence of column names to build, or NULL/None to
+ *                      build the default columns
+ * @param batch_size    maximum number of elems in each exported batch
+ * @return a new "arrow_array_stream" PyCapsule, or NULL if an error occurred
+ */
+PyObject *_pybgpstream_arrow_stream_new(PyObject *pystream, bgpstream_t *bs,
+                                        pybgpstream_prefetch_t *pf,
+                                        pybgpstream_cache_t *cache,
+                                        pybgpstream_checkpoint_t *cp,
+                                        const pybgpstream_elemfilter_t *filter,
+                                        pthread_mutex_t *lock,
+                                        pybgpstream_stats_t *stats,
+                                        PyObject *columns, int batch_size);
+
+#endif /* ___PYBGPSTREAM_ARROW_H */
@@ -25,12 +25,35 @@
  */
 
 #include "_pybgpstream_bgpelem.h"
+#include "_pybgpstream_freelist.h"
+#include "_pybgpstream_module.h"
+#include "_pybgpstream_utils.h"
 #include "pyutils.h"
 #include <Python.h>
 #include <bgpstream.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define BGPElemDocstring "BGPElem object"
 
+static PyTypeObject BGPElemType;
+
+/* deallocated BGPElem objects kept for re-use */
+static pybgpstream_freelist_t freelist;
+
+/* community sets shared between elems */
+static pybgpstream_objcache_t community_cache =
+  PYBGPSTREAM_OBJCACHE_INIT(PYBGPSTREAM_COMMUNITY_CACHE_DEFAULT_SIZE);
+
+/* prefixes and AS paths shared between elems (disabled by default) */
+static pybgpstream_objcache_t prefix_cache = PYBGPSTREAM_OBJCACHE_INIT(0);
+static pybgpstream_objcache_t as_path_cache = PYBGPSTREAM_OBJCACHE_INIT(0);
+
+/* representations of AS paths kept in the AS path cache */
+#define AS_PATH_KIND_STR 0
+#define AS_PATH_KIND_ASNS 1
+#define AS_PATH_KIND_ASNS_COLLAPSED 2
+
 static PyObject *get_pfx_pystr(bgpstream_pfx_t *pfx)
 {
   char pfx_str[INET6_ADDRSTRLEN + 3] = "";
@@ -39,6 +62,70 @@ static PyObject *get_pfx_pystr(bgpstream_pfx_t *pfx)
   return PYSTR_FROMSTR(pfx_str);
 }
 
+/* build a prefix value in the given representation */
+static PyObject *get_pfx_pyobj(bgpstream_pfx_t *pfx,
+                               pybgpstream_addr_format_t format)
+{
+  int version;
+
+  switch (format) {
+  case PYBGPSTREAM_ADDR_FORMAT_BYTES:
+    return Py_BuildValue("(Ni)", get_ip_pybytes(&pfx->address),
+                         (int)pfx->mask_len);
+
+  case PYBGPSTREAM_ADDR_FORMAT_INT:
+    if ((version = get_ip_version(&pfx->address)) == 0) {
+      Py_RETURN_NONE;
+    }
+    return Py_BuildValue("(Nii)", get_ip_pyint(&pfx->address),
+                         (int)pfx->mask_len, version);
+
+  case PYBGPSTREAM_ADDR_FORMAT_STR:
+  default:
+    return get_pfx_pystr(pfx);
+  }
+}
+
+/* Build a prefix value, or share the one built for an earlier elem with the
+   same prefix. In a RIB dump every prefix is seen once per peer, so if the
+   prefix cache is enabled, it is looked up there first (keyed on the
+   format, mask length and address bytes). */
+static PyObject *get_pfx_pyobj_shared(bgpstream_pfx_t *pfx,
+                                      pybgpstream_addr_format_t format)
+{
+  uint8_t key[2 + 16];
+  size_t len;
+  uint32_t hash;
+  PyObject *obj;
+
+  if (!pybgpstream_objcache_enabled(&prefix_cache)) {
+    return get_pfx_pyobj(pfx, format);
+  }
+
+  key[0] = (uint8_t)format;
+  key[1] = pfx->mask_len;
+  switch (pfx->address.version) {
+  case BGPSTREAM_ADDR_VERSION_IPV4:
+    memcpy(&key[2], &pfx->address.bs_ipv4.addr, 4);
+    len = 2 + 4;
+    break;
+  case BGPSTREAM_ADDR_VERSION_IPV6:
+    memcpy(&key[2], &pfx->address.bs_ipv6.addr, 16);
+    len = 2 + 16;
+    break;
+  default:
+    return get_pfx_pyobj(pfx, format);
+  }
+
+  hash = pybgpstream_hash(key, len);
+  if ((obj = pybgpstream_objcache_get(&prefix_cache, key, len, hash)) ==
+        NULL &&
+      (obj = get_pfx_pyobj(pfx, format)) != NULL) {
+    pybgpstream_objcache_add(&prefix_cache, key, len, hash, obj);
+  }
+  return obj;
+}
+
 static PyObject *get_aspath_pystr(bgpstream_as_path_t *aspath)
 {
   // assuming 10 char per ASN, then this will hold >400 hops, if we
@@ -62,15 +149,166 @@ static PyObject *get_aspath_pystr(bgpstream_as_path_t *aspath)
   return pystr;
 }
 
-static PyObject *get_communities_pyset(bgpstream_community_set_t *communities)
+static const char *get_aspath_seg_type_str(uint8_t type)
+{
+  switch (type) {
+  case BGPSTREAM_AS_PATH_SEG_SET:
+    return "set";
+  case BGPSTREAM_AS_PATH_SEG_CONFED_SEQ:
+    return "confed-seq";
+  case BGPSTREAM_AS_PATH_SEG_CONFED_SET:
+    return "confed-set";
+  default:
+    return "unknown";
+  }
+}
+
+/* Walk the segments of the AS path and build a tuple with one int per ASN
+   hop. Other segments (AS_SET and confederations) are represented as a
+   (type, (asn, ...)) tuple. Invalid segments (which carry no ASNs) are
+   skipped. If collapse is set, prepended ASNs appear only once. */
+static PyObject *get_aspath_pytuple(bgpstream_as_path_t *aspath, int collapse)
+{
+  bgpstream_as_path_iter_t iter;
+  bgpstream_as_path_seg_t *seg;
+  bgpstream_as_path_seg_set_t *set;
+  PyObject *tuple;
+  PyObject *asns;
+  PyObject *item;
+  uint32_t asn;
+  uint32_t last_asn = 0;
+  int have_last = 0;
+  int cnt = 0;
+  int idx = 0;
+  int i;
+
+  /* count the hops first so the tuple can be created at the right size */
+  bgpstream_as_path_iter_reset(&iter);
+  while ((seg = bgpstream_as_path_get_next_seg(aspath, &iter)) != NULL) {
+    if (seg->type == BGPSTREAM_AS_PATH_SEG_INVALID) {
+      continue;
+    }
+    if (seg->type == BGPSTREAM_AS_PATH_SEG_ASN) {
+      asn = ((bgpstream_as_path_seg_asn_t *)seg)->asn;
+      if (collapse && have_last && asn == last_asn) {
+        continue;
+      }
+      last_asn = asn;
+      have_last = 1;
+    } else {
+      have_last = 0;
+    }
+    cnt++;
+  }
+
+  if ((tuple = PyTuple_New(cnt)) == NULL) {
+    return NULL;
+  }
+
+  have_last = 0;
+  bgpstream_as_path_iter_reset(&iter);
+  while ((seg = bgpstream_as_path_get_next_seg(aspath, &iter)) != NULL) {
+    if (seg->type == BGPSTREAM_AS_PATH_SEG_INVALID) {
+      continue;
+    }
+    if (seg->type == BGPSTREAM_AS_PATH_SEG_ASN) {
+      asn = ((bgpstream_as_path_seg_asn_t *)seg)->asn;
+      if (collapse && have_last && asn == last_asn) {
+        continue;
+      }
+      last_asn = asn;
+      have_last = 1;
+      item = PyLong_FromUnsignedLong(asn);
+    } else {
+      have_last = 0;
+      set = (bgpstream_as_path_seg_set_t *)seg;
+      if ((asns = PyTuple_New(set->asn_cnt)) == NULL) {
+        Py_DECREF(tuple);
+        return NULL;
+      }
+      for (i = 0; i < set->asn_cnt; i++) {
+        if ((item = PyLong_FromUnsignedLong(set->asn[i])) == NULL) {
+          Py_DECREF(asns);
+          Py_DECREF(tuple);
+          return NULL;
+        }
+        PyTuple_SET_ITEM(asns, i, item);
+      }
+      item = Py_BuildValue("(sN)", get_aspath_seg_type_str(seg->type), asns);
+    }
+    if (item == NULL) {
+      Py_DECREF(tuple);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(tuple, idx++, item);
+  }
+
+  return tuple;
+}
+
+/* Build the given representation of an AS path, or share the one built for
+   an earlier elem with the same AS path. If the AS path cache is enabled,
+   it is looked up there first (keyed on the kind of representation and the
+   raw AS path data). */
+static PyObject *get_aspath_pyobj_shared(bgpstream_as_path_t *aspath,
+                                         int kind)
+{
+  uint8_t key_buf[256];
+  uint8_t *key = key_buf;
+  uint8_t *data = NULL;
+  uint16_t data_len;
+  size_t len;
+  uint32_t hash;
+  PyObject *obj;
+
+  if (pybgpstream_objcache_enabled(&as_path_cache)) {
+    data_len = bgpstream_as_path_get_data(aspath, &data);
+    len = 1 + (size_t)data_len;
+    if (len > sizeof(key_buf) && (key = malloc(len)) == NULL) {
+      return PyErr_NoMemory();
+    }
+    key[0] = (uint8_t)kind;
+    if (data_len > 0) {
+      memcpy(&key[1], data, data_len);
+    }
+    hash = pybgpstream_hash(key, len);
+    obj = pybgpstream_objcache_get(&as_path_cache, key, len, hash);
+  } else {
+    obj = NULL;
+    len = 0;
+    hash = 0;
+  }
+
+  if (obj == NULL) {
+    if (kind == AS_PATH_KIND_STR) {
+      obj = get_aspath_pystr(aspath);
+    } else {
+      obj = get_aspath_pytuple(aspath, kind == AS_PATH_KIND_ASNS_COLLAPSED);
+    }
+    if (obj != NULL && len != 0) {
+      pybgpstream_objcache_add(&as_path_cache, key, len, hash, obj);
+    }
+  }
+
+  if (key != key_buf) {
+    free(key);
+  }
+  return obj;
+}
+
+/* The set is cached on the elem, so it is frozen to keep it from being
+   changed through one of the references handed out */
+static PyObject *get_communities_pyfrozenset(
+  bgpstream_community_set_t *communities)
 {
   PyObject *set;
+  PyObject *pystr;
   const bgpstream_community_t *c;
   int cnt = bgpstream_community_set_size(communities);
   int i;
   char comm_buf[128];
-  /* create the dictionary */
-  if ((set = PySet_New(NULL)) == NULL)
+  /* create the set (a new frozenset can still be filled) */
+  if ((set = PyFrozenSet_New(NULL)) == NULL)
     return NULL;
 
   for (i = 0; i < cnt; i++) {
@@ -78,15 +316,97 @@ static PyObject *get_communities_pyset(bgpstream_community_set_t *communities)
 
     if (bgpstream_community_snprintf(comm_buf, sizeof(comm_buf), c) >=
         sizeof(comm_buf)) {
-      return NULL;
+      PyErr_SetString(PyExc_ValueError, "Could not format community");
+      goto err;
     }
 
     /* add community to set */
-    PyObject *pystr = PYSTR_FROMSTR(comm_buf);
-    PySet_Add(set, pystr); // does NOT steal reference
+    if ((pystr = PYSTR_FROMSTR(comm_buf)) == NULL) {
+      goto err;
+    }
+    if (PySet_Add(set, pystr) != 0) { // does NOT steal reference
+      Py_DECREF(pystr);
+      goto err;
+    }
     Py_DECREF(pystr);
   }
   return set;
+
+err:
+  Py_DECREF(set);
+  return NULL;
+}
+
+/* Build a frozenset of (asn, value) tuples from the sorted communities in
+   key (each one packed as asn << 16 | value) */
+static PyObject *build_community_values(const uint32_t *key, int cnt)
+{
+  PyObject *tuple;
+  PyObject *item;
+  PyObject *set;
+  int i;
+
+  if ((tuple = PyTuple_New(cnt)) == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < cnt; i++) {
+    if ((item = Py_BuildValue("(II)", (unsigned int)(key[i] >> 16),
+                              (unsigned int)(key[i] & 0xffff))) == NULL) {
+      Py_DECREF(tuple);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(tuple, i, item);
+  }
+  set = PyFrozenSet_New(tuple);
+  Py_DECREF(tuple);
+  return set;
+}
+
+/* Communities as a frozenset of (asn, value) tuples. As consecutive elems
+   from a peer usually carry the same communities, the set is looked up in
+   the community cache (keyed on the sorted raw communities) first, and
+   shared with the elems that carried the same set before. */
+static PyObject *get_community_values_pyobj(
+  bgpstream_community_set_t *communities)
+{
+  uint32_t key_buf[64];
+  uint32_t *key = key_buf;
+  const bgpstream_community_t *c;
+  int cnt =
+    (communities == NULL) ? 0 : bgpstream_community_set_size(communities);
+  uint32_t hash;
+  uint32_t tmp;
+  PyObject *set;
+  int i, j;
+
+  if (cnt > (int)(sizeof(key_buf) / sizeof(key_buf[0])) &&
+      (key = malloc(sizeof(uint32_t) * cnt)) == NULL) {
+    return PyErr_NoMemory();
+  }
+
+  /* build the key, insertion-sorted so that the order the communities were
+     received in does not matter (sets are short) */
+  for (i = 0; i < cnt; i++) {
+    c = bgpstream_community_set_get(communities, i);
+    tmp = ((uint32_t)c->asn << 16) | c->value;
+    for (j = i; j > 0 && key[j - 1] > tmp; j--) {
+      key[j] = key[j - 1];
+    }
+    key[j] = tmp;
+  }
+
+  hash = pybgpstream_hash(key, sizeof(uint32_t) * cnt);
+  if ((set = pybgpstream_objcache_get(&community_cache, key,
+                                      sizeof(uint32_t) * cnt, hash)) == NULL &&
+      (set = build_community_values(key, cnt)) != NULL) {
+    pybgpstream_objcache_add(&community_cache, key, sizeof(uint32_t) * cnt,
+                             hash, set);
+  }
+
+  if (key != key_buf) {
+    free(key);
+  }
+  return set;
 }
 
 static PyObject *get_peerstate_pystr(bgpstream_elem_peerstate_t state)
@@ -94,14 +414,22 @@ static PyObject *get_peerstate_pystr(bgpstream_elem_peerstate_t state)
   char buf[128] = "";
   if (bgpstream_elem_peerstate_snprintf(buf, 128, state) >= 128)
     return NULL;
-  return PYSTR_FROMSTR(buf);
+  return _pybgpstream_intern_str(buf);
 }
 
 static void BGPElem_dealloc(BGPElemObject *self)
 {
   Py_XDECREF(self->fields);
-
-  Py_TYPE(self)->tp_free((PyObject *)self);
+  Py_XDECREF(self->prefix);
+  Py_XDECREF(self->next_hop);
+  Py_XDECREF(self->as_path);
+  Py_XDECREF(self->communities);
+  Py_XDECREF(self->community_values);
+  Py_XDECREF(self->old_state);
+  Py_XDECREF(self->new_state);
+  Py_XDECREF(self->record);
+
+  pybgpstream_freelist_free(&freelist, (PyObject *)self);
 }
 
 static int BGPElem_init(BGPElemObject *self, PyObject *args, PyObject *kwds)
@@ -115,7 +443,7 @@ static PyObject *BGPElem_get_type(BGPElemObject *self, void *closure)
   char buf[128] = "";
   if (bgpstream_elem_type_snprintf(buf, 128, self->elem->type) >= 128)
     return NULL;
-  return PYSTR_FROMSTR(buf);
+  return _pybgpstream_intern_str(buf);
 }
 
 /* originated time (sec.usec) */
@@ -130,7 +458,8 @@ static PyObject *BGPElem_get_orig_time(BGPElemObject *self, void *closure)
     (http://pythonhosted.org/netaddr/) */
 static PyObject *BGPElem_get_peer_address(BGPElemObject *self, void *closure)
 {
-  return get_ip_pystr((bgpstream_ip_addr_t *)&self->elem->peer_ip);
+  return get_ip_pyobj((bgpstream_ip_addr_t *)&self->elem->peer_ip,
+                      self->record->opts.addr_format);
 }
 
 /* peer as number */
@@ -139,48 +468,232 @@ static PyObject *BGPElem_get_peer_asn(BGPElemObject *self, void *closure)
   return Py_BuildValue("k", self->elem->peer_asn);
 }
 
-/** Type-dependent field dict */
+/* AS path as a tuple of ASNs */
+static PyObject *get_as_path_asns(BGPElemObject *self, int collapse)
+{
+  if ((self->elem->type != BGPSTREAM_ELEM_TYPE_RIB &&
+       self->elem->type != BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT) ||
+      self->elem->as_path == NULL) {
+    Py_RETURN_NONE;
+  }
+  return get_aspath_pyobj_shared(self->elem->as_path,
+                                 collapse ? AS_PATH_KIND_ASNS_COLLAPSED
+                                          : AS_PATH_KIND_ASNS);
+}
+
+static PyObject *BGPElem_get_as_path_asns_attr(BGPElemObject *self,
+                                               void *closure)
+{
+  return get_as_path_asns(self, 0);
+}
+
+static PyObject *BGPElem_get_as_path_asns(BGPElemObject *self, PyObject *args,
+                                          PyObject *kwds)
+{
+  /* args: collapse_prepending (bool) */
+  static char *kwlist[] = {"collapse_prepending", NULL};
+  PyObject *collapse = NULL;
+  int collapse_val = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &collapse)) {
+    return NULL;
+  }
+  if (collapse != NULL && (collapse_val = PyObject_IsTrue(collapse)) < 0) {
+    return NULL;
+  }
+
+  return get_as_path_asns(self, collapse_val);
+}
+
+#define ELEM_HAS_PREFIX(elem)                                                  \
+  ((elem)->type == BGPSTREAM_ELEM_TYPE_RIB ||                                  \
+   (elem)->type == BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT ||                         \
+   (elem)->type == BGPSTREAM_ELEM_TYPE_WITHDRAWAL)
+
+#define ELEM_HAS_ATTRS(elem)                                                   \
+  ((elem)->type == BGPSTREAM_ELEM_TYPE_RIB ||                                  \
+   (elem)->type == BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT)
+
+#define ELEM_HAS_STATES(elem) ((elem)->type == BGPSTREAM_ELEM_TYPE_PEERSTATE)
+
+/* statistics of the stream that the elem was read from (or NULL) */
+#define ELEM_STATS(self)                                                       \
+  ((self)->record != NULL ? (self)->record->opts.stats : NULL)
+
+/* closure that get_fields passes to the field getters, as it times the
+   building of all fields itself */
+static char fields_closure;
+#define FROM_FIELDS ((void *)&fields_closure)
+
+/* Return the cached value of a type-specific field, building it (and only
+   it) on first access. Returns None if the elem type does not carry the
+   field. The elem is locked while the value is built, so that threads
+   sharing it build the value only once. */
+#define RETURN_CACHED_FIELD(cond, cache, build)                                \
+  do {                                                                         \
+    PyObject *value_;                                                          \
+    pybgpstream_stats_t *stats_ = ELEM_STATS(self);                            \
+    uint64_t start_ = 0;                                                       \
+    if (!(cond)) {                                                             \
+      Py_RETURN_NONE;                                                          \
+    }                                                                          \
+    Py_BEGIN_CRITICAL_SECTION(self);                                           \
+    if ((cache) == NULL) {                                                     \
+      if (stats_ != NULL && closure != FROM_FIELDS) {                          \
+        start_ = pybgpstream_stats_now();                                      \
+      }                                                                        \
+      (cache) = (build);                                                       \
+      if (stats_ != NULL && (cache) != NULL) {                                 \
+        PYBGPSTREAM_STATS_ADD(stats_, field_objects, 1);                       \
+        if (start_ != 0) {                                                     \
+          PYBGPSTREAM_STATS_ADD(stats_, convert_ns,                            \
+                                pybgpstream_stats_now() - start_);             \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+    value_ = (cache);                                                          \
+    Py_XINCREF(value_);                                                        \
+    Py_END_CRITICAL_SECTION();                                                 \
+    return value_;                                                             \
+  } while (0)
+
+/* prefix */
+static PyObject *BGPElem_get_prefix(BGPElemObject *self, void *closure)
+{
+  RETURN_CACHED_FIELD(ELEM_HAS_PREFIX(self->elem), self->prefix,
+                      get_pfx_pyobj_shared(
+                        (bgpstream_pfx_t *)&self->elem->prefix,
+                        self->record->opts.addr_format));
+}
+
+/* next hop */
+static PyObject *BGPElem_get_next_hop(BGPElemObject *self, void *closure)
+{
+  RETURN_CACHED_FIELD(
+    ELEM_HAS_ATTRS(self->elem), self->next_hop,
+    get_ip_pyobj((bgpstream_ip_addr_t *)&self->elem->nexthop,
+                 self->record->opts.addr_format));
+}
+
+/* AS path (string) */
+static PyObject *BGPElem_get_as_path(BGPElemObject *self, void *closure)
+{
+  RETURN_CACHED_FIELD(ELEM_HAS_ATTRS(self->elem), self->as_path,
+                      get_aspath_pyobj_shared(self->elem->as_path,
+                                              AS_PATH_KIND_STR));
+}
+
+/* communities */
+static PyObject *BGPElem_get_communities(BGPElemObject *self, void *closure)
+{
+  RETURN_CACHED_FIELD(ELEM_HAS_ATTRS(self->elem), self->communities,
+                      get_communities_pyfrozenset(self->elem->communities));
+}
+
+/* communities as (asn, value) tuples */
+static PyObject *BGPElem_get_community_values(BGPElemObject *self,
+                                              void *closure)
+{
+  RETURN_CACHED_FIELD(ELEM_HAS_ATTRS(self->elem), self->community_values,
+                      get_community_values_pyobj(self->elem->communities));
+}
+
+/* old peer state */
+static PyObject *BGPElem_get_old_state(BGPElemObject *self, void *closure)
+{
+  RETURN_CACHED_FIELD(ELEM_HAS_STATES(self->elem), self->old_state,
+                      get_peerstate_pystr(self->elem->old_state));
+}
+
+/* new peer state */
+static PyObject *BGPElem_get_new_state(BGPElemObject *self, void *closure)
+{
+  RETURN_CACHED_FIELD(ELEM_HAS_STATES(self->elem), self->new_state,
+                      get_peerstate_pystr(self->elem->new_state));
+}
+
+/* add a type-specific field to the dict using its getter */
+static int add_field_to_dict(PyObject *dict, const char *key,
+                             BGPElemObject *self, getter get)
+{
+  PyObject *value;
+  if ((value = get((PyObject *)self, FROM_FIELDS)) == NULL) {
+    return -1;
+  }
+  return add_to_dict(dict, key, value);
+}
+
+/* fields has always held a mutable set of communities, so it gets its own
+   copy of the shared frozenset */
+static int add_communities_to_dict(PyObject *dict, BGPElemObject *self)
+{
+  PyObject *communities;
+  PyObject *set;
+
+  if ((communities = BGPElem_get_communities(self, FROM_FIELDS)) == NULL) {
+    return -1;
+  }
+  set = PySet_New(communities);
+  Py_DECREF(communities);
+  if (set == NULL) {
+    return -1;
+  }
+  return add_to_dict(dict, "communities", set);
+}
+
+/** Type-dependent field dict
+ *
+ * Kept for compatibility, the values are shared with the per-field getters
+ * above.
+ */
 static PyObject *BGPElem_get_fields(BGPElemObject *self, void *closure)
 {
-  PyObject *dict = self->fields;
+  PyObject *dict;
+  pybgpstream_stats_t *stats = ELEM_STATS(self);
+  uint64_t start = 0;
 
   // check if we already built the dict before
+  Py_BEGIN_CRITICAL_SECTION(self);
+  dict = self->fields;
+  Py_XINCREF(dict);
+  Py_END_CRITICAL_SECTION();
   if (dict != NULL) {
-    // "O" will increase refcount
-    return Py_BuildValue("O", dict);
+    return dict;
+  }
+
+  if (stats != NULL) {
+    start = pybgpstream_stats_now();
   }
 
   // need to create the dictionary
-  if ((self->fields = dict = PyDict_New()) == NULL)
+  if ((dict = PyDict_New()) == NULL)
     return NULL;
 
   switch (self->elem->type) {
   case BGPSTREAM_ELEM_TYPE_RIB:
   case BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT:
-    if (add_to_dict(
-          dict, "next-hop",
-          get_ip_pystr((bgpstream_ip_addr_t *)&self->elem->nexthop)) ||
-        add_to_dict(dict, "as-path", get_aspath_pystr(self->elem->as_path)) ||
-        add_to_dict(dict, "communities",
-                    get_communities_pyset(self->elem->communities))) {
-      return NULL;
+    if (add_field_to_dict(dict, "next-hop", self,
+                          (getter)BGPElem_get_next_hop) ||
+        add_field_to_dict(dict, "as-path", self,
+                          (getter)BGPElem_get_as_path) ||
+        add_communities_to_dict(dict, self)) {
+      goto err;
     }
 
   /* FALLTHROUGH */
 
   case BGPSTREAM_ELEM_TYPE_WITHDRAWAL:
-    if (add_to_dict(dict, "prefix",
-                    get_pfx_pystr((bgpstream_pfx_t *)&self->elem->prefix))) {
-      return NULL;
+    if (add_field_to_dict(dict, "prefix", self, (getter)BGPElem_get_prefix)) {
+      goto err;
     }
     break;
 
   case BGPSTREAM_ELEM_TYPE_PEERSTATE:
-    if (add_to_dict(dict, "old-state",
-                    get_peerstate_pystr(self->elem->old_state)) ||
-        add_to_dict(dict, "new-state",
-                    get_peerstate_pystr(self->elem->new_state))) {
-      return NULL;
+    if (add_field_to_dict(dict, "old-state", self,
+                          (getter)BGPElem_get_old_state) ||
+        add_field_to_dict(dict, "new-state", self,
+                          (getter)BGPElem_get_new_state)) {
+      goto err;
     }
     break;
 
@@ -189,10 +702,136 @@ static PyObject *BGPElem_get_fields(BGPElemObject *self, void *closure)
     break;
   }
 
-  return Py_BuildValue("O", dict);
+  /* the getters lock the elem themselves, so the dict is built unlocked
+     and only kept if no other thread got there first */
+  Py_BEGIN_CRITICAL_SECTION(self);
+  if (self->fields == NULL) {
+    Py_INCREF(dict);
+    self->fields = dict;
+    if (stats != NULL) {
+      PYBGPSTREAM_STATS_ADD(stats, field_objects, 1);
+      PYBGPSTREAM_STATS_ADD(stats, convert_ns,
+                            pybgpstream_stats_now() - start);
+    }
+  } else {
+    Py_DECREF(dict);
+    dict = self->fields;
+    Py_INCREF(dict);
+  }
+  Py_END_CRITICAL_SECTION();
+  return dict;
+
+err:
+  Py_DECREF(dict);
+  return NULL;
+}
+
+/* record */
+static PyObject *BGPElem_get_record(BGPElemObject *self, void *closure)
+{
+  if (self->record == NULL) {
+    Py_RETURN_NONE;
+  }
+  Py_INCREF(self->record);
+  return (PyObject *)self->record;
+}
+
+/* whether the elem type defines the given attribute */
+static int BGPElem_type_has_attr(PyObject *name)
+{
+#if PY_VERSION_HEX >= 0x030D0000
+  /* the lookup returns a new reference on 3.13+, which free-threaded builds
+     need to keep the attribute alive */
+  PyObject *attr = _PyType_LookupRef(&BGPElemType, name);
+  Py_XDECREF(attr);
+  return attr != NULL;
+#else
+  return _PyType_Lookup(&BGPElemType, name) != NULL;
+#endif
+}
+
+/* Attributes that are not found on the elem are looked up on its record, so
+   that record fields (e.g. time or collector) can be accessed directly from
+   the elem. The record type is available as record_type. */
+static PyObject *BGPElem_getattro(BGPElemObject *self, PyObject *name)
+{
+  PyObject *value;
+
+  if (self->record == NULL) {
+    return PyObject_GenericGetAttr((PyObject *)self, name);
+  }
+
+  /* plain elems have no instance dict, so if the type does not know the
+     name, go straight to the record rather than raising (and then clearing)
+     an AttributeError */
+  if (Py_TYPE(self) != &BGPElemType || BGPElem_type_has_attr(name)) {
+    if ((value = PyObject_GenericGetAttr((PyObject *)self, name)) != NULL ||
+        !PyErr_ExceptionMatches(PyExc_AttributeError)) {
+      return value;
+    }
+    PyErr_Clear();
+  }
+
+  if (PYSTR_EQUALS(name, "record_type")) {
+    return PyObject_GetAttrString((PyObject *)self->record, "type");
+  }
+  return PyObject_GetAttr((PyObject *)self->record, name);
+}
+
+/* string representation (record_type|type|time|...) */
+static PyObject *BGPElem_str(BGPElemObject *self)
+{
+  static const char *names[] = {
+    "record_type", "type",      "time",        "project",     "collector",
+    "router",      "router_ip", "peer_asn",    "peer_address", "prefix",
+    "next_hop",    "as_path",   "communities", "old_state",   "new_state",
+    NULL,
+  };
+  /* index of communities in names, which are joined into a single string */
+  const int communities_idx = 12;
+  PyObject *fmt;
+  PyObject *args;
+  PyObject *communities;
+  PyObject *sep;
+  PyObject *str = NULL;
+
+  if ((args = get_attrs_pytuple((PyObject *)self, names)) == NULL) {
+    return NULL;
+  }
+
+  communities = PyTuple_GET_ITEM(args, communities_idx);
+  if (communities != Py_None) {
+    if ((sep = PYSTR_FROMSTR(" ")) == NULL) {
+      goto done;
+    }
+    str = PyObject_CallMethod(sep, "join", "O", communities);
+    Py_DECREF(sep);
+    if (str == NULL) {
+      goto done;
+    }
+    PyTuple_SET_ITEM(args, communities_idx, str);
+    Py_DECREF(communities);
+    str = NULL;
+  }
+
+  if ((fmt = PYSTR_FROMSTR("%s|%s|%f|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s")) ==
+      NULL) {
+    goto done;
+  }
+  str = PYSTR_FORMAT(fmt, args);
+  Py_DECREF(fmt);
+
+done:
+  Py_DECREF(args);
+  return str;
 }
 
 static PyMethodDef BGPElem_methods[] = {
+
+  {"get_as_path_asns", (PyCFunction)BGPElem_get_as_path_asns,
+   METH_VARARGS | METH_KEYWORDS,
+   "Get the AS path as a tuple of ASNs, optionally collapsing prepending"},
+
   {NULL} /* Sentinel */
 };
 
@@ -217,6 +856,36 @@ static PyGetSetDef BGPElem_getsetters[] = {
   /* peer ASN */
   {"peer_asn", (getter)BGPElem_get_peer_asn, NULL, "Peer ASN", NULL},
 
+  /* AS Path ASNs */
+  {"as_path_asns", (getter)BGPElem_get_as_path_asns_attr, NULL,
+   "AS Path as a tuple of ASNs", NULL},
+
+  /* Record */
+  {"record", (getter)BGPElem_get_record, NULL, "Record", NULL},
+
+  /* Prefix */
+  {"prefix", (getter)BGPElem_get_prefix, NULL, "Prefix", NULL},
+
+  /* Next Hop */
+  {"next_hop", (getter)BGPElem_get_next_hop, NULL, "Next Hop", NULL},
+
+  /* AS Path */
+  {"as_path", (getter)BGPElem_get_as_path, NULL, "AS Path", NULL},
+
+  /* Communities */
+  {"communities", (getter)BGPElem_get_communities, NULL, "Communities",
+   NULL},
+
+  /* Communities as (ASN, value) tuples */
+  {"community_values", (getter)BGPElem_get_community_values, NULL,
+   "Communities as a frozenset of (ASN, value) tuples", NULL},
+
+  /* Old Peer State */
+  {"old_state", (getter)BGPElem_get_old_state, NULL, "Old Peer State", NULL},
+
+  /* New Peer State */
+  {"new_state", (getter)BGPElem_get_new_state, NULL, "New Peer State", NULL},
+
   /* Type-Specific Fields */
   {"fields", (getter)BGPElem_get_fields, NULL, "Type-Specific Fields", NULL},
 
@@ -238,8 +907,8 @@ static PyTypeObject BGPElemType = {
   0,                                                     /* tp_as_mapping */
   0,                                                     /* tp_hash */
   0,                                                     /* tp_call */
-  0,                                                     /* tp_str */
-  0,                                                     /* tp_getattro */
+  (reprfunc)BGPElem_str,                                 /* tp_str */
+  (getattrofunc)BGPElem_getattro,                        /* tp_getattro */
   0,                                                     /* tp_setattro */
   0,                                                     /* tp_as_buffer */
   Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,              /* tp_flags */
@@ -263,22 +932,47 @@ static PyTypeObject BGPElemType = {
   0,                                                     /* tp_new */
 };
 
+static pybgpstream_freelist_t freelist =
+  PYBGPSTREAM_FREELIST_INIT(&BGPElemType);
+
 PyTypeObject *_pybgpstream_bgpstream_get_BGPElemType()
 {
   return &BGPElemType;
 }
 
+pybgpstream_freelist_t *_pybgpstream_bgpstream_get_BGPElemFreelist()
+{
+  return &freelist;
+}
+
+pybgpstream_objcache_t *_pybgpstream_bgpstream_get_BGPElemCommunityCache()
+{
+  return &community_cache;
+}
+
+pybgpstream_objcache_t *_pybgpstream_bgpstream_get_BGPElemPrefixCache()
+{
+  return &prefix_cache;
+}
+
+pybgpstream_objcache_t *_pybgpstream_bgpstream_get_BGPElemASPathCache()
+{
+  return &as_path_cache;
+}
+
 /* only available to c code */
-PyObject *BGPElem_new(bgpstream_elem_t *elem)
+PyObject *BGPElem_new(bgpstream_elem_t *elem, BGPRecordObject *record)
 {
   BGPElemObject *self;
 
-  self = (BGPElemObject *)(BGPElemType.tp_alloc(&BGPElemType, 0));
+  self = (BGPElemObject *)pybgpstream_freelist_alloc(&freelist);
   if (self == NULL) {
     return NULL;
   }
 
   self->elem = elem;
+  Py_XINCREF(record);
+  self->record = record;
 
   return (PyObject *)self;
 }
@@ -27,23 +27,53 @@
 #ifndef ___PYBGPSTREAM_BGPELEM_H
 #define ___PYBGPSTREAM_BGPELEM_H
 
+#include "_pybgpstream_bgprecord.h"
+#include "_pybgpstream_freelist.h"
+#include "_pybgpstream_objcache.h"
 #include "bgpstream_elem.h"
 #include <Python.h>
 
+/** Default maximum number of community sets shared between elems */
+#define PYBGPSTREAM_COMMUNITY_CACHE_DEFAULT_SIZE 16384
+
 typedef struct {
   PyObject_HEAD
 
   bgpstream_elem_t *elem;
 
+  /** Record that the elem belongs to (keeps detached elems alive) */
+  BGPRecordObject *record;
+
   /** Cached dictionary of elem fields */
   PyObject *fields;
 
+  /** Cached values of the type-specific fields (built on first access) */
+  PyObject *prefix;
+  PyObject *next_hop;
+  PyObject *as_path;
+  PyObject *communities;
+  PyObject *community_values;
+  PyObject *old_state;
+  PyObject *new_state;
+
 } BGPElemObject;
 
 /** Expose the BGPElemType structure */
 PyTypeObject *_pybgpstream_bgpstream_get_BGPElemType(void);
 
+/** Expose the free list of BGPElem objects */
+pybgpstream_freelist_t *_pybgpstream_bgpstream_get_BGPElemFreelist(void);
+
+/** Expose the cache of community sets shared between BGPElem objects */
+pybgpstream_objcache_t *_pybgpstream_bgpstream_get_BGPElemCommunityCache(void);
+
+/** Expose the cache of prefixes shared between BGPElem objects */
+pybgpstream_objcache_t *_pybgpstream_bgpstream_get_BGPElemPrefixCache(void);
+
+/** Expose the cache of AS paths shared between BGPElem objects */
+pybgpstream_objcache_t *_pybgpstream_bgpstream_get_BGPElemASPathCache(void);
+
 /** Expose our new function as it is not exposed to Python */
-PyObject *BGPElem_new(bgpstream_elem_t *elem);
+PyObject *BGPElem_new(bgpstream_elem_t *elem, BGPRecordObject *record);
 
 #endif /* ___PYBGPSTREAM_BGPELEM_H */
@@ -26,15 +26,27 @@
 
 #include "_pybgpstream_bgprecord.h"
 #include "_pybgpstream_bgpelem.h"
+#include "_pybgpstream_freelist.h"
+#include "_pybgpstream_module.h"
 #include "pyutils.h"
 #include <Python.h>
 #include <bgpstream.h>
+#include <stdlib.h>
 
 #define BGPRecordDocstring "BGPRecord object"
 
+/* deallocated BGPRecord objects kept for re-use */
+static pybgpstream_freelist_t freelist;
+
 static void BGPRecord_dealloc(BGPRecordObject *self)
 {
-  Py_TYPE(self)->tp_free((PyObject *)self);
+  pybgpstream_stats_decref(self->opts.stats);
+  pybgpstream_detached_record_destroy(self->detached);
+  if (self->mrt != NULL) {
+    pybgpstream_mrtbuf_clear(self->mrt);
+    free(self->mrt);
+  }
+  pybgpstream_freelist_free(&freelist, (PyObject *)self);
 }
 
 static int BGPRecord_init(BGPRecordObject *self, PyObject *args, PyObject *kwds)
@@ -49,7 +61,7 @@ static int BGPRecord_init(BGPRecordObject *self, PyObject *args, PyObject *kwds)
     if (strlen(cstr) == 0) {                                                   \
       Py_RETURN_NONE;                                                          \
     }                                                                          \
-    return Py_BuildValue("s", cstr);                                           \
+    return _pybgpstream_intern_str(cstr);                                      \
   } while (0)
 
 /* project */
@@ -78,7 +90,8 @@ static PyObject *BGPRecord_get_router_ip(BGPRecordObject *self, void *closure)
     Py_RETURN_NONE;
   }
   // else, assume valid version, and return a string
-  return get_ip_pystr((bgpstream_ip_addr_t *)&self->rec->router_ip);
+  return get_ip_pyobj((bgpstream_ip_addr_t *)&self->rec->router_ip,
+                      self->opts.addr_format);
 }
 
 /* type */
@@ -86,15 +99,15 @@ static PyObject *BGPRecord_get_type(BGPRecordObject *self, void *closure)
 {
   switch (self->rec->type) {
   case BGPSTREAM_UPDATE:
-    return Py_BuildValue("s", "update");
+    return _pybgpstream_intern_str("update");
     break;
 
   case BGPSTREAM_RIB:
-    return Py_BuildValue("s", "rib");
+    return _pybgpstream_intern_str("rib");
     break;
 
   default:
-    return Py_BuildValue("s", "unknown");
+    return _pybgpstream_intern_str("unknown");
   }
 
   return NULL;
@@ -118,27 +131,27 @@ static PyObject *BGPRecord_get_status(BGPRecordObject *self, void *closure)
 {
   switch (self->rec->status) {
   case BGPSTREAM_RECORD_STATUS_VALID_RECORD:
-    return Py_BuildValue("s", "valid");
+    return _pybgpstream_intern_str("valid");
     break;
 
   case BGPSTREAM_RECORD_STATUS_FILTERED_SOURCE:
-    return Py_BuildValue("s", "filtered-source");
+    return _pybgpstream_intern_str("filtered-source");
     break;
 
   case BGPSTREAM_RECORD_STATUS_EMPTY_SOURCE:
-    return Py_BuildValue("s", "empty-source");
+    return _pybgpstream_intern_str("empty-source");
     break;
 
   case BGPSTREAM_RECORD_STATUS_CORRUPTED_SOURCE:
-    return Py_BuildValue("s", "corrupted-source");
+    return _pybgpstream_intern_str("corrupted-source");
     break;
 
   case BGPSTREAM_RECORD_STATUS_CORRUPTED_RECORD:
-    return Py_BuildValue("s", "corrupted-record");
+    return _pybgpstream_intern_str("corrupted-record");
     break;
 
   default:
-    return Py_BuildValue("s", "unknown");
+    return _pybgpstream_intern_str("unknown");
   }
 
   return NULL;
@@ -150,55 +163,336 @@ static PyObject *BGPRecord_get_dump_position(BGPRecordObject *self,
 {
   switch (self->rec->dump_pos) {
   case BGPSTREAM_DUMP_START:
-    return Py_BuildValue("s", "start");
+    return _pybgpstream_intern_str("start");
     break;
 
   case BGPSTREAM_DUMP_MIDDLE:
-    return Py_BuildValue("s", "middle");
+    return _pybgpstream_intern_str("middle");
     break;
 
   case BGPSTREAM_DUMP_END:
-    return Py_BuildValue("s", "end");
+    return _pybgpstream_intern_str("end");
     break;
 
   default:
-    return Py_BuildValue("s", "unknown");
+    return _pybgpstream_intern_str("unknown");
   }
 
   return NULL;
 }
 
-/* get next elem */
-static PyObject *BGPRecord_get_next_elem(BGPRecordObject *self)
+static int BGPRecord_detach(BGPRecordObject *self);
+
+PyObject *BGPRecord_next_elem(BGPRecordObject *self)
 {
   bgpstream_elem_t *elem;
   int ret;
+  pybgpstream_stats_t *stats = self->opts.stats;
+  uint64_t start = 0;
+  uint64_t end;
 
   PyObject *pyelem;
 
-  ret = bgpstream_record_get_next_elem(self->rec, &elem);
+  if (stats != NULL) {
+    start = pybgpstream_stats_now();
+  }
+
+  /* threads iterating over the same record share its position */
+  Py_BEGIN_CRITICAL_SECTION(self);
+  ret = 0;
+  if (self->detached == NULL && self->detaching) {
+    /* another thread is decoding the elems: continue from its copy */
+    ret = BGPRecord_detach(self);
+  }
   if (ret < 0) {
-    PyErr_SetString(PyExc_RuntimeError,
-                    "Could not get next record (is the stream started?)");
+    /* the exception is set */
+  } else if (self->detached != NULL) {
+    /* detached records only hold the elems that passed the filter */
+    ret = pybgpstream_detached_record_get_next_elem(self->detached, &elem);
+  } else {
+    while ((ret = bgpstream_record_get_next_elem(self->rec, &elem)) > 0 &&
+           !pybgpstream_elemfilter_match(self->opts.elem_filter, elem))
+      ;
+    if (ret > 0) {
+      self->iterated = 1;
+    }
+  }
+  Py_END_CRITICAL_SECTION();
+  if (ret < 0) {
+    if (!PyErr_Occurred()) {
+      PyErr_SetString(PyExc_RuntimeError,
+                      "Could not get next record (is the stream started?)");
+    }
     return NULL;
   } else if (ret == 0) {
     /* end of elems */
-    Py_RETURN_NONE;
+    if (stats != NULL) {
+      PYBGPSTREAM_STATS_ADD(stats, read_ns, pybgpstream_stats_now() - start);
+    }
+    return NULL;
   }
 
-  if ((pyelem = BGPElem_new(elem)) == NULL) {
+  if (stats != NULL) {
+    end = pybgpstream_stats_now();
+    PYBGPSTREAM_STATS_ADD(stats, read_ns, end - start);
+    PYBGPSTREAM_STATS_ADD(stats, elems, 1);
+    start = end;
+  }
+
+  if ((pyelem = BGPElem_new(elem, self)) == NULL) {
     PyErr_SetString(PyExc_RuntimeError, "Could not create BGPElem object");
     return NULL;
   }
 
+  if (stats != NULL) {
+    PYBGPSTREAM_STATS_ADD(stats, convert_ns, pybgpstream_stats_now() - start);
+    PYBGPSTREAM_STATS_ADD(stats, elem_objects, 1);
+  }
+
+  return pyelem;
+}
+
+/* get next elem */
+static PyObject *BGPRecord_get_next_elem(BGPRecordObject *self)
+{
+  PyObject *pyelem;
+
+  if ((pyelem = BGPRecord_next_elem(self)) == NULL && !PyErr_Occurred()) {
+    Py_RETURN_NONE;
+  }
   return pyelem;
 }
 
+/* lock the stream that lent the record, without holding the GIL while
+   another thread holds the lock (as the stream itself does) */
+static void BGPRecord_lock_stream(BGPRecordObject *self)
+{
+  if (pthread_mutex_trylock(self->opts.lock) != 0) {
+    Py_BEGIN_ALLOW_THREADS;
+    pthread_mutex_lock(self->opts.lock);
+    Py_END_ALLOW_THREADS;
+  }
+}
+
+/* The elems of a borrowed record can only be read once, so the record is
+   detached from the stream (decoding all of its remaining elems with the
+   GIL released) before they are needed at once. Later iteration continues
+   from the copy.
+
+   The stream is locked during decoding, so that it does not move on to the
+   next record meanwhile, and so that threads detaching the same record
+   wait for each other (the later ones then find the copy). Threads that
+   iterate over the record see detaching set, and wait here too. */
+static int BGPRecord_detach(BGPRecordObject *self)
+{
+  pybgpstream_detached_record_t *drec;
+
+  if (self->detached != NULL) {
+    return 0;
+  }
+
+  BGPRecord_lock_stream(self);
+  if (self->detached != NULL) {
+    pthread_mutex_unlock(self->opts.lock);
+    return 0;
+  }
+  self->detaching = 1;
+  Py_BEGIN_ALLOW_THREADS;
+  drec = pybgpstream_detached_record_create(self->rec, self->opts.elem_filter);
+  Py_END_ALLOW_THREADS;
+  self->detaching = 0;
+  if (drec != NULL) {
+    self->detached = drec;
+    self->rec = &drec->rec;
+  }
+  pthread_mutex_unlock(self->opts.lock);
+
+  if (drec == NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "Could not detach record");
+    return -1;
+  }
+  return 0;
+}
+
+/* get all remaining elems */
+static PyObject *BGPRecord_get_elems(BGPRecordObject *self)
+{
+  pybgpstream_stats_t *stats = self->opts.stats;
+  uint64_t start = 0;
+  uint64_t end;
+  PyObject *tuple;
+  PyObject *pyelem;
+  int first = 0;
+  int cnt = 0;
+  int ret;
+  int i;
+
+  if (stats != NULL) {
+    start = pybgpstream_stats_now();
+  }
+
+  /* the elems are handed out here, so iteration is over */
+  Py_BEGIN_CRITICAL_SECTION(self);
+  if ((ret = BGPRecord_detach(self)) == 0) {
+    first = self->detached->next_elem;
+    cnt = self->detached->elems_cnt - first;
+    self->detached->next_elem = self->detached->elems_cnt;
+  }
+  Py_END_CRITICAL_SECTION();
+  if (ret != 0) {
+    return NULL;
+  }
+
+  if (stats != NULL) {
+    end = pybgpstream_stats_now();
+    PYBGPSTREAM_STATS_ADD(stats, read_ns, end - start);
+    PYBGPSTREAM_STATS_ADD(stats, elems, cnt);
+    start = end;
+  }
+
+  if ((tuple = PyTuple_New(cnt)) == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < cnt; i++) {
+    if ((pyelem = BGPElem_new(&self->detached->elems[first + i], self)) ==
+        NULL) {
+      Py_DECREF(tuple);
+      PyErr_SetString(PyExc_RuntimeError, "Could not create BGPElem object");
+      return NULL;
+    }
+    PyTuple_SET_ITEM(tuple, i, pyelem);
+  }
+
+  if (stats != NULL) {
+    PYBGPSTREAM_STATS_ADD(stats, convert_ns, pybgpstream_stats_now() - start);
+    PYBGPSTREAM_STATS_ADD(stats, elem_objects, cnt);
+  }
+
+  return tuple;
+}
+
+/* buffer protocol (the MRT encoding of the record) */
+
+static int BGPRecord_encode_mrt(BGPRecordObject *self)
+{
+  if (self->iterated) {
+    PyErr_SetString(PyExc_BufferError,
+                    "Cannot encode a record once its elems were read one by "
+                    "one (request the encoding first, or use get_elems)");
+    return -1;
+  }
+  if (BGPRecord_detach(self) != 0) {
+    return -1;
+  }
+
+  if ((self->mrt = calloc(1, sizeof(pybgpstream_mrtbuf_t))) == NULL) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  if (pybgpstream_mrt_encode_record(self->mrt, self->rec,
+                                    self->detached->elems,
+                                    self->detached->elems_cnt) != 0) {
+    if (self->mrt->failed) {
+      PyErr_NoMemory();
+    } else {
+      PyErr_SetString(PyExc_ValueError,
+                      "Record cannot be represented in MRT");
+    }
+    pybgpstream_mrtbuf_clear(self->mrt);
+    free(self->mrt);
+    self->mrt = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+static int BGPRecord_getbuffer(BGPRecordObject *self, Py_buffer *view,
+                               int flags)
+{
+  static char empty[1];
+  int ret = 0;
+
+  Py_BEGIN_CRITICAL_SECTION(self);
+  if (self->mrt == NULL) {
+    ret = BGPRecord_encode_mrt(self);
+  }
+  Py_END_CRITICAL_SECTION();
+  if (ret != 0) {
+    view->obj = NULL;
+    return -1;
+  }
+  /* the encoding never changes once built, so it can be shared read-only */
+  return PyBuffer_FillInfo(view, (PyObject *)self,
+                           (self->mrt->len == 0) ? empty :
+                                                   (char *)self->mrt->data,
+                           (Py_ssize_t)self->mrt->len, 1, flags);
+}
+
+static PyBufferProcs BGPRecord_as_buffer = {
+#if PY_MAJOR_VERSION <= 2
+  0, /* bf_getreadbuffer */
+  0, /* bf_getwritebuffer */
+  0, /* bf_getsegcount */
+  0, /* bf_getcharbuffer */
+#endif
+  (getbufferproc)BGPRecord_getbuffer, /* bf_getbuffer */
+  0,                                  /* bf_releasebuffer */
+};
+
+#if PY_MAJOR_VERSION > 2
+#define BGPRECORD_TPFLAGS (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE)
+#else
+#define BGPRECORD_TPFLAGS                                                      \
+  (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_NEWBUFFER)
+#endif
+
+/* mrt_encoding (read-only memoryview of the MRT encoding of the record) */
+static PyObject *BGPRecord_get_mrt_encoding(BGPRecordObject *self,
+                                            void *closure)
+{
+  return PyMemoryView_FromObject((PyObject *)self);
+}
+
+/* rec (the record itself, kept for compatibility with the former high-level
+   wrapper class) */
+static PyObject *BGPRecord_get_rec(BGPRecordObject *self, void *closure)
+{
+  Py_INCREF(self);
+  return (PyObject *)self;
+}
+
+/* string representation (type|dump_position|time|...) */
+static PyObject *BGPRecord_str(BGPRecordObject *self)
+{
+  static const char *names[] = {
+    "type",      "dump_position", "time",   "project",   "collector",
+    "router",    "router_ip",     "status", "dump_time", NULL,
+  };
+  PyObject *fmt;
+  PyObject *args;
+  PyObject *str;
+
+  if ((args = get_attrs_pytuple((PyObject *)self, names)) == NULL) {
+    return NULL;
+  }
+  if ((fmt = PYSTR_FROMSTR("%s|%s|%f|%s|%s|%s|%s|%s|%d")) == NULL) {
+    Py_DECREF(args);
+    return NULL;
+  }
+  str = PYSTR_FORMAT(fmt, args);
+  Py_DECREF(fmt);
+  Py_DECREF(args);
+  return str;
+}
+
 static PyMethodDef BGPRecord_methods[] = {
 
   {"get_next_elem", (PyCFunction)BGPRecord_get_next_elem, METH_NOARGS,
    "Get next BGP Elem from the Record"},
 
+  {"get_elems", (PyCFunction)BGPRecord_get_elems, METH_NOARGS,
+   "Get all remaining BGP Elems of the Record as a tuple"},
+
   {NULL} /* Sentinel */
 };
 
@@ -223,6 +517,11 @@ static PyGetSetDef BGPRecord_getsetters[] = {
   {"dump_position", (getter)BGPRecord_get_dump_position, NULL, "Dump Position",
    NULL},
 
+  {"rec", (getter)BGPRecord_get_rec, NULL, "The record itself", NULL},
+
+  {"mrt_encoding", (getter)BGPRecord_get_mrt_encoding, NULL,
+   "Read-only memoryview of the MRT encoding of the record", NULL},
+
   {NULL} /* Sentinel */
 };
 
@@ -241,18 +540,18 @@ static PyTypeObject BGPRecordType = {
   0,                                                       /* tp_as_mapping */
   0,                                                       /* tp_hash */
   0,                                                       /* tp_call */
-  0,                                                       /* tp_str */
+  (reprfunc)BGPRecord_str,                                 /* tp_str */
   0,                                                       /* tp_getattro */
   0,                                                       /* tp_setattro */
-  0,                                                       /* tp_as_buffer */
-  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,                /* tp_flags */
+  &BGPRecord_as_buffer,                                    /* tp_as_buffer */
+  BGPRECORD_TPFLAGS,                                       /* tp_flags */
   BGPRecordDocstring,                                      /* tp_doc */
   0,                                                       /* tp_traverse */
   0,                                                       /* tp_clear */
   0,                                                       /* tp_richcompare */
   0,                        /* tp_weaklistoffset */
-  0,                        /* tp_iter */
-  0,                        /* tp_iternext */
+  PyObject_SelfIter,                  /* tp_iter */
+  (iternextfunc)BGPRecord_next_elem, /* tp_iternext */
   BGPRecord_methods,        /* tp_methods */
   0,                        /* tp_members */
   BGPRecord_getsetters,     /* tp_getset */
@@ -266,22 +565,65 @@ static PyTypeObject BGPRecordType = {
   0,            /* tp_new */
 };
 
+static pybgpstream_freelist_t freelist =
+  PYBGPSTREAM_FREELIST_INIT(&BGPRecordType);
+
 PyTypeObject *_pybgpstream_bgpstream_get_BGPRecordType()
 {
   return &BGPRecordType;
 }
 
+pybgpstream_freelist_t *_pybgpstream_bgpstream_get_BGPRecordFreelist()
+{
+  return &freelist;
+}
+
 /* only available to c code */
-PyObject *BGPRecord_new(bgpstream_record_t *rec)
+PyObject *BGPRecord_new(bgpstream_record_t *rec,
+                        const pybgpstream_opts_t *opts)
 {
   BGPRecordObject *self;
 
-  self = (BGPRecordObject *)(BGPRecordType.tp_alloc(&BGPRecordType, 0));
+  self = (BGPRecordObject *)pybgpstream_freelist_alloc(&freelist);
   if (self == NULL) {
     return NULL;
   }
 
   self->rec = rec;
+  self->detached = NULL;
+  self->opts = *opts;
+  self->mrt = NULL;
+  self->iterated = 0;
+  self->detaching = 0;
+  if (opts->stats != NULL) {
+    pybgpstream_stats_incref(opts->stats);
+    PYBGPSTREAM_STATS_ADD(opts->stats, record_objects, 1);
+  }
+
+  return (PyObject *)self;
+}
+
+/* only available to c code */
+PyObject *BGPRecord_new_detached(pybgpstream_detached_record_t *drec,
+                                 const pybgpstream_opts_t *opts)
+{
+  BGPRecordObject *self;
+
+  self = (BGPRecordObject *)pybgpstream_freelist_alloc(&freelist);
+  if (self == NULL) {
+    return NULL;
+  }
+
+  self->rec = &drec->rec;
+  self->detached = drec;
+  self->opts = *opts;
+  self->mrt = NULL;
+  self->iterated = 0;
+  self->detaching = 0;
+  if (opts->stats != NULL) {
+    pybgpstream_stats_incref(opts->stats);
+    PYBGPSTREAM_STATS_ADD(opts->stats, record_objects, 1);
+  }
 
   return (PyObject *)self;
 }
@@ -27,21 +27,87 @@
 #ifndef ___PYBGPSTREAM_BGPRECORD_H
 #define ___PYBGPSTREAM_BGPRECORD_H
 
+#include "_pybgpstream_detached.h"
+#include "_pybgpstream_freelist.h"
+#include "_pybgpstream_elemfilter.h"
+#include "_pybgpstream_mrt.h"
+#include "_pybgpstream_stats.h"
 #include "bgpstream.h"
+#include "pyutils.h"
 #include <Python.h>
+#include <pthread.h>
+
+/** Stream options that records (and their elems) inherit when created */
+typedef struct {
+
+  /** Representation of IP address and prefix values */
+  pybgpstream_addr_format_t addr_format;
+
+  /** Filter that elems must pass (NULL to keep all elems). This points
+      into the stream, which outlives the records it lends, and records
+      detached from the stream only hold elems that passed the filter. */
+  const pybgpstream_elemfilter_t *elem_filter;
+
+  /** Statistics of the stream (NULL unless enabled). Records hold a
+      reference to them, as they may outlive the stream. */
+  pybgpstream_stats_t *stats;
+
+  /** Lock of the stream, held while the elems of a record borrowed from the
+      stream are decoded with the GIL released */
+  pthread_mutex_t *lock;
+
+} pybgpstream_opts_t;
 
 typedef struct {
   PyObject_HEAD
 
-    /* BGP Stream Record instance Handle (borrowed pointer) */
+    /* BGP Stream Record instance Handle (borrowed pointer, or a pointer into
+       detached if the record was detached from the stream) */
     bgpstream_record_t *rec;
 
+    /* Owned snapshot of the record and its elems (NULL if the record is
+       borrowed from the stream) */
+    pybgpstream_detached_record_t *detached;
+
+    /* Options inherited from the stream */
+    pybgpstream_opts_t opts;
+
+    /* MRT encoding of the record, built the first time its buffer is
+       requested (NULL until then) */
+    pybgpstream_mrtbuf_t *mrt;
+
+    /* Set once elems were read from the stream one by one (they are then
+       missing from the detached copy, so the record cannot be encoded) */
+    int iterated;
+
+    /* Set while a thread decodes the elems of the borrowed record with the
+       GIL released (other threads must wait for the copy) */
+    int detaching;
+
 } BGPRecordObject;
 
+/** Get the next elem of the given record
+ *
+ * @param self          pointer to the record object
+ * @return new reference to the next BGPElem object, or NULL if there are no
+ *         more elems (without an exception set) or an error occurred
+ *
+ * This is the tp_iternext of the BGPRecord type.
+ */
+PyObject *BGPRecord_next_elem(BGPRecordObject *self);
+
 /** Expose the BGPRecordType structure */
 PyTypeObject *_pybgpstream_bgpstream_get_BGPRecordType(void);
 
+/** Expose the free list of BGPRecord objects */
+pybgpstream_freelist_t *_pybgpstream_bgpstream_get_BGPRecordFreelist(void);
+
 /** Expose our new function as it is not exposed to Python */
-PyObject *BGPRecord_new(bgpstream_record_t *rec);
+PyObject *BGPRecord_new(bgpstream_record_t *rec,
+                        const pybgpstream_opts_t *opts);
+
+/** Create a record object that takes ownership of a detached record */
+PyObject *BGPRecord_new_detached(pybgpstream_detached_record_t *drec,
+                                 const pybgpstream_opts_t *opts);
 
 #endif /* ___PYBGPSTREAM_BGPRECORD_H */
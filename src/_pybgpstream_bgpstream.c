@@ -24,26 +24,328 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "_pybgpstream_arrow.h"
 #include "_pybgpstream_bgprecord.h"
 #include "_pybgpstream_bgpstream.h"
+#include "_pybgpstream_cache.h"
+#include "_pybgpstream_checkpoint.h"
+#include "_pybgpstream_mrt.h"
+#include "_pybgpstream_peercount.h"
+#include "_pybgpstream_prefetch.h"
+#include "_pybgpstream_prefixset.h"
+#include "_pybgpstream_reader.h"
+#include "_pybgpstream_routingtable.h"
+#include "_pybgpstream_topology.h"
 #include "pyutils.h"
 #include <Python.h>
 #include <bgpstream.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 typedef struct {
   PyObject_HEAD
 
     /* BGP Stream Instance Handle */
     bgpstream_t *bs;
+
+    /* Serializes reading from the stream (libbgpstream is not thread-safe,
+       and reads release the GIL) */
+    pthread_mutex_t lock;
+
+    /* Options inherited by records created from this stream */
+    pybgpstream_opts_t opts;
+
+    /* Whether the stream has been started */
+    int started;
+
+    /* Record whose elems are currently being iterated over */
+    BGPRecordObject *cur_rec;
+
+    /* Number of records to read ahead in a background thread (0 disables
+       prefetching) */
+    int prefetch_depth;
+
+    /* Record prefetcher (only set once a stream with a prefetch depth has
+       been started) */
+    pybgpstream_prefetch_t *prefetch;
+
+    /* Prefix set used by elem_filter (a reference is held) */
+    PrefixSetObject *prefix_filter;
+
+    /* Filters applied to elems before they are returned (opts.elem_filter
+       points here once any filter is set). Allocated separately, as the
+       prefetch thread may still use it once the stream is deallocated. A
+       reference is held to its trie. */
+    pybgpstream_elemfilter_t *elem_filter;
+
+    /* Settings that identify the data read by the stream (the key of its
+       cache file) */
+    pybgpstream_cache_key_t cache_key;
+
+    /* Directory of the decoded-elem cache (NULL if caching is disabled) */
+    char *cache_dir;
+
+    /* Maximum total size of the cache files */
+    unsigned long long cache_max_size;
+
+    /* Decoded-elem cache (only set once a stream with a cache directory has
+       been started) */
+    pybgpstream_cache_t *cache;
+
+    /* Tracks the records consumed from the stream (and the records to skip
+       when resuming from a checkpoint) */
+    pybgpstream_checkpoint_t *cp;
+
+    /* Counters and timers (NULL until first enabled, and kept when disabled
+       again; opts.stats points here while they are enabled) */
+    pybgpstream_stats_t *stats;
+
+    /* Callable that is periodically passed the statistics (or NULL) */
+    PyObject *stats_callback;
+
+    /* Minimum time between calls to stats_callback, in ns */
+    uint64_t stats_interval_ns;
+
+    /* Time after which stats_callback is due to be called, in ns */
+    uint64_t stats_next_ns;
+
+    /* Set once stats_callback is due, and cleared when it is called */
+    int stats_due;
+
+    /* Set when get_next_records hit an error after reading some records:
+       those are returned, and the error is raised by the next read (see
+       BGPStream_raise_records_error) */
+    int records_error;
 } BGPStreamObject;
 
 #define BGPStreamDocstring "BGPStream object"
 
+/* default maximum total size of the cache files (1 GiB) */
+#define DEFAULT_CACHE_MAX_SIZE (1ULL << 30)
+
+/* prefetch depth of streams started by get_notify_fd */
+#define DEFAULT_NOTIFY_PREFETCH_DEPTH 64
+
+/* default time between calls to the statistics callback, in seconds */
+#define DEFAULT_STATS_INTERVAL 10.0
+
+/* point the options at the elem filter if it filters anything */
+static void BGPStream_update_elem_filter(BGPStreamObject *self)
+{
+  self->opts.elem_filter =
+    pybgpstream_elemfilter_is_empty(self->elem_filter) ? NULL
+                                                       : self->elem_filter;
+}
+
+/* lock the stream, without holding the GIL while another thread reads
+   from it */
+static void BGPStream_lock(BGPStreamObject *self)
+{
+  if (pthread_mutex_trylock(&self->lock) != 0) {
+    Py_BEGIN_ALLOW_THREADS;
+    pthread_mutex_lock(&self->lock);
+    Py_END_ALLOW_THREADS;
+  }
+}
+
+static void BGPStream_unlock(BGPStreamObject *self)
+{
+  pthread_mutex_unlock(&self->lock);
+}
+
+/* Define BGPStream_<name> as a method that calls BGPStream_<name>_locked
+   with the stream locked */
+#define LOCKED_NOARGS_METHOD(name)                                             \
+  static PyObject *BGPStream_##name(BGPStreamObject *self)                     \
+  {                                                                            \
+    PyObject *ret;                                                             \
+    BGPStream_lock(self);                                                      \
+    ret = BGPStream_##name##_locked(self);                                     \
+    BGPStream_unlock(self);                                                    \
+    return ret;                                                                \
+  }
+
+#define LOCKED_VARARGS_METHOD(name)                                            \
+  static PyObject *BGPStream_##name(BGPStreamObject *self, PyObject *args)     \
+  {                                                                            \
+    PyObject *ret;                                                             \
+    BGPStream_lock(self);                                                      \
+    ret = BGPStream_##name##_locked(self, args);                               \
+    BGPStream_unlock(self);                                                    \
+    return ret;                                                                \
+  }
+
+#define LOCKED_KEYWORDS_METHOD(name)                                           \
+  static PyObject *BGPStream_##name(BGPStreamObject *self, PyObject *args,     \
+                                    PyObject *kwds)                            \
+  {                                                                            \
+    PyObject *ret;                                                             \
+    BGPStream_lock(self);                                                      \
+    ret = BGPStream_##name##_locked(self, args, kwds);                         \
+    BGPStream_unlock(self);                                                    \
+    return ret;                                                                \
+  }
+
+/* add the time since start to the given timer of stats, and flag the
+   statistics callback as due if it is time to call it again (the stream
+   must be locked). Returns the current time. */
+static uint64_t BGPStream_stats_add_time(BGPStreamObject *self,
+                                         pybgpstream_stats_t *stats,
+                                         uint64_t *timer, uint64_t start)
+{
+  uint64_t now = pybgpstream_stats_now();
+
+  __atomic_fetch_add(timer, now - start, __ATOMIC_RELAXED);
+  if (self->stats_callback != NULL && now >= self->stats_next_ns) {
+    self->stats_due = 1;
+  }
+  return now;
+}
+
+/* build the statistics dictionary returned by get_stats */
+static PyObject *get_stats_pydict(pybgpstream_stats_t *stats)
+{
+  pybgpstream_stats_t copy;
+  PyObject *status;
+  int i;
+
+  pybgpstream_stats_get(stats, &copy);
+
+  if ((status = PyDict_New()) == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < PYBGPSTREAM_STATS_STATUS_CNT; i++) {
+    if (add_to_dict(status, pybgpstream_stats_status_name(i),
+                    PyLong_FromUnsignedLongLong(copy.status[i])) != 0) {
+      Py_DECREF(status);
+      return NULL;
+    }
+  }
+
+  return Py_BuildValue(
+    "{s:K,s:K,s:N,s:d,s:d,s:{s:K,s:K,s:K},s:d}", "records",
+    (unsigned long long)copy.records, "elems",
+    (unsigned long long)copy.elems, "record_status", status, "read_time",
+    copy.read_ns / 1e9, "convert_time", copy.convert_ns / 1e9, "objects",
+    "records", (unsigned long long)copy.record_objects, "elems",
+    (unsigned long long)copy.elem_objects, "fields",
+    (unsigned long long)copy.field_objects, "elapsed",
+    (pybgpstream_stats_now() - copy.start_ns) / 1e9);
+}
+
+/* call the statistics callback if it is due (the stream must NOT be locked,
+   so that the callback can use the stream). Returns -1 if the callback
+   raised an exception. */
+static int BGPStream_report_stats(BGPStreamObject *self)
+{
+  PyObject *callback;
+  PyObject *dict;
+  PyObject *ret;
+
+  if (!self->stats_due) {
+    return 0;
+  }
+  self->stats_due = 0;
+  if ((callback = self->stats_callback) == NULL || self->stats == NULL) {
+    return 0;
+  }
+  self->stats_next_ns = pybgpstream_stats_now() + self->stats_interval_ns;
+
+  if ((dict = get_stats_pydict(self->stats)) == NULL) {
+    return -1;
+  }
+  Py_INCREF(callback);
+  ret = PyObject_CallFunctionObjArgs(callback, dict, NULL);
+  Py_DECREF(callback);
+  Py_DECREF(dict);
+  if (ret == NULL) {
+    return -1;
+  }
+  Py_DECREF(ret);
+  return 0;
+}
+
+/* What the records of a stream are read from. When a prefetching stream is
+   deallocated, this is handed to the prefetcher, as its reader thread may
+   still be reading. */
+typedef struct {
+  bgpstream_t *bs;
+  pybgpstream_cache_t *cache;
+  pybgpstream_checkpoint_t *cp;
+  pybgpstream_elemfilter_t *filter;
+} stream_source_t;
+
+static void clear_source(stream_source_t *src)
+{
+  pybgpstream_cache_destroy(src->cache);
+  pybgpstream_checkpoint_destroy(src->cp);
+  if (src->bs != NULL) {
+    bgpstream_destroy(src->bs);
+  }
+  if (src->filter != NULL) {
+    pybgpstream_pfxtrie_destroy((pybgpstream_pfxtrie_t *)src->filter->pfxtrie);
+    pybgpstream_elemfilter_clear(src->filter);
+    free(src->filter);
+  }
+}
+
+static void release_source(void *user)
+{
+  clear_source(user);
+  free(user);
+}
+
+/* The stream holds Python references to the record being iterated over, the
+   prefix filter and the statistics callback. The callback is often a bound
+   method of an object that owns the stream, so the GC must see them. */
+static int BGPStream_traverse(BGPStreamObject *self, visitproc visit,
+                              void *arg)
+{
+  Py_VISIT(self->cur_rec);
+  Py_VISIT(self->prefix_filter);
+  Py_VISIT(self->stats_callback);
+  return 0;
+}
+
+static int BGPStream_clear(BGPStreamObject *self)
+{
+  Py_CLEAR(self->cur_rec);
+  /* the elem filter holds its own reference to the trie */
+  Py_CLEAR(self->prefix_filter);
+  Py_CLEAR(self->stats_callback);
+  return 0;
+}
+
 static void BGPStream_dealloc(BGPStreamObject *self)
 {
-  if (self->bs != NULL) {
-    bgpstream_destroy(self->bs);
+  stream_source_t src = {self->bs, self->cache, self->cp, self->elem_filter};
+  stream_source_t *src_copy;
+
+  PyObject_GC_UnTrack(self);
+  Py_XDECREF(self->cur_rec);
+  if (self->prefetch != NULL &&
+      (src_copy = malloc(sizeof(stream_source_t))) != NULL) {
+    /* the reader thread may be blocked reading a record (e.g. in live
+       mode), in which case it releases the source itself once it is done */
+    *src_copy = src;
+    Py_BEGIN_ALLOW_THREADS;
+    pybgpstream_prefetch_destroy(self->prefetch, release_source, src_copy);
+    Py_END_ALLOW_THREADS;
+  } else {
+    if (self->prefetch != NULL) {
+      Py_BEGIN_ALLOW_THREADS;
+      pybgpstream_prefetch_destroy(self->prefetch, NULL, NULL);
+      Py_END_ALLOW_THREADS;
+    }
+    clear_source(&src);
   }
+  pybgpstream_cache_key_clear(&self->cache_key);
+  free(self->cache_dir);
+  Py_XDECREF(self->prefix_filter);
+  pybgpstream_stats_decref(self->stats);
+  Py_XDECREF(self->stats_callback);
+  pthread_mutex_destroy(&self->lock);
   Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
@@ -56,10 +358,15 @@ static PyObject *BGPStream_new(PyTypeObject *type, PyObject *args,
   if (self == NULL) {
     return NULL;
   }
+  pthread_mutex_init(&self->lock, NULL);
+  self->opts.lock = &self->lock;
 
-  if ((self->bs = bgpstream_create()) == NULL) {
+  if ((self->bs = bgpstream_create()) == NULL ||
+      (self->cp = pybgpstream_checkpoint_create()) == NULL ||
+      (self->elem_filter = calloc(1, sizeof(pybgpstream_elemfilter_t))) ==
+        NULL) {
     Py_DECREF(self);
-    return NULL;
+    return PyErr_NoMemory();
   }
 
   return (PyObject *)self;
@@ -70,8 +377,8 @@ static int BGPStream_init(BGPStreamObject *self, PyObject *args, PyObject *kwds)
   return 0;
 }
 
-static PyObject *BGPStream_parse_filter_string(BGPStreamObject *self,
-                                               PyObject *args)
+static PyObject *BGPStream_parse_filter_string_locked(BGPStreamObject *self,
+                                                      PyObject *args)
 {
   const char *fstring;
   if (!PyArg_ParseTuple(args, "s", &fstring)) {
@@ -81,12 +388,49 @@ static PyObject *BGPStream_parse_filter_string(BGPStreamObject *self,
   if (bgpstream_parse_filter_string(self->bs, fstring) == 0) {
     return PyErr_Format(PyExc_ValueError, "Invalid filter string: %s", fstring);
   }
+  pybgpstream_cache_key_add(&self->cache_key, "filter-string", fstring);
+
+  Py_RETURN_NONE;
+}
+
+LOCKED_VARARGS_METHOD(parse_filter_string)
+
+/** Add an elem predicate that libbgpstream cannot filter on */
+static PyObject *BGPStream_add_elem_filter_locked(BGPStreamObject *self,
+                                                  PyObject *args)
+{
+  /* args: EXPRESSION (string) */
+  const char *expr;
+  pybgpstream_pred_t *pred;
+  char err[256];
+
+  if (!PyArg_ParseTuple(args, "s", &expr)) {
+    return NULL;
+  }
+  if (self->started) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "Elem filters must be added before the stream is "
+                    "started");
+    return NULL;
+  }
+
+  if ((pred = pybgpstream_pred_compile(expr, err, sizeof(err))) == NULL) {
+    return PyErr_Format(PyExc_ValueError, "Invalid elem filter '%s': %s",
+                        expr, err);
+  }
+  if (pybgpstream_elemfilter_add_pred(self->elem_filter, pred) != 0) {
+    return PyErr_NoMemory();
+  }
+  BGPStream_update_elem_filter(self);
 
   Py_RETURN_NONE;
 }
 
+LOCKED_VARARGS_METHOD(add_elem_filter)
+
 /** Add a filter to the bgpstream. */
-static PyObject *BGPStream_add_filter(BGPStreamObject *self, PyObject *args)
+static PyObject *BGPStream_add_filter_locked(BGPStreamObject *self,
+                                             PyObject *args)
 {
   /* args: FILTER_TYPE (string), FILTER_VALUE (string) */
   static char *filtertype_strs[] = {
@@ -132,44 +476,61 @@ static PyObject *BGPStream_add_filter(BGPStreamObject *self, PyObject *args)
   }
 
   bgpstream_add_filter(self->bs, filter_val, value);
+  pybgpstream_cache_key_add(&self->cache_key, filter_type, value);
 
   Py_RETURN_NONE;
 }
 
+LOCKED_VARARGS_METHOD(add_filter)
+
 /** Add a rib period filter to the bgpstream. */
-static PyObject *BGPStream_add_rib_period_filter(BGPStreamObject *self,
-                                                 PyObject *args)
+static PyObject *BGPStream_add_rib_period_filter_locked(BGPStreamObject *self,
+                                                        PyObject *args)
 {
   /* args: period (int) */
 
   uint32_t filter_period;
+  char buf[16];
   if (!PyArg_ParseTuple(args, "I", &filter_period)) {
     return NULL;
   }
 
   bgpstream_add_rib_period_filter(self->bs, filter_period);
+  snprintf(buf, sizeof(buf), "%u", filter_period);
+  pybgpstream_cache_key_add(&self->cache_key, "rib-period", buf);
 
   Py_RETURN_NONE;
 }
 
+LOCKED_VARARGS_METHOD(add_rib_period_filter)
+
 /** Add a time filter to the bgpstream. */
-static PyObject *BGPStream_add_interval_filter(BGPStreamObject *self,
-                                               PyObject *args)
+static PyObject *BGPStream_add_interval_filter_locked(BGPStreamObject *self,
+                                                      PyObject *args)
 {
   /* args: from (int), until (int) */
 
   uint32_t filter_start, filter_stop;
+  char buf[32];
   if (!PyArg_ParseTuple(args, "II", &filter_start, &filter_stop)) {
     return NULL;
   }
 
   bgpstream_add_interval_filter(self->bs, filter_start, filter_stop);
+  snprintf(buf, sizeof(buf), "%u-%u", filter_start, filter_stop);
+  pybgpstream_cache_key_add(&self->cache_key, "interval", buf);
+  if (filter_stop == 0) {
+    /* open-ended intervals keep growing */
+    self->cache_key.uncacheable = 1;
+  }
 
   Py_RETURN_NONE;
 }
 
-static PyObject *BGPStream_add_recent_interval(BGPStreamObject *self,
-                                               PyObject *args)
+LOCKED_VARARGS_METHOD(add_interval_filter)
+
+static PyObject *BGPStream_add_recent_interval_locked(BGPStreamObject *self,
+                                                      PyObject *args)
 {
   const char *intstring;
   int islive;
@@ -179,9 +540,12 @@ static PyObject *BGPStream_add_recent_interval(BGPStreamObject *self,
   }
 
   bgpstream_add_recent_interval_filter(self->bs, intstring, islive);
+  self->cache_key.uncacheable = 1;
   Py_RETURN_NONE;
 }
 
+LOCKED_VARARGS_METHOD(add_recent_interval)
+
 /** Get information about available data interfaces */
 static PyObject *BGPStream_get_data_interfaces(BGPStreamObject *self)
 {
@@ -227,8 +591,8 @@ static PyObject *BGPStream_get_data_interfaces(BGPStreamObject *self)
 }
 
 /** Set the data interface */
-static PyObject *BGPStream_set_data_interface(BGPStreamObject *self,
-                                              PyObject *args)
+static PyObject *BGPStream_set_data_interface_locked(BGPStreamObject *self,
+                                                     PyObject *args)
 {
   const char *name;
   if (!PyArg_ParseTuple(args, "s", &name)) {
@@ -240,10 +604,13 @@ static PyObject *BGPStream_set_data_interface(BGPStreamObject *self,
     return PyErr_Format(PyExc_ValueError, "Invalid data interface: %s", name);
   }
   bgpstream_set_data_interface(self->bs, id);
+  pybgpstream_cache_key_add(&self->cache_key, "data-interface", name);
 
   Py_RETURN_NONE;
 }
 
+LOCKED_VARARGS_METHOD(set_data_interface)
+
 /** Get the list of interface options that are available for the given
     interface */
 static PyObject *BGPStream_get_data_interface_options(BGPStreamObject *self,
@@ -291,8 +658,9 @@ static PyObject *BGPStream_get_data_interface_options(BGPStreamObject *self,
 }
 
 /** Set a data interface option (takes interface, opt-name, opt-val) */
-static PyObject *BGPStream_set_data_interface_option(BGPStreamObject *self,
-                                                     PyObject *args)
+static PyObject *
+BGPStream_set_data_interface_option_locked(BGPStreamObject *self,
+                                           PyObject *args)
 {
   const char *interface_name;
   const char *opt_name;
@@ -317,47 +685,181 @@ static PyObject *BGPStream_set_data_interface_option(BGPStreamObject *self,
   }
 
   bgpstream_set_data_interface_option(self->bs, opt, opt_value);
+  pybgpstream_cache_key_add(&self->cache_key, "data-interface-option",
+                            interface_name);
+  pybgpstream_cache_key_add(&self->cache_key, opt_name, opt_value);
 
   Py_RETURN_NONE;
 }
 
+LOCKED_VARARGS_METHOD(set_data_interface_option)
+
 /** Enable blocking mode */
-static PyObject *BGPStream_set_live_mode(BGPStreamObject *self)
+static PyObject *BGPStream_set_live_mode_locked(BGPStreamObject *self)
 {
   bgpstream_set_live_mode(self->bs);
+  self->cache_key.uncacheable = 1;
   Py_RETURN_NONE;
 }
 
+LOCKED_NOARGS_METHOD(set_live_mode)
+
+/** Set the representation used for IP address and prefix values */
+static PyObject *BGPStream_set_address_format_locked(BGPStreamObject *self,
+                                                     PyObject *args)
+{
+  /* args: format (string) */
+  static char *format_strs[] = {"str", "bytes", "int", NULL};
+  static pybgpstream_addr_format_t format_vals[] = {
+    PYBGPSTREAM_ADDR_FORMAT_STR,
+    PYBGPSTREAM_ADDR_FORMAT_BYTES,
+    PYBGPSTREAM_ADDR_FORMAT_INT,
+  };
+
+  const char *format;
+  int i;
+
+  if (!PyArg_ParseTuple(args, "s", &format)) {
+    return NULL;
+  }
+
+  for (i = 0; format_strs[i] != NULL; i++) {
+    if (strcmp(format_strs[i], format) == 0) {
+      self->opts.addr_format = format_vals[i];
+      Py_RETURN_NONE;
+    }
+  }
+
+  return PyErr_Format(PyExc_ValueError, "Invalid address format: %s", format);
+}
+
+LOCKED_VARARGS_METHOD(set_address_format)
+
 /** Start the bgpstream.
  *
  * Corresponds to bgpstream_init (so as not to be confused with Python's
  * __init__ method)
  */
-static PyObject *BGPStream_start(BGPStreamObject *self)
+static PyObject *BGPStream_start_locked(BGPStreamObject *self)
 {
-  int ret = -1;
+  int ret = 0;
   Py_BEGIN_ALLOW_THREADS;
-  ret = bgpstream_start(self->bs);
+  if (self->cache_dir != NULL && !self->cache_key.uncacheable &&
+      (self->cache = pybgpstream_cache_open(
+         self->cache_dir, &self->cache_key, self->cache_max_size, self->bs,
+         self->cp, self->opts.elem_filter)) == NULL) {
+    ret = -1;
+  }
+  /* records are read from the cache file instead if it exists */
+  if (ret == 0 &&
+      (self->cache == NULL || !pybgpstream_cache_is_hit(self->cache))) {
+    ret = bgpstream_start(self->bs);
+  }
   Py_END_ALLOW_THREADS;
 
   if (ret < 0) {
+    pybgpstream_cache_destroy(self->cache);
+    self->cache = NULL;
     PyErr_SetString(PyExc_RuntimeError, "Could not start stream");
     return NULL;
   }
+  self->started = 1;
+
+  if (self->prefetch_depth > 0 &&
+      (self->prefetch = pybgpstream_prefetch_create(
+         self->bs, self->cache, self->cp, self->prefetch_depth,
+         self->opts.elem_filter)) == NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "Could not start prefetch thread");
+    return NULL;
+  }
+
   Py_RETURN_NONE;
 }
 
-/** Corresponds to bgpstream_get_next_record */
-static PyObject *BGPStream_get_next_record(BGPStreamObject *self)
+LOCKED_NOARGS_METHOD(start)
+
+/* start the stream unless it is already started (the stream must be
+   locked) */
+static int BGPStream_ensure_started(BGPStreamObject *self)
+{
+  PyObject *ret;
+
+  if (self->started) {
+    return 0;
+  }
+  if ((ret = BGPStream_start_locked(self)) == NULL) {
+    return -1;
+  }
+  Py_DECREF(ret);
+  return 0;
+}
+
+/* raise the error deferred by get_next_records, if any, and return -1 (or
+   return 0) */
+static int BGPStream_raise_records_error(BGPStreamObject *self)
+{
+  if (!self->records_error) {
+    return 0;
+  }
+  self->records_error = 0;
+  PyErr_SetString(PyExc_RuntimeError, "Could not get next records");
+  return -1;
+}
+
+/* get the next record, or NULL with errno set to EAGAIN (and no Python
+   exception) if block is not set and no record is ready (the stream must be
+   locked) */
+static PyObject *BGPStream_next_record(BGPStreamObject *self, int block)
 {
   bgpstream_record_t *rec = NULL;
+  pybgpstream_detached_record_t *drec = NULL;
+  pybgpstream_stats_t *stats = self->opts.stats;
+  uint64_t start = 0;
   int ret;
   PyObject *pyrec;
 
-  // get_next_record can block for a very long time, so release the GIL
-  Py_BEGIN_ALLOW_THREADS;
-  ret = bgpstream_get_next_record(self->bs, &rec);
-  Py_END_ALLOW_THREADS;
+  if (BGPStream_raise_records_error(self) != 0) {
+    return NULL;
+  }
+
+  /* asking for a record means the previous one was consumed */
+  pybgpstream_checkpoint_commit(self->cp);
+
+  if (stats != NULL) {
+    start = pybgpstream_stats_now();
+  }
+
+  if (!block) {
+    if (self->prefetch == NULL) {
+      PyErr_SetString(PyExc_RuntimeError,
+                      "Non-blocking reads need a stream started with a "
+                      "prefetch depth");
+      return NULL;
+    }
+    /* polling never waits for the reader thread, so the GIL is kept */
+    if ((ret = pybgpstream_prefetch_poll(self->prefetch, &drec)) == 2) {
+      errno = EAGAIN;
+      return NULL;
+    }
+  } else {
+    // get_next_record can block for a very long time, so release the GIL
+    Py_BEGIN_ALLOW_THREADS;
+    if (self->prefetch != NULL) {
+      ret = pybgpstream_prefetch_get_next(self->prefetch, &drec);
+    } else if (self->cache != NULL) {
+      ret = pybgpstream_cache_get_next(self->cache, &drec);
+    } else {
+      ret = pybgpstream_checkpoint_next_record(self->cp, self->bs, &rec);
+    }
+    Py_END_ALLOW_THREADS;
+  }
+
+  if (stats != NULL) {
+    start = BGPStream_stats_add_time(self, stats, &stats->read_ns, start);
+    if (ret > 0) {
+      pybgpstream_stats_add_record(stats, (drec != NULL) ? &drec->rec : rec);
+    }
+  }
 
   if (ret < 0) {
     PyErr_SetString(PyExc_RuntimeError,
@@ -369,18 +871,765 @@ static PyObject *BGPStream_get_next_record(BGPStreamObject *self)
   }
   // else, valid record
 
-  if ((pyrec = BGPRecord_new(rec)) == NULL) {
+  if (drec != NULL) {
+    pyrec = BGPRecord_new_detached(drec, &self->opts);
+  } else {
+    pyrec = BGPRecord_new(rec, &self->opts);
+  }
+  if (pyrec == NULL) {
+    pybgpstream_detached_record_destroy(drec);
     PyErr_SetString(PyExc_RuntimeError, "Could not create BGPRecord object");
     return NULL;
   }
+  pybgpstream_checkpoint_add(self->cp, (drec != NULL) ? &drec->rec : rec);
+
+  if (stats != NULL) {
+    BGPStream_stats_add_time(self, stats, &stats->convert_ns, start);
+  }
 
   return pyrec;
 }
 
+/** Corresponds to bgpstream_get_next_record */
+static PyObject *BGPStream_get_next_record(BGPStreamObject *self,
+                                           PyObject *args, PyObject *kwds)
+{
+  /* args: block (bool) */
+  static char *kwlist[] = {"block", NULL};
+  PyObject *pyblock = NULL;
+  PyObject *pyrec;
+  int block = 1;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &pyblock)) {
+    return NULL;
+  }
+  if (pyblock != NULL && (block = PyObject_IsTrue(pyblock)) < 0) {
+    return NULL;
+  }
+  if (BGPStream_report_stats(self) != 0) {
+    return NULL;
+  }
+
+  BGPStream_lock(self);
+  pyrec = BGPStream_next_record(self, block);
+  BGPStream_unlock(self);
+  if (pyrec == NULL && !PyErr_Occurred()) {
+    /* BlockingIOError (on Python 3) */
+    return PyErr_SetFromErrno(PyExc_OSError);
+  }
+  return pyrec;
+}
+
+/** Get the file descriptor to wait on for non-blocking reads */
+static PyObject *BGPStream_get_notify_fd_locked(BGPStreamObject *self)
+{
+  int fd;
+
+  if (!self->started && self->prefetch_depth == 0) {
+    self->prefetch_depth = DEFAULT_NOTIFY_PREFETCH_DEPTH;
+  }
+  if (BGPStream_ensure_started(self) != 0) {
+    return NULL;
+  }
+  if (self->prefetch == NULL) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "Non-blocking reads need a stream started with a "
+                    "prefetch depth");
+    return NULL;
+  }
+  if ((fd = pybgpstream_prefetch_get_fd(self->prefetch)) < 0) {
+    return PyErr_SetFromErrno(PyExc_OSError);
+  }
+
+  return PYNUM_FROMLONG(fd);
+}
+
+LOCKED_NOARGS_METHOD(get_notify_fd)
+
+/** Get up to N records from the stream in a single GIL-released section.
+ *
+ * Since libbgpstream re-uses its record structure, each record (and all of
+ * its elems) is detached from the stream before the next one is read.
+ */
+static PyObject *BGPStream_get_next_records_locked(BGPStreamObject *self,
+                                                   PyObject *args)
+{
+  /* args: max_cnt (int) */
+  int max_cnt;
+  pybgpstream_detached_record_t **drecs;
+  bgpstream_record_t *rec = NULL;
+  pybgpstream_stats_t *stats = self->opts.stats;
+  uint64_t start = 0;
+  int cnt = 0;
+  int ret = 0;
+  int i;
+  PyObject *list;
+  PyObject *pyrec;
+
+  if (!PyArg_ParseTuple(args, "i", &max_cnt)) {
+    return NULL;
+  }
+  if (max_cnt <= 0) {
+    return PyErr_Format(PyExc_ValueError, "Invalid record count: %d",
+                        max_cnt);
+  }
+  if (BGPStream_raise_records_error(self) != 0) {
+    return NULL;
+  }
+
+  if ((drecs = PyMem_Malloc(sizeof(pybgpstream_detached_record_t *) *
+                            max_cnt)) == NULL) {
+    return PyErr_NoMemory();
+  }
+
+  /* asking for records means the previous ones were consumed */
+  pybgpstream_checkpoint_commit(self->cp);
+
+  if (stats != NULL) {
+    start = pybgpstream_stats_now();
+  }
+
+  Py_BEGIN_ALLOW_THREADS;
+  for (cnt = 0; cnt < max_cnt; cnt++) {
+    if (self->prefetch != NULL) {
+      /* records are already detached by the prefetch thread */
+      if ((ret = pybgpstream_prefetch_get_next(self->prefetch,
+                                               &drecs[cnt])) <= 0) {
+        break;
+      }
+      continue;
+    }
+    if (self->cache != NULL) {
+      /* and so are records read through the cache */
+      if ((ret = pybgpstream_cache_get_next(self->cache, &drecs[cnt])) <= 0) {
+        break;
+      }
+      continue;
+    }
+    if ((ret = pybgpstream_checkpoint_next_record(self->cp, self->bs,
+                                                  &rec)) <= 0) {
+      break;
+    }
+    if ((drecs[cnt] = pybgpstream_detached_record_create(
+           rec, self->opts.elem_filter)) == NULL) {
+      ret = -1;
+      break;
+    }
+  }
+  Py_END_ALLOW_THREADS;
+
+  if (stats != NULL) {
+    start = BGPStream_stats_add_time(self, stats, &stats->read_ns, start);
+    for (i = 0; i < cnt; i++) {
+      pybgpstream_stats_add_record(stats, &drecs[i]->rec);
+    }
+  }
+
+  if (ret < 0 && cnt == 0) {
+    PyMem_Free(drecs);
+    PyErr_SetString(PyExc_RuntimeError,
+                    "Could not get next records (is the stream started?)");
+    return NULL;
+  }
+  /* an empty list indicates end of stream */
+  if ((list = PyList_New(cnt)) == NULL) {
+    goto err;
+  }
+  for (i = 0; i < cnt; i++) {
+    if ((pyrec = BGPRecord_new_detached(drecs[i], &self->opts)) == NULL) {
+      Py_DECREF(list);
+      goto err;
+    }
+    pybgpstream_checkpoint_add(self->cp, &drecs[i]->rec);
+    /* the record object now owns the detached record */
+    drecs[i] = NULL;
+    PyList_SET_ITEM(list, i, pyrec);
+  }
+
+  if (stats != NULL) {
+    BGPStream_stats_add_time(self, stats, &stats->convert_ns, start);
+  }
+
+  /* like the end of the stream, an error that follows some records is only
+     reported once those records were returned */
+  self->records_error = (ret < 0);
+
+  PyMem_Free(drecs);
+  return list;
+
+err:
+  for (i = 0; i < cnt; i++) {
+    pybgpstream_detached_record_destroy(drecs[i]);
+  }
+  PyMem_Free(drecs);
+  return NULL;
+}
+
+static PyObject *BGPStream_get_next_records(BGPStreamObject *self,
+                                            PyObject *args)
+{
+  PyObject *ret;
+
+  if (BGPStream_report_stats(self) != 0) {
+    return NULL;
+  }
+
+  BGPStream_lock(self);
+  ret = BGPStream_get_next_records_locked(self, args);
+  BGPStream_unlock(self);
+  return ret;
+}
+
+/** Export elems from the stream through the Arrow C stream interface */
+static PyObject *BGPStream_get_arrow_stream(BGPStreamObject *self,
+                                            PyObject *args, PyObject *kwds)
+{
+  /* args: columns (sequence of str or None), batch_size (int) */
+  static char *kwlist[] = {"columns", "batch_size", NULL};
+  PyObject *columns = NULL;
+  int batch_size = 65536;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oi", kwlist, &columns,
+                                   &batch_size)) {
+    return NULL;
+  }
+
+  return _pybgpstream_arrow_stream_new((PyObject *)self, self->bs,
+                                       self->prefetch, self->cache, self->cp,
+                                       self->opts.elem_filter, &self->lock,
+                                       self->opts.stats, columns, batch_size);
+}
+
+/** Count the elems and records of each peer in the rest of the stream */
+static PyObject *BGPStream_count_peers_locked(BGPStreamObject *self,
+                                              PyObject *args, PyObject *kwds)
+{
+  /* args: bucket_size (int) */
+  static char *kwlist[] = {"bucket_size", NULL};
+  unsigned int bucket_size = 0;
+  pybgpstream_reader_t reader;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|I", kwlist, &bucket_size)) {
+    return NULL;
+  }
+  if (BGPStream_ensure_started(self) != 0) {
+    return NULL;
+  }
+
+  /* the record being iterated over is about to be replaced */
+  Py_CLEAR(self->cur_rec);
+
+  pybgpstream_reader_init(&reader, self->bs, self->prefetch, self->cache,
+                          self->cp, self->opts.elem_filter, self->opts.stats);
+  return _pybgpstream_peercount_run(&reader, bucket_size,
+                                    self->opts.addr_format);
+}
+
+LOCKED_KEYWORDS_METHOD(count_peers)
+
+/** Extract the AS adjacencies seen in the rest of the stream */
+static PyObject *BGPStream_get_as_topology_locked(BGPStreamObject *self,
+                                                  PyObject *args,
+                                                  PyObject *kwds)
+{
+  /* args: counts (bool), first_seen (bool), peers (bool),
+     as_buffers (bool) */
+  static char *kwlist[] = {"counts", "first_seen", "peers", "as_buffers",
+                           NULL};
+  static const int opt_flags[] = {PYBGPSTREAM_TOPOLOGY_COUNTS,
+                                  PYBGPSTREAM_TOPOLOGY_FIRST_SEEN,
+                                  PYBGPSTREAM_TOPOLOGY_PEERS, 0};
+  PyObject *opts[] = {NULL, NULL, NULL, NULL};
+  pybgpstream_reader_t reader;
+  int flags = 0;
+  int buffers = 0;
+  int val;
+  int i;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOOO", kwlist, &opts[0],
+                                   &opts[1], &opts[2], &opts[3])) {
+    return NULL;
+  }
+  for (i = 0; i < 4; i++) {
+    if (opts[i] == NULL) {
+      continue;
+    }
+    if ((val = PyObject_IsTrue(opts[i])) < 0) {
+      return NULL;
+    }
+    if (val && opt_flags[i] != 0) {
+      flags |= opt_flags[i];
+    } else if (val) {
+      buffers = 1;
+    }
+  }
+  if (BGPStream_ensure_started(self) != 0) {
+    return NULL;
+  }
+
+  /* the record being iterated over is about to be replaced */
+  Py_CLEAR(self->cur_rec);
+
+  pybgpstream_reader_init(&reader, self->bs, self->prefetch, self->cache,
+                          self->cp, self->opts.elem_filter, self->opts.stats);
+  return _pybgpstream_topology_run(&reader, flags, buffers);
+}
+
+LOCKED_KEYWORDS_METHOD(get_as_topology)
+
+/** Write the MRT encoding of the rest of the stream to a file */
+static PyObject *BGPStream_write_mrt_locked(BGPStreamObject *self,
+                                            PyObject *args)
+{
+  /* args: file (int fd or object with a fileno() method) */
+  PyObject *file;
+  pybgpstream_reader_t reader;
+  int fd;
+
+  if (!PyArg_ParseTuple(args, "O", &file)) {
+    return NULL;
+  }
+  if ((fd = PyObject_AsFileDescriptor(file)) < 0) {
+    return NULL;
+  }
+  if (BGPStream_ensure_started(self) != 0) {
+    return NULL;
+  }
+
+  /* the record being iterated over is about to be replaced */
+  Py_CLEAR(self->cur_rec);
+
+  pybgpstream_reader_init(&reader, self->bs, self->prefetch, self->cache,
+                          self->cp, self->opts.elem_filter, self->opts.stats);
+  return _pybgpstream_mrt_write_run(&reader, fd);
+}
+
+LOCKED_VARARGS_METHOD(write_mrt)
+
+/** Apply the rest of the stream (or the records up to a time) to a routing
+    table */
+static PyObject *BGPStream_update_routing_table_locked(BGPStreamObject *self,
+                                                       PyObject *args,
+                                                       PyObject *kwds)
+{
+  /* args: table (RoutingTable), until (int or None) */
+  static char *kwlist[] = {"table", "until", NULL};
+  PyObject *table;
+  PyObject *until_obj = Py_None;
+  long long until = -1;
+  pybgpstream_reader_t reader;
+
+  if (!PyArg_ParseTupleAndKeywords(
+        args, kwds, "O!|O", kwlist,
+        _pybgpstream_bgpstream_get_RoutingTableType(), &table, &until_obj)) {
+    return NULL;
+  }
+  if (until_obj != Py_None) {
+    if ((until = PyLong_AsLongLong(until_obj)) == -1 && PyErr_Occurred()) {
+      return NULL;
+    }
+    if (until < 0) {
+      PyErr_SetString(PyExc_ValueError, "until must not be negative");
+      return NULL;
+    }
+  }
+  if (BGPStream_ensure_started(self) != 0) {
+    return NULL;
+  }
+
+  /* the record being iterated over is about to be replaced */
+  Py_CLEAR(self->cur_rec);
+
+  pybgpstream_reader_init(&reader, self->bs, self->prefetch, self->cache,
+                          self->cp, self->opts.elem_filter, self->opts.stats);
+  return _pybgpstream_routingtable_update(table, &reader, until);
+}
+
+LOCKED_KEYWORDS_METHOD(update_routing_table)
+
+/** Filter elems with a prefix set */
+static PyObject *BGPStream_set_prefix_filter_locked(BGPStreamObject *self,
+                                                    PyObject *args)
+{
+  /* args: prefix_set (PrefixSet or None) */
+  PyObject *pset;
+
+  if (!PyArg_ParseTuple(args, "O", &pset)) {
+    return NULL;
+  }
+  if (pset != Py_None &&
+      !PyObject_TypeCheck(pset, _pybgpstream_bgpstream_get_PrefixSetType())) {
+    PyErr_SetString(PyExc_TypeError, "Prefix filter must be a PrefixSet");
+    return NULL;
+  }
+  if (self->started) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "The prefix filter must be set before the stream is "
+                    "started");
+    return NULL;
+  }
+
+  Py_CLEAR(self->prefix_filter);
+  pybgpstream_pfxtrie_destroy(
+    (pybgpstream_pfxtrie_t *)self->elem_filter->pfxtrie);
+  self->elem_filter->pfxtrie = NULL;
+  if (pset != Py_None) {
+    /* the trie is read without the GIL once the stream is started */
+    Py_BEGIN_CRITICAL_SECTION(pset);
+    ((PrefixSetObject *)pset)->frozen = 1;
+    Py_END_CRITICAL_SECTION();
+    Py_INCREF(pset);
+    self->prefix_filter = (PrefixSetObject *)pset;
+    pybgpstream_pfxtrie_incref(self->prefix_filter->trie);
+    self->elem_filter->pfxtrie = self->prefix_filter->trie;
+  }
+  BGPStream_update_elem_filter(self);
+
+  Py_RETURN_NONE;
+}
+
+LOCKED_VARARGS_METHOD(set_prefix_filter)
+
+/** Set the number of records to read ahead in a background thread */
+static PyObject *BGPStream_set_prefetch_depth_locked(BGPStreamObject *self,
+                                                     PyObject *args)
+{
+  /* args: depth (int) */
+  int depth;
+
+  if (!PyArg_ParseTuple(args, "i", &depth)) {
+    return NULL;
+  }
+  if (depth < 0) {
+    return PyErr_Format(PyExc_ValueError, "Invalid prefetch depth: %d",
+                        depth);
+  }
+  if (self->started) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "Prefetching must be configured before the stream is "
+                    "started");
+    return NULL;
+  }
+
+  self->prefetch_depth = depth;
+
+  Py_RETURN_NONE;
+}
+
+LOCKED_VARARGS_METHOD(set_prefetch_depth)
+
+/** Cache the decoded elems of the stream in the given directory */
+static PyObject *BGPStream_set_cache_locked(BGPStreamObject *self,
+                                            PyObject *args, PyObject *kwds)
+{
+  /* args: directory (str or None), max_size (int) */
+  static char *kwlist[] = {"directory", "max_size", NULL};
+  const char *dir;
+  unsigned long long max_size = DEFAULT_CACHE_MAX_SIZE;
+  struct stat st;
+  char *tmp = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "z|K", kwlist, &dir,
+                                   &max_size)) {
+    return NULL;
+  }
+  if (self->started) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "The cache must be configured before the stream is "
+                    "started");
+    return NULL;
+  }
+  if (dir != NULL) {
+    if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+      return PyErr_Format(PyExc_ValueError, "Invalid cache directory: %s",
+                          dir);
+    }
+    if ((tmp = strdup(dir)) == NULL) {
+      return PyErr_NoMemory();
+    }
+  }
+
+  free(self->cache_dir);
+  self->cache_dir = tmp;
+  self->cache_max_size = max_size;
+
+  Py_RETURN_NONE;
+}
+
+LOCKED_KEYWORDS_METHOD(set_cache)
+
+/** Get information about the decoded-elem cache */
+static PyObject *BGPStream_get_cache_info_locked(BGPStreamObject *self)
+{
+  pybgpstream_cache_info_t info;
+
+  if (self->cache == NULL) {
+    Py_RETURN_NONE;
+  }
+
+  pybgpstream_cache_get_info(self->cache, &info);
+
+  return Py_BuildValue("{s:s,s:N,s:K,s:K}", "path", info.path, "hit",
+                       PyBool_FromLong(info.hit), "records",
+                       (unsigned long long)info.records, "size",
+                       (unsigned long long)info.size);
+}
+
+LOCKED_NOARGS_METHOD(get_cache_info)
+
+/** Get a token that captures the records consumed from the stream */
+static PyObject *BGPStream_checkpoint_locked(BGPStreamObject *self)
+{
+  PyObject *pytoken;
+  char *token;
+
+  if ((token = pybgpstream_checkpoint_get_token(
+         self->cp, pybgpstream_cache_key_hash(&self->cache_key))) == NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "Could not create checkpoint");
+    return NULL;
+  }
+  pytoken = PYSTR_FROMSTR(token);
+  free(token);
+  return pytoken;
+}
+
+LOCKED_NOARGS_METHOD(checkpoint)
+
+/** Skip the records consumed before the given checkpoint */
+static PyObject *BGPStream_resume_locked(BGPStreamObject *self, PyObject *args)
+{
+  /* args: token (str) */
+  const char *token;
+  pybgpstream_checkpoint_t *cp;
+  char err[256];
+
+  if (!PyArg_ParseTuple(args, "s", &token)) {
+    return NULL;
+  }
+  if (self->started) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "A stream must be resumed before it is started");
+    return NULL;
+  }
+
+  /* the settings of the stream must all be applied by now, since the token
+     is only valid for a stream with the same cache key */
+  if ((cp = pybgpstream_checkpoint_create()) == NULL) {
+    return PyErr_NoMemory();
+  }
+  if (pybgpstream_checkpoint_resume(
+        cp, token, pybgpstream_cache_key_hash(&self->cache_key), err,
+        sizeof(err)) != 0) {
+    pybgpstream_checkpoint_destroy(cp);
+    return PyErr_Format(PyExc_ValueError, "Invalid checkpoint: %s", err);
+  }
+  pybgpstream_checkpoint_destroy(self->cp);
+  self->cp = cp;
+
+  Py_RETURN_NONE;
+}
+
+LOCKED_VARARGS_METHOD(resume)
+
+/** Get the statistics of the record prefetcher */
+static PyObject *BGPStream_get_prefetch_stats(BGPStreamObject *self)
+{
+  pybgpstream_prefetch_stats_t stats;
+
+  if (self->prefetch == NULL) {
+    Py_RETURN_NONE;
+  }
+
+  pybgpstream_prefetch_get_stats(self->prefetch, &stats);
+
+  return Py_BuildValue("{s:i,s:i,s:K,s:K,s:K}", "depth", stats.depth,
+                       "queued", stats.queued, "records",
+                       (unsigned long long)stats.records, "full",
+                       (unsigned long long)stats.full, "empty",
+                       (unsigned long long)stats.empty);
+}
+
+/* enable the statistics of the stream (the stream must be locked) */
+static int BGPStream_enable_stats(BGPStreamObject *self)
+{
+  if (self->stats == NULL &&
+      (self->stats = pybgpstream_stats_create()) == NULL) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  self->opts.stats = self->stats;
+  return 0;
+}
+
+/** Enable or disable the counters and timers of the stream */
+static PyObject *BGPStream_set_stats_enabled_locked(BGPStreamObject *self,
+                                                    PyObject *args)
+{
+  /* args: enabled (bool) */
+  PyObject *pyenabled;
+  int enabled;
+
+  if (!PyArg_ParseTuple(args, "O", &pyenabled)) {
+    return NULL;
+  }
+  if ((enabled = PyObject_IsTrue(pyenabled)) < 0) {
+    return NULL;
+  }
+
+  if (!enabled) {
+    /* the counters are kept, so that they resume if enabled again */
+    self->opts.stats = NULL;
+  } else if (BGPStream_enable_stats(self) != 0) {
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+LOCKED_VARARGS_METHOD(set_stats_enabled)
+
+/** Set a callable to periodically pass the statistics of the stream to */
+static PyObject *BGPStream_set_stats_callback_locked(BGPStreamObject *self,
+                                                     PyObject *args,
+                                                     PyObject *kwds)
+{
+  /* args: callback (callable or None), interval (float, seconds) */
+  static char *kwlist[] = {"callback", "interval", NULL};
+  PyObject *callback;
+  double interval = DEFAULT_STATS_INTERVAL;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|d", kwlist, &callback,
+                                   &interval)) {
+    return NULL;
+  }
+  if (callback != Py_None && !PyCallable_Check(callback)) {
+    PyErr_SetString(PyExc_TypeError, "Statistics callback must be callable");
+    return NULL;
+  }
+  if (!(interval > 0)) {
+    return PyErr_Format(PyExc_ValueError, "Invalid statistics interval: %f",
+                        interval);
+  }
+
+  Py_CLEAR(self->stats_callback);
+  self->stats_due = 0;
+  if (callback == Py_None) {
+    Py_RETURN_NONE;
+  }
+  if (BGPStream_enable_stats(self) != 0) {
+    return NULL;
+  }
+  Py_INCREF(callback);
+  self->stats_callback = callback;
+  self->stats_interval_ns = (uint64_t)(interval * 1e9);
+  self->stats_next_ns = pybgpstream_stats_now() + self->stats_interval_ns;
+  Py_RETURN_NONE;
+}
+
+LOCKED_KEYWORDS_METHOD(set_stats_callback)
+
+/** Get the counters and timers of the stream */
+static PyObject *BGPStream_get_stats(BGPStreamObject *self)
+{
+  /* the counters are read atomically, so the stream is not locked (and the
+     statistics callback can call this) */
+  if (self->stats == NULL) {
+    Py_RETURN_NONE;
+  }
+  return get_stats_pydict(self->stats);
+}
+
+/** Iterating over a stream starts it (if needed) and yields its elems */
+static PyObject *BGPStream_iter(BGPStreamObject *self)
+{
+  int ret;
+
+  BGPStream_lock(self);
+  ret = BGPStream_ensure_started(self);
+  BGPStream_unlock(self);
+  if (ret != 0) {
+    return NULL;
+  }
+
+  Py_INCREF(self);
+  return (PyObject *)self;
+}
+
+/** Get the next elem of the stream, moving on to the next record once all
+    elems of the current one have been returned */
+static PyObject *BGPStream_iternext(BGPStreamObject *self)
+{
+  PyObject *elem = NULL;
+  PyObject *rec;
+
+  if (BGPStream_report_stats(self) != 0) {
+    return NULL;
+  }
+
+  BGPStream_lock(self);
+  while (1) {
+    if (self->cur_rec != NULL) {
+      if ((elem = BGPRecord_next_elem(self->cur_rec)) != NULL ||
+          PyErr_Occurred()) {
+        break;
+      }
+      Py_CLEAR(self->cur_rec);
+    }
+
+    if ((rec = BGPStream_next_record(self, 1)) == NULL) {
+      break;
+    }
+    if (rec == Py_None) {
+      /* end of stream */
+      Py_DECREF(rec);
+      break;
+    }
+    self->cur_rec = (BGPRecordObject *)rec;
+  }
+  BGPStream_unlock(self);
+  return elem;
+}
+
+/* started */
+static PyObject *BGPStream_get_started(BGPStreamObject *self, void *closure)
+{
+  return PyBool_FromLong(self->started);
+}
+
+/* started used to be a plain attribute of the wrapper class, which was set
+   once the stream was started: setting it starts the stream if needed */
+static int BGPStream_set_started(BGPStreamObject *self, PyObject *value,
+                                 void *closure)
+{
+  int started;
+  int ret = 0;
+
+  if (value == NULL) {
+    PyErr_SetString(PyExc_TypeError, "Cannot delete the started attribute");
+    return -1;
+  }
+  if ((started = PyObject_IsTrue(value)) < 0) {
+    return -1;
+  }
+
+  BGPStream_lock(self);
+  if (started) {
+    ret = BGPStream_ensure_started(self);
+  } else if (self->started) {
+    PyErr_SetString(PyExc_ValueError, "A started stream cannot be stopped");
+    ret = -1;
+  }
+  BGPStream_unlock(self);
+
+  return ret;
+}
+
 static PyMethodDef BGPStream_methods[] = {
   {"parse_filter_string", (PyCFunction)BGPStream_parse_filter_string,
    METH_VARARGS, "Parse a string to add filters to an un-started stream."},
 
+  {"add_elem_filter", (PyCFunction)BGPStream_add_elem_filter, METH_VARARGS,
+   "Only keep the elems that match the given predicate expression"},
+
   {"add_filter", (PyCFunction)BGPStream_add_filter, METH_VARARGS,
    "Add a filter to an un-started stream."},
 
@@ -406,12 +1655,92 @@ static PyMethodDef BGPStream_methods[] = {
   {"set_live_mode", (PyCFunction)BGPStream_set_live_mode, METH_NOARGS,
    "Enable live mode"},
 
+  {"set_address_format", (PyCFunction)BGPStream_set_address_format,
+   METH_VARARGS,
+   "Set the representation of IP address and prefix values ('str', 'bytes' "
+   "or 'int')"},
+
+  {"count_peers", (PyCFunction)BGPStream_count_peers,
+   METH_VARARGS | METH_KEYWORDS,
+   "Count the elems and records of each peer in the rest of the stream"},
+
+  {"get_as_topology", (PyCFunction)BGPStream_get_as_topology,
+   METH_VARARGS | METH_KEYWORDS,
+   "Extract the AS adjacencies seen in the AS paths of the rest of the "
+   "stream"},
+
+  {"write_mrt", (PyCFunction)BGPStream_write_mrt, METH_VARARGS,
+   "Write the MRT encoding of the rest of the stream to a file descriptor"},
+
+  {"update_routing_table", (PyCFunction)BGPStream_update_routing_table,
+   METH_VARARGS | METH_KEYWORDS,
+   "Apply the rest of the stream (or the records up to a time) to a "
+   "RoutingTable"},
+
+  {"set_prefix_filter", (PyCFunction)BGPStream_set_prefix_filter,
+   METH_VARARGS,
+   "Only keep the elems whose prefix matches the given PrefixSet"},
+
+  {"set_prefetch_depth", (PyCFunction)BGPStream_set_prefetch_depth,
+   METH_VARARGS,
+   "Read up to N records ahead in a background thread once the stream is "
+   "started"},
+
+  {"get_prefetch_stats", (PyCFunction)BGPStream_get_prefetch_stats,
+   METH_NOARGS, "Get the statistics of the record prefetch thread"},
+
+  {"set_stats_enabled", (PyCFunction)BGPStream_set_stats_enabled,
+   METH_VARARGS, "Enable or disable the counters and timers of the stream"},
+
+  {"set_stats_callback", (PyCFunction)BGPStream_set_stats_callback,
+   METH_VARARGS | METH_KEYWORDS,
+   "Periodically pass the statistics of the stream to a callable"},
+
+  {"get_stats", (PyCFunction)BGPStream_get_stats, METH_NOARGS,
+   "Get the counters and timers of the stream"},
+
+  {"set_cache", (PyCFunction)BGPStream_set_cache,
+   METH_VARARGS | METH_KEYWORDS,
+   "Cache the decoded elems of the stream in the given directory"},
+
+  {"get_cache_info", (PyCFunction)BGPStream_get_cache_info, METH_NOARGS,
+   "Get information about the decoded-elem cache of the stream"},
+
+  {"checkpoint", (PyCFunction)BGPStream_checkpoint, METH_NOARGS,
+   "Get a token that captures the records consumed from the stream"},
+
+  {"resume", (PyCFunction)BGPStream_resume, METH_VARARGS,
+   "Skip the records consumed before the given checkpoint token once the "
+   "stream is started"},
+
   {"start", (PyCFunction)BGPStream_start, METH_NOARGS, "Start the BGPStream."},
 
-  {"get_next_record", (PyCFunction)BGPStream_get_next_record, METH_VARARGS,
+  {"get_next_record", (PyCFunction)BGPStream_get_next_record,
+   METH_VARARGS | METH_KEYWORDS,
    "Get the next BGPStreamRecord from the stream, or None if end-of-stream "
    "has been reached"},
 
+  {"get_notify_fd", (PyCFunction)BGPStream_get_notify_fd, METH_NOARGS,
+   "Get a file descriptor that is readable while a record can be read "
+   "without blocking"},
+
+  {"get_next_records", (PyCFunction)BGPStream_get_next_records, METH_VARARGS,
+   "Get a list of up to N BGPStreamRecords from the stream, or an empty list "
+   "if end-of-stream has been reached"},
+
+  {"get_arrow_stream", (PyCFunction)BGPStream_get_arrow_stream,
+   METH_VARARGS | METH_KEYWORDS,
+   "Get an Arrow C stream (PyCapsule) of the elems in the stream"},
+
+  {NULL} /* Sentinel */
+};
+
+static PyGetSetDef BGPStream_getsetters[] = {
+
+  {"started", (getter)BGPStream_get_started, (setter)BGPStream_set_started,
+   "Whether the stream has been started (setting it starts the stream)",
+   NULL},
+
   {NULL} /* Sentinel */
 };
 
@@ -434,17 +1763,18 @@ static PyTypeObject BGPStreamType = {
   0,                                                       /* tp_getattro */
   0,                                                       /* tp_setattro */
   0,                                                       /* tp_as_buffer */
-  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,                /* tp_flags */
+  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE |
+    Py_TPFLAGS_HAVE_GC,                                    /* tp_flags */
   BGPStreamDocstring,                                      /* tp_doc */
-  0,                                                       /* tp_traverse */
-  0,                                                       /* tp_clear */
+  (traverseproc)BGPStream_traverse,                        /* tp_traverse */
+  (inquiry)BGPStream_clear,                                /* tp_clear */
   0,                                                       /* tp_richcompare */
   0,                        /* tp_weaklistoffset */
-  0,                        /* tp_iter */
-  0,                        /* tp_iternext */
+  (getiterfunc)BGPStream_iter,         /* tp_iter */
+  (iternextfunc)BGPStream_iternext,    /* tp_iternext */
   BGPStream_methods,        /* tp_methods */
   0,                        /* tp_members */
-  0,                        /* tp_getset */
+  BGPStream_getsetters,     /* tp_getset */
   0,                        /* tp_base */
   0,                        /* tp_dict */
   0,                        /* tp_descr_get */
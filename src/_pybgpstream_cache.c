@@ -0,0 +1,854 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_cache.h"
+#include "_pybgpstream_utils.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+
+#define CACHE_MAGIC "PBSCACHE"
+#define CACHE_VERSION 1
+#define CACHE_SUFFIX ".pbscache"
+
+/* A cache file is laid out as follows (all integers are in host byte order,
+   as cache files are only read on the host that wrote them):
+
+   - a cache_header_t, followed by the key (padded to 8 bytes)
+   - the records, each being a cache_record_t followed by elems_cnt
+     cache_elem_t, and then by the AS path data and the communities of each
+     elem in turn (padded to 4 bytes)
+   - the name table: a uint32_t count, then for each name a uint16_t length
+     and the bytes of the name
+
+   Records are appended as they are read from the stream, and the header is
+   written once the end of the stream is reached. */
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t key_len;
+  uint64_t records_cnt;
+
+  /** Offset of the name table (and end of the records) */
+  uint64_t names_off;
+
+  /** Size of the whole file */
+  uint64_t size;
+} cache_header_t;
+
+typedef struct {
+
+  /** Size of the whole entry (including elems and their data) */
+  uint32_t size;
+  uint32_t elems_cnt;
+  uint32_t time_sec;
+  uint32_t time_usec;
+  uint32_t dump_time_sec;
+
+  /** Indexes of the names in the name table */
+  uint16_t project;
+  uint16_t collector;
+  uint16_t router;
+
+  uint8_t type;
+  uint8_t dump_pos;
+  uint8_t status;
+  uint8_t router_ip_version;
+  uint8_t pad[2];
+  uint8_t router_ip[16];
+} cache_record_t;
+
+typedef struct {
+  uint32_t orig_time_sec;
+  uint32_t orig_time_usec;
+  uint32_t peer_asn;
+
+  /** Number of bytes of AS path data */
+  uint16_t path_len;
+  uint16_t communities_cnt;
+
+  uint8_t type;
+  uint8_t old_state;
+  uint8_t new_state;
+  uint8_t prefix_len;
+  uint8_t peer_ip_version;
+  uint8_t prefix_version;
+  uint8_t nexthop_version;
+
+  /** Whether the elem has an AS path and a community set */
+  uint8_t has_attrs;
+
+  uint8_t peer_ip[16];
+  uint8_t prefix[16];
+  uint8_t nexthop[16];
+} cache_elem_t;
+
+typedef struct {
+  const char *str;
+  uint16_t len;
+} cache_name_t;
+
+struct pybgpstream_cache {
+
+  /** Directory of the cache files */
+  char *dir;
+
+  /** Path of the cache file, and of the file being written */
+  char *path;
+  char *tmp_path;
+
+  /** Key of the stream */
+  char *key;
+  size_t key_len;
+
+  /** Maximum total size of the cache files (0 for no limit) */
+  uint64_t max_size;
+
+  /** libbgpstream instance (only read if the cache file did not exist) */
+  bgpstream_t *bs;
+
+  /** Checkpoint tracker (or NULL) */
+  pybgpstream_checkpoint_t *cp;
+
+  /** Filter that elems must pass (or NULL) */
+  const pybgpstream_elemfilter_t *filter;
+
+  /** Whether records are read from the cache file */
+  int hit;
+
+  /** Number of records read or written */
+  uint64_t records;
+
+  /* reading */
+
+  /** Mapped cache file */
+  uint8_t *map;
+  size_t map_len;
+
+  /** Offset of the next record, and end of the records */
+  uint64_t off;
+  uint64_t end;
+
+  /** Name table */
+  cache_name_t *names;
+  uint32_t names_cnt;
+
+  /* writing */
+
+  /** File being written (NULL once written, or if writing failed) */
+  FILE *fp;
+
+  /** Number of bytes written */
+  uint64_t size;
+
+  /** Distinct names written */
+  pybgpstream_names_t wnames;
+};
+
+/* ---------- keys ---------- */
+
+void pybgpstream_cache_key_add(pybgpstream_cache_key_t *key, const char *name,
+                               const char *value)
+{
+  size_t name_len = strlen(name) + 1;
+  size_t value_len = strlen(value) + 1;
+  size_t new_alloc;
+  char *tmp;
+
+  if (key->uncacheable) {
+    return;
+  }
+  if (key->len + name_len + value_len > key->alloc) {
+    new_alloc = (key->alloc == 0) ? 256 : key->alloc;
+    while (new_alloc < key->len + name_len + value_len) {
+      new_alloc *= 2;
+    }
+    if ((tmp = realloc(key->data, new_alloc)) == NULL) {
+      key->uncacheable = 1;
+      return;
+    }
+    key->data = tmp;
+    key->alloc = new_alloc;
+  }
+  memcpy(key->data + key->len, name, name_len);
+  key->len += name_len;
+  memcpy(key->data + key->len, value, value_len);
+  key->len += value_len;
+}
+
+void pybgpstream_cache_key_clear(pybgpstream_cache_key_t *key)
+{
+  free(key->data);
+  memset(key, 0, sizeof(*key));
+}
+
+uint64_t pybgpstream_cache_key_hash(const pybgpstream_cache_key_t *key)
+{
+  return pybgpstream_hash64(key->data, key->len);
+}
+
+/* ---------- addresses ---------- */
+
+static uint8_t addr_get(const bgpstream_ip_addr_t *addr, uint8_t *bytes)
+{
+  if (addr->version == BGPSTREAM_ADDR_VERSION_IPV4) {
+    memcpy(bytes, &addr->bs_ipv4.addr, 4);
+    return 4;
+  }
+  if (addr->version == BGPSTREAM_ADDR_VERSION_IPV6) {
+    memcpy(bytes, &addr->bs_ipv6.addr, 16);
+    return 6;
+  }
+  return 0;
+}
+
+static void addr_set(bgpstream_ip_addr_t *addr, uint8_t version,
+                     const uint8_t *bytes)
+{
+  if (version == 4) {
+    addr->version = BGPSTREAM_ADDR_VERSION_IPV4;
+    memcpy(&addr->bs_ipv4.addr, bytes, 4);
+  } else if (version == 6) {
+    addr->version = BGPSTREAM_ADDR_VERSION_IPV6;
+    memcpy(&addr->bs_ipv6.addr, bytes, 16);
+  } else {
+    addr->version = BGPSTREAM_ADDR_VERSION_UNKNOWN;
+  }
+}
+
+/* ---------- eviction ---------- */
+
+typedef struct {
+  char *path;
+  time_t mtime;
+  uint64_t size;
+} cache_file_t;
+
+static int file_cmp(const void *a, const void *b)
+{
+  const cache_file_t *fa = a;
+  const cache_file_t *fb = b;
+  return (fa->mtime > fb->mtime) - (fa->mtime < fb->mtime);
+}
+
+/* remove the least recently used cache files of dir until their total size
+   is at most max_size */
+static void evict(const char *dir, uint64_t max_size)
+{
+  size_t suffix_len = strlen(CACHE_SUFFIX);
+  cache_file_t *files = NULL;
+  cache_file_t *tmp;
+  int files_cnt = 0;
+  int files_alloc = 0;
+  uint64_t total = 0;
+  struct dirent *ent;
+  struct stat st;
+  size_t name_len;
+  char *path;
+  DIR *d;
+  int i;
+
+  if (max_size == 0 || (d = opendir(dir)) == NULL) {
+    return;
+  }
+  while ((ent = readdir(d)) != NULL) {
+    name_len = strlen(ent->d_name);
+    if (name_len <= suffix_len ||
+        strcmp(ent->d_name + name_len - suffix_len, CACHE_SUFFIX) != 0) {
+      continue;
+    }
+    if ((path = malloc(strlen(dir) + name_len + 2)) == NULL) {
+      break;
+    }
+    sprintf(path, "%s/%s", dir, ent->d_name);
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+      free(path);
+      continue;
+    }
+    if (files_cnt == files_alloc) {
+      files_alloc = (files_alloc == 0) ? 16 : files_alloc * 2;
+      if ((tmp = realloc(files, sizeof(cache_file_t) * files_alloc)) ==
+          NULL) {
+        free(path);
+        break;
+      }
+      files = tmp;
+    }
+    files[files_cnt].path = path;
+    files[files_cnt].mtime = st.st_mtime;
+    files[files_cnt].size = st.st_size;
+    files_cnt++;
+    total += st.st_size;
+  }
+  closedir(d);
+
+  if (total > max_size) {
+    qsort(files, files_cnt, sizeof(cache_file_t), file_cmp);
+    for (i = 0; i < files_cnt && total > max_size; i++) {
+      if (unlink(files[i].path) == 0) {
+        total -= files[i].size;
+      }
+    }
+  }
+
+  for (i = 0; i < files_cnt; i++) {
+    free(files[i].path);
+  }
+  free(files);
+}
+
+/* ---------- reading ---------- */
+
+static int open_reader(pybgpstream_cache_t *cache)
+{
+  const cache_header_t *hdr;
+  struct stat st;
+  uint64_t off;
+  uint32_t i;
+  int fd;
+
+  if ((fd = open(cache->path, O_RDONLY)) < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(cache_header_t)) {
+    close(fd);
+    return -1;
+  }
+  cache->map_len = st.st_size;
+  cache->map = mmap(NULL, cache->map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (cache->map == MAP_FAILED) {
+    cache->map = NULL;
+    return -1;
+  }
+  madvise(cache->map, cache->map_len, MADV_SEQUENTIAL);
+
+  hdr = (const cache_header_t *)cache->map;
+  cache->off = (sizeof(cache_header_t) + cache->key_len + 7) & ~(uint64_t)7;
+  if (memcmp(hdr->magic, CACHE_MAGIC, sizeof(hdr->magic)) != 0 ||
+      hdr->version != CACHE_VERSION || hdr->size != cache->map_len ||
+      hdr->key_len != cache->key_len ||
+      memcmp(cache->map + sizeof(cache_header_t), cache->key,
+             cache->key_len) != 0 ||
+      hdr->names_off < cache->off ||
+      hdr->names_off + sizeof(uint32_t) > cache->map_len) {
+    goto err;
+  }
+  cache->end = hdr->names_off;
+
+  /* name table */
+  off = hdr->names_off;
+  memcpy(&cache->names_cnt, cache->map + off, sizeof(uint32_t));
+  off += sizeof(uint32_t);
+  if (cache->names_cnt > UINT16_MAX + 1 ||
+      (cache->names = malloc(sizeof(cache_name_t) *
+                             (cache->names_cnt + 1))) == NULL) {
+    goto err;
+  }
+  for (i = 0; i < cache->names_cnt; i++) {
+    if (off + sizeof(uint16_t) > cache->map_len) {
+      goto err;
+    }
+    memcpy(&cache->names[i].len, cache->map + off, sizeof(uint16_t));
+    off += sizeof(uint16_t);
+    if (off + cache->names[i].len > cache->map_len) {
+      goto err;
+    }
+    cache->names[i].str = (const char *)cache->map + off;
+    off += cache->names[i].len;
+  }
+
+  return 0;
+
+err:
+  munmap(cache->map, cache->map_len);
+  cache->map = NULL;
+  free(cache->names);
+  cache->names = NULL;
+  return -1;
+}
+
+static int get_name(pybgpstream_cache_t *cache, uint16_t idx, char *dst)
+{
+  size_t len;
+
+  if (idx >= cache->names_cnt) {
+    return -1;
+  }
+  len = cache->names[idx].len;
+  if (len >= BGPSTREAM_UTILS_STR_NAME_LEN) {
+    len = BGPSTREAM_UTILS_STR_NAME_LEN - 1;
+  }
+  memcpy(dst, cache->names[idx].str, len);
+  dst[len] = '\0';
+  return 0;
+}
+
+static int read_elem(bgpstream_elem_t *elem, const cache_elem_t *ce,
+                     const uint8_t *data)
+{
+  bgpstream_community_t comm;
+  int i;
+
+  elem->type = ce->type;
+  elem->orig_time_sec = ce->orig_time_sec;
+  elem->orig_time_usec = ce->orig_time_usec;
+  elem->peer_asn = ce->peer_asn;
+  elem->old_state = ce->old_state;
+  elem->new_state = ce->new_state;
+  addr_set(&elem->peer_ip, ce->peer_ip_version, ce->peer_ip);
+  addr_set(&elem->nexthop, ce->nexthop_version, ce->nexthop);
+  addr_set(&elem->prefix.address, ce->prefix_version, ce->prefix);
+  elem->prefix.mask_len = ce->prefix_len;
+
+  if (!ce->has_attrs) {
+    return 0;
+  }
+  if ((elem->as_path = bgpstream_as_path_create()) == NULL ||
+      bgpstream_as_path_populate_from_data(elem->as_path, data,
+                                           ce->path_len) != 0 ||
+      (elem->communities = bgpstream_community_set_create()) == NULL) {
+    return -1;
+  }
+  data += ce->path_len;
+  for (i = 0; i < ce->communities_cnt; i++) {
+    memcpy(&comm.asn, data, sizeof(uint16_t));
+    memcpy(&comm.value, data + sizeof(uint16_t), sizeof(uint16_t));
+    data += 2 * sizeof(uint16_t);
+    if (bgpstream_community_set_insert(elem->communities, &comm) < 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/* read the next record, returning 2 if it was skipped because it was
+   consumed before a checkpoint */
+static int read_record(pybgpstream_cache_t *cache,
+                       pybgpstream_detached_record_t **drecp)
+{
+  pybgpstream_detached_record_t *drec;
+  const cache_record_t *cr;
+  const cache_elem_t *ces;
+  const uint8_t *data;
+  const uint8_t *data_end;
+  uint64_t elems_size;
+  uint32_t i;
+  int skip = 0;
+
+  if (cache->off == cache->end) {
+    return 0;
+  }
+  if (cache->end - cache->off < sizeof(cache_record_t)) {
+    return -1;
+  }
+  cr = (const cache_record_t *)(cache->map + cache->off);
+  elems_size = (uint64_t)cr->elems_cnt * sizeof(cache_elem_t);
+  if (cr->size > cache->end - cache->off ||
+      sizeof(cache_record_t) + elems_size > cr->size) {
+    return -1;
+  }
+  ces = (const cache_elem_t *)(cr + 1);
+  data = (const uint8_t *)(ces + cr->elems_cnt);
+  data_end = cache->map + cache->off + cr->size;
+
+  if ((drec = calloc(1, sizeof(pybgpstream_detached_record_t))) == NULL) {
+    return -1;
+  }
+  drec->rec.type = cr->type;
+  drec->rec.dump_pos = cr->dump_pos;
+  drec->rec.status = cr->status;
+  drec->rec.time_sec = cr->time_sec;
+  drec->rec.time_usec = cr->time_usec;
+  drec->rec.dump_time_sec = cr->dump_time_sec;
+  addr_set(&drec->rec.router_ip, cr->router_ip_version, cr->router_ip);
+  if (get_name(cache, cr->project, drec->rec.project_name) != 0 ||
+      get_name(cache, cr->collector, drec->rec.collector_name) != 0 ||
+      get_name(cache, cr->router, drec->rec.router_name) != 0 ||
+      (cache->cp != NULL &&
+       (skip = pybgpstream_checkpoint_skip(cache->cp, &drec->rec)) < 0)) {
+    goto err;
+  }
+  if (skip) {
+    /* the elems of records consumed before a checkpoint are not decoded */
+    cache->off += cr->size;
+    pybgpstream_detached_record_destroy(drec);
+    return 2;
+  }
+
+  if (cr->elems_cnt > 0) {
+    if ((drec->elems = malloc(sizeof(bgpstream_elem_t) * cr->elems_cnt)) ==
+        NULL) {
+      goto err;
+    }
+    drec->elems_alloc = cr->elems_cnt;
+  }
+  for (i = 0; i < cr->elems_cnt; i++) {
+    if (data + ces[i].path_len +
+          (size_t)ces[i].communities_cnt * 2 * sizeof(uint16_t) >
+        data_end) {
+      goto err;
+    }
+    /* count the elem first so that a partial read is cleaned up */
+    memset(&drec->elems[i], 0, sizeof(bgpstream_elem_t));
+    drec->elems_cnt++;
+    if (read_elem(&drec->elems[i], &ces[i], data) != 0) {
+      goto err;
+    }
+    data += ces[i].path_len +
+            (size_t)ces[i].communities_cnt * 2 * sizeof(uint16_t);
+  }
+
+  cache->off += cr->size;
+  cache->records++;
+  pybgpstream_detached_record_filter(drec, cache->filter);
+  *drecp = drec;
+  return 1;
+
+err:
+  pybgpstream_detached_record_destroy(drec);
+  return -1;
+}
+
+/* ---------- writing ---------- */
+
+/* stop writing the cache file and remove it */
+static void abandon(pybgpstream_cache_t *cache)
+{
+  if (cache->fp != NULL) {
+    fclose(cache->fp);
+    cache->fp = NULL;
+    unlink(cache->tmp_path);
+  }
+}
+
+/* get the index of the given name (which is written as a uint16_t), adding
+   it if needed */
+static int get_name_idx(pybgpstream_cache_t *cache, const char *name)
+{
+  return pybgpstream_names_get_idx(&cache->wnames, name, UINT16_MAX + 1);
+}
+
+static int write_bytes(pybgpstream_cache_t *cache, const void *data,
+                       size_t len)
+{
+  if (len > 0 && fwrite(data, len, 1, cache->fp) != 1) {
+    return -1;
+  }
+  cache->size += len;
+  return 0;
+}
+
+static int write_record(pybgpstream_cache_t *cache,
+                        const pybgpstream_detached_record_t *drec)
+{
+  static const uint8_t zeros[8] = {0};
+  const bgpstream_elem_t *elem;
+  bgpstream_community_t *comm;
+  cache_record_t cr;
+  cache_elem_t ce;
+  uint8_t *path_data;
+  uint16_t path_len;
+  uint64_t size;
+  int project, collector, router;
+  int cnt;
+  int i, j;
+
+  if ((project = get_name_idx(cache, drec->rec.project_name)) < 0 ||
+      (collector = get_name_idx(cache, drec->rec.collector_name)) < 0 ||
+      (router = get_name_idx(cache, drec->rec.router_name)) < 0) {
+    return -1;
+  }
+
+  size = sizeof(cache_record_t) +
+         (uint64_t)drec->elems_cnt * sizeof(cache_elem_t);
+  for (i = 0; i < drec->elems_cnt; i++) {
+    elem = &drec->elems[i];
+    if (elem->as_path != NULL && elem->communities != NULL) {
+      size += bgpstream_as_path_get_data(elem->as_path, &path_data);
+      size += (uint64_t)bgpstream_community_set_size(elem->communities) * 2 *
+              sizeof(uint16_t);
+    }
+  }
+  size = (size + 3) & ~(uint64_t)3;
+  if (size > UINT32_MAX) {
+    return -1;
+  }
+
+  memset(&cr, 0, sizeof(cr));
+  cr.size = (uint32_t)size;
+  cr.elems_cnt = drec->elems_cnt;
+  cr.time_sec = drec->rec.time_sec;
+  cr.time_usec = drec->rec.time_usec;
+  cr.dump_time_sec = drec->rec.dump_time_sec;
+  cr.project = project;
+  cr.collector = collector;
+  cr.router = router;
+  cr.type = drec->rec.type;
+  cr.dump_pos = drec->rec.dump_pos;
+  cr.status = drec->rec.status;
+  cr.router_ip_version = addr_get(&drec->rec.router_ip, cr.router_ip);
+  if (write_bytes(cache, &cr, sizeof(cr)) != 0) {
+    return -1;
+  }
+
+  for (i = 0; i < drec->elems_cnt; i++) {
+    elem = &drec->elems[i];
+    memset(&ce, 0, sizeof(ce));
+    ce.orig_time_sec = elem->orig_time_sec;
+    ce.orig_time_usec = elem->orig_time_usec;
+    ce.peer_asn = elem->peer_asn;
+    ce.type = elem->type;
+    ce.old_state = elem->old_state;
+    ce.new_state = elem->new_state;
+    ce.prefix_len = elem->prefix.mask_len;
+    ce.peer_ip_version = addr_get(&elem->peer_ip, ce.peer_ip);
+    ce.prefix_version = addr_get(&elem->prefix.address, ce.prefix);
+    ce.nexthop_version = addr_get(&elem->nexthop, ce.nexthop);
+    if (elem->as_path != NULL && elem->communities != NULL) {
+      ce.has_attrs = 1;
+      ce.path_len = bgpstream_as_path_get_data(elem->as_path, &path_data);
+      if ((cnt = bgpstream_community_set_size(elem->communities)) >
+          UINT16_MAX) {
+        return -1;
+      }
+      ce.communities_cnt = cnt;
+    }
+    if (write_bytes(cache, &ce, sizeof(ce)) != 0) {
+      return -1;
+    }
+  }
+
+  for (i = 0; i < drec->elems_cnt; i++) {
+    elem = &drec->elems[i];
+    if (elem->as_path == NULL || elem->communities == NULL) {
+      continue;
+    }
+    path_len = bgpstream_as_path_get_data(elem->as_path, &path_data);
+    if (write_bytes(cache, path_data, path_len) != 0) {
+      return -1;
+    }
+    cnt = bgpstream_community_set_size(elem->communities);
+    for (j = 0; j < cnt; j++) {
+      comm = bgpstream_community_set_get(elem->communities, j);
+      if (write_bytes(cache, &comm->asn, sizeof(uint16_t)) != 0 ||
+          write_bytes(cache, &comm->value, sizeof(uint16_t)) != 0) {
+        return -1;
+      }
+    }
+  }
+
+  return write_bytes(cache, zeros, (size_t)(-cache->size & 3));
+}
+
+/* write the name table and the header, and move the file into place */
+static void commit(pybgpstream_cache_t *cache)
+{
+  cache_header_t hdr;
+  uint64_t names_off = cache->size;
+  uint32_t cnt = cache->wnames.cnt;
+  uint16_t len;
+  int ret;
+  int i;
+
+  if (write_bytes(cache, &cnt, sizeof(cnt)) != 0) {
+    goto err;
+  }
+  for (i = 0; i < cache->wnames.cnt; i++) {
+    len = (uint16_t)strlen(cache->wnames.names[i]);
+    if (write_bytes(cache, &len, sizeof(len)) != 0 ||
+        write_bytes(cache, cache->wnames.names[i], len) != 0) {
+      goto err;
+    }
+  }
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, CACHE_MAGIC, sizeof(hdr.magic));
+  hdr.version = CACHE_VERSION;
+  hdr.key_len = cache->key_len;
+  hdr.records_cnt = cache->records;
+  hdr.names_off = names_off;
+  hdr.size = cache->size;
+  if (fseek(cache->fp, 0, SEEK_SET) != 0 ||
+      fwrite(&hdr, sizeof(hdr), 1, cache->fp) != 1) {
+    goto err;
+  }
+
+  ret = fclose(cache->fp);
+  cache->fp = NULL;
+  if (ret != 0 || rename(cache->tmp_path, cache->path) != 0) {
+    unlink(cache->tmp_path);
+    return;
+  }
+  evict(cache->dir, cache->max_size);
+  return;
+
+err:
+  abandon(cache);
+}
+
+static void open_writer(pybgpstream_cache_t *cache)
+{
+  static const uint8_t zeros[8] = {0};
+  cache_header_t hdr;
+
+  if ((cache->fp = fopen(cache->tmp_path, "wb")) == NULL) {
+    return;
+  }
+  /* the header is only filled in once the file is complete */
+  memset(&hdr, 0, sizeof(hdr));
+  if (write_bytes(cache, &hdr, sizeof(hdr)) != 0 ||
+      write_bytes(cache, cache->key, cache->key_len) != 0 ||
+      write_bytes(cache, zeros, (size_t)(-cache->size & 7)) != 0) {
+    abandon(cache);
+  }
+}
+
+/* ---------- cache ---------- */
+
+pybgpstream_cache_t *pybgpstream_cache_open(const char *dir,
+                                            const pybgpstream_cache_key_t *key,
+                                            uint64_t max_size, bgpstream_t *bs,
+                                            pybgpstream_checkpoint_t *cp,
+                                            const pybgpstream_elemfilter_t
+                                              *filter)
+{
+  pybgpstream_cache_t *cache;
+  size_t path_len = strlen(dir) + 64;
+
+  if ((cache = calloc(1, sizeof(pybgpstream_cache_t))) == NULL) {
+    return NULL;
+  }
+  cache->max_size = max_size;
+  cache->bs = bs;
+  cache->cp = cp;
+  cache->filter = filter;
+  cache->key_len = key->len;
+  if ((cache->dir = strdup(dir)) == NULL ||
+      (cache->key = malloc(key->len + 1)) == NULL ||
+      (cache->path = malloc(path_len)) == NULL ||
+      (cache->tmp_path = malloc(path_len)) == NULL) {
+    pybgpstream_cache_destroy(cache);
+    return NULL;
+  }
+  memcpy(cache->key, key->data, key->len);
+  snprintf(cache->path, path_len, "%s/%016llx" CACHE_SUFFIX, dir,
+           (unsigned long long)pybgpstream_cache_key_hash(key));
+  snprintf(cache->tmp_path, path_len, "%s.tmp.%ld", cache->path,
+           (long)getpid());
+
+  if (open_reader(cache) == 0) {
+    /* mark the file as recently used */
+    cache->hit = 1;
+    utime(cache->path, NULL);
+  } else if (cp == NULL || !pybgpstream_checkpoint_is_resuming(cp)) {
+    /* the stream is read through anyway if the file cannot be written */
+    open_writer(cache);
+  }
+
+  return cache;
+}
+
+void pybgpstream_cache_destroy(pybgpstream_cache_t *cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+  abandon(cache);
+  if (cache->map != NULL) {
+    munmap(cache->map, cache->map_len);
+  }
+  free(cache->names);
+  pybgpstream_names_clear(&cache->wnames);
+  free(cache->dir);
+  free(cache->key);
+  free(cache->path);
+  free(cache->tmp_path);
+  free(cache);
+}
+
+int pybgpstream_cache_get_next(pybgpstream_cache_t *cache,
+                               pybgpstream_detached_record_t **drec)
+{
+  bgpstream_record_t *rec = NULL;
+  int ret;
+
+  if (cache->hit) {
+    while ((ret = read_record(cache, drec)) == 2)
+      ;
+    return ret;
+  }
+
+  if ((ret = pybgpstream_checkpoint_next_record(cache->cp, cache->bs,
+                                                &rec)) <= 0) {
+    if (ret < 0) {
+      abandon(cache);
+    } else if (cache->fp != NULL) {
+      commit(cache);
+    }
+    return ret;
+  }
+
+  /* records are written unfiltered (and only filtered once written) */
+  if ((*drec = pybgpstream_detached_record_create(
+         rec, (cache->fp != NULL) ? NULL : cache->filter)) == NULL) {
+    abandon(cache);
+    return -1;
+  }
+  if (cache->fp == NULL) {
+    return 1;
+  }
+  if (write_record(cache, *drec) != 0 ||
+      (cache->max_size != 0 && cache->size > cache->max_size)) {
+    abandon(cache);
+  } else {
+    cache->records++;
+  }
+  pybgpstream_detached_record_filter(*drec, cache->filter);
+  return 1;
+}
+
+int pybgpstream_cache_is_hit(const pybgpstream_cache_t *cache)
+{
+  return cache->hit;
+}
+
+void pybgpstream_cache_get_info(const pybgpstream_cache_t *cache,
+                                pybgpstream_cache_info_t *info)
+{
+  info->path = cache->path;
+  info->hit = cache->hit;
+  info->records = cache->records;
+  info->size = cache->hit ? cache->map_len : cache->size;
+}
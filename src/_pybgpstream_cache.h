@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_CACHE_H
+#define ___PYBGPSTREAM_CACHE_H
+
+#include "_pybgpstream_checkpoint.h"
+#include "_pybgpstream_detached.h"
+#include <bgpstream.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Identifies the data a stream reads: the data interface, its options
+ * (e.g. the dump files to read) and the libbgpstream filters, in the order
+ * they were set. Streams with equal keys read the same records.
+ */
+typedef struct pybgpstream_cache_key {
+
+  /** NUL-separated names and values */
+  char *data;
+
+  /** Number of bytes used */
+  size_t len;
+
+  /** Number of bytes allocated */
+  size_t alloc;
+
+  /** Set if the stream reads data that may change (e.g. live mode or
+      open-ended intervals), or if the key could not be built */
+  int uncacheable;
+
+} pybgpstream_cache_key_t;
+
+/** Add a configuration setting to a cache key
+ *
+ * @param key           pointer to the key
+ * @param name          name of the setting
+ * @param value         value of the setting
+ *
+ * The key is marked uncacheable if memory could not be allocated.
+ */
+void pybgpstream_cache_key_add(pybgpstream_cache_key_t *key, const char *name,
+                               const char *value);
+
+/** Free the memory used by the given key */
+void pybgpstream_cache_key_clear(pybgpstream_cache_key_t *key);
+
+/** Get a 64-bit hash of the given key */
+uint64_t pybgpstream_cache_key_hash(const pybgpstream_cache_key_t *key);
+
+/** Opaque handle for a decoded-elem cache */
+typedef struct pybgpstream_cache pybgpstream_cache_t;
+
+/** Information about a cache */
+typedef struct pybgpstream_cache_info {
+
+  /** Path of the cache file */
+  const char *path;
+
+  /** Whether records are read from the cache file (rather than being
+      written to it) */
+  int hit;
+
+  /** Number of records read from, or written to, the cache file */
+  uint64_t records;
+
+  /** Size of the cache file (or of the part written so far) */
+  uint64_t size;
+
+} pybgpstream_cache_info_t;
+
+/** Open the cache file of a stream
+ *
+ * @param dir           directory that cache files are kept in
+ * @param key           pointer to the key of the stream
+ * @param max_size      maximum total size of the cache files in dir (0 for
+ *                      no limit)
+ * @param bs            libbgpstream instance to read records from if the
+ *                      cache file does not exist yet
+ * @param cp            checkpoint tracker whose consumed records are
+ *                      skipped, or NULL
+ * @param filter        filter that elems must pass (or NULL)
+ * @return pointer to a new cache, or NULL if an error occurred
+ *
+ * If a complete cache file exists for the key, records are read from it
+ * (through mmap) and bs must not be started. Otherwise bs must be started,
+ * and the records read from it are written to a new cache file as they are
+ * returned. The file is only kept if the end of the stream is reached, at
+ * which point the least recently used cache files are removed until the
+ * total size of the files in dir is at most max_size. Files are always
+ * written unfiltered, so streams with the same key but different elem
+ * filters share them. No cache file is written when resuming from a
+ * checkpoint, since the stream is then incomplete.
+ *
+ * None of these functions touch the Python API.
+ */
+pybgpstream_cache_t *pybgpstream_cache_open(const char *dir,
+                                            const pybgpstream_cache_key_t *key,
+                                            uint64_t max_size, bgpstream_t *bs,
+                                            pybgpstream_checkpoint_t *cp,
+                                            const pybgpstream_elemfilter_t
+                                              *filter);
+
+/** Destroy the given cache (discarding any incomplete cache file) */
+void pybgpstream_cache_destroy(pybgpstream_cache_t *cache);
+
+/** Get the next record through the given cache
+ *
+ * @param cache         pointer to the cache
+ * @param[out] drec     set to point to the next record (owned by the caller
+ *                      from then on)
+ * @return 1 if a record was returned, 0 if the end of the stream was
+ *         reached, -1 if an error occurred
+ *
+ * Like the records of a prefetcher, the records are detached and only hold
+ * the elems that passed the filter.
+ */
+int pybgpstream_cache_get_next(pybgpstream_cache_t *cache,
+                               pybgpstream_detached_record_t **drec);
+
+/** Check whether records are read from the cache file */
+int pybgpstream_cache_is_hit(const pybgpstream_cache_t *cache);
+
+/** Get information about the given cache */
+void pybgpstream_cache_get_info(const pybgpstream_cache_t *cache,
+                                pybgpstream_cache_info_t *info);
+
+#endif /* ___PYBGPSTREAM_CACHE_H */
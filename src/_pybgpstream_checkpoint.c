@@ -0,0 +1,440 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_checkpoint.h"
+#include "_pybgpstream_u64set.h"
+#include "_pybgpstream_utils.h"
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOKEN_MAGIC "pybgpstream-checkpoint"
+#define TOKEN_VERSION 2
+
+/* maximum length of a field of a dump line (escaped names take up to 3
+   characters per byte) */
+#define FIELD_LEN (BGPSTREAM_UTILS_STR_NAME_LEN * 3)
+
+/* project indexes are packed into 15 bits of dump keys */
+#define MAX_NAMES 0x8000
+
+/** Number of records of each dump */
+typedef struct {
+
+  /** Distinct project and collector names */
+  pybgpstream_names_t names;
+
+  /** Keys of the dumps: dump time, collector, project and record type */
+  pybgpstream_u64set_t dumps;
+
+  /** Number of records of each dump (parallel to the keys) */
+  uint64_t *counts;
+  size_t counts_alloc;
+
+} dump_table_t;
+
+struct pybgpstream_checkpoint {
+
+  /* reading side */
+
+  /** Number of records left to skip in each dump */
+  dump_table_t skip;
+
+  /** Whether a token was loaded */
+  int resuming;
+
+  /* consuming side */
+
+  /** Number of records consumed from each dump */
+  dump_table_t consumed;
+
+  /** Dumps of the records handed out but not consumed yet */
+  uint32_t *pending;
+  int pending_cnt;
+  int pending_alloc;
+
+  /** Set if a record could not be tracked */
+  int failed;
+};
+
+/* ---------- dump tables ---------- */
+
+static void table_clear(dump_table_t *t)
+{
+  pybgpstream_names_clear(&t->names);
+  pybgpstream_u64set_clear(&t->dumps);
+  free(t->counts);
+}
+
+/* get the index of the given dump, adding it (with a count of 0) if
+   needed */
+static int table_get(dump_table_t *t, const char *project,
+                     const char *collector, int type, uint32_t dump_time,
+                     uint32_t *idx)
+{
+  int project_idx, collector_idx;
+  uint64_t *tmp;
+  size_t new_alloc;
+  uint64_t key;
+  int ret;
+
+  if ((project_idx =
+         pybgpstream_names_get_idx(&t->names, project, MAX_NAMES)) < 0 ||
+      (collector_idx =
+         pybgpstream_names_get_idx(&t->names, collector, MAX_NAMES)) < 0) {
+    return -1;
+  }
+  key = ((uint64_t)dump_time << 32) | ((uint64_t)collector_idx << 16) |
+        ((uint64_t)project_idx << 1) | (type != 0);
+  if ((ret = pybgpstream_u64set_add(&t->dumps, key, idx)) <= 0) {
+    return ret;
+  }
+
+  if (*idx >= t->counts_alloc) {
+    new_alloc = (t->counts_alloc == 0) ? 64 : t->counts_alloc * 2;
+    if ((tmp = realloc(t->counts, sizeof(uint64_t) * new_alloc)) == NULL) {
+      return -1;
+    }
+    t->counts = tmp;
+    t->counts_alloc = new_alloc;
+  }
+  t->counts[*idx] = 0;
+  return 0;
+}
+
+static int table_get_rec(dump_table_t *t, const bgpstream_record_t *rec,
+                         uint32_t *idx)
+{
+  return table_get(t, rec->project_name, rec->collector_name,
+                   rec->type == BGPSTREAM_RIB, rec->dump_time_sec, idx);
+}
+
+/* ---------- tokens ---------- */
+
+typedef struct {
+  char *data;
+  size_t len;
+  size_t alloc;
+  int failed;
+} strbuf_t;
+
+static void strbuf_printf(strbuf_t *buf, const char *fmt, ...)
+{
+  va_list ap;
+  size_t new_alloc;
+  char *tmp;
+  int ret;
+
+  while (!buf->failed) {
+    va_start(ap, fmt);
+    ret = vsnprintf(buf->data + buf->len, buf->alloc - buf->len, fmt, ap);
+    va_end(ap);
+    if (ret < 0) {
+      buf->failed = 1;
+    } else if ((size_t)ret < buf->alloc - buf->len) {
+      buf->len += ret;
+      return;
+    } else {
+      new_alloc = (buf->alloc == 0) ? 256 : buf->alloc;
+      while (new_alloc < buf->len + ret + 1) {
+        new_alloc *= 2;
+      }
+      if ((tmp = realloc(buf->data, new_alloc)) == NULL) {
+        buf->failed = 1;
+      } else {
+        buf->data = tmp;
+        buf->alloc = new_alloc;
+      }
+    }
+  }
+}
+
+/* names are written with whitespace, '%' and non-ASCII bytes escaped as
+   %XX, and the empty name as a lone '%' */
+static void strbuf_put_name(strbuf_t *buf, const char *name)
+{
+  const unsigned char *p;
+
+  if (*name == '\0') {
+    strbuf_printf(buf, "%%");
+    return;
+  }
+  for (p = (const unsigned char *)name; *p != '\0'; p++) {
+    if (*p <= 0x20 || *p == '%' || *p >= 0x7f) {
+      strbuf_printf(buf, "%%%02X", *p);
+    } else {
+      strbuf_printf(buf, "%c", *p);
+    }
+  }
+}
+
+static int parse_name(const char *str, char *name, size_t name_len)
+{
+  size_t len = 0;
+  unsigned int c;
+
+  if (strcmp(str, "%") == 0) {
+    *name = '\0';
+    return 0;
+  }
+  while (*str != '\0') {
+    if (len + 1 >= name_len) {
+      return -1;
+    }
+    if (*str == '%') {
+      if (sscanf(str + 1, "%2x", &c) != 1 || str[1] == '\0' ||
+          str[2] == '\0') {
+        return -1;
+      }
+      name[len++] = (char)c;
+      str += 3;
+    } else {
+      name[len++] = *str++;
+    }
+  }
+  name[len] = '\0';
+  return 0;
+}
+
+/* ---------- tracker ---------- */
+
+pybgpstream_checkpoint_t *pybgpstream_checkpoint_create(void)
+{
+  pybgpstream_checkpoint_t *cp;
+
+  if ((cp = calloc(1, sizeof(pybgpstream_checkpoint_t))) == NULL) {
+    return NULL;
+  }
+  pybgpstream_u64set_init(&cp->skip.dumps);
+  pybgpstream_u64set_init(&cp->consumed.dumps);
+  return cp;
+}
+
+void pybgpstream_checkpoint_destroy(pybgpstream_checkpoint_t *cp)
+{
+  if (cp == NULL) {
+    return;
+  }
+  table_clear(&cp->skip);
+  table_clear(&cp->consumed);
+  free(cp->pending);
+  free(cp);
+}
+
+int pybgpstream_checkpoint_resume(pybgpstream_checkpoint_t *cp,
+                                  const char *token, uint64_t key_hash,
+                                  char *err, size_t err_len)
+{
+  char project[BGPSTREAM_UTILS_STR_NAME_LEN];
+  char collector[BGPSTREAM_UTILS_STR_NAME_LEN];
+  char buf[FIELD_LEN + 1];
+  char fields[5][FIELD_LEN + 1];
+  char fmt[64];
+  char magic[32];
+  unsigned long long hash, count;
+  unsigned int version, dump_time;
+  const char *line;
+  const char *end;
+  uint32_t idx;
+  int type;
+  int line_no = 1;
+  int n;
+
+  if (sscanf(token, "%31s %u %llx%n", magic, &version, &hash, &n) != 3 ||
+      strcmp(magic, TOKEN_MAGIC) != 0 || version != TOKEN_VERSION) {
+    snprintf(err, err_len, "not a checkpoint token");
+    return -1;
+  }
+  if (hash != key_hash) {
+    snprintf(err, err_len,
+             "the token was created by a stream with a different "
+             "configuration");
+    return -1;
+  }
+
+  snprintf(fmt, sizeof(fmt), "%%%ds %%%ds %%%ds %%%ds %%%ds", FIELD_LEN,
+           FIELD_LEN, FIELD_LEN, FIELD_LEN, FIELD_LEN);
+  for (line = token + n; *line != '\0'; line = end) {
+    while (*line == '\n') {
+      line++;
+    }
+    if (*line == '\0') {
+      break;
+    }
+    line_no++;
+    if ((end = strchr(line, '\n')) == NULL) {
+      end = line + strlen(line);
+    }
+    if ((size_t)(end - line) >= sizeof(buf)) {
+      snprintf(err, err_len, "invalid dump on line %d", line_no);
+      return -1;
+    }
+    memcpy(buf, line, end - line);
+    buf[end - line] = '\0';
+    if (sscanf(buf, fmt, fields[0], fields[1], fields[2], fields[3],
+               fields[4]) != 5 ||
+        parse_name(fields[0], project, sizeof(project)) != 0 ||
+        parse_name(fields[1], collector, sizeof(collector)) != 0 ||
+        sscanf(fields[3], "%u", &dump_time) != 1 ||
+        sscanf(fields[4], "%llu", &count) != 1) {
+      snprintf(err, err_len, "invalid dump on line %d", line_no);
+      return -1;
+    }
+    if (strcmp(fields[2], "update") == 0) {
+      type = 0;
+    } else if (strcmp(fields[2], "rib") == 0) {
+      type = 1;
+    } else {
+      snprintf(err, err_len, "invalid record type on line %d", line_no);
+      return -1;
+    }
+
+    if (table_get(&cp->skip, project, collector, type, dump_time, &idx) !=
+          0 ||
+        table_get(&cp->consumed, project, collector, type, dump_time,
+                  &idx) != 0) {
+      snprintf(err, err_len, "out of memory");
+      return -1;
+    }
+    cp->skip.counts[idx] = count;
+    cp->consumed.counts[idx] = count;
+  }
+
+  cp->resuming = 1;
+  return 0;
+}
+
+int pybgpstream_checkpoint_is_resuming(const pybgpstream_checkpoint_t *cp)
+{
+  return cp->resuming;
+}
+
+int pybgpstream_checkpoint_skip(pybgpstream_checkpoint_t *cp,
+                                const bgpstream_record_t *rec)
+{
+  uint32_t idx;
+
+  if (!cp->resuming) {
+    return 0;
+  }
+  if (table_get_rec(&cp->skip, rec, &idx) != 0) {
+    return -1;
+  }
+  if (cp->skip.counts[idx] == 0) {
+    return 0;
+  }
+  cp->skip.counts[idx]--;
+  return 1;
+}
+
+int pybgpstream_checkpoint_next_record(pybgpstream_checkpoint_t *cp,
+                                       bgpstream_t *bs,
+                                       bgpstream_record_t **rec)
+{
+  int ret;
+  int skip;
+
+  while ((ret = bgpstream_get_next_record(bs, rec)) > 0) {
+    if (cp == NULL || (skip = pybgpstream_checkpoint_skip(cp, *rec)) == 0) {
+      return ret;
+    }
+    if (skip < 0) {
+      return -1;
+    }
+  }
+  return ret;
+}
+
+void pybgpstream_checkpoint_add(pybgpstream_checkpoint_t *cp,
+                                const bgpstream_record_t *rec)
+{
+  uint32_t *tmp;
+  uint32_t idx;
+
+  if (cp->failed) {
+    return;
+  }
+  if (table_get_rec(&cp->consumed, rec, &idx) != 0) {
+    cp->failed = 1;
+    return;
+  }
+  if (cp->pending_cnt == cp->pending_alloc) {
+    cp->pending_alloc = (cp->pending_alloc == 0) ? 16 : cp->pending_alloc * 2;
+    if ((tmp = realloc(cp->pending, sizeof(uint32_t) * cp->pending_alloc)) ==
+        NULL) {
+      cp->failed = 1;
+      return;
+    }
+    cp->pending = tmp;
+  }
+  cp->pending[cp->pending_cnt++] = idx;
+}
+
+void pybgpstream_checkpoint_commit(pybgpstream_checkpoint_t *cp)
+{
+  int i;
+
+  for (i = 0; i < cp->pending_cnt; i++) {
+    cp->consumed.counts[cp->pending[i]]++;
+  }
+  cp->pending_cnt = 0;
+}
+
+char *pybgpstream_checkpoint_get_token(pybgpstream_checkpoint_t *cp,
+                                       uint64_t key_hash)
+{
+  dump_table_t *t = &cp->consumed;
+  strbuf_t buf;
+  uint64_t key;
+  size_t i;
+
+  if (cp->failed) {
+    return NULL;
+  }
+
+  memset(&buf, 0, sizeof(buf));
+  strbuf_printf(&buf, "%s %d %016" PRIx64 "\n", TOKEN_MAGIC, TOKEN_VERSION,
+                key_hash);
+  for (i = 0; i < t->dumps.cnt; i++) {
+    if (t->counts[i] == 0) {
+      continue;
+    }
+    key = t->dumps.keys[i];
+    strbuf_put_name(&buf, t->names.names[(key >> 1) & (MAX_NAMES - 1)]);
+    strbuf_printf(&buf, " ");
+    strbuf_put_name(&buf, t->names.names[(key >> 16) & 0xffff]);
+    strbuf_printf(&buf, " %s %" PRIu32 " %" PRIu64 "\n",
+                  (key & 1) ? "rib" : "update", (uint32_t)(key >> 32),
+                  t->counts[i]);
+  }
+  if (buf.failed) {
+    free(buf.data);
+    return NULL;
+  }
+  return buf.data;
+}
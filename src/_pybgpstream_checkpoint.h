@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_CHECKPOINT_H
+#define ___PYBGPSTREAM_CHECKPOINT_H
+
+#include <bgpstream.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Tracks the records of a stream that have been consumed, and skips the
+ * records that an earlier run of the same stream consumed when it is
+ * resumed.
+ *
+ * Records are identified by their dump (project, collector, record type and
+ * dump time) and their position in it, so a checkpoint holds the number of
+ * records consumed from each dump. The reading side (skip and next_record)
+ * and the consuming side (add, commit and get_token) keep separate state,
+ * so they can be used from different threads (e.g. a prefetch thread and
+ * the Python thread), as long as each side is only used by one thread at a
+ * time. None of these functions touch the Python API.
+ */
+typedef struct pybgpstream_checkpoint pybgpstream_checkpoint_t;
+
+/** Create a checkpoint tracker for a stream that starts at the beginning
+ *
+ * @return pointer to a new tracker, or NULL if an error occurred
+ */
+pybgpstream_checkpoint_t *pybgpstream_checkpoint_create(void);
+
+/** Destroy the given tracker */
+void pybgpstream_checkpoint_destroy(pybgpstream_checkpoint_t *cp);
+
+/** Resume from the given checkpoint token
+ *
+ * @param cp            pointer to the tracker (that must not have been used
+ *                      yet)
+ * @param token         token returned by pybgpstream_checkpoint_get_token
+ * @param key_hash      hash of the configuration of the stream, which must
+ *                      match the one the token was created with
+ * @param err           buffer to write an error message to
+ * @param err_len       size of the err buffer
+ * @return 0 if the token was loaded, -1 if it is invalid
+ */
+int pybgpstream_checkpoint_resume(pybgpstream_checkpoint_t *cp,
+                                  const char *token, uint64_t key_hash,
+                                  char *err, size_t err_len);
+
+/** Check whether the given tracker was resumed from a token */
+int pybgpstream_checkpoint_is_resuming(const pybgpstream_checkpoint_t *cp);
+
+/** Check whether a record read from the stream was already consumed
+ *
+ * @param cp            pointer to the tracker
+ * @param rec           pointer to the record (read in stream order)
+ * @return 1 if the record should be skipped, 0 if it should be returned,
+ *         -1 if an error occurred
+ */
+int pybgpstream_checkpoint_skip(pybgpstream_checkpoint_t *cp,
+                                const bgpstream_record_t *rec);
+
+/** Get the next record from libbgpstream that was not already consumed
+ *
+ * @param cp            pointer to the tracker (NULL to skip nothing)
+ * @param bs            pointer to the libbgpstream instance
+ * @param[out] rec      set to point to the next record
+ * @return same as bgpstream_get_next_record
+ *
+ * The elems of skipped records are never decoded.
+ */
+int pybgpstream_checkpoint_next_record(pybgpstream_checkpoint_t *cp,
+                                       bgpstream_t *bs,
+                                       bgpstream_record_t **rec);
+
+/** Note that a record was handed out to the consumer
+ *
+ * @param cp            pointer to the tracker
+ * @param rec           pointer to the record
+ *
+ * The record only counts as consumed once pybgpstream_checkpoint_commit is
+ * called (i.e. when the consumer asks for more records).
+ */
+void pybgpstream_checkpoint_add(pybgpstream_checkpoint_t *cp,
+                                const bgpstream_record_t *rec);
+
+/** Mark all records handed out so far as consumed */
+void pybgpstream_checkpoint_commit(pybgpstream_checkpoint_t *cp);
+
+/** Get a token that captures the records consumed so far
+ *
+ * @param cp            pointer to the tracker
+ * @param key_hash      hash of the configuration of the stream
+ * @return a new string (to be freed with free), or NULL if an error
+ *         occurred (including earlier allocation failures while tracking)
+ */
+char *pybgpstream_checkpoint_get_token(pybgpstream_checkpoint_t *cp,
+                                       uint64_t key_hash);
+
+#endif /* ___PYBGPSTREAM_CHECKPOINT_H */
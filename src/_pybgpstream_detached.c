@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_detached.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Deep copy an elem. The as path and community set are only copied for the
+   elem types that carry them. */
+static int elem_copy(bgpstream_elem_t *dst, bgpstream_elem_t *src)
+{
+  *dst = *src;
+  dst->as_path = NULL;
+  dst->communities = NULL;
+
+  if (src->type != BGPSTREAM_ELEM_TYPE_RIB &&
+      src->type != BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT) {
+    return 0;
+  }
+
+  if (src->as_path != NULL) {
+    if ((dst->as_path = bgpstream_as_path_create()) == NULL ||
+        bgpstream_as_path_copy(dst->as_path, src->as_path) != 0) {
+      return -1;
+    }
+  }
+
+  if (src->communities != NULL) {
+    if ((dst->communities = bgpstream_community_set_create()) == NULL ||
+        bgpstream_community_set_copy(dst->communities, src->communities) !=
+          0) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static void elem_clear(bgpstream_elem_t *elem)
+{
+  if (elem->as_path != NULL) {
+    bgpstream_as_path_destroy(elem->as_path);
+    elem->as_path = NULL;
+  }
+  if (elem->communities != NULL) {
+    bgpstream_community_set_destroy(elem->communities);
+    elem->communities = NULL;
+  }
+}
+
+pybgpstream_detached_record_t *
+pybgpstream_detached_record_create(bgpstream_record_t *rec,
+                                   const pybgpstream_elemfilter_t *filter)
+{
+  pybgpstream_detached_record_t *drec;
+  bgpstream_elem_t *elem = NULL;
+  bgpstream_elem_t *tmp;
+  int ret;
+
+  if ((drec = malloc(sizeof(pybgpstream_detached_record_t))) == NULL) {
+    return NULL;
+  }
+  drec->rec = *rec;
+  drec->elems = NULL;
+  drec->elems_cnt = 0;
+  drec->elems_alloc = 0;
+  drec->next_elem = 0;
+
+  while ((ret = bgpstream_record_get_next_elem(rec, &elem)) > 0) {
+    if (!pybgpstream_elemfilter_match(filter, elem)) {
+      continue;
+    }
+    if (drec->elems_cnt == drec->elems_alloc) {
+      drec->elems_alloc = (drec->elems_alloc == 0) ? 8 : drec->elems_alloc * 2;
+      if ((tmp = realloc(drec->elems, sizeof(bgpstream_elem_t) *
+                                        drec->elems_alloc)) == NULL) {
+        goto err;
+      }
+      drec->elems = tmp;
+    }
+    if (elem_copy(&drec->elems[drec->elems_cnt], elem) != 0) {
+      /* clean up the partial copy */
+      elem_clear(&drec->elems[drec->elems_cnt]);
+      goto err;
+    }
+    drec->elems_cnt++;
+  }
+  if (ret < 0) {
+    goto err;
+  }
+
+  return drec;
+
+err:
+  pybgpstream_detached_record_destroy(drec);
+  return NULL;
+}
+
+void pybgpstream_detached_record_filter(pybgpstream_detached_record_t *drec,
+                                        const pybgpstream_elemfilter_t *filter)
+{
+  int cnt = 0;
+  int i;
+
+  if (filter == NULL) {
+    return;
+  }
+  for (i = 0; i < drec->elems_cnt; i++) {
+    if (pybgpstream_elemfilter_match(filter, &drec->elems[i])) {
+      drec->elems[cnt++] = drec->elems[i];
+    } else {
+      elem_clear(&drec->elems[i]);
+    }
+  }
+  drec->elems_cnt = cnt;
+}
+
+void pybgpstream_detached_record_destroy(pybgpstream_detached_record_t *drec)
+{
+  int i;
+  if (drec == NULL) {
+    return;
+  }
+  for (i = 0; i < drec->elems_cnt; i++) {
+    elem_clear(&drec->elems[i]);
+  }
+  free(drec->elems);
+  free(drec);
+}
+
+int pybgpstream_detached_record_get_next_elem(
+  pybgpstream_detached_record_t *drec, bgpstream_elem_t **elem)
+{
+  if (drec->next_elem >= drec->elems_cnt) {
+    return 0;
+  }
+  *elem = &drec->elems[drec->next_elem++];
+  return 1;
+}
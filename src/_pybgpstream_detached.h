@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_DETACHED_H
+#define ___PYBGPSTREAM_DETACHED_H
+
+#include "_pybgpstream_elemfilter.h"
+#include <bgpstream.h>
+
+/** A snapshot of a record and all of its elems that no longer depends on
+ * the stream that produced it.
+ *
+ * libbgpstream re-uses the same record (and elem) structure for every call to
+ * bgpstream_get_next_record, so anything that wants to hold on to more than
+ * one record at a time must take a copy. None of these functions touch the
+ * Python API, so they are safe to call with the GIL released.
+ */
+typedef struct pybgpstream_detached_record {
+
+  /** Copy of the record metadata (only the public fields are valid) */
+  bgpstream_record_t rec;
+
+  /** Deep copies of the elems of the record */
+  bgpstream_elem_t *elems;
+
+  /** Number of elems in the elems array */
+  int elems_cnt;
+
+  /** Number of elems allocated in the elems array */
+  int elems_alloc;
+
+  /** Index of the next elem to be returned */
+  int next_elem;
+
+} pybgpstream_detached_record_t;
+
+/** Create a detached copy of the given record
+ *
+ * @param rec           pointer to the record to copy
+ * @param filter        filter that elems must pass to be copied (NULL to
+ *                      copy all elems)
+ * @return pointer to a new detached record, or NULL if an error occurred
+ *
+ * All remaining elems of the record are decoded (and so consumed) by this
+ * function.
+ */
+pybgpstream_detached_record_t *
+pybgpstream_detached_record_create(bgpstream_record_t *rec,
+                                   const pybgpstream_elemfilter_t *filter);
+
+/** Remove the elems of a detached record that do not pass a filter
+ *
+ * @param drec          pointer to the detached record
+ * @param filter        filter that elems must pass to be kept (NULL to keep
+ *                      all elems)
+ */
+void pybgpstream_detached_record_filter(pybgpstream_detached_record_t *drec,
+                                        const pybgpstream_elemfilter_t *filter);
+
+/** Destroy the given detached record and all of its elems */
+void pybgpstream_detached_record_destroy(pybgpstream_detached_record_t *drec);
+
+/** Get the next elem from the given detached record
+ *
+ * @param drec          pointer to the detached record
+ * @param[out] elem     set to point to the next elem
+ * @return 1 if an elem was returned, 0 if there are no more elems
+ */
+int pybgpstream_detached_record_get_next_elem(
+  pybgpstream_detached_record_t *drec, bgpstream_elem_t **elem);
+
+#endif /* ___PYBGPSTREAM_DETACHED_H */
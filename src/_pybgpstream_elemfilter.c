@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_elemfilter.h"
+#include <stdlib.h>
+
+int pybgpstream_elemfilter_add_pred(pybgpstream_elemfilter_t *filter,
+                                    pybgpstream_pred_t *pred)
+{
+  pybgpstream_pred_t **tmp;
+
+  if ((tmp = realloc(filter->preds, sizeof(pybgpstream_pred_t *) *
+                                      (filter->preds_cnt + 1))) == NULL) {
+    pybgpstream_pred_destroy(pred);
+    return -1;
+  }
+  filter->preds = tmp;
+  filter->preds[filter->preds_cnt++] = pred;
+  return 0;
+}
+
+int pybgpstream_elemfilter_is_empty(const pybgpstream_elemfilter_t *filter)
+{
+  return filter->pfxtrie == NULL && filter->preds_cnt == 0;
+}
+
+int pybgpstream_elemfilter_match(const pybgpstream_elemfilter_t *filter,
+                                 const bgpstream_elem_t *elem)
+{
+  int i;
+
+  if (filter == NULL) {
+    return 1;
+  }
+  if (filter->pfxtrie != NULL) {
+    /* elems without a prefix never match a prefix set */
+    if ((elem->type != BGPSTREAM_ELEM_TYPE_RIB &&
+         elem->type != BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT &&
+         elem->type != BGPSTREAM_ELEM_TYPE_WITHDRAWAL) ||
+        !pybgpstream_pfxtrie_match(filter->pfxtrie, &elem->prefix)) {
+      return 0;
+    }
+  }
+  for (i = 0; i < filter->preds_cnt; i++) {
+    if (!pybgpstream_pred_eval(filter->preds[i], elem)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void pybgpstream_elemfilter_clear(pybgpstream_elemfilter_t *filter)
+{
+  int i;
+
+  for (i = 0; i < filter->preds_cnt; i++) {
+    pybgpstream_pred_destroy(filter->preds[i]);
+  }
+  free(filter->preds);
+  filter->preds = NULL;
+  filter->preds_cnt = 0;
+}
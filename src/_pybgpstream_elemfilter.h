@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_ELEMFILTER_H
+#define ___PYBGPSTREAM_ELEMFILTER_H
+
+#include "_pybgpstream_pfxtrie.h"
+#include "_pybgpstream_pred.h"
+#include <bgpstream.h>
+
+/** Filters applied to elems as they are read from libbgpstream, before any
+ * Python object is created for them. An elem is kept if it passes all of
+ * them.
+ *
+ * None of these functions touch the Python API.
+ */
+typedef struct pybgpstream_elemfilter {
+
+  /** Prefix trie that elem prefixes must match (or NULL) */
+  const pybgpstream_pfxtrie_t *pfxtrie;
+
+  /** Compiled predicates that elems must all match */
+  pybgpstream_pred_t **preds;
+  int preds_cnt;
+
+} pybgpstream_elemfilter_t;
+
+/** Add a predicate to the given filter
+ *
+ * @param filter        pointer to the filter
+ * @param pred          pointer to the predicate (owned by the filter from
+ *                      then on, even if an error occurred)
+ * @return 0 if the predicate was added, -1 if an error occurred
+ */
+int pybgpstream_elemfilter_add_pred(pybgpstream_elemfilter_t *filter,
+                                    pybgpstream_pred_t *pred);
+
+/** Check whether the given filter is empty (keeps all elems) */
+int pybgpstream_elemfilter_is_empty(const pybgpstream_elemfilter_t *filter);
+
+/** Check whether an elem passes the given filter
+ *
+ * @param filter        pointer to the filter (NULL to let all elems pass)
+ * @param elem          elem to check
+ * @return 1 if the elem passes, 0 if it is filtered out
+ */
+int pybgpstream_elemfilter_match(const pybgpstream_elemfilter_t *filter,
+                                 const bgpstream_elem_t *elem);
+
+/** Free the predicates of the given filter (the trie is not owned by it) */
+void pybgpstream_elemfilter_clear(pybgpstream_elemfilter_t *filter);
+
+#endif /* ___PYBGPSTREAM_ELEMFILTER_H */
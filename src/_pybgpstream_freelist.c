@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_freelist.h"
+#include <Python.h>
+#include <stdlib.h>
+#include <string.h>
+
+PyObject *pybgpstream_freelist_alloc(pybgpstream_freelist_t *fl)
+{
+  PyObject *obj;
+
+  PYBGPSTREAM_MUTEX_LOCK(&fl->mutex);
+  if (fl->cnt == 0) {
+    fl->misses++;
+    PYBGPSTREAM_MUTEX_UNLOCK(&fl->mutex);
+    return fl->type->tp_alloc(fl->type, 0);
+  }
+  fl->hits++;
+  obj = fl->objs[--fl->cnt];
+  PYBGPSTREAM_MUTEX_UNLOCK(&fl->mutex);
+
+  /* tp_alloc hands out zeroed objects, so do the same */
+  memset((char *)obj + sizeof(PyObject), 0,
+         fl->type->tp_basicsize - sizeof(PyObject));
+  (void)PyObject_INIT(obj, fl->type);
+  return obj;
+}
+
+void pybgpstream_freelist_free(pybgpstream_freelist_t *fl, PyObject *obj)
+{
+  PYBGPSTREAM_MUTEX_LOCK(&fl->mutex);
+  if (Py_TYPE(obj) == fl->type && fl->cnt < fl->max) {
+    /* the array is only allocated once something is released */
+    if (fl->objs != NULL ||
+        (fl->objs = malloc(sizeof(PyObject *) * fl->max)) != NULL) {
+      fl->objs[fl->cnt++] = obj;
+      PYBGPSTREAM_MUTEX_UNLOCK(&fl->mutex);
+      return;
+    }
+  }
+  PYBGPSTREAM_MUTEX_UNLOCK(&fl->mutex);
+  Py_TYPE(obj)->tp_free(obj);
+}
+
+int pybgpstream_freelist_set_size(pybgpstream_freelist_t *fl, int max)
+{
+  PyObject **objs;
+  int ret = 0;
+
+  if (max < 0) {
+    return -1;
+  }
+
+  PYBGPSTREAM_MUTEX_LOCK(&fl->mutex);
+  while (fl->cnt > max) {
+    fl->type->tp_free(fl->objs[--fl->cnt]);
+  }
+
+  if (max == 0) {
+    free(fl->objs);
+    fl->objs = NULL;
+  } else if ((objs = realloc(fl->objs, sizeof(PyObject *) * max)) == NULL) {
+    ret = -1;
+  } else {
+    fl->objs = objs;
+  }
+  if (ret == 0) {
+    fl->max = max;
+  }
+  PYBGPSTREAM_MUTEX_UNLOCK(&fl->mutex);
+
+  return ret;
+}
+
+void pybgpstream_freelist_clear(pybgpstream_freelist_t *fl)
+{
+  PYBGPSTREAM_MUTEX_LOCK(&fl->mutex);
+  while (fl->cnt > 0) {
+    fl->type->tp_free(fl->objs[--fl->cnt]);
+  }
+  free(fl->objs);
+  fl->objs = NULL;
+  PYBGPSTREAM_MUTEX_UNLOCK(&fl->mutex);
+}
+
+PyObject *pybgpstream_freelist_get_stats(pybgpstream_freelist_t *fl)
+{
+  int cnt, max;
+  unsigned long long hits, misses;
+
+  PYBGPSTREAM_MUTEX_LOCK(&fl->mutex);
+  cnt = fl->cnt;
+  max = fl->max;
+  hits = fl->hits;
+  misses = fl->misses;
+  PYBGPSTREAM_MUTEX_UNLOCK(&fl->mutex);
+
+  return Py_BuildValue("{s:i,s:i,s:K,s:K}", "size", cnt, "max_size", max,
+                       "hits", hits, "misses", misses);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_FREELIST_H
+#define ___PYBGPSTREAM_FREELIST_H
+
+#include "pyutils.h"
+#include <Python.h>
+#include <stdint.h>
+
+/** Default maximum number of objects kept in a free list
+ *
+ * Free-threaded builds allocate from per-thread heaps, which a free list
+ * shared by all threads (and its lock) would only slow down, so they do
+ * not keep objects unless asked to.
+ */
+#ifdef Py_GIL_DISABLED
+#define PYBGPSTREAM_FREELIST_DEFAULT_SIZE 0
+#else
+#define PYBGPSTREAM_FREELIST_DEFAULT_SIZE 256
+#endif
+
+/** A bounded free list of objects of a single type
+ *
+ * Elems and records are created and destroyed at a very high rate (usually
+ * one elem object is alive at a time), so rather than going back to the
+ * allocator each time, deallocated objects are kept here and handed out
+ * again by the next allocation. This works like the free lists CPython keeps
+ * for floats and tuples.
+ */
+typedef struct pybgpstream_freelist {
+
+  /** Type of the objects in this free list */
+  PyTypeObject *type;
+
+  /** Objects available for re-use */
+  PyObject **objs;
+
+  /** Number of objects in objs */
+  int cnt;
+
+  /** Maximum number of objects kept (0 disables the free list) */
+  int max;
+
+  /** Number of allocations served from the free list */
+  uint64_t hits;
+
+  /** Number of allocations that had to use tp_alloc */
+  uint64_t misses;
+
+  /** Protects all of the fields above (on free-threaded builds) */
+  PYBGPSTREAM_MUTEX mutex;
+
+} pybgpstream_freelist_t;
+
+/** Static initializer for a free list of objects of the given type */
+#define PYBGPSTREAM_FREELIST_INIT(type)                                        \
+  { (type), NULL, 0, PYBGPSTREAM_FREELIST_DEFAULT_SIZE, 0, 0 }
+
+/** Allocate an object from the given free list
+ *
+ * @param fl            pointer to the free list
+ * @return new (zeroed) object of the type of the free list, or NULL if an
+ *         error occurred
+ */
+PyObject *pybgpstream_freelist_alloc(pybgpstream_freelist_t *fl);
+
+/** Release an object to the given free list
+ *
+ * @param fl            pointer to the free list
+ * @param obj           object to release
+ *
+ * The object must not hold any references anymore. If the free list is full
+ * (or obj is an instance of a subclass) it is freed using tp_free.
+ */
+void pybgpstream_freelist_free(pybgpstream_freelist_t *fl, PyObject *obj);
+
+/** Change the maximum size of the given free list
+ *
+ * @param fl            pointer to the free list
+ * @param max           new maximum number of objects to keep
+ * @return 0 if the size was changed successfully, -1 otherwise
+ *
+ * Objects in excess of the new size are freed.
+ */
+int pybgpstream_freelist_set_size(pybgpstream_freelist_t *fl, int max);
+
+/** Free all objects held by the given free list */
+void pybgpstream_freelist_clear(pybgpstream_freelist_t *fl);
+
+/** Get a dictionary with the statistics of the given free list
+ *
+ * @param fl            pointer to the free list
+ * @return new reference to a dict with the "size", "max_size", "hits" and
+ *         "misses" of the free list, or NULL if an error occurred
+ */
+PyObject *pybgpstream_freelist_get_stats(pybgpstream_freelist_t *fl);
+
+#endif /* ___PYBGPSTREAM_FREELIST_H */
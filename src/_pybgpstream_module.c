@@ -24,12 +24,336 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "_pybgpstream_module.h"
 #include "_pybgpstream_bgpelem.h"
 #include "_pybgpstream_bgprecord.h"
 #include "_pybgpstream_bgpstream.h"
+#include "_pybgpstream_prefixset.h"
+#include "_pybgpstream_routingtable.h"
+#include "_pybgpstream_utils.h"
+#include "pyutils.h"
 #include <Python.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Maximum number of strings kept in the intern table */
+#define INTERN_MAX_CNT 4096
+
+typedef struct {
+
+  /** Hash of str */
+  uint32_t hash;
+
+  /** Owned copy of the C string (NULL if the slot is empty) */
+  char *str;
+
+  /** Shared string object */
+  PyObject *obj;
+
+} intern_entry_t;
+
+typedef struct {
+
+  /** Whether low-cardinality strings are interned */
+  int intern_enabled;
+
+  /** Open-addressing table of interned strings */
+  intern_entry_t *intern_tbl;
+
+  /** Number of slots in intern_tbl (always a power of two) */
+  size_t intern_alloc;
+
+  /** Number of used slots in intern_tbl */
+  size_t intern_cnt;
+
+  /** Protects the intern table (on free-threaded builds) */
+  PYBGPSTREAM_MUTEX intern_mutex;
+
+} module_state_t;
+
+/* Module state. This is the PyModule_GetState area of the module, kept here
+   so that object getters can reach it without looking the module up. */
+static module_state_t *state = NULL;
+
+#if PY_MAJOR_VERSION <= 2
+static module_state_t static_state;
+#endif
+
+static void intern_clear(module_state_t *st)
+{
+  size_t i;
+  for (i = 0; i < st->intern_alloc; i++) {
+    if (st->intern_tbl[i].str != NULL) {
+      free(st->intern_tbl[i].str);
+      Py_DECREF(st->intern_tbl[i].obj);
+    }
+  }
+  free(st->intern_tbl);
+  st->intern_tbl = NULL;
+  st->intern_alloc = 0;
+  st->intern_cnt = 0;
+}
+
+static intern_entry_t *intern_find_slot(intern_entry_t *tbl, size_t alloc,
+                                        const char *str, uint32_t hash)
+{
+  size_t mask = alloc - 1;
+  size_t i = hash & mask;
+  while (tbl[i].str != NULL &&
+         (tbl[i].hash != hash || strcmp(tbl[i].str, str) != 0)) {
+    i = (i + 1) & mask;
+  }
+  return &tbl[i];
+}
+
+static int intern_grow(module_state_t *st)
+{
+  size_t new_alloc = (st->intern_alloc == 0) ? 64 : st->intern_alloc * 2;
+  intern_entry_t *new_tbl;
+  intern_entry_t *slot;
+  size_t i;
+
+  if ((new_tbl = calloc(new_alloc, sizeof(intern_entry_t))) == NULL) {
+    return -1;
+  }
+  for (i = 0; i < st->intern_alloc; i++) {
+    if (st->intern_tbl[i].str != NULL) {
+      slot = intern_find_slot(new_tbl, new_alloc, st->intern_tbl[i].str,
+                              st->intern_tbl[i].hash);
+      *slot = st->intern_tbl[i];
+    }
+  }
+  free(st->intern_tbl);
+  st->intern_tbl = new_tbl;
+  st->intern_alloc = new_alloc;
+  return 0;
+}
+
+/* look up (or add) a string in the intern table, which must be locked */
+static PyObject *intern_str_locked(const char *str)
+{
+  intern_entry_t *slot;
+  uint32_t hash;
+  PyObject *obj;
+
+  if (!state->intern_enabled) {
+    return PYSTR_FROMSTR(str);
+  }
+
+  hash = pybgpstream_hash(str, strlen(str));
+  if (state->intern_alloc != 0) {
+    slot = intern_find_slot(state->intern_tbl, state->intern_alloc, str, hash);
+    if (slot->str != NULL) {
+      Py_INCREF(slot->obj);
+      return slot->obj;
+    }
+  }
+
+  /* not seen before */
+  if ((obj = PYSTR_FROMSTR(str)) == NULL) {
+    return NULL;
+  }
+  if (state->intern_cnt >= INTERN_MAX_CNT) {
+    /* the table is full, so this string is just not shared */
+    return obj;
+  }
+  if ((state->intern_cnt + 1) * 2 > state->intern_alloc &&
+      intern_grow(state) != 0) {
+    return obj;
+  }
+  slot = intern_find_slot(state->intern_tbl, state->intern_alloc, str, hash);
+  if ((slot->str = strdup(str)) == NULL) {
+    return obj;
+  }
+  slot->hash = hash;
+  Py_INCREF(obj);
+  slot->obj = obj;
+  state->intern_cnt++;
+
+  return obj;
+}
+
+PyObject *_pybgpstream_intern_str(const char *str)
+{
+  PyObject *obj;
+
+  if (state == NULL) {
+    return PYSTR_FROMSTR(str);
+  }
+
+  PYBGPSTREAM_MUTEX_LOCK(&state->intern_mutex);
+  obj = intern_str_locked(str);
+  PYBGPSTREAM_MUTEX_UNLOCK(&state->intern_mutex);
+  return obj;
+}
+
+/** Enable or disable string interning */
+static PyObject *set_string_interning(PyObject *self, PyObject *args)
+{
+  /* args: enabled (bool) */
+  PyObject *enabled;
+  int enabled_val;
+
+  if (!PyArg_ParseTuple(args, "O", &enabled)) {
+    return NULL;
+  }
+  if ((enabled_val = PyObject_IsTrue(enabled)) < 0) {
+    return NULL;
+  }
+
+  if (state != NULL) {
+    PYBGPSTREAM_MUTEX_LOCK(&state->intern_mutex);
+    state->intern_enabled = enabled_val;
+    if (!enabled_val) {
+      intern_clear(state);
+    }
+    PYBGPSTREAM_MUTEX_UNLOCK(&state->intern_mutex);
+  }
+
+  Py_RETURN_NONE;
+}
+
+/* set the size of a free list from an (optional) Python int */
+static int set_freelist_size_pyobj(pybgpstream_freelist_t *fl, PyObject *size)
+{
+  long size_val;
+
+  if (size == NULL || size == Py_None) {
+    return 0;
+  }
+  if ((size_val = PyLong_AsLong(size)) == -1 && PyErr_Occurred()) {
+    return -1;
+  }
+  if (size_val < 0 || size_val > INT_MAX ||
+      pybgpstream_freelist_set_size(fl, (int)size_val) != 0) {
+    PyErr_SetString(PyExc_ValueError, "Invalid free list size");
+    return -1;
+  }
+  return 0;
+}
+
+/** Change the maximum size of the elem and/or record free lists */
+static PyObject *set_freelist_size(PyObject *self, PyObject *args,
+                                   PyObject *kwds)
+{
+  /* args: elem (int), record (int) */
+  static char *kwlist[] = {"elem", "record", NULL};
+  PyObject *elem_size = NULL;
+  PyObject *record_size = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OO", kwlist, &elem_size,
+                                   &record_size)) {
+    return NULL;
+  }
+
+  if (set_freelist_size_pyobj(_pybgpstream_bgpstream_get_BGPElemFreelist(),
+                              elem_size) != 0 ||
+      set_freelist_size_pyobj(_pybgpstream_bgpstream_get_BGPRecordFreelist(),
+                              record_size) != 0) {
+    return NULL;
+  }
+
+  Py_RETURN_NONE;
+}
+
+/** Get the statistics of the elem and record free lists */
+static PyObject *get_freelist_stats(PyObject *self)
+{
+  return Py_BuildValue(
+    "{s:N,s:N}", "BGPElem",
+    pybgpstream_freelist_get_stats(
+      _pybgpstream_bgpstream_get_BGPElemFreelist()),
+    "BGPRecord",
+    pybgpstream_freelist_get_stats(
+      _pybgpstream_bgpstream_get_BGPRecordFreelist()));
+}
+
+/* set the size of an object cache from an (optional) Python int */
+static int set_objcache_size_pyobj(pybgpstream_objcache_t *cache,
+                                   PyObject *size)
+{
+  long size_val;
+
+  if (size == NULL || size == Py_None) {
+    return 0;
+  }
+  if ((size_val = PyLong_AsLong(size)) == -1 && PyErr_Occurred()) {
+    return -1;
+  }
+  if (size_val < 0) {
+    PyErr_SetString(PyExc_ValueError, "Invalid object cache size");
+    return -1;
+  }
+  pybgpstream_objcache_set_size(cache, (size_t)size_val);
+  return 0;
+}
+
+/** Change the maximum number of entries of the shared object caches */
+static PyObject *set_object_cache_size(PyObject *self, PyObject *args,
+                                       PyObject *kwds)
+{
+  /* args: communities (int), prefixes (int), as_paths (int) */
+  static char *kwlist[] = {"communities", "prefixes", "as_paths", NULL};
+  PyObject *communities_size = NULL;
+  PyObject *prefixes_size = NULL;
+  PyObject *as_paths_size = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOO", kwlist,
+                                   &communities_size, &prefixes_size,
+                                   &as_paths_size)) {
+    return NULL;
+  }
+
+  if (set_objcache_size_pyobj(
+        _pybgpstream_bgpstream_get_BGPElemCommunityCache(),
+        communities_size) != 0 ||
+      set_objcache_size_pyobj(_pybgpstream_bgpstream_get_BGPElemPrefixCache(),
+                              prefixes_size) != 0 ||
+      set_objcache_size_pyobj(_pybgpstream_bgpstream_get_BGPElemASPathCache(),
+                              as_paths_size) != 0) {
+    return NULL;
+  }
+
+  Py_RETURN_NONE;
+}
+
+/** Get the statistics of the shared object caches */
+static PyObject *get_object_cache_stats(PyObject *self)
+{
+  return Py_BuildValue(
+    "{s:N,s:N,s:N}", "communities",
+    pybgpstream_objcache_get_stats(
+      _pybgpstream_bgpstream_get_BGPElemCommunityCache()),
+    "prefixes",
+    pybgpstream_objcache_get_stats(
+      _pybgpstream_bgpstream_get_BGPElemPrefixCache()),
+    "as_paths",
+    pybgpstream_objcache_get_stats(
+      _pybgpstream_bgpstream_get_BGPElemASPathCache()));
+}
 
 static PyMethodDef module_methods[] = {
+
+  {"set_string_interning", (PyCFunction)set_string_interning, METH_VARARGS,
+   "Enable or disable sharing of low-cardinality string values"},
+
+  {"set_freelist_size", (PyCFunction)set_freelist_size,
+   METH_VARARGS | METH_KEYWORDS,
+   "Set the maximum number of BGPElem/BGPRecord objects kept for re-use"},
+
+  {"get_freelist_stats", (PyCFunction)get_freelist_stats, METH_NOARGS,
+   "Get the size, hits and misses of the BGPElem/BGPRecord free lists"},
+
+  {"set_object_cache_size", (PyCFunction)set_object_cache_size,
+   METH_VARARGS | METH_KEYWORDS,
+   "Set the maximum number of field values shared between elems"},
+
+  {"get_object_cache_stats", (PyCFunction)get_object_cache_stats,
+   METH_NOARGS,
+   "Get the size, hit rate and memory use of the shared object caches"},
+
   {NULL} /* Sentinel */
 };
 
@@ -47,16 +371,30 @@ static PyMethodDef module_methods[] = {
   "Module that provides a low-level interface to libbgpstream"
 
 #if PY_MAJOR_VERSION > 2
+static void module_free(void *m)
+{
+  if (state != NULL) {
+    intern_clear(state);
+    state = NULL;
+  }
+  pybgpstream_freelist_clear(_pybgpstream_bgpstream_get_BGPElemFreelist());
+  pybgpstream_freelist_clear(_pybgpstream_bgpstream_get_BGPRecordFreelist());
+  pybgpstream_objcache_clear(
+    _pybgpstream_bgpstream_get_BGPElemCommunityCache());
+  pybgpstream_objcache_clear(_pybgpstream_bgpstream_get_BGPElemPrefixCache());
+  pybgpstream_objcache_clear(_pybgpstream_bgpstream_get_BGPElemASPathCache());
+}
+
 static struct PyModuleDef module_def = {
   PyModuleDef_HEAD_INIT,
   "_pybgpstream",
   MODULE_DOCSTRING,
-  -1,
+  sizeof(module_state_t),
   module_methods,
   NULL,
   NULL,
   NULL,
-  NULL,
+  module_free,
 };
 #endif
 
@@ -78,6 +416,20 @@ static PyObject *moduleinit(void)
   if (m == NULL)
     return NULL;
 
+#if PY_MAJOR_VERSION > 2
+  state = PyModule_GetState(m);
+#else
+  state = &static_state;
+#endif
+  memset(state, 0, sizeof(module_state_t));
+  state->intern_enabled = 1;
+
+#ifdef Py_GIL_DISABLED
+  /* shared state is protected by locks and critical sections, so the
+     module can run without the GIL */
+  PyUnstable_Module_SetGIL(m, Py_MOD_GIL_NOT_USED);
+#endif
+
   /* BGPStream object */
   ADD_OBJECT(BGPStream);
 
@@ -87,6 +439,14 @@ static PyObject *moduleinit(void)
   /* BGPRecord object */
   ADD_OBJECT(BGPElem);
 
+  /* PrefixSet object */
+  ADD_OBJECT(PrefixSet);
+
+  /* RoutingTable object (and the iterator over its routes) */
+  ADD_OBJECT(RoutingTable);
+  if (PyType_Ready(_pybgpstream_bgpstream_get_RoutingTableIterType()) < 0)
+    return NULL;
+
   return m;
 }
 
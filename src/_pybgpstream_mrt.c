@@ -0,0 +1,754 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_mrt.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* MRT types and subtypes (RFC 6396) */
+#define MRT_TYPE_TABLE_DUMP_V2 13
+#define MRT_TYPE_BGP4MP 16
+#define TABLE_DUMP_V2_PEER_INDEX_TABLE 1
+#define TABLE_DUMP_V2_RIB_IPV4_UNICAST 2
+#define TABLE_DUMP_V2_RIB_IPV6_UNICAST 4
+#define TABLE_DUMP_V2_PEER_IPV6 0x01
+#define TABLE_DUMP_V2_PEER_AS4 0x02
+#define BGP4MP_MESSAGE_AS4 4
+#define BGP4MP_STATE_CHANGE_AS4 5
+
+/* BGP message type, path attributes and AS path segment types (RFC 4271,
+   RFC 4760, RFC 5065) */
+#define BGP_MSG_UPDATE 2
+#define BGP_ATTR_ORIGIN 1
+#define BGP_ATTR_AS_PATH 2
+#define BGP_ATTR_NEXT_HOP 3
+#define BGP_ATTR_COMMUNITIES 8
+#define BGP_ATTR_MP_REACH_NLRI 14
+#define BGP_ATTR_MP_UNREACH_NLRI 15
+#define BGP_ATTR_FLAG_OPTIONAL 0x80
+#define BGP_ATTR_FLAG_TRANSITIVE 0x40
+#define BGP_ATTR_FLAG_EXT_LEN 0x10
+#define BGP_AS_SET 1
+#define BGP_AS_SEQUENCE 2
+#define BGP_AS_CONFED_SEQUENCE 3
+#define BGP_AS_CONFED_SET 4
+#define AFI_IPV4 1
+#define AFI_IPV6 2
+#define SAFI_UNICAST 1
+
+/* encoded bytes are written out once the buffer holds this many */
+#define WRITE_CHUNK_SIZE (256 * 1024)
+
+/* ---------- buffer ---------- */
+
+void pybgpstream_mrtbuf_clear(pybgpstream_mrtbuf_t *buf)
+{
+  free(buf->data);
+  memset(buf, 0, sizeof(*buf));
+}
+
+static int reserve(pybgpstream_mrtbuf_t *buf, size_t cnt)
+{
+  size_t new_alloc;
+  uint8_t *tmp;
+
+  if (buf->failed) {
+    return -1;
+  }
+  if (buf->len + cnt <= buf->alloc) {
+    return 0;
+  }
+  new_alloc = (buf->alloc == 0) ? 4096 : buf->alloc;
+  while (new_alloc < buf->len + cnt) {
+    new_alloc *= 2;
+  }
+  if ((tmp = realloc(buf->data, new_alloc)) == NULL) {
+    buf->failed = 1;
+    return -1;
+  }
+  buf->data = tmp;
+  buf->alloc = new_alloc;
+  return 0;
+}
+
+static void put_bytes(pybgpstream_mrtbuf_t *buf, const void *bytes,
+                      size_t cnt)
+{
+  if (reserve(buf, cnt) != 0) {
+    return;
+  }
+  if (bytes != NULL) {
+    memcpy(buf->data + buf->len, bytes, cnt);
+  } else {
+    memset(buf->data + buf->len, 0, cnt);
+  }
+  buf->len += cnt;
+}
+
+static void put_u8(pybgpstream_mrtbuf_t *buf, uint8_t val)
+{
+  put_bytes(buf, &val, 1);
+}
+
+static void set_u16(pybgpstream_mrtbuf_t *buf, size_t off, uint16_t val)
+{
+  if (!buf->failed) {
+    buf->data[off] = (uint8_t)(val >> 8);
+    buf->data[off + 1] = (uint8_t)val;
+  }
+}
+
+static void put_u16(pybgpstream_mrtbuf_t *buf, uint16_t val)
+{
+  size_t off = buf->len;
+  put_bytes(buf, NULL, 2);
+  set_u16(buf, off, val);
+}
+
+static void set_u32(pybgpstream_mrtbuf_t *buf, size_t off, uint32_t val)
+{
+  if (!buf->failed) {
+    buf->data[off] = (uint8_t)(val >> 24);
+    buf->data[off + 1] = (uint8_t)(val >> 16);
+    buf->data[off + 2] = (uint8_t)(val >> 8);
+    buf->data[off + 3] = (uint8_t)val;
+  }
+}
+
+static void put_u32(pybgpstream_mrtbuf_t *buf, uint32_t val)
+{
+  size_t off = buf->len;
+  put_bytes(buf, NULL, 4);
+  set_u32(buf, off, val);
+}
+
+/* ---------- BGP encoding ---------- */
+
+/* get the bytes of an address, and return their number (0 for addresses of
+   an unknown version) */
+static int get_addr_bytes(const bgpstream_ip_addr_t *addr,
+                          const uint8_t **bytes)
+{
+  if (addr->version == BGPSTREAM_ADDR_VERSION_IPV4) {
+    *bytes = (const uint8_t *)&addr->bs_ipv4.addr;
+    return 4;
+  }
+  if (addr->version == BGPSTREAM_ADDR_VERSION_IPV6) {
+    *bytes = (const uint8_t *)&addr->bs_ipv6.addr;
+    return 16;
+  }
+  *bytes = NULL;
+  return 0;
+}
+
+static void put_prefix(pybgpstream_mrtbuf_t *buf, const bgpstream_pfx_t *pfx)
+{
+  const uint8_t *bytes;
+  int len = get_addr_bytes(&pfx->address, &bytes);
+  int mask_len = (pfx->mask_len <= len * 8) ? pfx->mask_len : len * 8;
+
+  put_u8(buf, (uint8_t)mask_len);
+  put_bytes(buf, bytes, (mask_len + 7) / 8);
+}
+
+/* start an attribute (always with a 2-byte length) and return the offset
+   of its length */
+static size_t begin_attr(pybgpstream_mrtbuf_t *buf, uint8_t flags,
+                         uint8_t type)
+{
+  size_t off;
+
+  put_u8(buf, flags | BGP_ATTR_FLAG_EXT_LEN);
+  put_u8(buf, type);
+  off = buf->len;
+  put_u16(buf, 0);
+  return off;
+}
+
+static void end_attr(pybgpstream_mrtbuf_t *buf, size_t off)
+{
+  set_u16(buf, off, (uint16_t)(buf->len - off - 2));
+}
+
+static void put_as_path(pybgpstream_mrtbuf_t *buf, bgpstream_as_path_t *path)
+{
+  bgpstream_as_path_iter_t iter;
+  bgpstream_as_path_seg_t *seg;
+  bgpstream_as_path_seg_set_t *set;
+  size_t attr_off;
+  size_t seq_off = 0;
+  int seq_cnt = 0;
+  int i;
+
+  /* elems do not tell an empty AS_PATH from a missing one, and both decode
+     the same, so none is written */
+  if (path == NULL || bgpstream_as_path_get_len(path) == 0) {
+    return;
+  }
+  attr_off = begin_attr(buf, BGP_ATTR_FLAG_TRANSITIVE, BGP_ATTR_AS_PATH);
+
+  /* consecutive ASN hops are merged into AS_SEQUENCE segments */
+  bgpstream_as_path_iter_reset(&iter);
+  while ((seg = bgpstream_as_path_get_next_seg(path, &iter)) != NULL) {
+    if (seg->type == BGPSTREAM_AS_PATH_SEG_ASN) {
+      if (seq_cnt == 0 || seq_cnt == 255) {
+        put_u8(buf, BGP_AS_SEQUENCE);
+        seq_off = buf->len;
+        put_u8(buf, 0);
+        seq_cnt = 0;
+      }
+      put_u32(buf, ((bgpstream_as_path_seg_asn_t *)seg)->asn);
+      seq_cnt++;
+      if (!buf->failed) {
+        buf->data[seq_off] = (uint8_t)seq_cnt;
+      }
+      continue;
+    }
+
+    seq_cnt = 0;
+    set = (bgpstream_as_path_seg_set_t *)seg;
+    switch (seg->type) {
+    case BGPSTREAM_AS_PATH_SEG_SET:
+      put_u8(buf, BGP_AS_SET);
+      break;
+    case BGPSTREAM_AS_PATH_SEG_CONFED_SEQ:
+      put_u8(buf, BGP_AS_CONFED_SEQUENCE);
+      break;
+    case BGPSTREAM_AS_PATH_SEG_CONFED_SET:
+      put_u8(buf, BGP_AS_CONFED_SET);
+      break;
+    default:
+      continue;
+    }
+    put_u8(buf, set->asn_cnt);
+    for (i = 0; i < set->asn_cnt; i++) {
+      put_u32(buf, set->asn[i]);
+    }
+  }
+
+  end_attr(buf, attr_off);
+}
+
+static void put_communities(pybgpstream_mrtbuf_t *buf,
+                            const bgpstream_community_set_t *comms)
+{
+  bgpstream_community_t *comm;
+  size_t off;
+  int cnt = bgpstream_community_set_size(comms);
+  int i;
+
+  if (cnt == 0) {
+    return;
+  }
+  off = begin_attr(buf, BGP_ATTR_FLAG_OPTIONAL | BGP_ATTR_FLAG_TRANSITIVE,
+                   BGP_ATTR_COMMUNITIES);
+  for (i = 0; i < cnt; i++) {
+    comm = bgpstream_community_set_get(comms, i);
+    put_u16(buf, comm->asn);
+    put_u16(buf, comm->value);
+  }
+  end_attr(buf, off);
+}
+
+/* Put the path attributes of a RIB or announcement elem. Only the
+   attributes that elems carry are written (no value is made up for the
+   others, e.g. ORIGIN, even where RFC 4271 makes them mandatory). IPv4
+   routes with an IPv6 next hop are carried in MP_REACH_NLRI (RFC 8950). In
+   TABLE_DUMP_V2 RIB entries, MP_REACH_NLRI only holds the next hop (RFC
+   6396 section 4.3.4). Return whether the prefix is carried in
+   MP_REACH_NLRI. */
+static int put_attrs(pybgpstream_mrtbuf_t *buf, const bgpstream_elem_t *elem,
+                     int rib)
+{
+  int v4 = (elem->prefix.address.version == BGPSTREAM_ADDR_VERSION_IPV4);
+  const uint8_t *nh;
+  int nh_len = get_addr_bytes(&elem->nexthop, &nh);
+  int mp = (!v4 || nh_len == 16);
+  size_t off;
+
+  put_as_path(buf, elem->as_path);
+
+  if (!mp && nh_len == 4) {
+    off = begin_attr(buf, BGP_ATTR_FLAG_TRANSITIVE, BGP_ATTR_NEXT_HOP);
+    put_bytes(buf, nh, 4);
+    end_attr(buf, off);
+  }
+
+  if (elem->communities != NULL) {
+    put_communities(buf, elem->communities);
+  }
+
+  if (mp && (!rib || nh_len != 0)) {
+    off = begin_attr(buf, BGP_ATTR_FLAG_OPTIONAL, BGP_ATTR_MP_REACH_NLRI);
+    if (!rib) {
+      put_u16(buf, v4 ? AFI_IPV4 : AFI_IPV6);
+      put_u8(buf, SAFI_UNICAST);
+    }
+    put_u8(buf, (uint8_t)nh_len);
+    put_bytes(buf, nh, nh_len);
+    if (!rib) {
+      put_u8(buf, 0); /* reserved */
+      put_prefix(buf, &elem->prefix);
+    }
+    end_attr(buf, off);
+  }
+
+  return mp;
+}
+
+static void put_update(pybgpstream_mrtbuf_t *buf,
+                       const bgpstream_elem_t *elem)
+{
+  int withdrawal = (elem->type == BGPSTREAM_ELEM_TYPE_WITHDRAWAL);
+  int v4 = (elem->prefix.address.version == BGPSTREAM_ADDR_VERSION_IPV4);
+  int mp = 0;
+  size_t msg_off;
+  size_t off;
+  size_t attrs_off;
+
+  msg_off = buf->len;
+  put_bytes(buf, NULL, 16);
+  if (!buf->failed) {
+    memset(buf->data + msg_off, 0xff, 16);
+  }
+  put_u16(buf, 0);
+  put_u8(buf, BGP_MSG_UPDATE);
+
+  /* withdrawn routes */
+  off = buf->len;
+  put_u16(buf, 0);
+  if (withdrawal && v4) {
+    put_prefix(buf, &elem->prefix);
+  }
+  set_u16(buf, off, (uint16_t)(buf->len - off - 2));
+
+  /* path attributes */
+  attrs_off = buf->len;
+  put_u16(buf, 0);
+  if (withdrawal && !v4) {
+    off = begin_attr(buf, BGP_ATTR_FLAG_OPTIONAL, BGP_ATTR_MP_UNREACH_NLRI);
+    put_u16(buf, AFI_IPV6);
+    put_u8(buf, SAFI_UNICAST);
+    put_prefix(buf, &elem->prefix);
+    end_attr(buf, off);
+  }
+  if (!withdrawal) {
+    mp = put_attrs(buf, elem, 0);
+  }
+  set_u16(buf, attrs_off, (uint16_t)(buf->len - attrs_off - 2));
+
+  /* NLRI */
+  if (!withdrawal && !mp) {
+    put_prefix(buf, &elem->prefix);
+  }
+
+  set_u16(buf, msg_off + 16, (uint16_t)(buf->len - msg_off));
+}
+
+/* put an MRT header and return its offset (the length is set by
+   end_mrt) */
+static size_t begin_mrt(pybgpstream_mrtbuf_t *buf, uint32_t time_sec,
+                        uint16_t type, uint16_t subtype)
+{
+  size_t off = buf->len;
+
+  put_u32(buf, time_sec);
+  put_u16(buf, type);
+  put_u16(buf, subtype);
+  put_u32(buf, 0);
+  return off;
+}
+
+static void end_mrt(pybgpstream_mrtbuf_t *buf, size_t off)
+{
+  set_u32(buf, off + 8, (uint32_t)(buf->len - off - 12));
+}
+
+/* start a BGP4MP message and return the offset of its MRT header */
+static size_t begin_bgp4mp(pybgpstream_mrtbuf_t *buf,
+                           const bgpstream_record_t *rec, uint16_t subtype,
+                           const bgpstream_elem_t *elem)
+{
+  const uint8_t *peer_ip;
+  int ip_len = get_addr_bytes(&elem->peer_ip, &peer_ip);
+  size_t off = begin_mrt(buf, rec->time_sec, MRT_TYPE_BGP4MP, subtype);
+
+  /* elems do not carry the local AS, interface and address, which are set
+     to 0 */
+  put_u32(buf, elem->peer_asn);
+  put_u32(buf, 0); /* local AS */
+  put_u16(buf, 0); /* interface index */
+  put_u16(buf, (ip_len == 16) ? AFI_IPV6 : AFI_IPV4);
+  put_bytes(buf, peer_ip, ip_len);
+  put_bytes(buf, NULL, ip_len); /* local address */
+  return off;
+}
+
+/* ---------- TABLE_DUMP_V2 encoding ---------- */
+
+static int peer_equal(const pybgpstream_mrt_peer_t *peer,
+                      const bgpstream_elem_t *elem)
+{
+  const uint8_t *ip;
+  int ip_len = get_addr_bytes(&elem->peer_ip, &ip);
+
+  return peer->asn == elem->peer_asn && peer->ip_len == ip_len &&
+         memcmp(peer->ip, ip, ip_len) == 0;
+}
+
+static int pfx_equal(const bgpstream_pfx_t *a, const bgpstream_pfx_t *b)
+{
+  const uint8_t *a_bytes, *b_bytes;
+  int len = get_addr_bytes(&a->address, &a_bytes);
+
+  return a->mask_len == b->mask_len &&
+         get_addr_bytes(&b->address, &b_bytes) == len &&
+         memcmp(a_bytes, b_bytes, len) == 0;
+}
+
+/* close the RIB record that is being encoded (if any) */
+static void end_rib(pybgpstream_mrt_encoder_t *enc, pybgpstream_mrtbuf_t *buf)
+{
+  if (!enc->rib_open) {
+    return;
+  }
+  set_u16(buf, enc->rib_cnt_off, enc->rib_cnt);
+  end_mrt(buf, enc->rib_off);
+  enc->rib_open = 0;
+}
+
+/* get the index of the peer of an elem in the peer index table, adding it
+   (and writing the updated table) if it is not in the table yet. Indexes
+   never change, so RIB records already written stay valid. Returns -1 if an
+   error occurred. */
+static int get_peer_idx(pybgpstream_mrt_encoder_t *enc,
+                        pybgpstream_mrtbuf_t *buf,
+                        const bgpstream_record_t *rec,
+                        const bgpstream_elem_t *elem)
+{
+  pybgpstream_mrt_peer_t *peers;
+  pybgpstream_mrt_peer_t *peer;
+  const uint8_t *ip;
+  size_t off;
+  int i;
+
+  for (i = 0; i < enc->peers_cnt; i++) {
+    if (peer_equal(&enc->peers[i], elem)) {
+      return i;
+    }
+  }
+
+  if (enc->peers_cnt == UINT16_MAX + 1) {
+    return -1;
+  }
+  if (enc->peers_cnt == enc->peers_alloc) {
+    enc->peers_alloc = (enc->peers_alloc == 0) ? 16 : enc->peers_alloc * 2;
+    if ((peers = realloc(enc->peers, sizeof(pybgpstream_mrt_peer_t) *
+                                       enc->peers_alloc)) == NULL) {
+      buf->failed = 1;
+      return -1;
+    }
+    enc->peers = peers;
+  }
+  peer = &enc->peers[enc->peers_cnt++];
+  peer->asn = elem->peer_asn;
+  peer->ip_len = get_addr_bytes(&elem->peer_ip, &ip);
+  memcpy(peer->ip, ip, peer->ip_len);
+
+  /* the table must come before the RIB records that refer to the peer */
+  end_rib(enc, buf);
+  off = begin_mrt(buf, rec->time_sec, MRT_TYPE_TABLE_DUMP_V2,
+                  TABLE_DUMP_V2_PEER_INDEX_TABLE);
+  put_u32(buf, 0); /* collector BGP ID */
+  put_u16(buf, 0); /* view name length */
+  put_u16(buf, (uint16_t)enc->peers_cnt);
+  for (i = 0; i < enc->peers_cnt; i++) {
+    peer = &enc->peers[i];
+    put_u8(buf, TABLE_DUMP_V2_PEER_AS4 |
+                  ((peer->ip_len == 16) ? TABLE_DUMP_V2_PEER_IPV6 : 0));
+    put_u32(buf, 0); /* peer BGP ID */
+    put_bytes(buf, peer->ip, peer->ip_len);
+    put_u32(buf, peer->asn);
+  }
+  end_mrt(buf, off);
+
+  return enc->peers_cnt - 1;
+}
+
+/* Encode a RIB elem as an entry of a TABLE_DUMP_V2 RIB record. Consecutive
+   elems of a record for the same prefix share a RIB record. */
+static int put_rib_entry(pybgpstream_mrt_encoder_t *enc,
+                         pybgpstream_mrtbuf_t *buf,
+                         const bgpstream_record_t *rec,
+                         const bgpstream_elem_t *elem)
+{
+  int v4 = (elem->prefix.address.version == BGPSTREAM_ADDR_VERSION_IPV4);
+  int peer_idx;
+  size_t off;
+
+  if ((peer_idx = get_peer_idx(enc, buf, rec, elem)) < 0) {
+    return -1;
+  }
+
+  if (enc->rib_open && (enc->rib_cnt == UINT16_MAX ||
+                        !pfx_equal(&enc->rib_pfx, &elem->prefix))) {
+    end_rib(enc, buf);
+  }
+  if (!enc->rib_open) {
+    enc->rib_off = begin_mrt(buf, rec->time_sec, MRT_TYPE_TABLE_DUMP_V2,
+                             v4 ? TABLE_DUMP_V2_RIB_IPV4_UNICAST
+                                : TABLE_DUMP_V2_RIB_IPV6_UNICAST);
+    put_u32(buf, enc->rib_seq++);
+    put_prefix(buf, &elem->prefix);
+    enc->rib_cnt_off = buf->len;
+    put_u16(buf, 0);
+    enc->rib_cnt = 0;
+    enc->rib_pfx = elem->prefix;
+    enc->rib_open = 1;
+  }
+
+  put_u16(buf, (uint16_t)peer_idx);
+  put_u32(buf, (elem->orig_time_sec != 0) ? elem->orig_time_sec
+                                          : rec->time_sec);
+  off = buf->len;
+  put_u16(buf, 0);
+  put_attrs(buf, elem, 1);
+  set_u16(buf, off, (uint16_t)(buf->len - off - 2));
+  enc->rib_cnt++;
+
+  return 0;
+}
+
+void pybgpstream_mrt_encoder_clear(pybgpstream_mrt_encoder_t *enc)
+{
+  free(enc->peers);
+  memset(enc, 0, sizeof(*enc));
+}
+
+int pybgpstream_mrt_encode_elem(pybgpstream_mrt_encoder_t *enc,
+                                pybgpstream_mrtbuf_t *buf,
+                                const bgpstream_record_t *rec,
+                                const bgpstream_elem_t *elem)
+{
+  const uint8_t *peer_ip;
+  size_t off;
+
+  /* elems whose peer or prefix address is unknown cannot be encoded (rather
+     than being given a made-up address) */
+  if (get_addr_bytes(&elem->peer_ip, &peer_ip) == 0) {
+    return -1;
+  }
+
+  if (elem->type != BGPSTREAM_ELEM_TYPE_RIB) {
+    end_rib(enc, buf);
+  }
+
+  switch (elem->type) {
+  case BGPSTREAM_ELEM_TYPE_PEERSTATE:
+    off = begin_bgp4mp(buf, rec, BGP4MP_STATE_CHANGE_AS4, elem);
+    put_u16(buf, (uint16_t)elem->old_state);
+    put_u16(buf, (uint16_t)elem->new_state);
+    end_mrt(buf, off);
+    break;
+
+  case BGPSTREAM_ELEM_TYPE_RIB:
+  case BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT:
+  case BGPSTREAM_ELEM_TYPE_WITHDRAWAL:
+    if (elem->prefix.address.version != BGPSTREAM_ADDR_VERSION_IPV4 &&
+        elem->prefix.address.version != BGPSTREAM_ADDR_VERSION_IPV6) {
+      return -1;
+    }
+    if (elem->type == BGPSTREAM_ELEM_TYPE_RIB) {
+      if (put_rib_entry(enc, buf, rec, elem) != 0) {
+        return -1;
+      }
+      break;
+    }
+    off = begin_bgp4mp(buf, rec, BGP4MP_MESSAGE_AS4, elem);
+    put_update(buf, elem);
+    end_mrt(buf, off);
+    break;
+
+  default:
+    return -1;
+  }
+
+  return buf->failed ? -1 : 0;
+}
+
+int pybgpstream_mrt_encode_end(pybgpstream_mrt_encoder_t *enc,
+                               pybgpstream_mrtbuf_t *buf)
+{
+  end_rib(enc, buf);
+  return buf->failed ? -1 : 0;
+}
+
+int pybgpstream_mrt_encode_record(pybgpstream_mrtbuf_t *buf,
+                                  const bgpstream_record_t *rec,
+                                  const bgpstream_elem_t *elems,
+                                  int elems_cnt)
+{
+  pybgpstream_mrt_encoder_t enc;
+  int ret = 0;
+  int i;
+
+  memset(&enc, 0, sizeof(enc));
+  for (i = 0; i < elems_cnt && ret == 0; i++) {
+    ret = pybgpstream_mrt_encode_elem(&enc, buf, rec, &elems[i]);
+  }
+  if (ret == 0) {
+    ret = pybgpstream_mrt_encode_end(&enc, buf);
+  }
+  pybgpstream_mrt_encoder_clear(&enc);
+
+  return ret;
+}
+
+/* ---------- writing to a file descriptor ---------- */
+
+typedef struct {
+  uint64_t records;
+  uint64_t elems;
+  uint64_t bytes;
+} write_stats_t;
+
+/* write (and empty) the whole buffer, returning 0 or an errno value */
+static int flush(pybgpstream_mrtbuf_t *buf, int fd, write_stats_t *stats)
+{
+  size_t done = 0;
+  ssize_t ret;
+
+  while (done < buf->len) {
+    if ((ret = write(fd, buf->data + done, buf->len - done)) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    done += ret;
+  }
+  stats->bytes += done;
+  buf->len = 0;
+  return 0;
+}
+
+/* write the rest of the stream (no Python API calls) */
+static int write_records(pybgpstream_reader_t *reader, int fd,
+                         pybgpstream_mrt_encoder_t *enc,
+                         pybgpstream_mrtbuf_t *buf, write_stats_t *stats,
+                         PyObject **exc, const char **err, int *errnum)
+{
+  bgpstream_elem_t *elem;
+  uint64_t elem_cnt;
+  int ret;
+
+  while ((ret = pybgpstream_reader_next_record(reader)) > 0) {
+    if (reader->rec->status != BGPSTREAM_RECORD_STATUS_VALID_RECORD) {
+      continue;
+    }
+
+    /* elems are only valid until the next one is read, so they are encoded
+       one at a time */
+    elem_cnt = 0;
+    while ((ret = pybgpstream_reader_next_elem(reader, &elem)) > 0) {
+      if (pybgpstream_mrt_encode_elem(enc, buf, reader->rec, elem) != 0) {
+        if (!buf->failed) {
+          *exc = PyExc_ValueError;
+          *err = "Elem cannot be represented in MRT";
+        }
+        return -1;
+      }
+      elem_cnt++;
+    }
+    if (ret < 0) {
+      *err = "Could not get next elem";
+      return -1;
+    }
+    /* the buffer is only flushed between records */
+    if (pybgpstream_mrt_encode_end(enc, buf) != 0) {
+      return -1;
+    }
+    if (elem_cnt == 0) {
+      continue;
+    }
+    stats->records++;
+    stats->elems += elem_cnt;
+
+    if (buf->len >= WRITE_CHUNK_SIZE && (*errnum = flush(buf, fd, stats))) {
+      return -1;
+    }
+  }
+  if (ret < 0) {
+    *err = "Could not get next record (is the stream started?)";
+    return -1;
+  }
+
+  if ((*errnum = flush(buf, fd, stats)) != 0) {
+    return -1;
+  }
+  return 0;
+}
+
+PyObject *_pybgpstream_mrt_write_run(pybgpstream_reader_t *reader, int fd)
+{
+  pybgpstream_mrt_encoder_t enc;
+  pybgpstream_mrtbuf_t buf;
+  write_stats_t stats;
+  PyObject *exc = PyExc_RuntimeError;
+  const char *err = NULL;
+  int errnum = 0;
+  int ret;
+
+  memset(&enc, 0, sizeof(enc));
+  memset(&buf, 0, sizeof(buf));
+  memset(&stats, 0, sizeof(stats));
+
+  Py_BEGIN_ALLOW_THREADS
+  ret = write_records(reader, fd, &enc, &buf, &stats, &exc, &err, &errnum);
+  pybgpstream_reader_clear(reader);
+  pybgpstream_mrt_encoder_clear(&enc);
+  pybgpstream_mrtbuf_clear(&buf);
+  Py_END_ALLOW_THREADS
+
+  if (ret != 0) {
+    if (errnum != 0) {
+      errno = errnum;
+      PyErr_SetFromErrno(PyExc_OSError);
+    } else if (err == NULL) {
+      PyErr_NoMemory();
+    } else {
+      PyErr_SetString(exc, err);
+    }
+    return NULL;
+  }
+
+  return Py_BuildValue("{sKsKsK}", "records",
+                       (unsigned long long)stats.records, "elems",
+                       (unsigned long long)stats.elems, "bytes",
+                       (unsigned long long)stats.bytes);
+}
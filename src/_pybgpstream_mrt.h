@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_MRT_H
+#define ___PYBGPSTREAM_MRT_H
+
+#include "_pybgpstream_reader.h"
+#include <Python.h>
+#include <bgpstream.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** A growable byte buffer */
+typedef struct pybgpstream_mrtbuf {
+
+  /** Encoded bytes */
+  uint8_t *data;
+
+  /** Number of bytes used */
+  size_t len;
+
+  /** Number of bytes allocated */
+  size_t alloc;
+
+  /** Set if an allocation failed (the buffer contents are then invalid) */
+  int failed;
+
+} pybgpstream_mrtbuf_t;
+
+/** Free the memory used by the given buffer */
+void pybgpstream_mrtbuf_clear(pybgpstream_mrtbuf_t *buf);
+
+/** A peer of a TABLE_DUMP_V2 peer index table */
+typedef struct pybgpstream_mrt_peer {
+
+  /** AS number of the peer */
+  uint32_t asn;
+
+  /** Address of the peer */
+  uint8_t ip[16];
+
+  /** Number of bytes of the address (0 if it is unknown) */
+  int ip_len;
+
+} pybgpstream_mrt_peer_t;
+
+/** State of an MRT encoder, carried from one record to the next
+ *
+ * A zeroed structure is a valid initial state.
+ */
+typedef struct pybgpstream_mrt_encoder {
+
+  /** Peers of the last peer index table written (peers are only ever
+      appended, so indexes stay valid) */
+  pybgpstream_mrt_peer_t *peers;
+
+  /** Number of peers in the table */
+  int peers_cnt;
+
+  /** Number of peers allocated */
+  int peers_alloc;
+
+  /** Sequence number of the next RIB record */
+  uint32_t rib_seq;
+
+  /** Set if a RIB record is being encoded */
+  int rib_open;
+
+  /** Offset of the MRT header of the RIB record being encoded */
+  size_t rib_off;
+
+  /** Offset of the entry count of the RIB record being encoded */
+  size_t rib_cnt_off;
+
+  /** Number of entries of the RIB record being encoded */
+  uint16_t rib_cnt;
+
+  /** Prefix of the RIB record being encoded */
+  bgpstream_pfx_t rib_pfx;
+
+} pybgpstream_mrt_encoder_t;
+
+/** Free the memory used by the given encoder and reset its state */
+void pybgpstream_mrt_encoder_clear(pybgpstream_mrt_encoder_t *enc);
+
+/** Append the MRT encoding of an elem to a buffer
+ *
+ * @param enc           pointer to the encoder state
+ * @param buf           pointer to the buffer to append to
+ * @param rec           pointer to the record of the elem
+ * @param elem          pointer to the elem
+ * @return 0 if the elem was encoded, -1 if an error occurred
+ *
+ * libbgpstream does not keep the bytes it decodes records from, so records
+ * are re-encoded from their elems, with the record time:
+ * - peer state changes as BGP4MP_STATE_CHANGE_AS4 messages,
+ * - announcements and withdrawals as one BGP4MP_MESSAGE_AS4 UPDATE each,
+ * - RIB entries as TABLE_DUMP_V2 RIB_IPV4_UNICAST or RIB_IPV6_UNICAST
+ *   records, preceded by a PEER_INDEX_TABLE record each time a new peer is
+ *   seen. Consecutive RIB entries for the same prefix share a RIB record,
+ *   which stays open until pybgpstream_mrt_encode_end is called (or an elem
+ *   of another type or prefix is encoded).
+ *
+ * Only the attributes that elems carry are encoded (AS_PATH, NEXT_HOP or
+ * MP_REACH_NLRI, COMMUNITIES): no value is made up for the others, so
+ * ORIGIN is missing, as are AS_PATH and NEXT_HOP when they are unknown.
+ * IPv4 routes with an IPv6 next hop are encoded in MP_REACH_NLRI. Local AS
+ * numbers and addresses, and BGP IDs are set to 0. Elems of an unknown
+ * type, or whose peer or prefix address is of an unknown version, cannot be
+ * encoded: -1 is then returned with buf->failed unset (it is only set when
+ * an allocation fails).
+ *
+ * This function does not touch the Python API.
+ */
+int pybgpstream_mrt_encode_elem(pybgpstream_mrt_encoder_t *enc,
+                                pybgpstream_mrtbuf_t *buf,
+                                const bgpstream_record_t *rec,
+                                const bgpstream_elem_t *elem);
+
+/** Finish the RIB record being encoded (if any)
+ *
+ * @param enc           pointer to the encoder state
+ * @param buf           pointer to the buffer the record is encoded in
+ * @return 0 if the record was finished, -1 if an error occurred
+ *
+ * This must be called before the buffer is written out or reset.
+ */
+int pybgpstream_mrt_encode_end(pybgpstream_mrt_encoder_t *enc,
+                               pybgpstream_mrtbuf_t *buf);
+
+/** Append the MRT encoding of a record and its elems to a buffer
+ *
+ * @param buf           pointer to the buffer to append to
+ * @param rec           pointer to the record
+ * @param elems         array of the elems of the record
+ * @param elems_cnt     number of elems in the array
+ * @return 0 if the record was encoded, -1 if an error occurred
+ *
+ * The elems are encoded as by pybgpstream_mrt_encode_elem, with a fresh
+ * encoder state, so the encoding is self-contained (RIB entries come with
+ * their own peer index table).
+ *
+ * This function does not touch the Python API.
+ */
+int pybgpstream_mrt_encode_record(pybgpstream_mrtbuf_t *buf,
+                                  const bgpstream_record_t *rec,
+                                  const bgpstream_elem_t *elems,
+                                  int elems_cnt);
+
+/** Write the MRT encoding of the rest of a stream to a file descriptor
+ *
+ * @param reader        pointer to the reader to drain
+ * @param fd            file descriptor to write to
+ * @return new reference to a dict with the number of "records", "elems" and
+ *         "bytes" written, or NULL if an error occurred
+ *
+ * Only valid records with at least one elem (that passed the filter of the
+ * reader) are written. Reading, encoding and writing are all done with the
+ * GIL released, and no record or elem objects are created.
+ */
+PyObject *_pybgpstream_mrt_write_run(pybgpstream_reader_t *reader, int fd);
+
+#endif /* ___PYBGPSTREAM_MRT_H */
@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_objcache.h"
+#include <Python.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct pybgpstream_objcache_entry {
+
+  /** Hash of key */
+  uint32_t hash;
+
+  /** Length of key in bytes */
+  uint32_t len;
+
+  /** Owned copy of the key (NULL if the slot is empty) */
+  uint8_t *key;
+
+  /** Shared object */
+  PyObject *obj;
+
+  /** Bytes accounted for this entry */
+  size_t bytes;
+
+} entry_t;
+
+/* Approximate size of an object, including the items of (nested) tuples and
+   frozensets, found from the object layout (without calling __sizeof__, so
+   without running any Python code). GC headers are not counted. */
+static size_t get_obj_size(PyObject *obj, int depth)
+{
+  PyTypeObject *type = Py_TYPE(obj);
+  size_t size = (size_t)type->tp_basicsize;
+  PySetObject *set;
+  PyObject *iter;
+  PyObject *item;
+  Py_ssize_t i;
+
+  if (PyTuple_Check(obj)) {
+    size += (size_t)(PyTuple_GET_SIZE(obj) * type->tp_itemsize);
+    for (i = 0; depth > 0 && i < PyTuple_GET_SIZE(obj); i++) {
+      size += get_obj_size(PyTuple_GET_ITEM(obj, i), depth - 1);
+    }
+  } else if (PyBytes_Check(obj)) {
+    size += (size_t)PyBytes_GET_SIZE(obj);
+  } else if (PyUnicode_Check(obj)) {
+#if PY_MAJOR_VERSION > 2
+    /* compact strings keep their characters right after a shorter header */
+    if (PyUnicode_IS_COMPACT_ASCII(obj)) {
+      size = sizeof(PyASCIIObject);
+    } else if (PyUnicode_IS_COMPACT(obj)) {
+      size = sizeof(PyCompactUnicodeObject);
+    }
+    size += (size_t)(PyUnicode_GET_LENGTH(obj) + 1) * PyUnicode_KIND(obj);
+#else
+    size += (size_t)(PyUnicode_GET_SIZE(obj) + 1) * sizeof(Py_UNICODE);
+#endif
+  } else if (PyAnySet_Check(obj)) {
+    set = (PySetObject *)obj;
+    if (set->table != set->smalltable) {
+      size += (size_t)(set->mask + 1) * sizeof(setentry);
+    }
+    /* the iterator of a frozenset is implemented in C */
+    if (depth > 0 && (iter = PyObject_GetIter(obj)) != NULL) {
+      while ((item = PyIter_Next(iter)) != NULL) {
+        size += get_obj_size(item, depth - 1);
+        Py_DECREF(item);
+      }
+      Py_DECREF(iter);
+    }
+    PyErr_Clear();
+  }
+
+  return size;
+}
+
+static entry_t *find_slot(entry_t *tbl, size_t alloc, const void *key,
+                          size_t len, uint32_t hash)
+{
+  size_t mask = alloc - 1;
+  size_t i = hash & mask;
+  while (tbl[i].key != NULL &&
+         (tbl[i].hash != hash || tbl[i].len != len ||
+          memcmp(tbl[i].key, key, len) != 0)) {
+    i = (i + 1) & mask;
+  }
+  return &tbl[i];
+}
+
+/* free all entries of the cache, which must be locked */
+static void clear_locked(pybgpstream_objcache_t *cache)
+{
+  size_t i;
+  for (i = 0; i < cache->alloc; i++) {
+    if (cache->tbl[i].key != NULL) {
+      free(cache->tbl[i].key);
+      Py_DECREF(cache->tbl[i].obj);
+    }
+  }
+  free(cache->tbl);
+  cache->tbl = NULL;
+  cache->alloc = 0;
+  cache->cnt = 0;
+  cache->bytes = 0;
+}
+
+static int grow_locked(pybgpstream_objcache_t *cache)
+{
+  size_t new_alloc = (cache->alloc == 0) ? 64 : cache->alloc * 2;
+  entry_t *new_tbl;
+  entry_t *slot;
+  size_t i;
+
+  if ((new_tbl = calloc(new_alloc, sizeof(entry_t))) == NULL) {
+    return -1;
+  }
+  for (i = 0; i < cache->alloc; i++) {
+    if (cache->tbl[i].key != NULL) {
+      slot = find_slot(new_tbl, new_alloc, cache->tbl[i].key,
+                       cache->tbl[i].len, cache->tbl[i].hash);
+      *slot = cache->tbl[i];
+    }
+  }
+  free(cache->tbl);
+  cache->tbl = new_tbl;
+  cache->alloc = new_alloc;
+  return 0;
+}
+
+int pybgpstream_objcache_enabled(pybgpstream_objcache_t *cache)
+{
+  int enabled;
+
+  PYBGPSTREAM_MUTEX_LOCK(&cache->mutex);
+  enabled = (cache->max != 0);
+  PYBGPSTREAM_MUTEX_UNLOCK(&cache->mutex);
+
+  return enabled;
+}
+
+PyObject *pybgpstream_objcache_get(pybgpstream_objcache_t *cache,
+                                   const void *key, size_t len, uint32_t hash)
+{
+  entry_t *slot;
+  PyObject *obj = NULL;
+
+  PYBGPSTREAM_MUTEX_LOCK(&cache->mutex);
+  if (cache->max == 0) {
+    PYBGPSTREAM_MUTEX_UNLOCK(&cache->mutex);
+    return NULL;
+  }
+  if (cache->alloc != 0) {
+    slot = find_slot(cache->tbl, cache->alloc, key, len, hash);
+    if (slot->key != NULL) {
+      obj = slot->obj;
+      Py_INCREF(obj);
+    }
+  }
+  if (obj != NULL) {
+    cache->hits++;
+  } else {
+    cache->misses++;
+  }
+  PYBGPSTREAM_MUTEX_UNLOCK(&cache->mutex);
+
+  return obj;
+}
+
+void pybgpstream_objcache_add(pybgpstream_objcache_t *cache, const void *key,
+                              size_t len, uint32_t hash, PyObject *obj)
+{
+  entry_t *slot;
+  uint8_t *key_copy;
+  size_t bytes;
+
+  if (cache->max == 0 || len > UINT32_MAX) {
+    return;
+  }
+
+  /* done before locking as it iterates over frozensets */
+  bytes = len + get_obj_size(obj, 2);
+  if ((key_copy = malloc(len == 0 ? 1 : len)) == NULL) {
+    return;
+  }
+  memcpy(key_copy, key, len);
+
+  PYBGPSTREAM_MUTEX_LOCK(&cache->mutex);
+  if (cache->max == 0) {
+    goto skip;
+  }
+  if (cache->cnt >= cache->max) {
+    cache->flushes++;
+    clear_locked(cache);
+  }
+  if ((cache->cnt + 1) * 2 > cache->alloc && grow_locked(cache) != 0) {
+    goto skip;
+  }
+  slot = find_slot(cache->tbl, cache->alloc, key, len, hash);
+  if (slot->key != NULL) {
+    /* another thread added it in the meantime */
+    goto skip;
+  }
+  slot->hash = hash;
+  slot->len = (uint32_t)len;
+  slot->key = key_copy;
+  slot->bytes = bytes;
+  Py_INCREF(obj);
+  slot->obj = obj;
+  cache->cnt++;
+  cache->bytes += bytes;
+  PYBGPSTREAM_MUTEX_UNLOCK(&cache->mutex);
+  return;
+
+skip:
+  PYBGPSTREAM_MUTEX_UNLOCK(&cache->mutex);
+  free(key_copy);
+}
+
+void pybgpstream_objcache_set_size(pybgpstream_objcache_t *cache, size_t max)
+{
+  PYBGPSTREAM_MUTEX_LOCK(&cache->mutex);
+  clear_locked(cache);
+  cache->max = max;
+  PYBGPSTREAM_MUTEX_UNLOCK(&cache->mutex);
+}
+
+void pybgpstream_objcache_clear(pybgpstream_objcache_t *cache)
+{
+  PYBGPSTREAM_MUTEX_LOCK(&cache->mutex);
+  clear_locked(cache);
+  PYBGPSTREAM_MUTEX_UNLOCK(&cache->mutex);
+}
+
+PyObject *pybgpstream_objcache_get_stats(pybgpstream_objcache_t *cache)
+{
+  size_t cnt, max, bytes;
+  unsigned long long hits, misses, flushes;
+
+  PYBGPSTREAM_MUTEX_LOCK(&cache->mutex);
+  cnt = cache->cnt;
+  max = cache->max;
+  hits = cache->hits;
+  misses = cache->misses;
+  flushes = cache->flushes;
+  bytes = cache->alloc * sizeof(entry_t) + cache->bytes;
+  PYBGPSTREAM_MUTEX_UNLOCK(&cache->mutex);
+
+  return Py_BuildValue("{s:n,s:n,s:K,s:K,s:d,s:K,s:n}", "size",
+                       (Py_ssize_t)cnt, "max_size", (Py_ssize_t)max, "hits",
+                       hits, "misses", misses, "hit_rate",
+                       (hits + misses) == 0
+                         ? 0.0
+                         : (double)hits / (double)(hits + misses),
+                       "flushes", flushes, "memory", (Py_ssize_t)bytes);
+}
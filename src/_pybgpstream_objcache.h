@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_OBJCACHE_H
+#define ___PYBGPSTREAM_OBJCACHE_H
+
+#include "pyutils.h"
+#include <Python.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** A bounded cache of immutable objects keyed on their binary source
+ *
+ * Many field values repeat over and over in a stream (the same community
+ * set is usually attached to every update of a peer), so rather than
+ * building the same object again, the caller looks the raw libbgpstream
+ * value up here first and shares the object built the first time. When the
+ * cache is full it is flushed, so that it follows the values currently seen
+ * in the stream rather than those seen first.
+ */
+typedef struct pybgpstream_objcache {
+
+  /** Open-addressing table of entries */
+  struct pybgpstream_objcache_entry *tbl;
+
+  /** Number of slots in tbl (always a power of two) */
+  size_t alloc;
+
+  /** Number of used slots in tbl */
+  size_t cnt;
+
+  /** Maximum number of entries kept (0 disables the cache) */
+  size_t max;
+
+  /** Number of lookups that found a shared object */
+  uint64_t hits;
+
+  /** Number of lookups that did not */
+  uint64_t misses;
+
+  /** Number of times the cache was flushed because it was full */
+  uint64_t flushes;
+
+  /** Bytes used by the keys and (approximately) the cached objects */
+  size_t bytes;
+
+  /** Protects all of the fields above (on free-threaded builds) */
+  PYBGPSTREAM_MUTEX mutex;
+
+} pybgpstream_objcache_t;
+
+/** Static initializer for a cache of at most max entries */
+#define PYBGPSTREAM_OBJCACHE_INIT(max)                                         \
+  { NULL, 0, 0, (max), 0, 0, 0, 0 }
+
+/** Check whether the given cache is enabled
+ *
+ * @param cache         pointer to the cache
+ * @return 1 if the cache keeps objects, 0 if it is disabled
+ *
+ * Lets callers skip building a key for a disabled cache.
+ */
+int pybgpstream_objcache_enabled(pybgpstream_objcache_t *cache);
+
+/** Look up the object cached for the given key
+ *
+ * @param cache         pointer to the cache
+ * @param key           pointer to the key
+ * @param len           length of the key in bytes
+ * @param hash          hash of the key (see pybgpstream_hash)
+ * @return new reference to the cached object, or NULL if there is none (no
+ *         exception is set in this case)
+ */
+PyObject *pybgpstream_objcache_get(pybgpstream_objcache_t *cache,
+                                   const void *key, size_t len, uint32_t hash);
+
+/** Add an object to the cache
+ *
+ * @param cache         pointer to the cache
+ * @param key           pointer to the key
+ * @param len           length of the key in bytes
+ * @param hash          hash of the key (see pybgpstream_hash)
+ * @param obj           object to share (the cache takes its own reference)
+ *
+ * The object must be immutable. Failing to add it (e.g., because memory is
+ * short) is not an error, the object is just not shared.
+ */
+void pybgpstream_objcache_add(pybgpstream_objcache_t *cache, const void *key,
+                              size_t len, uint32_t hash, PyObject *obj);
+
+/** Change the maximum number of entries of the given cache
+ *
+ * @param cache         pointer to the cache
+ * @param max           new maximum number of entries (0 disables the cache)
+ *
+ * The cache is flushed.
+ */
+void pybgpstream_objcache_set_size(pybgpstream_objcache_t *cache, size_t max);
+
+/** Release all objects held by the given cache */
+void pybgpstream_objcache_clear(pybgpstream_objcache_t *cache);
+
+/** Get a dictionary with the statistics of the given cache
+ *
+ * @param cache         pointer to the cache
+ * @return new reference to a dict with the "size", "max_size", "hits",
+ *         "misses", "hit_rate", "flushes" and "memory" (in bytes) of the
+ *         cache, or NULL if an error occurred
+ */
+PyObject *pybgpstream_objcache_get_stats(pybgpstream_objcache_t *cache);
+
+#endif /* ___PYBGPSTREAM_OBJCACHE_H */
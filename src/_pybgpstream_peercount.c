@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_peercount.h"
+#include "_pybgpstream_module.h"
+#include "_pybgpstream_utils.h"
+#include <Python.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* row kinds (rows of both tables share the hash table) */
+#define ROW_COLLECTOR 0
+#define ROW_PEER 1
+
+typedef struct {
+
+  /** Start time of the bucket */
+  uint32_t bucket;
+
+  /** Peer ASN (0 for collector rows) */
+  uint32_t peer_asn;
+
+  /** Indexes of the project and collector names */
+  uint16_t project;
+  uint16_t collector;
+
+  /** ROW_COLLECTOR or ROW_PEER */
+  uint8_t kind;
+
+  /** Peer address version (4 or 6, 0 for collector rows) */
+  uint8_t version;
+
+  /** Peer address (network byte order) */
+  uint8_t addr[16];
+
+} row_key_t;
+
+typedef struct {
+
+  /** Key of the row (all padding is zeroed so keys can be memcmp'd) */
+  row_key_t key;
+
+  /** Whether the slot is used */
+  int used;
+
+  /** Counters */
+  uint64_t elem_cnt;
+  uint64_t record_cnt;
+
+  /** Sequence number of the last record counted for this row */
+  uint64_t last_record;
+
+} row_t;
+
+typedef struct {
+
+  /** Open-addressing table of rows */
+  row_t *rows;
+  size_t rows_alloc;
+  size_t rows_cnt;
+
+  /** Distinct project and collector names */
+  pybgpstream_names_t names;
+
+} peercount_t;
+
+static row_t *find_slot(row_t *rows, size_t alloc, const row_key_t *key)
+{
+  size_t mask = alloc - 1;
+  size_t i = pybgpstream_hash(key, sizeof(row_key_t)) & mask;
+  while (rows[i].used && memcmp(&rows[i].key, key, sizeof(row_key_t)) != 0) {
+    i = (i + 1) & mask;
+  }
+  return &rows[i];
+}
+
+static int grow(peercount_t *pc)
+{
+  size_t new_alloc = (pc->rows_alloc == 0) ? 1024 : pc->rows_alloc * 2;
+  row_t *new_rows;
+  size_t i;
+
+  if ((new_rows = calloc(new_alloc, sizeof(row_t))) == NULL) {
+    return -1;
+  }
+  for (i = 0; i < pc->rows_alloc; i++) {
+    if (pc->rows[i].used) {
+      *find_slot(new_rows, new_alloc, &pc->rows[i].key) = pc->rows[i];
+    }
+  }
+  free(pc->rows);
+  pc->rows = new_rows;
+  pc->rows_alloc = new_alloc;
+  return 0;
+}
+
+/* get the row for the given key, creating it if needed */
+static row_t *get_row(peercount_t *pc, const row_key_t *key)
+{
+  row_t *row;
+
+  if ((pc->rows_cnt + 1) * 2 > pc->rows_alloc && grow(pc) != 0) {
+    return NULL;
+  }
+  row = find_slot(pc->rows, pc->rows_alloc, key);
+  if (!row->used) {
+    row->key = *key;
+    row->used = 1;
+    pc->rows_cnt++;
+  }
+  return row;
+}
+
+static void peercount_clear(peercount_t *pc)
+{
+  pybgpstream_names_clear(&pc->names);
+  free(pc->rows);
+}
+
+/* count the rest of the stream (no Python API calls) */
+static int count(peercount_t *pc, pybgpstream_reader_t *reader,
+                 uint32_t bucket_size, const char **err)
+{
+  bgpstream_elem_t *elem;
+  row_key_t key;
+  row_t *row;
+  uint64_t record_seq = 0;
+  uint64_t elem_cnt;
+  int project, collector;
+  int ret;
+
+  while ((ret = pybgpstream_reader_next_record(reader)) > 0) {
+    if (reader->rec->status != BGPSTREAM_RECORD_STATUS_VALID_RECORD) {
+      continue;
+    }
+    record_seq++;
+
+    if ((project = pybgpstream_names_get_idx(
+           &pc->names, reader->rec->project_name, UINT16_MAX)) < 0 ||
+        (collector = pybgpstream_names_get_idx(
+           &pc->names, reader->rec->collector_name, UINT16_MAX)) < 0) {
+      *err = "Could not add project/collector name";
+      return -1;
+    }
+
+    memset(&key, 0, sizeof(key));
+    key.bucket = (bucket_size == 0) ?
+      0 : reader->rec->time_sec - (reader->rec->time_sec % bucket_size);
+    key.project = project;
+    key.collector = collector;
+    key.kind = ROW_PEER;
+    elem_cnt = 0;
+
+    while ((ret = pybgpstream_reader_next_elem(reader, &elem)) > 0) {
+      key.peer_asn = elem->peer_asn;
+      memset(key.addr, 0, sizeof(key.addr));
+      if (elem->peer_ip.version == BGPSTREAM_ADDR_VERSION_IPV4) {
+        key.version = 4;
+        memcpy(key.addr, &elem->peer_ip.bs_ipv4.addr, 4);
+      } else if (elem->peer_ip.version == BGPSTREAM_ADDR_VERSION_IPV6) {
+        key.version = 6;
+        memcpy(key.addr, &elem->peer_ip.bs_ipv6.addr, 16);
+      } else {
+        key.version = 0;
+      }
+
+      if ((row = get_row(pc, &key)) == NULL) {
+        *err = "Could not add peer row";
+        return -1;
+      }
+      row->elem_cnt++;
+      if (row->last_record != record_seq) {
+        row->last_record = record_seq;
+        row->record_cnt++;
+      }
+      elem_cnt++;
+    }
+    if (ret < 0) {
+      *err = "Could not get next elem";
+      return -1;
+    }
+
+    /* records without elems (e.g. when all of them were filtered out) are
+       not counted for the collector either */
+    if (elem_cnt == 0) {
+      continue;
+    }
+    key.kind = ROW_COLLECTOR;
+    key.peer_asn = 0;
+    key.version = 0;
+    memset(key.addr, 0, sizeof(key.addr));
+    if ((row = get_row(pc, &key)) == NULL) {
+      *err = "Could not add collector row";
+      return -1;
+    }
+    row->record_cnt++;
+  }
+  if (ret < 0) {
+    *err = "Could not get next record (is the stream started?)";
+    return -1;
+  }
+
+  return 0;
+}
+
+static PyObject *get_peer_address(const row_key_t *key,
+                                  pybgpstream_addr_format_t addr_format)
+{
+  bgpstream_ip_addr_t ip;
+
+  memset(&ip, 0, sizeof(ip));
+  if (key->version == 4) {
+    ip.version = BGPSTREAM_ADDR_VERSION_IPV4;
+    memcpy(&ip.bs_ipv4.addr, key->addr, 4);
+  } else if (key->version == 6) {
+    ip.version = BGPSTREAM_ADDR_VERSION_IPV6;
+    memcpy(&ip.bs_ipv6.addr, key->addr, 16);
+  } else {
+    Py_RETURN_NONE;
+  }
+  return get_ip_pyobj(&ip, addr_format);
+}
+
+static PyObject *build_result(peercount_t *pc,
+                              pybgpstream_addr_format_t addr_format)
+{
+  PyObject *peers = NULL;
+  PyObject *collectors = NULL;
+  PyObject **names = NULL;
+  PyObject *key;
+  PyObject *value;
+  row_t *row;
+  size_t i;
+  int j;
+  int err;
+
+  if ((peers = PyDict_New()) == NULL ||
+      (collectors = PyDict_New()) == NULL ||
+      (names = PyMem_Malloc(sizeof(PyObject *) * (pc->names.cnt + 1))) ==
+        NULL) {
+    goto err;
+  }
+  memset(names, 0, sizeof(PyObject *) * (pc->names.cnt + 1));
+  for (j = 0; j < pc->names.cnt; j++) {
+    if ((names[j] = _pybgpstream_intern_str(pc->names.names[j])) == NULL) {
+      goto err;
+    }
+  }
+
+  for (i = 0; i < pc->rows_alloc; i++) {
+    row = &pc->rows[i];
+    if (!row->used) {
+      continue;
+    }
+    if (row->key.kind == ROW_COLLECTOR) {
+      key = Py_BuildValue("(kOO)", (unsigned long)row->key.bucket,
+                          names[row->key.project], names[row->key.collector]);
+      value = PyLong_FromUnsignedLongLong(row->record_cnt);
+    } else {
+      key = Py_BuildValue("(kOOkN)", (unsigned long)row->key.bucket,
+                          names[row->key.project], names[row->key.collector],
+                          (unsigned long)row->key.peer_asn,
+                          get_peer_address(&row->key, addr_format));
+      value = Py_BuildValue("(KK)", (unsigned long long)row->elem_cnt,
+                            (unsigned long long)row->record_cnt);
+    }
+    err = (key == NULL || value == NULL ||
+           PyDict_SetItem(row->key.kind == ROW_COLLECTOR ? collectors : peers,
+                          key, value) != 0);
+    Py_XDECREF(key);
+    Py_XDECREF(value);
+    if (err) {
+      goto err;
+    }
+  }
+
+  for (j = 0; j < pc->names.cnt; j++) {
+    Py_XDECREF(names[j]);
+  }
+  PyMem_Free(names);
+
+  return Py_BuildValue("{s:N,s:N}", "peers", peers, "collectors",
+                       collectors);
+
+err:
+  if (names != NULL) {
+    for (j = 0; j < pc->names.cnt; j++) {
+      Py_XDECREF(names[j]);
+    }
+    PyMem_Free(names);
+  }
+  Py_XDECREF(peers);
+  Py_XDECREF(collectors);
+  return NULL;
+}
+
+PyObject *_pybgpstream_peercount_run(pybgpstream_reader_t *reader,
+                                     uint32_t bucket_size,
+                                     pybgpstream_addr_format_t addr_format)
+{
+  peercount_t pc;
+  const char *err = NULL;
+  PyObject *result;
+  int ret;
+
+  memset(&pc, 0, sizeof(pc));
+
+  Py_BEGIN_ALLOW_THREADS;
+  ret = count(&pc, reader, bucket_size, &err);
+  pybgpstream_reader_clear(reader);
+  Py_END_ALLOW_THREADS;
+
+  if (ret != 0) {
+    peercount_clear(&pc);
+    PyErr_SetString(PyExc_RuntimeError, err);
+    return NULL;
+  }
+
+  result = build_result(&pc, addr_format);
+  peercount_clear(&pc);
+  return result;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_PEERCOUNT_H
+#define ___PYBGPSTREAM_PEERCOUNT_H
+
+#include "_pybgpstream_reader.h"
+#include "pyutils.h"
+#include <Python.h>
+#include <stdint.h>
+
+/** Count the elems and records of every peer in the rest of a stream
+ *
+ * @param reader        pointer to the reader to drain
+ * @param bucket_size   size of the time buckets in seconds (0 to put all
+ *                      records in a single bucket)
+ * @param addr_format   representation of the peer addresses in the result
+ * @return new reference to a dict with a "peers" and a "collectors" table,
+ *         or NULL if an error occurred
+ *
+ * The "peers" table maps (bucket, project, collector, peer_asn,
+ * peer_address) to (elem_cnt, record_cnt), where record_cnt is the number of
+ * records with at least one elem from the peer. The "collectors" table maps
+ * (bucket, project, collector) to the number of records with at least one
+ * elem. Only valid records are counted. All counting is done with the GIL
+ * released, and no record or elem objects are created.
+ */
+PyObject *_pybgpstream_peercount_run(pybgpstream_reader_t *reader,
+                                     uint32_t bucket_size,
+                                     pybgpstream_addr_format_t addr_format);
+
+#endif /* ___PYBGPSTREAM_PEERCOUNT_H */
@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_pfxtrie.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* nodes are referred to by their index in the node array, and index 0 is
+   never used so that it can stand for "no node" */
+#define NO_NODE 0
+
+typedef struct {
+
+  /** Children (for the next bit being 0 and 1) */
+  uint32_t child[2];
+
+  /** Address of the prefix (bits past len are zeroed) */
+  uint8_t addr[16];
+
+  /** Length of the prefix */
+  uint8_t len;
+
+  /** Match flags of the prefix (0 for nodes that only join two branches) */
+  uint8_t match;
+
+  /** Union of the match flags of the node and all its descendants */
+  uint8_t sub_match;
+
+} node_t;
+
+struct pybgpstream_pfxtrie {
+
+  /** Nodes (the first one is unused) */
+  node_t *nodes;
+  uint32_t nodes_cnt;
+  uint32_t nodes_alloc;
+
+  /** Roots of the IPv4 and IPv6 tries */
+  uint32_t root[2];
+
+  /** Number of prefixes */
+  size_t size;
+
+  /** Number of references held to the trie */
+  int refcnt;
+};
+
+/* Get the address bytes, maximum length and root index of a prefix, or
+   return -1 for prefixes of an unknown version */
+static int get_pfx_info(const bgpstream_pfx_t *pfx, const uint8_t **addr,
+                        int *max_len)
+{
+  if (pfx->address.version == BGPSTREAM_ADDR_VERSION_IPV4) {
+    *addr = (const uint8_t *)&pfx->address.bs_ipv4.addr;
+    *max_len = 32;
+    return 0;
+  }
+  if (pfx->address.version == BGPSTREAM_ADDR_VERSION_IPV6) {
+    *addr = (const uint8_t *)&pfx->address.bs_ipv6.addr;
+    *max_len = 128;
+    return 1;
+  }
+  return -1;
+}
+
+static int get_bit(const uint8_t *addr, int bit)
+{
+  return (addr[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+/* length of the longest common prefix of a and b, up to max_len bits */
+static int get_common_len(const uint8_t *a, const uint8_t *b, int max_len)
+{
+  int len = 0;
+  uint8_t diff;
+  int i;
+
+  for (i = 0; len < max_len; i++, len += 8) {
+    if ((diff = a[i] ^ b[i]) != 0) {
+      while ((diff & 0x80) == 0) {
+        diff <<= 1;
+        len++;
+      }
+      break;
+    }
+  }
+  return (len < max_len) ? len : max_len;
+}
+
+static uint32_t new_node(pybgpstream_pfxtrie_t *trie, const uint8_t *addr,
+                         int len, uint8_t match)
+{
+  node_t *node = &trie->nodes[trie->nodes_cnt];
+  int bytes = (len + 7) / 8;
+
+  memset(node, 0, sizeof(node_t));
+  memcpy(node->addr, addr, bytes);
+  if ((len & 7) != 0) {
+    node->addr[bytes - 1] &= (uint8_t)(0xff << (8 - (len & 7)));
+  }
+  node->len = (uint8_t)len;
+  node->match = match;
+  node->sub_match = match;
+  if (match != 0) {
+    trie->size++;
+  }
+  return trie->nodes_cnt++;
+}
+
+pybgpstream_pfxtrie_t *pybgpstream_pfxtrie_create()
+{
+  pybgpstream_pfxtrie_t *trie;
+
+  if ((trie = calloc(1, sizeof(pybgpstream_pfxtrie_t))) == NULL) {
+    return NULL;
+  }
+  trie->nodes_cnt = 1;
+  trie->refcnt = 1;
+  return trie;
+}
+
+void pybgpstream_pfxtrie_incref(pybgpstream_pfxtrie_t *trie)
+{
+  __atomic_fetch_add(&trie->refcnt, 1, __ATOMIC_RELAXED);
+}
+
+void pybgpstream_pfxtrie_destroy(pybgpstream_pfxtrie_t *trie)
+{
+  if (trie == NULL ||
+      __atomic_sub_fetch(&trie->refcnt, 1, __ATOMIC_ACQ_REL) != 0) {
+    return;
+  }
+  free(trie->nodes);
+  free(trie);
+}
+
+int pybgpstream_pfxtrie_insert(pybgpstream_pfxtrie_t *trie,
+                               const bgpstream_pfx_t *pfx, uint8_t match)
+{
+  const uint8_t *addr;
+  int max_len;
+  int len = pfx->mask_len;
+  int common;
+  int v;
+  uint32_t *link;
+  uint32_t idx;
+  uint32_t glue;
+  node_t *node;
+  node_t *tmp;
+
+  if ((v = get_pfx_info(pfx, &addr, &max_len)) < 0 || len > max_len ||
+      match == 0) {
+    return -1;
+  }
+
+  /* make room for the (at most two) new nodes first, so that pointers into
+     the node array stay valid */
+  if (trie->nodes_cnt + 2 > trie->nodes_alloc) {
+    if (trie->nodes_alloc >= UINT32_MAX / 2) {
+      return -1;
+    }
+    trie->nodes_alloc = (trie->nodes_alloc == 0) ? 1024 :
+                                                   trie->nodes_alloc * 2;
+    if ((tmp = realloc(trie->nodes, sizeof(node_t) * trie->nodes_alloc)) ==
+        NULL) {
+      return -1;
+    }
+    trie->nodes = tmp;
+  }
+
+  link = &trie->root[v];
+  while (*link != NO_NODE) {
+    node = &trie->nodes[*link];
+    common = get_common_len(addr, node->addr,
+                            (len < node->len) ? len : node->len);
+
+    if (common < node->len) {
+      /* the prefix diverges from the node, or is an ancestor of it */
+      if (common == len) {
+        idx = new_node(trie, addr, len, match);
+        trie->nodes[idx].child[get_bit(node->addr, len)] = *link;
+        trie->nodes[idx].sub_match |= node->sub_match;
+      } else {
+        idx = new_node(trie, addr, len, match);
+        glue = new_node(trie, addr, common, 0);
+        trie->nodes[glue].child[get_bit(addr, common)] = idx;
+        trie->nodes[glue].child[get_bit(node->addr, common)] = *link;
+        trie->nodes[glue].sub_match = node->sub_match | match;
+        idx = glue;
+      }
+      *link = idx;
+      return 0;
+    }
+
+    /* the node is the prefix, or one of its ancestors */
+    node->sub_match |= match;
+    if (node->len == len) {
+      if (node->match == 0) {
+        trie->size++;
+      }
+      node->match |= match;
+      return 0;
+    }
+    link = &node->child[get_bit(addr, node->len)];
+  }
+
+  *link = new_node(trie, addr, len, match);
+  return 0;
+}
+
+int pybgpstream_pfxtrie_match(const pybgpstream_pfxtrie_t *trie,
+                              const bgpstream_pfx_t *pfx)
+{
+  const uint8_t *addr;
+  const node_t *node;
+  int max_len;
+  int len = pfx->mask_len;
+  uint32_t idx;
+  int v;
+
+  if ((v = get_pfx_info(pfx, &addr, &max_len)) < 0 || len > max_len) {
+    return 0;
+  }
+
+  idx = trie->root[v];
+  while (idx != NO_NODE) {
+    node = &trie->nodes[idx];
+
+    if (node->len > len) {
+      /* all the prefixes under the node are more specific than the elem
+         prefix, if they are covered by it at all */
+      return get_common_len(addr, node->addr, len) == len &&
+             (node->sub_match & PYBGPSTREAM_PFXTRIE_MATCH_LESS) != 0;
+    }
+    if (get_common_len(addr, node->addr, node->len) < node->len) {
+      return 0;
+    }
+    if (node->len == len) {
+      /* every match type matches an equal prefix */
+      return node->match != 0 ||
+             (node->sub_match & PYBGPSTREAM_PFXTRIE_MATCH_LESS) != 0;
+    }
+    if ((node->match & PYBGPSTREAM_PFXTRIE_MATCH_MORE) != 0) {
+      return 1;
+    }
+    idx = node->child[get_bit(addr, node->len)];
+  }
+  return 0;
+}
+
+size_t pybgpstream_pfxtrie_get_size(const pybgpstream_pfxtrie_t *trie)
+{
+  return trie->size;
+}
+
+size_t pybgpstream_pfxtrie_get_memory(const pybgpstream_pfxtrie_t *trie)
+{
+  return sizeof(pybgpstream_pfxtrie_t) + sizeof(node_t) * trie->nodes_alloc;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_PFXTRIE_H
+#define ___PYBGPSTREAM_PFXTRIE_H
+
+#include <bgpstream.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Ways an elem prefix can match a prefix of the trie */
+#define PYBGPSTREAM_PFXTRIE_MATCH_EXACT 0x01 /* equal prefixes only */
+#define PYBGPSTREAM_PFXTRIE_MATCH_MORE 0x02  /* equal or more specific */
+#define PYBGPSTREAM_PFXTRIE_MATCH_LESS 0x04  /* equal or less specific */
+#define PYBGPSTREAM_PFXTRIE_MATCH_ANY                                          \
+  (PYBGPSTREAM_PFXTRIE_MATCH_MORE | PYBGPSTREAM_PFXTRIE_MATCH_LESS)
+
+/** Opaque struct holding a set of IPv4 and IPv6 prefixes in a Patricia
+ * (path-compressed radix) trie, each with the ways it can be matched.
+ *
+ * None of these functions touch the Python API.
+ */
+typedef struct pybgpstream_pfxtrie pybgpstream_pfxtrie_t;
+
+/** Create an empty trie
+ *
+ * @return pointer to the trie (holding one reference), or NULL if an error
+ *         occurred
+ */
+pybgpstream_pfxtrie_t *pybgpstream_pfxtrie_create(void);
+
+/** Take a reference to the given trie
+ *
+ * Lets a stream keep using the trie of a prefix filter from a thread that
+ * may outlive the PrefixSet object that created it.
+ */
+void pybgpstream_pfxtrie_incref(pybgpstream_pfxtrie_t *trie);
+
+/** Release a reference to the given trie, destroying it with the last one */
+void pybgpstream_pfxtrie_destroy(pybgpstream_pfxtrie_t *trie);
+
+/** Add a prefix to the given trie
+ *
+ * @param trie          pointer to the trie
+ * @param pfx           prefix to add
+ * @param match         PYBGPSTREAM_PFXTRIE_MATCH_* flags (added to those of
+ *                      the prefix if it is already in the trie)
+ * @return 0 if the prefix was added, -1 if it is invalid or an error
+ *         occurred
+ */
+int pybgpstream_pfxtrie_insert(pybgpstream_pfxtrie_t *trie,
+                               const bgpstream_pfx_t *pfx, uint8_t match);
+
+/** Check whether a prefix matches any prefix of the given trie
+ *
+ * @param trie          pointer to the trie
+ * @param pfx           prefix to look up
+ * @return 1 if the prefix matches, 0 otherwise
+ */
+int pybgpstream_pfxtrie_match(const pybgpstream_pfxtrie_t *trie,
+                              const bgpstream_pfx_t *pfx);
+
+/** Get the number of prefixes in the given trie */
+size_t pybgpstream_pfxtrie_get_size(const pybgpstream_pfxtrie_t *trie);
+
+/** Get the number of bytes of memory used by the given trie */
+size_t pybgpstream_pfxtrie_get_memory(const pybgpstream_pfxtrie_t *trie);
+
+#endif /* ___PYBGPSTREAM_PFXTRIE_H */
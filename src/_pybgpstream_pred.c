@@ -0,0 +1,827 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_pred.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+  NODE_AND,
+  NODE_OR,
+  NODE_NOT,
+  NODE_CMP,           /* field <cmp> value */
+  NODE_IN,            /* field in {values} */
+  NODE_PATH_CONTAINS, /* path contains {values} */
+  NODE_COMMUNITY,     /* community in {patterns} */
+} node_type_t;
+
+typedef enum {
+  FIELD_PEER_ASN,
+  FIELD_ORIGIN_ASN,
+  FIELD_PATH_LEN,
+  FIELD_PREFIX_LEN,
+  FIELD_TYPE,
+} field_t;
+
+typedef enum {
+  CMP_EQ,
+  CMP_NE,
+  CMP_LT,
+  CMP_LE,
+  CMP_GT,
+  CMP_GE,
+} cmp_t;
+
+typedef struct {
+
+  /** Community to match */
+  uint16_t asn;
+  uint16_t value;
+
+  /** Whether the ASN and value must match (0 for "*") */
+  uint8_t match_asn;
+  uint8_t match_value;
+
+} comm_pattern_t;
+
+struct pybgpstream_pred {
+
+  node_type_t type;
+
+  /** Operands of NODE_AND/NODE_OR (and left only for NODE_NOT) */
+  struct pybgpstream_pred *left;
+  struct pybgpstream_pred *right;
+
+  /** Field, comparison and value of NODE_CMP/NODE_IN */
+  field_t field;
+  cmp_t cmp;
+  uint32_t value;
+
+  /** Sorted values of NODE_IN/NODE_PATH_CONTAINS */
+  uint32_t *values;
+  int values_cnt;
+
+  /** Patterns of NODE_COMMUNITY */
+  comm_pattern_t *comms;
+  int comms_cnt;
+};
+
+/* ---------- evaluation ---------- */
+
+#define ELEM_HAS_PREFIX(elem)                                                  \
+  ((elem)->type == BGPSTREAM_ELEM_TYPE_RIB ||                                  \
+   (elem)->type == BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT ||                         \
+   (elem)->type == BGPSTREAM_ELEM_TYPE_WITHDRAWAL)
+
+#define ELEM_HAS_PATH(elem)                                                    \
+  (((elem)->type == BGPSTREAM_ELEM_TYPE_RIB ||                                 \
+    (elem)->type == BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT) &&                       \
+   (elem)->as_path != NULL)
+
+/* number of hops of an AS path, not counting prepended ASNs */
+static uint32_t get_path_len(bgpstream_as_path_t *path)
+{
+  bgpstream_as_path_iter_t iter;
+  bgpstream_as_path_seg_t *seg;
+  uint32_t len = 0;
+  uint32_t asn;
+  uint32_t prev = 0;
+  int have_prev = 0;
+
+  bgpstream_as_path_iter_reset(&iter);
+  while ((seg = bgpstream_as_path_get_next_seg(path, &iter)) != NULL) {
+    if (seg->type != BGPSTREAM_AS_PATH_SEG_ASN) {
+      len++;
+      have_prev = 0;
+      continue;
+    }
+    asn = ((bgpstream_as_path_seg_asn_t *)seg)->asn;
+    if (!have_prev || asn != prev) {
+      len++;
+    }
+    prev = asn;
+    have_prev = 1;
+  }
+  return len;
+}
+
+/* get the value of a field, or return 0 if the elem does not have it */
+static int get_field(const bgpstream_elem_t *elem, field_t field,
+                     uint32_t *val)
+{
+  bgpstream_as_path_seg_t *seg;
+
+  switch (field) {
+  case FIELD_PEER_ASN:
+    *val = elem->peer_asn;
+    return 1;
+
+  case FIELD_ORIGIN_ASN:
+    if (!ELEM_HAS_PATH(elem) ||
+        (seg = bgpstream_as_path_get_origin_seg(elem->as_path)) == NULL ||
+        seg->type != BGPSTREAM_AS_PATH_SEG_ASN) {
+      return 0;
+    }
+    *val = ((bgpstream_as_path_seg_asn_t *)seg)->asn;
+    return 1;
+
+  case FIELD_PATH_LEN:
+    if (!ELEM_HAS_PATH(elem)) {
+      return 0;
+    }
+    *val = get_path_len(elem->as_path);
+    return 1;
+
+  case FIELD_PREFIX_LEN:
+    if (!ELEM_HAS_PREFIX(elem)) {
+      return 0;
+    }
+    *val = elem->prefix.mask_len;
+    return 1;
+
+  case FIELD_TYPE:
+    *val = elem->type;
+    return 1;
+  }
+  return 0;
+}
+
+static int compare(cmp_t cmp, uint32_t a, uint32_t b)
+{
+  switch (cmp) {
+  case CMP_EQ:
+    return a == b;
+  case CMP_NE:
+    return a != b;
+  case CMP_LT:
+    return a < b;
+  case CMP_LE:
+    return a <= b;
+  case CMP_GT:
+    return a > b;
+  case CMP_GE:
+    return a >= b;
+  }
+  return 0;
+}
+
+static int values_contain(const pybgpstream_pred_t *pred, uint32_t val)
+{
+  int lo = 0;
+  int hi = pred->values_cnt - 1;
+  int mid;
+
+  while (lo <= hi) {
+    mid = lo + (hi - lo) / 2;
+    if (pred->values[mid] == val) {
+      return 1;
+    }
+    if (pred->values[mid] < val) {
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return 0;
+}
+
+static int path_contains(const pybgpstream_pred_t *pred,
+                         const bgpstream_elem_t *elem)
+{
+  bgpstream_as_path_iter_t iter;
+  bgpstream_as_path_seg_t *seg;
+  bgpstream_as_path_seg_set_t *set;
+  int i;
+
+  if (!ELEM_HAS_PATH(elem)) {
+    return 0;
+  }
+  bgpstream_as_path_iter_reset(&iter);
+  while ((seg = bgpstream_as_path_get_next_seg(elem->as_path, &iter)) !=
+         NULL) {
+    if (seg->type == BGPSTREAM_AS_PATH_SEG_ASN) {
+      if (values_contain(pred, ((bgpstream_as_path_seg_asn_t *)seg)->asn)) {
+        return 1;
+      }
+      continue;
+    }
+    set = (bgpstream_as_path_seg_set_t *)seg;
+    for (i = 0; i < set->asn_cnt; i++) {
+      if (values_contain(pred, set->asn[i])) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static int has_community(const pybgpstream_pred_t *pred,
+                         const bgpstream_elem_t *elem)
+{
+  bgpstream_community_t *comm;
+  const comm_pattern_t *pat;
+  int cnt;
+  int i, j;
+
+  if ((elem->type != BGPSTREAM_ELEM_TYPE_RIB &&
+       elem->type != BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT) ||
+      elem->communities == NULL) {
+    return 0;
+  }
+  cnt = bgpstream_community_set_size(elem->communities);
+  for (i = 0; i < cnt; i++) {
+    comm = bgpstream_community_set_get(elem->communities, i);
+    for (j = 0; j < pred->comms_cnt; j++) {
+      pat = &pred->comms[j];
+      if ((!pat->match_asn || pat->asn == comm->asn) &&
+          (!pat->match_value || pat->value == comm->value)) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+int pybgpstream_pred_eval(const pybgpstream_pred_t *pred,
+                          const bgpstream_elem_t *elem)
+{
+  uint32_t val;
+
+  switch (pred->type) {
+  case NODE_AND:
+    return pybgpstream_pred_eval(pred->left, elem) &&
+           pybgpstream_pred_eval(pred->right, elem);
+  case NODE_OR:
+    return pybgpstream_pred_eval(pred->left, elem) ||
+           pybgpstream_pred_eval(pred->right, elem);
+  case NODE_NOT:
+    /* conditions on missing fields are false, so their negation is true */
+    return !pybgpstream_pred_eval(pred->left, elem);
+  case NODE_CMP:
+    return get_field(elem, pred->field, &val) &&
+           compare(pred->cmp, val, pred->value);
+  case NODE_IN:
+    return get_field(elem, pred->field, &val) && values_contain(pred, val);
+  case NODE_PATH_CONTAINS:
+    return path_contains(pred, elem);
+  case NODE_COMMUNITY:
+    return has_community(pred, elem);
+  }
+  return 0;
+}
+
+void pybgpstream_pred_destroy(pybgpstream_pred_t *pred)
+{
+  if (pred == NULL) {
+    return;
+  }
+  pybgpstream_pred_destroy(pred->left);
+  pybgpstream_pred_destroy(pred->right);
+  free(pred->values);
+  free(pred->comms);
+  free(pred);
+}
+
+/* ---------- parsing ---------- */
+
+typedef enum {
+  TOK_END,
+  TOK_WORD,
+  TOK_CMP,
+  TOK_LPAREN,
+  TOK_RPAREN,
+  TOK_LBRACE,
+  TOK_RBRACE,
+  TOK_COMMA,
+  TOK_INVALID,
+} token_type_t;
+
+typedef struct {
+
+  /** Expression being parsed */
+  const char *expr;
+
+  /** Current token */
+  token_type_t tok;
+  size_t tok_start;
+  size_t tok_len;
+  cmp_t tok_cmp;
+
+  /** Error message buffer (set on the first error) */
+  char *err;
+  size_t err_len;
+  int failed;
+
+} parser_t;
+
+static const char *field_names[] = {"peer-asn", "origin-asn", "path-len",
+                                    "prefix-len", "type", NULL};
+
+static const char *type_names[] = {"rib", "announcement", "withdrawal",
+                                   "peerstate", NULL};
+static const bgpstream_elem_type_t type_vals[] = {
+  BGPSTREAM_ELEM_TYPE_RIB, BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT,
+  BGPSTREAM_ELEM_TYPE_WITHDRAWAL, BGPSTREAM_ELEM_TYPE_PEERSTATE};
+
+static void parse_error(parser_t *p, const char *fmt, ...)
+{
+  va_list ap;
+  int len;
+
+  if (p->failed) {
+    return;
+  }
+  p->failed = 1;
+  len = snprintf(p->err, p->err_len, "at position %d: ", (int)p->tok_start);
+  if (len < 0 || (size_t)len >= p->err_len) {
+    return;
+  }
+  va_start(ap, fmt);
+  vsnprintf(p->err + len, p->err_len - len, fmt, ap);
+  va_end(ap);
+}
+
+static int is_word_char(char c)
+{
+  return isalnum((unsigned char)c) ||
+         (c != '\0' && strchr("-_:*.", c) != NULL);
+}
+
+static void next_token(parser_t *p)
+{
+  const char *s = p->expr;
+  size_t i = p->tok_start + p->tok_len;
+
+  while (isspace((unsigned char)s[i])) {
+    i++;
+  }
+  p->tok_start = i;
+  p->tok_len = 1;
+
+  switch (s[i]) {
+  case '\0':
+    p->tok = TOK_END;
+    p->tok_len = 0;
+    return;
+  case '(':
+    p->tok = TOK_LPAREN;
+    return;
+  case ')':
+    p->tok = TOK_RPAREN;
+    return;
+  case '{':
+    p->tok = TOK_LBRACE;
+    return;
+  case '}':
+    p->tok = TOK_RBRACE;
+    return;
+  case ',':
+    p->tok = TOK_COMMA;
+    return;
+  case '=':
+    p->tok = TOK_CMP;
+    p->tok_cmp = CMP_EQ;
+    p->tok_len = (s[i + 1] == '=') ? 2 : 1;
+    return;
+  case '!':
+    p->tok = (s[i + 1] == '=') ? TOK_CMP : TOK_INVALID;
+    p->tok_cmp = CMP_NE;
+    p->tok_len = 2;
+    return;
+  case '<':
+  case '>':
+    p->tok = TOK_CMP;
+    if (s[i + 1] == '=') {
+      p->tok_cmp = (s[i] == '<') ? CMP_LE : CMP_GE;
+      p->tok_len = 2;
+    } else {
+      p->tok_cmp = (s[i] == '<') ? CMP_LT : CMP_GT;
+    }
+    return;
+  }
+
+  if (!is_word_char(s[i])) {
+    p->tok = TOK_INVALID;
+    return;
+  }
+  p->tok = TOK_WORD;
+  while (is_word_char(s[i + p->tok_len])) {
+    p->tok_len++;
+  }
+}
+
+static int tok_is(parser_t *p, const char *word)
+{
+  return p->tok == TOK_WORD && strlen(word) == p->tok_len &&
+         strncmp(p->expr + p->tok_start, word, p->tok_len) == 0;
+}
+
+static int tok_lookup(parser_t *p, const char **words)
+{
+  int i;
+  for (i = 0; words[i] != NULL; i++) {
+    if (tok_is(p, words[i])) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int expect(parser_t *p, token_type_t tok, const char *what)
+{
+  if (p->tok != tok) {
+    parse_error(p, "expected %s", what);
+    return -1;
+  }
+  next_token(p);
+  return 0;
+}
+
+static pybgpstream_pred_t *new_node(parser_t *p, node_type_t type)
+{
+  pybgpstream_pred_t *node;
+
+  if ((node = calloc(1, sizeof(pybgpstream_pred_t))) == NULL) {
+    parse_error(p, "out of memory");
+    return NULL;
+  }
+  node->type = type;
+  return node;
+}
+
+/* parse an unsigned 32-bit integer (or an elem type name for the type
+   field) from the current token */
+static int parse_value(parser_t *p, field_t field, uint32_t *val)
+{
+  char buf[16];
+  char *end;
+  unsigned long v;
+  int i;
+
+  if (p->tok != TOK_WORD) {
+    parse_error(p, "expected a value");
+    return -1;
+  }
+  if (field == FIELD_TYPE) {
+    if ((i = tok_lookup(p, type_names)) < 0) {
+      parse_error(p, "unknown elem type '%.*s'", (int)p->tok_len,
+                  p->expr + p->tok_start);
+      return -1;
+    }
+    *val = type_vals[i];
+    next_token(p);
+    return 0;
+  }
+
+  if (p->tok_len >= sizeof(buf) ||
+      !isdigit((unsigned char)p->expr[p->tok_start])) {
+    parse_error(p, "invalid number '%.*s'", (int)p->tok_len,
+                p->expr + p->tok_start);
+    return -1;
+  }
+  memcpy(buf, p->expr + p->tok_start, p->tok_len);
+  buf[p->tok_len] = '\0';
+  errno = 0;
+  v = strtoul(buf, &end, 10);
+  if (*end != '\0' || errno != 0 || v > UINT32_MAX) {
+    parse_error(p, "invalid number '%s'", buf);
+    return -1;
+  }
+  *val = (uint32_t)v;
+  next_token(p);
+  return 0;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* parse a single value or a {v1, v2, ...} list into node->values */
+static int parse_values(parser_t *p, field_t field, pybgpstream_pred_t *node,
+                        int allow_single)
+{
+  int alloc = 0;
+  uint32_t val;
+  uint32_t *tmp;
+  int list = (p->tok == TOK_LBRACE);
+
+  if (!list && !allow_single) {
+    parse_error(p, "expected '{'");
+    return -1;
+  }
+  if (list) {
+    next_token(p);
+  }
+  do {
+    if (node->values_cnt > 0 && expect(p, TOK_COMMA, "',' or '}'") != 0) {
+      return -1;
+    }
+    if (parse_value(p, field, &val) != 0) {
+      return -1;
+    }
+    if (node->values_cnt == alloc) {
+      alloc = (alloc == 0) ? 8 : alloc * 2;
+      if ((tmp = realloc(node->values, sizeof(uint32_t) * alloc)) == NULL) {
+        parse_error(p, "out of memory");
+        return -1;
+      }
+      node->values = tmp;
+    }
+    node->values[node->values_cnt++] = val;
+  } while (list && p->tok != TOK_RBRACE);
+  if (list) {
+    next_token(p);
+  }
+
+  qsort(node->values, node->values_cnt, sizeof(uint32_t), compare_u32);
+  return 0;
+}
+
+/* parse one half of a community pattern ("*" or a 16-bit number) */
+static int parse_comm_half(const char *s, size_t len, uint16_t *val,
+                           uint8_t *match)
+{
+  unsigned long v = 0;
+  size_t i;
+
+  if (len == 1 && s[0] == '*') {
+    *match = 0;
+    return 0;
+  }
+  if (len == 0 || len > 5) {
+    return -1;
+  }
+  for (i = 0; i < len; i++) {
+    if (!isdigit((unsigned char)s[i])) {
+      return -1;
+    }
+    v = v * 10 + (s[i] - '0');
+  }
+  if (v > UINT16_MAX) {
+    return -1;
+  }
+  *val = (uint16_t)v;
+  *match = 1;
+  return 0;
+}
+
+static int parse_comm(parser_t *p, comm_pattern_t *pat)
+{
+  const char *s = p->expr + p->tok_start;
+  const char *colon;
+
+  if (p->tok != TOK_WORD ||
+      (colon = memchr(s, ':', p->tok_len)) == NULL ||
+      parse_comm_half(s, colon - s, &pat->asn, &pat->match_asn) != 0 ||
+      parse_comm_half(colon + 1, p->tok_len - (colon - s) - 1, &pat->value,
+                      &pat->match_value) != 0) {
+    parse_error(p, "invalid community '%.*s' (expected asn:value, where "
+                   "either can be *)",
+                (int)p->tok_len, s);
+    return -1;
+  }
+  next_token(p);
+  return 0;
+}
+
+static int parse_comms(parser_t *p, pybgpstream_pred_t *node)
+{
+  int alloc = 0;
+  comm_pattern_t *tmp;
+  int list = (p->tok == TOK_LBRACE);
+
+  if (list) {
+    next_token(p);
+  }
+  do {
+    if (node->comms_cnt > 0 && expect(p, TOK_COMMA, "',' or '}'") != 0) {
+      return -1;
+    }
+    if (node->comms_cnt == alloc) {
+      alloc = (alloc == 0) ? 8 : alloc * 2;
+      if ((tmp = realloc(node->comms, sizeof(comm_pattern_t) * alloc)) ==
+          NULL) {
+        parse_error(p, "out of memory");
+        return -1;
+      }
+      node->comms = tmp;
+    }
+    if (parse_comm(p, &node->comms[node->comms_cnt]) != 0) {
+      return -1;
+    }
+    node->comms_cnt++;
+  } while (list && p->tok != TOK_RBRACE);
+  if (list) {
+    next_token(p);
+  }
+  return 0;
+}
+
+static pybgpstream_pred_t *parse_or(parser_t *p);
+
+/* cond := FIELD CMP VALUE | FIELD "in" LIST
+         | "path" "contains" (VALUE | LIST)
+         | "community" ("in")? (COMM | COMM_LIST) */
+static pybgpstream_pred_t *parse_cond(parser_t *p)
+{
+  pybgpstream_pred_t *node = NULL;
+  int field;
+
+  if (tok_is(p, "path")) {
+    next_token(p);
+    if (!tok_is(p, "contains")) {
+      parse_error(p, "expected 'contains'");
+      return NULL;
+    }
+    next_token(p);
+    if ((node = new_node(p, NODE_PATH_CONTAINS)) == NULL ||
+        parse_values(p, FIELD_PEER_ASN, node, 1) != 0) {
+      goto err;
+    }
+    return node;
+  }
+
+  if (tok_is(p, "community")) {
+    next_token(p);
+    if (tok_is(p, "in")) {
+      next_token(p);
+      if (p->tok != TOK_LBRACE) {
+        parse_error(p, "expected '{'");
+        return NULL;
+      }
+    }
+    if ((node = new_node(p, NODE_COMMUNITY)) == NULL ||
+        parse_comms(p, node) != 0) {
+      goto err;
+    }
+    return node;
+  }
+
+  if ((field = tok_lookup(p, field_names)) < 0) {
+    parse_error(p, "expected a field name, 'path', 'community', 'not' or "
+                   "'('");
+    return NULL;
+  }
+  next_token(p);
+
+  if (tok_is(p, "in")) {
+    next_token(p);
+    if ((node = new_node(p, NODE_IN)) == NULL) {
+      return NULL;
+    }
+    node->field = field;
+    if (parse_values(p, field, node, 0) != 0) {
+      goto err;
+    }
+    return node;
+  }
+
+  if (p->tok != TOK_CMP) {
+    parse_error(p, "expected a comparison or 'in'");
+    return NULL;
+  }
+  if ((node = new_node(p, NODE_CMP)) == NULL) {
+    return NULL;
+  }
+  node->field = field;
+  node->cmp = p->tok_cmp;
+  next_token(p);
+  if (parse_value(p, field, &node->value) != 0) {
+    goto err;
+  }
+  return node;
+
+err:
+  pybgpstream_pred_destroy(node);
+  return NULL;
+}
+
+/* unary := "not" unary | "(" or ")" | cond */
+static pybgpstream_pred_t *parse_unary(parser_t *p)
+{
+  pybgpstream_pred_t *node;
+  pybgpstream_pred_t *operand;
+
+  if (tok_is(p, "not")) {
+    next_token(p);
+    if ((operand = parse_unary(p)) == NULL) {
+      return NULL;
+    }
+    if ((node = new_node(p, NODE_NOT)) == NULL) {
+      pybgpstream_pred_destroy(operand);
+      return NULL;
+    }
+    node->left = operand;
+    return node;
+  }
+
+  if (p->tok == TOK_LPAREN) {
+    next_token(p);
+    if ((node = parse_or(p)) == NULL) {
+      return NULL;
+    }
+    if (expect(p, TOK_RPAREN, "')'") != 0) {
+      pybgpstream_pred_destroy(node);
+      return NULL;
+    }
+    return node;
+  }
+
+  return parse_cond(p);
+}
+
+/* parse a chain of operands joined by the given keyword */
+static pybgpstream_pred_t *parse_chain(parser_t *p, const char *keyword,
+                                       node_type_t type,
+                                       pybgpstream_pred_t *(*operand)(
+                                         parser_t *))
+{
+  pybgpstream_pred_t *left;
+  pybgpstream_pred_t *right;
+  pybgpstream_pred_t *node;
+
+  if ((left = operand(p)) == NULL) {
+    return NULL;
+  }
+  while (tok_is(p, keyword)) {
+    next_token(p);
+    if ((right = operand(p)) == NULL) {
+      pybgpstream_pred_destroy(left);
+      return NULL;
+    }
+    if ((node = new_node(p, type)) == NULL) {
+      pybgpstream_pred_destroy(left);
+      pybgpstream_pred_destroy(right);
+      return NULL;
+    }
+    node->left = left;
+    node->right = right;
+    left = node;
+  }
+  return left;
+}
+
+static pybgpstream_pred_t *parse_and(parser_t *p)
+{
+  return parse_chain(p, "and", NODE_AND, parse_unary);
+}
+
+static pybgpstream_pred_t *parse_or(parser_t *p)
+{
+  return parse_chain(p, "or", NODE_OR, parse_and);
+}
+
+pybgpstream_pred_t *pybgpstream_pred_compile(const char *expr, char *err,
+                                             size_t err_len)
+{
+  parser_t p;
+  pybgpstream_pred_t *pred;
+
+  memset(&p, 0, sizeof(p));
+  p.expr = expr;
+  p.err = err;
+  p.err_len = err_len;
+  next_token(&p);
+
+  if ((pred = parse_or(&p)) == NULL) {
+    return NULL;
+  }
+  if (p.tok != TOK_END) {
+    parse_error(&p, "unexpected '%.*s'", (int)p.tok_len,
+                p.expr + p.tok_start);
+    pybgpstream_pred_destroy(pred);
+    return NULL;
+  }
+  return pred;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_PRED_H
+#define ___PYBGPSTREAM_PRED_H
+
+#include <bgpstream.h>
+#include <stddef.h>
+
+/** Opaque struct holding an elem predicate compiled into an evaluation tree
+ *
+ * Predicates are written in a small language of conditions on elem fields
+ * that libbgpstream cannot filter on, combined with "and", "or", "not" and
+ * parentheses, e.g.:
+ *
+ *   origin-asn in {3356, 174} and not community 65535:*
+ *   path-len > 6 or prefix-len >= 25
+ *
+ * None of these functions touch the Python API.
+ */
+typedef struct pybgpstream_pred pybgpstream_pred_t;
+
+/** Compile a predicate
+ *
+ * @param expr          the predicate expression
+ * @param err           buffer for the error message
+ * @param err_len       size of the err buffer
+ * @return pointer to the compiled predicate, or NULL if the expression is
+ *         invalid or an error occurred (with a message in err)
+ */
+pybgpstream_pred_t *pybgpstream_pred_compile(const char *expr, char *err,
+                                             size_t err_len);
+
+/** Destroy the given predicate */
+void pybgpstream_pred_destroy(pybgpstream_pred_t *pred);
+
+/** Evaluate a predicate on an elem
+ *
+ * @param pred          pointer to the predicate
+ * @param elem          elem to evaluate the predicate on
+ * @return 1 if the elem matches the predicate, 0 otherwise
+ */
+int pybgpstream_pred_eval(const pybgpstream_pred_t *pred,
+                          const bgpstream_elem_t *elem);
+
+#endif /* ___PYBGPSTREAM_PRED_H */
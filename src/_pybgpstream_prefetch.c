@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_prefetch.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct pybgpstream_prefetch {
+
+  /** libbgpstream instance that records are read from */
+  bgpstream_t *bs;
+
+  /** Cache that records are read through instead of bs (if set) */
+  pybgpstream_cache_t *cache;
+
+  /** Checkpoint tracker (only its reading side is used by the thread) */
+  pybgpstream_checkpoint_t *cp;
+
+  /** Filter that elems must pass (or NULL) */
+  const pybgpstream_elemfilter_t *filter;
+
+  /** Reader thread */
+  pthread_t thread;
+
+  /** Protects all of the fields below */
+  pthread_mutex_t mutex;
+
+  /** Signalled when a slot is freed (or the reader is asked to stop) */
+  pthread_cond_t not_full;
+
+  /** Signalled when a record is queued (or the reader stops) */
+  pthread_cond_t not_empty;
+
+  /** Ring of detached records */
+  pybgpstream_detached_record_t **ring;
+
+  /** Size of the ring */
+  int depth;
+
+  /** Index of the oldest record in the ring */
+  int head;
+
+  /** Number of records in the ring */
+  int cnt;
+
+  /** Set once the reader has reached the end of the stream */
+  int eos;
+
+  /** Set if the reader failed to read or detach a record */
+  int error;
+
+  /** Set when the reader should stop */
+  int stop;
+
+  /** Set while the reader is reading a record (without the lock) */
+  int reading;
+
+  /** Called by the reader thread once it is done with the stream, if the
+      prefetcher was destroyed while it was reading (see abandoned) */
+  void (*release)(void *arg);
+  void *release_arg;
+
+  /** Set if the prefetcher was destroyed while the reader was reading, in
+      which case the reader thread frees the prefetcher itself */
+  int abandoned;
+
+  /** Notification pipe (-1 until pybgpstream_prefetch_get_fd is called) */
+  int notify_fds[2];
+
+  /** Set while a byte is waiting to be read from the notification pipe */
+  int notified;
+
+  /** Statistics */
+  uint64_t records;
+  uint64_t full;
+  uint64_t empty;
+};
+
+/* make the notification pipe readable (the mutex must be held) */
+static void notify(pybgpstream_prefetch_t *pf)
+{
+  static const char byte = 0;
+
+  if (pf->notify_fds[1] == -1 || pf->notified) {
+    return;
+  }
+  /* the pipe holds at most one byte, so this cannot block */
+  while (write(pf->notify_fds[1], &byte, 1) < 0 && errno == EINTR)
+    ;
+  pf->notified = 1;
+}
+
+/* drain the notification pipe once no record is ready (the mutex must be
+   held) */
+static void unnotify(pybgpstream_prefetch_t *pf)
+{
+  char byte;
+
+  if (!pf->notified || pf->cnt > 0 || pf->eos || pf->error) {
+    return;
+  }
+  while (read(pf->notify_fds[0], &byte, 1) < 0 && errno == EINTR)
+    ;
+  pf->notified = 0;
+}
+
+/* take the oldest record from the ring (the mutex must be held) */
+static int take(pybgpstream_prefetch_t *pf,
+                pybgpstream_detached_record_t **drec)
+{
+  if (pf->cnt == 0) {
+    /* records that were read before an error are still handed out */
+    return pf->error ? -1 : 0;
+  }
+  *drec = pf->ring[pf->head];
+  pf->ring[pf->head] = NULL;
+  pf->head = (pf->head + 1) % pf->depth;
+  pf->cnt--;
+  pthread_cond_signal(&pf->not_full);
+  unnotify(pf);
+  return 1;
+}
+
+/* free the prefetcher once the reader thread has stopped */
+static void free_prefetch(pybgpstream_prefetch_t *pf)
+{
+  int i;
+
+  for (i = 0; i < pf->cnt; i++) {
+    pybgpstream_detached_record_destroy(pf->ring[(pf->head + i) % pf->depth]);
+  }
+
+  if (pf->notify_fds[0] != -1) {
+    close(pf->notify_fds[0]);
+    close(pf->notify_fds[1]);
+  }
+  pthread_cond_destroy(&pf->not_empty);
+  pthread_cond_destroy(&pf->not_full);
+  pthread_mutex_destroy(&pf->mutex);
+  free(pf->ring);
+  free(pf);
+}
+
+static void *reader_thread(void *user)
+{
+  pybgpstream_prefetch_t *pf = user;
+  pybgpstream_detached_record_t *drec;
+  bgpstream_record_t *rec = NULL;
+  int ret;
+
+  while (1) {
+    /* wait for a free slot */
+    pthread_mutex_lock(&pf->mutex);
+    if (pf->cnt == pf->depth && !pf->stop) {
+      pf->full++;
+      while (pf->cnt == pf->depth && !pf->stop) {
+        pthread_cond_wait(&pf->not_full, &pf->mutex);
+      }
+    }
+    if (pf->stop) {
+      pthread_mutex_unlock(&pf->mutex);
+      break;
+    }
+    pf->reading = 1;
+    pthread_mutex_unlock(&pf->mutex);
+
+    /* read and detach the next record without holding the lock */
+    drec = NULL;
+    if (pf->cache != NULL) {
+      ret = pybgpstream_cache_get_next(pf->cache, &drec);
+    } else if ((ret = pybgpstream_checkpoint_next_record(pf->cp, pf->bs,
+                                                         &rec)) > 0 &&
+               (drec = pybgpstream_detached_record_create(rec, pf->filter)) ==
+                 NULL) {
+      ret = -1;
+    }
+
+    pthread_mutex_lock(&pf->mutex);
+    pf->reading = 0;
+    if (pf->abandoned) {
+      /* nobody is waiting for this record anymore, and the stream is only
+         kept alive for this thread */
+      pthread_mutex_unlock(&pf->mutex);
+      pybgpstream_detached_record_destroy(drec);
+      if (pf->release != NULL) {
+        pf->release(pf->release_arg);
+      }
+      free_prefetch(pf);
+      break;
+    }
+    if (ret <= 0) {
+      if (ret < 0) {
+        pf->error = 1;
+      } else {
+        pf->eos = 1;
+      }
+      pthread_cond_broadcast(&pf->not_empty);
+      notify(pf);
+      pthread_mutex_unlock(&pf->mutex);
+      break;
+    }
+    pf->ring[(pf->head + pf->cnt) % pf->depth] = drec;
+    pf->cnt++;
+    pf->records++;
+    pthread_cond_signal(&pf->not_empty);
+    notify(pf);
+    pthread_mutex_unlock(&pf->mutex);
+  }
+
+  return NULL;
+}
+
+pybgpstream_prefetch_t *
+pybgpstream_prefetch_create(bgpstream_t *bs, pybgpstream_cache_t *cache,
+                            pybgpstream_checkpoint_t *cp, int depth,
+                            const pybgpstream_elemfilter_t *filter)
+{
+  pybgpstream_prefetch_t *pf;
+
+  if (depth <= 0 || (pf = calloc(1, sizeof(pybgpstream_prefetch_t))) == NULL) {
+    return NULL;
+  }
+  if ((pf->ring = calloc(depth, sizeof(pybgpstream_detached_record_t *))) ==
+      NULL) {
+    free(pf);
+    return NULL;
+  }
+  pf->bs = bs;
+  pf->cache = cache;
+  pf->cp = cp;
+  pf->filter = filter;
+  pf->depth = depth;
+  pf->notify_fds[0] = pf->notify_fds[1] = -1;
+
+  pthread_mutex_init(&pf->mutex, NULL);
+  pthread_cond_init(&pf->not_full, NULL);
+  pthread_cond_init(&pf->not_empty, NULL);
+
+  if (pthread_create(&pf->thread, NULL, reader_thread, pf) != 0) {
+    pthread_cond_destroy(&pf->not_empty);
+    pthread_cond_destroy(&pf->not_full);
+    pthread_mutex_destroy(&pf->mutex);
+    free(pf->ring);
+    free(pf);
+    return NULL;
+  }
+
+  return pf;
+}
+
+void pybgpstream_prefetch_destroy(pybgpstream_prefetch_t *pf,
+                                  void (*release)(void *arg), void *arg)
+{
+  pthread_t thread;
+
+  if (pf == NULL) {
+    if (release != NULL) {
+      release(arg);
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&pf->mutex);
+  pf->stop = 1;
+  pthread_cond_broadcast(&pf->not_full);
+  if (pf->reading && release != NULL) {
+    /* the read may never return (e.g. in live mode), so rather than
+       waiting for it, leave the clean up to the reader thread */
+    pf->abandoned = 1;
+    pf->release = release;
+    pf->release_arg = arg;
+    thread = pf->thread;
+    pthread_mutex_unlock(&pf->mutex);
+    /* pf may already be freed by now */
+    pthread_detach(thread);
+    return;
+  }
+  pthread_mutex_unlock(&pf->mutex);
+  pthread_join(pf->thread, NULL);
+
+  free_prefetch(pf);
+  if (release != NULL) {
+    release(arg);
+  }
+}
+
+int pybgpstream_prefetch_get_next(pybgpstream_prefetch_t *pf,
+                                  pybgpstream_detached_record_t **drec)
+{
+  int ret;
+
+  pthread_mutex_lock(&pf->mutex);
+  if (pf->cnt == 0 && !pf->eos && !pf->error) {
+    pf->empty++;
+    while (pf->cnt == 0 && !pf->eos && !pf->error) {
+      pthread_cond_wait(&pf->not_empty, &pf->mutex);
+    }
+  }
+
+  ret = take(pf, drec);
+  pthread_mutex_unlock(&pf->mutex);
+
+  return ret;
+}
+
+int pybgpstream_prefetch_poll(pybgpstream_prefetch_t *pf,
+                              pybgpstream_detached_record_t **drec)
+{
+  int ret;
+
+  pthread_mutex_lock(&pf->mutex);
+  if (pf->cnt == 0 && !pf->eos && !pf->error) {
+    ret = 2;
+  } else {
+    ret = take(pf, drec);
+  }
+  pthread_mutex_unlock(&pf->mutex);
+
+  return ret;
+}
+
+int pybgpstream_prefetch_get_fd(pybgpstream_prefetch_t *pf)
+{
+  int i;
+
+  pthread_mutex_lock(&pf->mutex);
+  if (pf->notify_fds[0] == -1) {
+    if (pipe(pf->notify_fds) != 0) {
+      pf->notify_fds[0] = pf->notify_fds[1] = -1;
+      pthread_mutex_unlock(&pf->mutex);
+      return -1;
+    }
+    for (i = 0; i < 2; i++) {
+      fcntl(pf->notify_fds[i], F_SETFL,
+            fcntl(pf->notify_fds[i], F_GETFL) | O_NONBLOCK);
+      fcntl(pf->notify_fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    /* records may already be waiting */
+    if (pf->cnt > 0 || pf->eos || pf->error) {
+      notify(pf);
+    }
+  }
+  pthread_mutex_unlock(&pf->mutex);
+
+  return pf->notify_fds[0];
+}
+
+void pybgpstream_prefetch_get_stats(pybgpstream_prefetch_t *pf,
+                                    pybgpstream_prefetch_stats_t *stats)
+{
+  pthread_mutex_lock(&pf->mutex);
+  stats->depth = pf->depth;
+  stats->queued = pf->cnt;
+  stats->records = pf->records;
+  stats->full = pf->full;
+  stats->empty = pf->empty;
+  pthread_mutex_unlock(&pf->mutex);
+}
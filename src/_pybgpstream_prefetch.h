@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_PREFETCH_H
+#define ___PYBGPSTREAM_PREFETCH_H
+
+#include "_pybgpstream_cache.h"
+#include "_pybgpstream_checkpoint.h"
+#include "_pybgpstream_detached.h"
+#include <bgpstream.h>
+#include <stdint.h>
+
+/** Opaque handle for a record prefetcher */
+typedef struct pybgpstream_prefetch pybgpstream_prefetch_t;
+
+/** Statistics of a record prefetcher */
+typedef struct pybgpstream_prefetch_stats {
+
+  /** Maximum number of records read ahead */
+  int depth;
+
+  /** Number of records currently waiting to be consumed */
+  int queued;
+
+  /** Number of records read from the stream so far */
+  uint64_t records;
+
+  /** Number of times the reader thread had to wait for a free slot */
+  uint64_t full;
+
+  /** Number of times the consumer had to wait for a record */
+  uint64_t empty;
+
+} pybgpstream_prefetch_stats_t;
+
+/** Create a prefetcher that reads ahead from the given (started) stream
+ *
+ * @param bs            pointer to the libbgpstream instance to read from
+ * @param cache         pointer to the cache to read records through instead
+ *                      of bs, or NULL
+ * @param cp            pointer to the checkpoint tracker whose consumed
+ *                      records are skipped, or NULL
+ * @param depth         maximum number of records to read ahead
+ * @param filter        filter that elems must pass to be kept (NULL to keep
+ *                      all elems)
+ * @return pointer to a new prefetcher, or NULL if an error occurred
+ *
+ * A reader thread is started that detaches records (and all their elems)
+ * from the stream into a ring of at most depth entries, so that decoding
+ * can proceed while the consumer is busy with earlier records. Once the
+ * prefetcher is created, bs (or cache) must only be read through it.
+ */
+pybgpstream_prefetch_t *
+pybgpstream_prefetch_create(bgpstream_t *bs, pybgpstream_cache_t *cache,
+                            pybgpstream_checkpoint_t *cp, int depth,
+                            const pybgpstream_elemfilter_t *filter);
+
+/** Stop the reader thread and destroy the given prefetcher
+ *
+ * @param pf            pointer to the prefetcher to destroy (may be NULL)
+ * @param release       function that releases what the reader thread reads
+ *                      from (bs, cache, cp and filter), or NULL
+ * @param arg           argument to pass to release
+ *
+ * Any records that have not been consumed are destroyed. If the reader
+ * thread is blocked in libbgpstream (e.g. waiting for new data in live
+ * mode), this does not wait for that read to complete: the thread is
+ * detached, and frees the prefetcher and calls release itself once the read
+ * returns. Otherwise release is called before this returns. If release is
+ * NULL, this always waits for the reader thread.
+ */
+void pybgpstream_prefetch_destroy(pybgpstream_prefetch_t *pf,
+                                  void (*release)(void *arg), void *arg);
+
+/** Get the next record from the given prefetcher
+ *
+ * @param pf            pointer to the prefetcher
+ * @param[out] drec     set to point to the next detached record, which the
+ *                      caller becomes the owner of
+ * @return 1 if a record was returned, 0 if the end of the stream was
+ *         reached, -1 if an error occurred
+ *
+ * This blocks until a record is available, and does not touch the Python
+ * API (so should be called with the GIL released). It is safe to call
+ * from multiple threads.
+ */
+int pybgpstream_prefetch_get_next(pybgpstream_prefetch_t *pf,
+                                  pybgpstream_detached_record_t **drec);
+
+/** Get the next record from the given prefetcher if one is ready
+ *
+ * @param pf            pointer to the prefetcher
+ * @param[out] drec     set to point to the next detached record, which the
+ *                      caller becomes the owner of
+ * @return 1 if a record was returned, 2 if no record is ready yet, 0 if the
+ *         end of the stream was reached, -1 if an error occurred
+ *
+ * This never blocks on the reader thread.
+ */
+int pybgpstream_prefetch_poll(pybgpstream_prefetch_t *pf,
+                              pybgpstream_detached_record_t **drec);
+
+/** Get a file descriptor that is readable while the given prefetcher has a
+ * record ready (or has reached the end of the stream, or failed)
+ *
+ * @param pf            pointer to the prefetcher
+ * @return the file descriptor (owned by the prefetcher), or -1 if it could
+ *         not be created
+ *
+ * The descriptor (the read end of a non-blocking pipe) is created on the
+ * first call, so that prefetchers that are only read from with
+ * pybgpstream_prefetch_get_next do not pay for the notifications. It lets
+ * an event loop wait for records instead of a thread blocking in
+ * pybgpstream_prefetch_get_next. The consumer must not read from it itself:
+ * it is drained by pybgpstream_prefetch_get_next and
+ * pybgpstream_prefetch_poll once no record is ready.
+ */
+int pybgpstream_prefetch_get_fd(pybgpstream_prefetch_t *pf);
+
+/** Get the statistics of the given prefetcher
+ *
+ * @param pf            pointer to the prefetcher
+ * @param[out] stats    filled with the current statistics
+ */
+void pybgpstream_prefetch_get_stats(pybgpstream_prefetch_t *pf,
+                                    pybgpstream_prefetch_stats_t *stats);
+
+#endif /* ___PYBGPSTREAM_PREFETCH_H */
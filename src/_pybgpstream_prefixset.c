@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_prefixset.h"
+#include "pyutils.h"
+#include <Python.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PrefixSetDocstring "PrefixSet object"
+
+static int check_not_frozen(PrefixSetObject *self)
+{
+  if (self->frozen) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "PrefixSet is used as a stream filter and can no longer "
+                    "be changed");
+    return -1;
+  }
+  return 0;
+}
+
+/* parse a match type name into PYBGPSTREAM_PFXTRIE_MATCH_* flags */
+static int parse_match(const char *name, uint8_t *match)
+{
+  static const char *names[] = {"exact", "more", "less", "any", NULL};
+  static const uint8_t vals[] = {
+    PYBGPSTREAM_PFXTRIE_MATCH_EXACT, PYBGPSTREAM_PFXTRIE_MATCH_MORE,
+    PYBGPSTREAM_PFXTRIE_MATCH_LESS, PYBGPSTREAM_PFXTRIE_MATCH_ANY};
+  int i;
+
+  if (name == NULL) {
+    *match = PYBGPSTREAM_PFXTRIE_MATCH_EXACT;
+    return 0;
+  }
+  for (i = 0; names[i] != NULL; i++) {
+    if (strcmp(name, names[i]) == 0) {
+      *match = vals[i];
+      return 0;
+    }
+  }
+  PyErr_Format(PyExc_ValueError, "Invalid match type: %s", name);
+  return -1;
+}
+
+static int insert_str(PrefixSetObject *self, const char *pfx_str,
+                      uint8_t match)
+{
+  bgpstream_pfx_t pfx;
+  int ret = 0;
+
+  if (bgpstream_str2pfx(pfx_str, &pfx) == NULL) {
+    PyErr_Format(PyExc_ValueError, "Invalid prefix: %s", pfx_str);
+    return -1;
+  }
+  /* the set may have been frozen by another thread since it was checked */
+  Py_BEGIN_CRITICAL_SECTION(self);
+  if ((ret = check_not_frozen(self)) == 0 &&
+      (ret = pybgpstream_pfxtrie_insert(self->trie, &pfx, match)) != 0) {
+    PyErr_Format(PyExc_ValueError, "Invalid prefix: %s", pfx_str);
+  }
+  Py_END_CRITICAL_SECTION();
+  return ret;
+}
+
+static int update(PrefixSetObject *self, PyObject *prefixes, uint8_t match)
+{
+  PyObject *iter;
+  PyObject *item;
+  const char *pfx_str;
+
+  if ((iter = PyObject_GetIter(prefixes)) == NULL) {
+    return -1;
+  }
+  while ((item = PyIter_Next(iter)) != NULL) {
+    if ((pfx_str = PYSTR_ASSTR(item)) == NULL ||
+        insert_str(self, pfx_str, match) != 0) {
+      Py_DECREF(item);
+      Py_DECREF(iter);
+      return -1;
+    }
+    Py_DECREF(item);
+  }
+  Py_DECREF(iter);
+  return PyErr_Occurred() ? -1 : 0;
+}
+
+static void PrefixSet_dealloc(PrefixSetObject *self)
+{
+  pybgpstream_pfxtrie_destroy(self->trie);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *PrefixSet_new(PyTypeObject *type, PyObject *args,
+                               PyObject *kwds)
+{
+  PrefixSetObject *self;
+
+  self = (PrefixSetObject *)type->tp_alloc(type, 0);
+  if (self == NULL) {
+    return NULL;
+  }
+
+  if ((self->trie = pybgpstream_pfxtrie_create()) == NULL) {
+    Py_DECREF(self);
+    return PyErr_NoMemory();
+  }
+
+  return (PyObject *)self;
+}
+
+static int PrefixSet_init(PrefixSetObject *self, PyObject *args,
+                          PyObject *kwds)
+{
+  /* args: prefixes (iterable of str), match (str) */
+  static char *kwlist[] = {"prefixes", "match", NULL};
+  PyObject *prefixes = NULL;
+  const char *match_str = NULL;
+  uint8_t match;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oz", kwlist, &prefixes,
+                                   &match_str) ||
+      parse_match(match_str, &match) != 0) {
+    return -1;
+  }
+  if (prefixes == NULL || prefixes == Py_None) {
+    return 0;
+  }
+  if (check_not_frozen(self) != 0) {
+    return -1;
+  }
+  return update(self, prefixes, match);
+}
+
+/** Add a prefix to the set */
+static PyObject *PrefixSet_add(PrefixSetObject *self, PyObject *args,
+                               PyObject *kwds)
+{
+  /* args: prefix (str), match (str) */
+  static char *kwlist[] = {"prefix", "match", NULL};
+  const char *pfx_str;
+  const char *match_str = NULL;
+  uint8_t match;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|z", kwlist, &pfx_str,
+                                   &match_str) ||
+      parse_match(match_str, &match) != 0 || check_not_frozen(self) != 0 ||
+      insert_str(self, pfx_str, match) != 0) {
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+/** Add the prefixes of an iterable to the set */
+static PyObject *PrefixSet_update(PrefixSetObject *self, PyObject *args,
+                                  PyObject *kwds)
+{
+  /* args: prefixes (iterable of str), match (str) */
+  static char *kwlist[] = {"prefixes", "match", NULL};
+  PyObject *prefixes;
+  const char *match_str = NULL;
+  uint8_t match;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|z", kwlist, &prefixes,
+                                   &match_str) ||
+      parse_match(match_str, &match) != 0 || check_not_frozen(self) != 0 ||
+      update(self, prefixes, match) != 0) {
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+/** Add the prefixes listed in a file to the set */
+static PyObject *PrefixSet_load(PrefixSetObject *self, PyObject *args,
+                                PyObject *kwds)
+{
+  /* args: path (str), match (str) */
+  static char *kwlist[] = {"path", "match", NULL};
+  const char *path;
+  const char *match_str = NULL;
+  uint8_t match;
+  FILE *fh;
+  char line[1024];
+  char *start;
+  char *end;
+  int line_no = 0;
+  long cnt = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|z", kwlist, &path,
+                                   &match_str) ||
+      parse_match(match_str, &match) != 0 || check_not_frozen(self) != 0) {
+    return NULL;
+  }
+
+  if ((fh = fopen(path, "r")) == NULL) {
+    return PyErr_SetFromErrnoWithFilename(PyExc_IOError, path);
+  }
+  while (fgets(line, sizeof(line), fh) != NULL) {
+    line_no++;
+    /* one prefix per line, ignoring blank lines and # comments */
+    if ((end = strchr(line, '#')) != NULL) {
+      *end = '\0';
+    }
+    for (start = line; isspace((unsigned char)*start); start++)
+      ;
+    for (end = start + strlen(start);
+         end > start && isspace((unsigned char)end[-1]); end--)
+      ;
+    *end = '\0';
+    if (*start == '\0') {
+      continue;
+    }
+    if (insert_str(self, start, match) != 0) {
+      PyErr_Format(PyExc_ValueError, "Invalid prefix at %s:%d: %s", path,
+                   line_no, start);
+      fclose(fh);
+      return NULL;
+    }
+    cnt++;
+  }
+  fclose(fh);
+
+  return PyLong_FromLong(cnt);
+}
+
+/** Check whether a prefix matches any prefix of the set */
+static PyObject *PrefixSet_match(PrefixSetObject *self, PyObject *args)
+{
+  /* args: prefix (str) */
+  const char *pfx_str;
+  bgpstream_pfx_t pfx;
+  int matched;
+
+  if (!PyArg_ParseTuple(args, "s", &pfx_str)) {
+    return NULL;
+  }
+  if (bgpstream_str2pfx(pfx_str, &pfx) == NULL) {
+    return PyErr_Format(PyExc_ValueError, "Invalid prefix: %s", pfx_str);
+  }
+  Py_BEGIN_CRITICAL_SECTION(self);
+  matched = pybgpstream_pfxtrie_match(self->trie, &pfx);
+  Py_END_CRITICAL_SECTION();
+  return PyBool_FromLong(matched);
+}
+
+static Py_ssize_t PrefixSet_len(PrefixSetObject *self)
+{
+  Py_ssize_t len;
+
+  Py_BEGIN_CRITICAL_SECTION(self);
+  len = (Py_ssize_t)pybgpstream_pfxtrie_get_size(self->trie);
+  Py_END_CRITICAL_SECTION();
+  return len;
+}
+
+static PyObject *PrefixSet_get_memory(PrefixSetObject *self, void *closure)
+{
+  size_t memory;
+
+  Py_BEGIN_CRITICAL_SECTION(self);
+  memory = pybgpstream_pfxtrie_get_memory(self->trie);
+  Py_END_CRITICAL_SECTION();
+  return PyLong_FromSize_t(memory);
+}
+
+static PyObject *PrefixSet_get_frozen(PrefixSetObject *self, void *closure)
+{
+  return PyBool_FromLong(self->frozen);
+}
+
+static PyMethodDef PrefixSet_methods[] = {
+
+  {"add", (PyCFunction)PrefixSet_add, METH_VARARGS | METH_KEYWORDS,
+   "Add a prefix to the set"},
+
+  {"update", (PyCFunction)PrefixSet_update, METH_VARARGS | METH_KEYWORDS,
+   "Add the prefixes of an iterable to the set"},
+
+  {"load", (PyCFunction)PrefixSet_load, METH_VARARGS | METH_KEYWORDS,
+   "Add the prefixes listed in a file (one per line) to the set"},
+
+  {"match", (PyCFunction)PrefixSet_match, METH_VARARGS,
+   "Check whether a prefix matches any prefix of the set"},
+
+  {NULL} /* Sentinel */
+};
+
+static PyGetSetDef PrefixSet_getsetters[] = {
+
+  {"memory", (getter)PrefixSet_get_memory, NULL,
+   "Number of bytes of memory used by the set", NULL},
+
+  {"frozen", (getter)PrefixSet_get_frozen, NULL,
+   "Whether the set is used as a stream filter (and can no longer be "
+   "changed)",
+   NULL},
+
+  {NULL} /* Sentinel */
+};
+
+static PySequenceMethods PrefixSet_as_sequence = {
+  (lenfunc)PrefixSet_len, /* sq_length */
+};
+
+static PyTypeObject PrefixSetType = {
+  PyVarObject_HEAD_INIT(NULL, 0) "_pybgpstream.PrefixSet", /* tp_name */
+  sizeof(PrefixSetObject),                                 /* tp_basicsize */
+  0,                                                       /* tp_itemsize */
+  (destructor)PrefixSet_dealloc,                           /* tp_dealloc */
+  0,                                                       /* tp_print */
+  0,                                                       /* tp_getattr */
+  0,                                                       /* tp_setattr */
+  0,                                                       /* tp_compare */
+  0,                                                       /* tp_repr */
+  0,                                                       /* tp_as_number */
+  &PrefixSet_as_sequence,                                  /* tp_as_sequence */
+  0,                                                       /* tp_as_mapping */
+  0,                                                       /* tp_hash */
+  0,                                                       /* tp_call */
+  0,                                                       /* tp_str */
+  0,                                                       /* tp_getattro */
+  0,                                                       /* tp_setattro */
+  0,                                                       /* tp_as_buffer */
+  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,                /* tp_flags */
+  PrefixSetDocstring,                                      /* tp_doc */
+  0,                                                       /* tp_traverse */
+  0,                                                       /* tp_clear */
+  0,                                                       /* tp_richcompare */
+  0,                        /* tp_weaklistoffset */
+  0,                        /* tp_iter */
+  0,                        /* tp_iternext */
+  PrefixSet_methods,        /* tp_methods */
+  0,                        /* tp_members */
+  PrefixSet_getsetters,     /* tp_getset */
+  0,                        /* tp_base */
+  0,                        /* tp_dict */
+  0,                        /* tp_descr_get */
+  0,                        /* tp_descr_set */
+  0,                        /* tp_dictoffset */
+  (initproc)PrefixSet_init, /* tp_init */
+  0,                        /* tp_alloc */
+  PrefixSet_new,            /* tp_new */
+};
+
+PyTypeObject *_pybgpstream_bgpstream_get_PrefixSetType()
+{
+  return &PrefixSetType;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_reader.h"
+
+void pybgpstream_reader_init(pybgpstream_reader_t *reader, bgpstream_t *bs,
+                             pybgpstream_prefetch_t *pf,
+                             pybgpstream_cache_t *cache,
+                             pybgpstream_checkpoint_t *cp,
+                             const pybgpstream_elemfilter_t *filter,
+                             pybgpstream_stats_t *stats)
+{
+  reader->bs = bs;
+  reader->pf = pf;
+  reader->cache = cache;
+  reader->cp = cp;
+  reader->filter = filter;
+  reader->stats = stats;
+  reader->rec = NULL;
+  reader->drec = NULL;
+}
+
+int pybgpstream_reader_next_record(pybgpstream_reader_t *reader)
+{
+  int ret;
+  uint64_t start = 0;
+
+  if (reader->stats != NULL) {
+    start = pybgpstream_stats_now();
+  }
+
+  pybgpstream_reader_clear(reader);
+  pybgpstream_checkpoint_commit(reader->cp);
+
+  if (reader->pf != NULL) {
+    if ((ret = pybgpstream_prefetch_get_next(reader->pf, &reader->drec)) > 0) {
+      reader->rec = &reader->drec->rec;
+    }
+  } else if (reader->cache != NULL) {
+    if ((ret = pybgpstream_cache_get_next(reader->cache, &reader->drec)) > 0) {
+      reader->rec = &reader->drec->rec;
+    }
+  } else if ((ret = pybgpstream_checkpoint_next_record(
+                reader->cp, reader->bs, &reader->rec)) <= 0) {
+    reader->rec = NULL;
+  }
+
+  if (ret > 0) {
+    pybgpstream_checkpoint_add(reader->cp, reader->rec);
+  }
+  if (reader->stats != NULL) {
+    PYBGPSTREAM_STATS_ADD(reader->stats, read_ns,
+                          pybgpstream_stats_now() - start);
+    if (ret > 0) {
+      pybgpstream_stats_add_record(reader->stats, reader->rec);
+    }
+  }
+  return ret;
+}
+
+int pybgpstream_reader_next_elem(pybgpstream_reader_t *reader,
+                                 bgpstream_elem_t **elem)
+{
+  int ret;
+  uint64_t start = 0;
+
+  if (reader->rec == NULL) {
+    return 0;
+  }
+  if (reader->drec != NULL) {
+    /* prefetched (and cached) records were already filtered, so there is
+       nothing to time */
+    if ((ret = pybgpstream_detached_record_get_next_elem(reader->drec,
+                                                         elem)) > 0 &&
+        reader->stats != NULL) {
+      PYBGPSTREAM_STATS_ADD(reader->stats, elems, 1);
+    }
+    return ret;
+  }
+  if (reader->stats != NULL) {
+    start = pybgpstream_stats_now();
+  }
+  while ((ret = bgpstream_record_get_next_elem(reader->rec, elem)) > 0 &&
+         !pybgpstream_elemfilter_match(reader->filter, *elem))
+    ;
+  if (reader->stats != NULL) {
+    PYBGPSTREAM_STATS_ADD(reader->stats, read_ns,
+                          pybgpstream_stats_now() - start);
+    if (ret > 0) {
+      PYBGPSTREAM_STATS_ADD(reader->stats, elems, 1);
+    }
+  }
+  return ret;
+}
+
+void pybgpstream_reader_clear(pybgpstream_reader_t *reader)
+{
+  pybgpstream_detached_record_destroy(reader->drec);
+  reader->drec = NULL;
+  reader->rec = NULL;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_READER_H
+#define ___PYBGPSTREAM_READER_H
+
+#include "_pybgpstream_cache.h"
+#include "_pybgpstream_checkpoint.h"
+#include "_pybgpstream_detached.h"
+#include "_pybgpstream_prefetch.h"
+#include "_pybgpstream_stats.h"
+#include <bgpstream.h>
+
+/** Reads records and elems from a started stream, either directly or
+ * through its prefetcher, for the consumers implemented in C (which never
+ * create Python objects for the records and elems they read).
+ *
+ * None of these functions touch the Python API, so they are safe to call
+ * with the GIL released.
+ */
+typedef struct pybgpstream_reader {
+
+  /** libbgpstream instance that records are read from */
+  bgpstream_t *bs;
+
+  /** Prefetcher that records are read from instead of bs (if set) */
+  pybgpstream_prefetch_t *pf;
+
+  /** Cache that records are read through instead of bs (if set, and there
+      is no prefetcher) */
+  pybgpstream_cache_t *cache;
+
+  /** Checkpoint tracker that records are skipped by and reported to */
+  pybgpstream_checkpoint_t *cp;
+
+  /** Filter that elems must pass (or NULL) */
+  const pybgpstream_elemfilter_t *filter;
+
+  /** Statistics that records and elems are counted in (or NULL) */
+  pybgpstream_stats_t *stats;
+
+  /** Current record (NULL before the first record and at the end) */
+  bgpstream_record_t *rec;
+
+  /** Owned copy of rec when records come from the prefetcher or cache */
+  pybgpstream_detached_record_t *drec;
+
+} pybgpstream_reader_t;
+
+/** Initialize a reader for the given stream
+ *
+ * @param reader        pointer to the reader to initialize
+ * @param bs            pointer to the (started) libbgpstream instance
+ * @param pf            pointer to the prefetcher of the stream, or NULL
+ * @param cache         pointer to the cache of the stream, or NULL
+ * @param cp            pointer to the checkpoint tracker of the stream
+ * @param filter        filter that elems must pass, or NULL
+ * @param stats         pointer to the statistics of the stream, or NULL
+ */
+void pybgpstream_reader_init(pybgpstream_reader_t *reader, bgpstream_t *bs,
+                             pybgpstream_prefetch_t *pf,
+                             pybgpstream_cache_t *cache,
+                             pybgpstream_checkpoint_t *cp,
+                             const pybgpstream_elemfilter_t *filter,
+                             pybgpstream_stats_t *stats);
+
+/** Move the given reader to the next record
+ *
+ * @param reader        pointer to the reader
+ * @return 1 if reader->rec is the next record, 0 if the end of the stream
+ *         was reached, -1 if an error occurred
+ *
+ * The previous record counts as consumed for checkpoints from then on.
+ */
+int pybgpstream_reader_next_record(pybgpstream_reader_t *reader);
+
+/** Get the next elem of the current record of the given reader
+ *
+ * @param reader        pointer to the reader
+ * @param[out] elem     set to point to the next elem
+ * @return 1 if an elem was returned, 0 if there are no more elems in the
+ *         record, -1 if an error occurred
+ */
+int pybgpstream_reader_next_elem(pybgpstream_reader_t *reader,
+                                 bgpstream_elem_t **elem);
+
+/** Release any record held by the given reader */
+void pybgpstream_reader_clear(pybgpstream_reader_t *reader);
+
+#endif /* ___PYBGPSTREAM_READER_H */
@@ -0,0 +1,1263 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_rib.h"
+#include "_pybgpstream_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* trie nodes are referred to by their index in the node array, and index 0
+   is never used so that it can stand for "no node" */
+#define NO_NODE 0
+
+/* attribute sets are referred to by their index in the attribute table, and
+   index 0 is never used so that it can stand for "no route" */
+#define NO_ATTRS 0
+
+typedef struct {
+
+  /** Children (for the next bit being 0 and 1) */
+  uint32_t child[2];
+
+  /** Attribute set of the route for the prefix (NO_ATTRS for nodes that
+      only join two branches, and for withdrawn prefixes) */
+  uint32_t attrs;
+
+  /** Time of the record that last announced the route */
+  uint32_t time;
+
+  /** Length of the prefix */
+  uint8_t len;
+
+} node_t;
+
+typedef struct {
+
+  /** Nodes (the first one is unused) */
+  node_t *nodes;
+
+  /** Addresses of the prefixes of the nodes (addr_len bytes each, with the
+      bits past the prefix length zeroed). Keeping them out of the nodes
+      lets IPv4 nodes take 4 bytes for their address rather than 16. */
+  uint8_t *addrs;
+
+  uint32_t nodes_cnt;
+  uint32_t nodes_alloc;
+
+  /** Root of the trie */
+  uint32_t root;
+
+} trie_t;
+
+typedef struct {
+
+  /** Index of the collector name */
+  uint16_t collector;
+
+  /** Peer address version (4 or 6, 0 if unknown) */
+  uint8_t version;
+
+  /** Peer address (network byte order) */
+  uint8_t addr[16];
+
+  /** Peer ASN */
+  uint32_t asn;
+
+} peer_key_t;
+
+typedef struct {
+
+  /** Key of the peer (all padding is zeroed so keys can be memcmp'd) */
+  peer_key_t key;
+
+  /** Last session state seen */
+  bgpstream_elem_peerstate_t state;
+
+  /** Number of routes */
+  size_t routes_cnt;
+
+  /** IPv4 and IPv6 routes */
+  trie_t tries[2];
+
+} peer_t;
+
+typedef struct {
+
+  /** Time of the first record of the RIB dump being applied */
+  uint32_t rib_start;
+
+  /** Whether a RIB dump is being applied */
+  int in_rib;
+
+} collector_t;
+
+typedef struct {
+
+  /** Number of routes that refer to the set (0 for unused entries) */
+  uint32_t refcnt;
+
+  /** Hash of the set (as computed by attrs_hash) */
+  uint32_t hash;
+
+  uint16_t as_path_len;
+  uint16_t communities_cnt;
+
+  /** Next hop address version (4 or 6, 0 if there is none) */
+  uint8_t next_hop_version;
+  uint8_t next_hop[16];
+
+  /** Communities (communities_cnt of them), followed by the AS path data */
+  uint32_t data[];
+
+} attrs_t;
+
+struct pybgpstream_rib {
+
+  /** Peers, and an open-addressing index of (peer index + 1) by key */
+  peer_t *peers;
+  int peers_cnt;
+  int peers_alloc;
+  int *peer_index;
+  size_t peer_index_alloc;
+
+  /** Peer of the last elem applied */
+  int last_peer;
+
+  /** Collector names, and the state of each collector (parallel to the
+      names) */
+  pybgpstream_names_t collector_names;
+  collector_t *collectors;
+  int collectors_alloc;
+
+  /** Collector and time of the last record started */
+  int cur_collector;
+  uint32_t time;
+
+  /** Attribute sets (the first one is unused), the indexes of the unused
+      entries, and an open-addressing index of the sets by hash */
+  attrs_t **attrs;
+  uint32_t attrs_cnt;
+  uint32_t attrs_alloc;
+  uint32_t *free_attrs;
+  uint32_t free_attrs_cnt;
+  uint32_t free_attrs_alloc;
+  uint32_t *attrs_index;
+  size_t attrs_index_cnt;
+  size_t attrs_index_alloc;
+
+  /** Attribute set being built for an elem */
+  attrs_t *scratch;
+  size_t scratch_alloc;
+
+  /** Number of bytes used by the attribute sets */
+  size_t attrs_bytes;
+
+  /** Number of routes of all peers */
+  size_t routes_cnt;
+
+  /** Incremented every time the table is changed */
+  uint64_t version;
+};
+
+/* ========== TRIES ========== */
+
+/* Get the address bytes, maximum length and trie index of a prefix, or
+   return -1 for prefixes of an unknown version */
+static int get_pfx_info(const bgpstream_pfx_t *pfx, const uint8_t **addr,
+                        int *max_len)
+{
+  if (pfx->address.version == BGPSTREAM_ADDR_VERSION_IPV4) {
+    *addr = (const uint8_t *)&pfx->address.bs_ipv4.addr;
+    *max_len = 32;
+    return 0;
+  }
+  if (pfx->address.version == BGPSTREAM_ADDR_VERSION_IPV6) {
+    *addr = (const uint8_t *)&pfx->address.bs_ipv6.addr;
+    *max_len = 128;
+    return 1;
+  }
+  return -1;
+}
+
+static int get_bit(const uint8_t *addr, int bit)
+{
+  return (addr[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+/* length of the longest common prefix of a and b, up to max_len bits */
+static int get_common_len(const uint8_t *a, const uint8_t *b, int max_len)
+{
+  int len = 0;
+  uint8_t diff;
+  int i;
+
+  for (i = 0; len < max_len; i++, len += 8) {
+    if ((diff = a[i] ^ b[i]) != 0) {
+      while ((diff & 0x80) == 0) {
+        diff <<= 1;
+        len++;
+      }
+      break;
+    }
+  }
+  return (len < max_len) ? len : max_len;
+}
+
+#define ADDR_LEN(v) ((v) == 0 ? 4 : 16)
+#define NODE_ADDR(trie, v, idx) (&(trie)->addrs[(size_t)(idx)*ADDR_LEN(v)])
+
+static uint32_t new_node(trie_t *trie, int v, const uint8_t *addr, int len)
+{
+  node_t *node = &trie->nodes[trie->nodes_cnt];
+  uint8_t *node_addr = NODE_ADDR(trie, v, trie->nodes_cnt);
+  int bytes = (len + 7) / 8;
+
+  memset(node, 0, sizeof(node_t));
+  memset(node_addr, 0, ADDR_LEN(v));
+  memcpy(node_addr, addr, bytes);
+  if ((len & 7) != 0) {
+    node_addr[bytes - 1] &= (uint8_t)(0xff << (8 - (len & 7)));
+  }
+  node->len = (uint8_t)len;
+  return trie->nodes_cnt++;
+}
+
+/* make room for (at most) two new nodes in a trie */
+static int trie_reserve(trie_t *trie, int v)
+{
+  uint32_t alloc;
+  node_t *nodes;
+  uint8_t *addrs;
+
+  if (trie->nodes_cnt + 2 <= trie->nodes_alloc) {
+    return 0;
+  }
+  if (trie->nodes_alloc >= UINT32_MAX / 2) {
+    return -1;
+  }
+  alloc = (trie->nodes_alloc == 0) ? 256 : trie->nodes_alloc * 2;
+  if ((nodes = realloc(trie->nodes, sizeof(node_t) * alloc)) == NULL) {
+    return -1;
+  }
+  trie->nodes = nodes;
+  if ((addrs = realloc(trie->addrs, (size_t)ADDR_LEN(v) * alloc)) == NULL) {
+    return -1;
+  }
+  trie->addrs = addrs;
+  if (trie->nodes_cnt == 0) {
+    trie->nodes_cnt = 1;
+  }
+  trie->nodes_alloc = alloc;
+  return 0;
+}
+
+/* get the node of a prefix, adding it if needed (NO_NODE if an error
+   occurred) */
+static uint32_t trie_get_node(trie_t *trie, int v, const uint8_t *addr,
+                              int len)
+{
+  uint32_t *link;
+  uint32_t idx;
+  uint32_t glue;
+  const uint8_t *node_addr;
+  node_t *node;
+  int common;
+
+  if (trie_reserve(trie, v) != 0) {
+    return NO_NODE;
+  }
+
+  link = &trie->root;
+  while (*link != NO_NODE) {
+    node = &trie->nodes[*link];
+    node_addr = NODE_ADDR(trie, v, *link);
+    common =
+      get_common_len(addr, node_addr, (len < node->len) ? len : node->len);
+
+    if (common < node->len) {
+      /* the prefix diverges from the node, or is an ancestor of it */
+      idx = new_node(trie, v, addr, len);
+      if (common == len) {
+        trie->nodes[idx].child[get_bit(node_addr, len)] = *link;
+        *link = idx;
+        return idx;
+      }
+      glue = new_node(trie, v, addr, common);
+      trie->nodes[glue].child[get_bit(addr, common)] = idx;
+      trie->nodes[glue].child[get_bit(node_addr, common)] = *link;
+      *link = glue;
+      return idx;
+    }
+    if (node->len == len) {
+      return *link;
+    }
+    link = &node->child[get_bit(addr, node->len)];
+  }
+
+  return *link = new_node(trie, v, addr, len);
+}
+
+/* find the node of a prefix (NO_NODE if there is none) */
+static uint32_t trie_find_node(const trie_t *trie, int v, const uint8_t *addr,
+                               int len)
+{
+  uint32_t idx = trie->root;
+  const node_t *node;
+
+  while (idx != NO_NODE) {
+    node = &trie->nodes[idx];
+    if (node->len > len ||
+        get_common_len(addr, NODE_ADDR(trie, v, idx), node->len) <
+          node->len) {
+      return NO_NODE;
+    }
+    if (node->len == len) {
+      return idx;
+    }
+    idx = node->child[get_bit(addr, node->len)];
+  }
+  return NO_NODE;
+}
+
+/* find the node of the most specific route covering a prefix (NO_NODE if
+   there is none) */
+static uint32_t trie_find_covering(const trie_t *trie, int v,
+                                   const uint8_t *addr, int len)
+{
+  uint32_t idx = trie->root;
+  uint32_t found = NO_NODE;
+  const node_t *node;
+
+  while (idx != NO_NODE) {
+    node = &trie->nodes[idx];
+    if (node->len > len ||
+        get_common_len(addr, NODE_ADDR(trie, v, idx), node->len) <
+          node->len) {
+      break;
+    }
+    if (node->attrs != NO_ATTRS) {
+      found = idx;
+    }
+    if (node->len == len) {
+      break;
+    }
+    idx = node->child[get_bit(addr, node->len)];
+  }
+  return found;
+}
+
+static int trie_copy(trie_t *dst, const trie_t *src, int v)
+{
+  memset(dst, 0, sizeof(trie_t));
+  if (src->nodes_cnt == 0) {
+    return 0;
+  }
+  /* there is no need to copy the unused part of the arrays */
+  if ((dst->nodes = malloc(sizeof(node_t) * src->nodes_cnt)) == NULL ||
+      (dst->addrs = malloc((size_t)ADDR_LEN(v) * src->nodes_cnt)) == NULL) {
+    free(dst->nodes);
+    dst->nodes = NULL;
+    return -1;
+  }
+  memcpy(dst->nodes, src->nodes, sizeof(node_t) * src->nodes_cnt);
+  memcpy(dst->addrs, src->addrs, (size_t)ADDR_LEN(v) * src->nodes_cnt);
+  dst->nodes_cnt = src->nodes_cnt;
+  dst->nodes_alloc = src->nodes_cnt;
+  dst->root = src->root;
+  return 0;
+}
+
+static void trie_free(trie_t *trie)
+{
+  free(trie->nodes);
+  free(trie->addrs);
+  memset(trie, 0, sizeof(trie_t));
+}
+
+/* ========== ATTRIBUTE SETS ========== */
+
+static size_t attrs_size(const attrs_t *attrs)
+{
+  return sizeof(attrs_t) + sizeof(uint32_t) * attrs->communities_cnt +
+         attrs->as_path_len;
+}
+
+static uint32_t attrs_hash(const attrs_t *attrs)
+{
+  /* everything past the hash (the padding of the header is zeroed) */
+  return pybgpstream_hash(&attrs->as_path_len,
+                          attrs_size(attrs) - offsetof(attrs_t, as_path_len));
+}
+
+static int attrs_equal(const attrs_t *a, const attrs_t *b)
+{
+  return a->hash == b->hash && a->as_path_len == b->as_path_len &&
+         a->communities_cnt == b->communities_cnt &&
+         memcmp(&a->as_path_len, &b->as_path_len,
+                attrs_size(a) - offsetof(attrs_t, as_path_len)) == 0;
+}
+
+static int cmp_community(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* build the attribute set of an elem in the scratch entry */
+static int attrs_build(pybgpstream_rib_t *rib, const bgpstream_elem_t *elem)
+{
+  bgpstream_community_t *comm;
+  uint8_t *path = NULL;
+  uint16_t path_len = 0;
+  int comm_cnt = 0;
+  size_t size;
+  attrs_t *attrs;
+  int i;
+
+  if (elem->as_path != NULL) {
+    path_len = bgpstream_as_path_get_data(elem->as_path, &path);
+  }
+  if (elem->communities != NULL) {
+    comm_cnt = bgpstream_community_set_size(elem->communities);
+  }
+  if (comm_cnt > UINT16_MAX) {
+    return -1;
+  }
+
+  size = sizeof(attrs_t) + sizeof(uint32_t) * comm_cnt + path_len;
+  if (size > rib->scratch_alloc) {
+    if ((attrs = realloc(rib->scratch, size)) == NULL) {
+      return -1;
+    }
+    rib->scratch = attrs;
+    rib->scratch_alloc = size;
+  }
+  attrs = rib->scratch;
+  memset(attrs, 0, sizeof(attrs_t));
+  attrs->as_path_len = path_len;
+  attrs->communities_cnt = (uint16_t)comm_cnt;
+
+  if (elem->nexthop.version == BGPSTREAM_ADDR_VERSION_IPV4) {
+    attrs->next_hop_version = 4;
+    memcpy(attrs->next_hop, &elem->nexthop.bs_ipv4.addr, 4);
+  } else if (elem->nexthop.version == BGPSTREAM_ADDR_VERSION_IPV6) {
+    attrs->next_hop_version = 6;
+    memcpy(attrs->next_hop, &elem->nexthop.bs_ipv6.addr, 16);
+  }
+
+  /* communities are a set, so their order does not tell sets apart */
+  for (i = 0; i < comm_cnt; i++) {
+    comm = bgpstream_community_set_get(elem->communities, i);
+    attrs->data[i] = ((uint32_t)comm->asn << 16) | comm->value;
+  }
+  qsort(attrs->data, comm_cnt, sizeof(uint32_t), cmp_community);
+  if (path_len > 0) {
+    memcpy(&attrs->data[comm_cnt], path, path_len);
+  }
+
+  attrs->hash = attrs_hash(attrs);
+  return 0;
+}
+
+/* get the slot of the attribute index where the given set is (or would be
+   added) */
+static uint32_t *attrs_find_slot(const pybgpstream_rib_t *rib,
+                                 const attrs_t *attrs)
+{
+  size_t mask = rib->attrs_index_alloc - 1;
+  size_t i = attrs->hash & mask;
+
+  while (rib->attrs_index[i] != NO_ATTRS &&
+         !attrs_equal(rib->attrs[rib->attrs_index[i]], attrs)) {
+    i = (i + 1) & mask;
+  }
+  return &rib->attrs_index[i];
+}
+
+static int attrs_grow_index(pybgpstream_rib_t *rib)
+{
+  size_t old_alloc = rib->attrs_index_alloc;
+  uint32_t *old_index = rib->attrs_index;
+  size_t i;
+
+  rib->attrs_index_alloc = (old_alloc == 0) ? 1024 : old_alloc * 2;
+  if ((rib->attrs_index =
+         calloc(rib->attrs_index_alloc, sizeof(uint32_t))) == NULL) {
+    rib->attrs_index = old_index;
+    rib->attrs_index_alloc = old_alloc;
+    return -1;
+  }
+  for (i = 0; i < old_alloc; i++) {
+    if (old_index[i] != NO_ATTRS) {
+      *attrs_find_slot(rib, rib->attrs[old_index[i]]) = old_index[i];
+    }
+  }
+  free(old_index);
+  return 0;
+}
+
+/* make sure that every entry of the attribute table can be freed */
+static int attrs_reserve_free(pybgpstream_rib_t *rib)
+{
+  uint32_t *tmp;
+
+  if (rib->free_attrs_alloc >= rib->attrs_alloc) {
+    return 0;
+  }
+  if ((tmp = realloc(rib->free_attrs, sizeof(uint32_t) * rib->attrs_alloc)) ==
+      NULL) {
+    return -1;
+  }
+  rib->free_attrs = tmp;
+  rib->free_attrs_alloc = rib->attrs_alloc;
+  return 0;
+}
+
+/* get a reference to the attribute set of an elem, adding it if needed
+   (NO_ATTRS if an error occurred) */
+static uint32_t attrs_get(pybgpstream_rib_t *rib,
+                          const bgpstream_elem_t *elem)
+{
+  attrs_t **tmp;
+  uint32_t *slot;
+  uint32_t idx;
+  size_t size;
+
+  if (attrs_build(rib, elem) != 0) {
+    return NO_ATTRS;
+  }
+  if ((rib->attrs_index_cnt + 1) * 2 > rib->attrs_index_alloc &&
+      attrs_grow_index(rib) != 0) {
+    return NO_ATTRS;
+  }
+  slot = attrs_find_slot(rib, rib->scratch);
+  if (*slot != NO_ATTRS) {
+    rib->attrs[*slot]->refcnt++;
+    return *slot;
+  }
+
+  if (rib->free_attrs_cnt > 0) {
+    idx = rib->free_attrs[--rib->free_attrs_cnt];
+  } else {
+    if (rib->attrs_cnt == 0) {
+      rib->attrs_cnt = 1;
+    }
+    if (rib->attrs_cnt >= rib->attrs_alloc) {
+      if (rib->attrs_alloc >= UINT32_MAX / 2) {
+        return NO_ATTRS;
+      }
+      rib->attrs_alloc = (rib->attrs_alloc == 0) ? 1024 : rib->attrs_alloc * 2;
+      if ((tmp = realloc(rib->attrs, sizeof(attrs_t *) * rib->attrs_alloc)) ==
+          NULL) {
+        return NO_ATTRS;
+      }
+      rib->attrs = tmp;
+      if (attrs_reserve_free(rib) != 0) {
+        return NO_ATTRS;
+      }
+    }
+    idx = rib->attrs_cnt++;
+    rib->attrs[idx] = NULL;
+  }
+
+  size = attrs_size(rib->scratch);
+  if ((rib->attrs[idx] = malloc(size)) == NULL) {
+    rib->free_attrs[rib->free_attrs_cnt++] = idx;
+    return NO_ATTRS;
+  }
+  memcpy(rib->attrs[idx], rib->scratch, size);
+  rib->attrs[idx]->refcnt = 1;
+  rib->attrs_bytes += size;
+  *slot = idx;
+  rib->attrs_index_cnt++;
+  return idx;
+}
+
+/* remove an attribute set from the attribute index */
+static void attrs_unindex(pybgpstream_rib_t *rib, uint32_t idx)
+{
+  size_t mask = rib->attrs_index_alloc - 1;
+  size_t i = rib->attrs[idx]->hash & mask;
+  size_t j;
+  size_t home;
+
+  while (rib->attrs_index[i] != idx) {
+    i = (i + 1) & mask;
+  }
+  rib->attrs_index[i] = NO_ATTRS;
+  rib->attrs_index_cnt--;
+
+  /* move back the entries of the probe sequence that would no longer be
+     found past the hole */
+  j = i;
+  for (;;) {
+    j = (j + 1) & mask;
+    if (rib->attrs_index[j] == NO_ATTRS) {
+      break;
+    }
+    home = rib->attrs[rib->attrs_index[j]]->hash & mask;
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      rib->attrs_index[i] = rib->attrs_index[j];
+      rib->attrs_index[j] = NO_ATTRS;
+      i = j;
+    }
+  }
+}
+
+static void attrs_decref(pybgpstream_rib_t *rib, uint32_t idx)
+{
+  if (--rib->attrs[idx]->refcnt > 0) {
+    return;
+  }
+  attrs_unindex(rib, idx);
+  rib->attrs_bytes -= attrs_size(rib->attrs[idx]);
+  free(rib->attrs[idx]);
+  rib->attrs[idx] = NULL;
+  /* free_attrs has room for every entry (see attrs_reserve_free) */
+  rib->free_attrs[rib->free_attrs_cnt++] = idx;
+}
+
+/* ========== PEERS ========== */
+
+static uint32_t peer_hash(const peer_key_t *key)
+{
+  return pybgpstream_hash(key, sizeof(peer_key_t));
+}
+
+static int *peer_find_slot(int *index, size_t alloc, const peer_t *peers,
+                           const peer_key_t *key)
+{
+  size_t mask = alloc - 1;
+  size_t i = peer_hash(key) & mask;
+
+  while (index[i] != 0 &&
+         memcmp(&peers[index[i] - 1].key, key, sizeof(peer_key_t)) != 0) {
+    i = (i + 1) & mask;
+  }
+  return &index[i];
+}
+
+static int peer_grow(pybgpstream_rib_t *rib)
+{
+  size_t alloc = (rib->peer_index_alloc == 0) ? 64 : rib->peer_index_alloc * 2;
+  peer_t *peers;
+  int *index;
+  int i;
+
+  if ((index = calloc(alloc, sizeof(int))) == NULL) {
+    return -1;
+  }
+  for (i = 0; i < rib->peers_cnt; i++) {
+    *peer_find_slot(index, alloc, rib->peers, &rib->peers[i].key) = i + 1;
+  }
+  free(rib->peer_index);
+  rib->peer_index = index;
+  rib->peer_index_alloc = alloc;
+
+  if ((peers = realloc(rib->peers, sizeof(peer_t) * alloc / 2)) == NULL) {
+    return -1;
+  }
+  rib->peers = peers;
+  rib->peers_alloc = (int)(alloc / 2);
+  return 0;
+}
+
+static void peer_make_key(peer_key_t *key, int collector, uint32_t asn,
+                          const bgpstream_ip_addr_t *addr)
+{
+  memset(key, 0, sizeof(peer_key_t));
+  key->collector = (uint16_t)collector;
+  key->asn = asn;
+  if (addr->version == BGPSTREAM_ADDR_VERSION_IPV4) {
+    key->version = 4;
+    memcpy(key->addr, &addr->bs_ipv4.addr, 4);
+  } else if (addr->version == BGPSTREAM_ADDR_VERSION_IPV6) {
+    key->version = 6;
+    memcpy(key->addr, &addr->bs_ipv6.addr, 16);
+  }
+}
+
+/* get the index of the peer of an elem, adding it if needed (-1 if an error
+   occurred) */
+static int peer_get(pybgpstream_rib_t *rib, const bgpstream_elem_t *elem)
+{
+  peer_key_t key;
+  peer_t *peer;
+  int *slot;
+
+  peer_make_key(&key, rib->cur_collector, elem->peer_asn, &elem->peer_ip);
+
+  /* the elems of a record usually all come from the same peer */
+  if (rib->last_peer >= 0 &&
+      memcmp(&rib->peers[rib->last_peer].key, &key, sizeof(key)) == 0) {
+    return rib->last_peer;
+  }
+
+  if ((size_t)(rib->peers_cnt + 1) * 2 > rib->peer_index_alloc &&
+      peer_grow(rib) != 0) {
+    return -1;
+  }
+  slot = peer_find_slot(rib->peer_index, rib->peer_index_alloc, rib->peers,
+                        &key);
+  if (*slot == 0) {
+    peer = &rib->peers[rib->peers_cnt];
+    memset(peer, 0, sizeof(peer_t));
+    peer->key = key;
+    peer->state = BGPSTREAM_ELEM_PEERSTATE_UNKNOWN;
+    *slot = ++rib->peers_cnt;
+  }
+  return rib->last_peer = *slot - 1;
+}
+
+/* remove all the routes of a peer, or only those announced before the
+   given time */
+static void peer_clear(pybgpstream_rib_t *rib, peer_t *peer, int all,
+                       uint32_t before)
+{
+  trie_t *trie;
+  node_t *node;
+  uint32_t i;
+  int v;
+
+  for (v = 0; v < 2; v++) {
+    trie = &peer->tries[v];
+    for (i = 1; i < trie->nodes_cnt; i++) {
+      node = &trie->nodes[i];
+      if (node->attrs != NO_ATTRS && (all || node->time < before)) {
+        attrs_decref(rib, node->attrs);
+        node->attrs = NO_ATTRS;
+        peer->routes_cnt--;
+        rib->routes_cnt--;
+      }
+    }
+    if (all) {
+      /* the peer will announce a full table again (if it comes back), so
+         there is no point keeping the nodes around */
+      trie_free(trie);
+    }
+  }
+  rib->version++;
+}
+
+/* ========== COLLECTORS ========== */
+
+/* get the index of the given collector, adding it if needed */
+static int collector_get(pybgpstream_rib_t *rib, const char *name)
+{
+  collector_t *tmp;
+  int alloc;
+  int idx;
+
+  /* records of a collector come in runs */
+  if (rib->cur_collector >= 0 &&
+      strcmp(rib->collector_names.names[rib->cur_collector], name) == 0) {
+    return rib->cur_collector;
+  }
+  if ((idx = pybgpstream_names_get_idx(&rib->collector_names, name,
+                                       UINT16_MAX)) < 0) {
+    return -1;
+  }
+  if (idx == rib->collectors_alloc) {
+    alloc = (rib->collectors_alloc == 0) ? 16 : rib->collectors_alloc * 2;
+    if ((tmp = realloc(rib->collectors, sizeof(collector_t) * alloc)) ==
+        NULL) {
+      return -1;
+    }
+    memset(&tmp[rib->collectors_alloc], 0,
+           sizeof(collector_t) * (alloc - rib->collectors_alloc));
+    rib->collectors = tmp;
+    rib->collectors_alloc = alloc;
+  }
+  return idx;
+}
+
+/* ========== PUBLIC FUNCTIONS ========== */
+
+pybgpstream_rib_t *pybgpstream_rib_create()
+{
+  pybgpstream_rib_t *rib;
+
+  if ((rib = calloc(1, sizeof(pybgpstream_rib_t))) == NULL) {
+    return NULL;
+  }
+  rib->last_peer = -1;
+  rib->cur_collector = -1;
+  return rib;
+}
+
+pybgpstream_rib_t *pybgpstream_rib_copy(const pybgpstream_rib_t *rib)
+{
+  pybgpstream_rib_t *copy;
+  uint32_t i;
+  int j;
+  int v;
+
+  if ((copy = pybgpstream_rib_create()) == NULL) {
+    return NULL;
+  }
+  copy->cur_collector = rib->cur_collector;
+  copy->time = rib->time;
+  copy->routes_cnt = rib->routes_cnt;
+
+  if (rib->collectors_alloc > 0) {
+    if ((copy->collectors =
+           malloc(sizeof(collector_t) * rib->collectors_alloc)) == NULL ||
+        pybgpstream_names_copy(&copy->collector_names,
+                               &rib->collector_names) != 0) {
+      goto err;
+    }
+    memcpy(copy->collectors, rib->collectors,
+           sizeof(collector_t) * rib->collectors_alloc);
+    copy->collectors_alloc = rib->collectors_alloc;
+  }
+
+  if (rib->peers_alloc > 0) {
+    if ((copy->peers = calloc(rib->peers_alloc, sizeof(peer_t))) == NULL ||
+        (copy->peer_index = malloc(sizeof(int) * rib->peer_index_alloc)) ==
+          NULL) {
+      goto err;
+    }
+    copy->peers_alloc = rib->peers_alloc;
+    memcpy(copy->peer_index, rib->peer_index,
+           sizeof(int) * rib->peer_index_alloc);
+    copy->peer_index_alloc = rib->peer_index_alloc;
+    for (j = 0; j < rib->peers_cnt; j++) {
+      copy->peers[j] = rib->peers[j];
+      memset(copy->peers[j].tries, 0, sizeof(copy->peers[j].tries));
+      copy->peers_cnt++;
+      for (v = 0; v < 2; v++) {
+        if (trie_copy(&copy->peers[j].tries[v], &rib->peers[j].tries[v], v) !=
+            0) {
+          goto err;
+        }
+      }
+    }
+  }
+
+  if (rib->attrs_alloc > 0) {
+    if ((copy->attrs = calloc(rib->attrs_alloc, sizeof(attrs_t *))) ==
+          NULL ||
+        (copy->free_attrs = malloc(sizeof(uint32_t) * rib->attrs_alloc)) ==
+          NULL ||
+        (copy->attrs_index = malloc(sizeof(uint32_t) *
+                                    rib->attrs_index_alloc)) == NULL) {
+      goto err;
+    }
+    copy->attrs_cnt = rib->attrs_cnt;
+    copy->attrs_alloc = rib->attrs_alloc;
+    copy->free_attrs_alloc = rib->attrs_alloc;
+    for (i = 1; i < rib->attrs_cnt; i++) {
+      if (rib->attrs[i] == NULL) {
+        continue;
+      }
+      if ((copy->attrs[i] = malloc(attrs_size(rib->attrs[i]))) == NULL) {
+        goto err;
+      }
+      memcpy(copy->attrs[i], rib->attrs[i], attrs_size(rib->attrs[i]));
+    }
+    if (rib->free_attrs_cnt > 0) {
+      memcpy(copy->free_attrs, rib->free_attrs,
+             sizeof(uint32_t) * rib->free_attrs_cnt);
+    }
+    copy->free_attrs_cnt = rib->free_attrs_cnt;
+    memcpy(copy->attrs_index, rib->attrs_index,
+           sizeof(uint32_t) * rib->attrs_index_alloc);
+    copy->attrs_index_cnt = rib->attrs_index_cnt;
+    copy->attrs_bytes = rib->attrs_bytes;
+    copy->attrs_index_alloc = rib->attrs_index_alloc;
+  }
+
+  return copy;
+
+err:
+  pybgpstream_rib_destroy(copy);
+  return NULL;
+}
+
+void pybgpstream_rib_destroy(pybgpstream_rib_t *rib)
+{
+  uint32_t i;
+  int j;
+
+  if (rib == NULL) {
+    return;
+  }
+  for (j = 0; j < rib->peers_cnt; j++) {
+    trie_free(&rib->peers[j].tries[0]);
+    trie_free(&rib->peers[j].tries[1]);
+  }
+  free(rib->peers);
+  free(rib->peer_index);
+  pybgpstream_names_clear(&rib->collector_names);
+  free(rib->collectors);
+  for (i = 1; i < rib->attrs_cnt; i++) {
+    free(rib->attrs[i]);
+  }
+  free(rib->attrs);
+  free(rib->free_attrs);
+  free(rib->attrs_index);
+  free(rib->scratch);
+  free(rib);
+}
+
+int pybgpstream_rib_start_record(pybgpstream_rib_t *rib,
+                                 const bgpstream_record_t *rec)
+{
+  collector_t *collector;
+  int idx;
+  int i;
+
+  if ((idx = collector_get(rib, rec->collector_name)) < 0) {
+    return -1;
+  }
+  rib->cur_collector = idx;
+  rib->time = rec->time_sec;
+  collector = &rib->collectors[idx];
+
+  if (rec->type != BGPSTREAM_RIB) {
+    return 0;
+  }
+  if (rec->dump_pos == BGPSTREAM_DUMP_START) {
+    collector->rib_start = rec->time_sec;
+    collector->in_rib = 1;
+  } else if (rec->dump_pos == BGPSTREAM_DUMP_END && collector->in_rib) {
+    /* routes that were neither in the dump nor announced since it started
+       are gone (the routes in the last record are added back next) */
+    collector->in_rib = 0;
+    for (i = 0; i < rib->peers_cnt; i++) {
+      if (rib->peers[i].key.collector == idx) {
+        peer_clear(rib, &rib->peers[i], 0, collector->rib_start);
+      }
+    }
+  }
+  return 0;
+}
+
+int pybgpstream_rib_apply_elem(pybgpstream_rib_t *rib,
+                               const bgpstream_elem_t *elem)
+{
+  const uint8_t *addr;
+  int max_len;
+  peer_t *peer;
+  trie_t *trie;
+  node_t *node;
+  uint32_t idx;
+  uint32_t attrs;
+  int p;
+  int v;
+
+  if (rib->cur_collector < 0) {
+    return -1;
+  }
+
+  switch (elem->type) {
+  case BGPSTREAM_ELEM_TYPE_RIB:
+  case BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT:
+  case BGPSTREAM_ELEM_TYPE_WITHDRAWAL:
+    if ((v = get_pfx_info(&elem->prefix, &addr, &max_len)) < 0 ||
+        elem->prefix.mask_len > max_len) {
+      return 0;
+    }
+    if ((p = peer_get(rib, elem)) < 0) {
+      return -1;
+    }
+    peer = &rib->peers[p];
+    trie = &peer->tries[v];
+    rib->version++;
+
+    if (elem->type == BGPSTREAM_ELEM_TYPE_WITHDRAWAL) {
+      /* withdrawn prefixes keep their node, as they are likely to be
+         announced again */
+      if ((idx = trie_find_node(trie, v, addr, elem->prefix.mask_len)) ==
+            NO_NODE ||
+          trie->nodes[idx].attrs == NO_ATTRS) {
+        return 1;
+      }
+      node = &trie->nodes[idx];
+      attrs_decref(rib, node->attrs);
+      node->attrs = NO_ATTRS;
+      node->time = rib->time;
+      peer->routes_cnt--;
+      rib->routes_cnt--;
+      return 1;
+    }
+
+    if ((idx = trie_get_node(trie, v, addr, elem->prefix.mask_len)) ==
+          NO_NODE ||
+        (attrs = attrs_get(rib, elem)) == NO_ATTRS) {
+      return -1;
+    }
+    node = &trie->nodes[idx];
+    if (node->attrs != NO_ATTRS) {
+      attrs_decref(rib, node->attrs);
+    } else {
+      peer->routes_cnt++;
+      rib->routes_cnt++;
+    }
+    node->attrs = attrs;
+    node->time = rib->time;
+    return 1;
+
+  case BGPSTREAM_ELEM_TYPE_PEERSTATE:
+    if ((p = peer_get(rib, elem)) < 0) {
+      return -1;
+    }
+    peer = &rib->peers[p];
+    peer->state = elem->new_state;
+    if (elem->new_state != BGPSTREAM_ELEM_PEERSTATE_ESTABLISHED) {
+      peer_clear(rib, peer, 1, 0);
+    }
+    rib->version++;
+    return 1;
+
+  default:
+    return 0;
+  }
+}
+
+uint32_t pybgpstream_rib_get_time(const pybgpstream_rib_t *rib)
+{
+  return rib->time;
+}
+
+size_t pybgpstream_rib_get_size(const pybgpstream_rib_t *rib)
+{
+  return rib->routes_cnt;
+}
+
+uint64_t pybgpstream_rib_get_version(const pybgpstream_rib_t *rib)
+{
+  return rib->version;
+}
+
+int pybgpstream_rib_get_peers_cnt(const pybgpstream_rib_t *rib)
+{
+  return rib->peers_cnt;
+}
+
+void pybgpstream_rib_get_peer(const pybgpstream_rib_t *rib, int idx,
+                              pybgpstream_rib_peer_t *peer)
+{
+  const peer_t *p = &rib->peers[idx];
+
+  memset(peer, 0, sizeof(pybgpstream_rib_peer_t));
+  peer->collector = rib->collector_names.names[p->key.collector];
+  peer->asn = p->key.asn;
+  if (p->key.version == 4) {
+    peer->addr.version = BGPSTREAM_ADDR_VERSION_IPV4;
+    memcpy(&peer->addr.bs_ipv4.addr, p->key.addr, 4);
+  } else if (p->key.version == 6) {
+    peer->addr.version = BGPSTREAM_ADDR_VERSION_IPV6;
+    memcpy(&peer->addr.bs_ipv6.addr, p->key.addr, 16);
+  }
+  peer->state = p->state;
+  peer->routes_cnt = p->routes_cnt;
+}
+
+int pybgpstream_rib_find_peer(const pybgpstream_rib_t *rib,
+                              const char *collector, uint32_t asn,
+                              const bgpstream_ip_addr_t *addr)
+{
+  peer_key_t key;
+  int c;
+
+  if (rib->peers_cnt == 0) {
+    return -1;
+  }
+  for (c = 0; c < rib->collector_names.cnt; c++) {
+    if (strcmp(rib->collector_names.names[c], collector) == 0) {
+      break;
+    }
+  }
+  if (c == rib->collector_names.cnt) {
+    return -1;
+  }
+  peer_make_key(&key, c, asn, addr);
+  return *peer_find_slot(rib->peer_index, rib->peer_index_alloc, rib->peers,
+                         &key) -
+         1;
+}
+
+/* fill a route from a trie node */
+static void get_route(const pybgpstream_rib_t *rib, const trie_t *trie,
+                      int v, uint32_t idx, pybgpstream_rib_route_t *route)
+{
+  const node_t *node = &trie->nodes[idx];
+  const attrs_t *attrs = rib->attrs[node->attrs];
+
+  memset(route, 0, sizeof(pybgpstream_rib_route_t));
+  route->prefix.mask_len = node->len;
+  if (v == 0) {
+    route->prefix.address.version = BGPSTREAM_ADDR_VERSION_IPV4;
+    memcpy(&route->prefix.address.bs_ipv4.addr, NODE_ADDR(trie, v, idx), 4);
+  } else {
+    route->prefix.address.version = BGPSTREAM_ADDR_VERSION_IPV6;
+    memcpy(&route->prefix.address.bs_ipv6.addr, NODE_ADDR(trie, v, idx), 16);
+  }
+  route->time = node->time;
+
+  if (attrs->next_hop_version == 4) {
+    route->next_hop.version = BGPSTREAM_ADDR_VERSION_IPV4;
+    memcpy(&route->next_hop.bs_ipv4.addr, attrs->next_hop, 4);
+  } else if (attrs->next_hop_version == 6) {
+    route->next_hop.version = BGPSTREAM_ADDR_VERSION_IPV6;
+    memcpy(&route->next_hop.bs_ipv6.addr, attrs->next_hop, 16);
+  }
+  route->communities = attrs->data;
+  route->communities_cnt = attrs->communities_cnt;
+  route->as_path_data = (const uint8_t *)&attrs->data[attrs->communities_cnt];
+  route->as_path_len = attrs->as_path_len;
+}
+
+int pybgpstream_rib_lookup(const pybgpstream_rib_t *rib, int peer,
+                           const bgpstream_pfx_t *pfx,
+                           pybgpstream_rib_route_t *route)
+{
+  const trie_t *trie;
+  const uint8_t *addr;
+  int max_len;
+  uint32_t idx;
+  int v;
+
+  if ((v = get_pfx_info(pfx, &addr, &max_len)) < 0 ||
+      pfx->mask_len > max_len) {
+    return 0;
+  }
+  trie = &rib->peers[peer].tries[v];
+  if ((idx = trie_find_node(trie, v, addr, pfx->mask_len)) == NO_NODE ||
+      trie->nodes[idx].attrs == NO_ATTRS) {
+    return 0;
+  }
+  get_route(rib, trie, v, idx, route);
+  return 1;
+}
+
+int pybgpstream_rib_longest_match(const pybgpstream_rib_t *rib, int peer,
+                                  const bgpstream_pfx_t *pfx,
+                                  pybgpstream_rib_route_t *route)
+{
+  const trie_t *trie;
+  const uint8_t *addr;
+  int max_len;
+  uint32_t idx;
+  int v;
+
+  if ((v = get_pfx_info(pfx, &addr, &max_len)) < 0 ||
+      pfx->mask_len > max_len) {
+    return 0;
+  }
+  trie = &rib->peers[peer].tries[v];
+  if ((idx = trie_find_covering(trie, v, addr, pfx->mask_len)) == NO_NODE) {
+    return 0;
+  }
+  get_route(rib, trie, v, idx, route);
+  return 1;
+}
+
+void pybgpstream_rib_iter_init(const pybgpstream_rib_t *rib,
+                               pybgpstream_rib_iter_t *iter, int peer)
+{
+  iter->peer = peer;
+  iter->trie = 0;
+  iter->depth = 0;
+  if (rib->peers[peer].tries[0].root != NO_NODE) {
+    iter->stack[iter->depth++] = rib->peers[peer].tries[0].root;
+  }
+}
+
+int pybgpstream_rib_iter_next(const pybgpstream_rib_t *rib,
+                              pybgpstream_rib_iter_t *iter,
+                              pybgpstream_rib_route_t *route)
+{
+  const trie_t *trie;
+  const node_t *node;
+  uint32_t idx;
+
+  while (iter->trie < 2) {
+    trie = &rib->peers[iter->peer].tries[iter->trie];
+    while (iter->depth > 0) {
+      /* visiting a node before its children (the 0 branch first) walks
+         the prefixes in order; there is at most one pending sibling per
+         level */
+      idx = iter->stack[--iter->depth];
+      node = &trie->nodes[idx];
+      if (node->child[1] != NO_NODE) {
+        iter->stack[iter->depth++] = node->child[1];
+      }
+      if (node->child[0] != NO_NODE) {
+        iter->stack[iter->depth++] = node->child[0];
+      }
+      if (node->attrs != NO_ATTRS) {
+        get_route(rib, trie, iter->trie, idx, route);
+        return 1;
+      }
+    }
+    if (++iter->trie < 2 &&
+        rib->peers[iter->peer].tries[iter->trie].root != NO_NODE) {
+      iter->stack[iter->depth++] = rib->peers[iter->peer].tries[1].root;
+    }
+  }
+  return 0;
+}
+
+void pybgpstream_rib_get_info(const pybgpstream_rib_t *rib,
+                              pybgpstream_rib_info_t *info)
+{
+  const trie_t *trie;
+  int j;
+  int v;
+
+  memset(info, 0, sizeof(pybgpstream_rib_info_t));
+  info->peers_cnt = rib->peers_cnt;
+  info->routes_cnt = rib->routes_cnt;
+  info->attrs_cnt = rib->attrs_index_cnt;
+
+  info->peers_memory = sizeof(pybgpstream_rib_t) +
+                       sizeof(peer_t) * rib->peers_alloc +
+                       sizeof(int) * rib->peer_index_alloc +
+                       sizeof(collector_t) * rib->collectors_alloc +
+                       sizeof(char *) * rib->collector_names.alloc;
+  for (j = 0; j < rib->collector_names.cnt; j++) {
+    info->peers_memory += strlen(rib->collector_names.names[j]) + 1;
+  }
+
+  for (j = 0; j < rib->peers_cnt; j++) {
+    for (v = 0; v < 2; v++) {
+      trie = &rib->peers[j].tries[v];
+      if (trie->nodes_cnt > 0) {
+        info->nodes_cnt += trie->nodes_cnt - 1;
+      }
+      info->tries_memory +=
+        (sizeof(node_t) + ADDR_LEN(v)) * (size_t)trie->nodes_alloc;
+    }
+  }
+
+  info->attrs_memory = (sizeof(attrs_t *) + sizeof(uint32_t)) *
+                         (size_t)rib->attrs_alloc +
+                       sizeof(uint32_t) * rib->attrs_index_alloc +
+                       rib->scratch_alloc + rib->attrs_bytes;
+}
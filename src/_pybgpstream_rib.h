@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_RIB_H
+#define ___PYBGPSTREAM_RIB_H
+
+#include <bgpstream.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Opaque struct holding the routing table of every peer seen in a stream.
+ *
+ * The prefixes of each peer are kept in a Patricia trie per address family,
+ * and each route refers to a set of path attributes (next hop, AS path and
+ * communities) that is stored once in a table shared by all peers.
+ *
+ * None of these functions touch the Python API.
+ */
+typedef struct pybgpstream_rib pybgpstream_rib_t;
+
+/** A peer of the routing table */
+typedef struct {
+
+  /** Name of the collector the peer is seen at */
+  const char *collector;
+
+  /** ASN of the peer */
+  uint32_t asn;
+
+  /** Address of the peer */
+  bgpstream_ip_addr_t addr;
+
+  /** Last session state seen for the peer (UNKNOWN if none was seen) */
+  bgpstream_elem_peerstate_t state;
+
+  /** Number of routes of the peer */
+  size_t routes_cnt;
+
+} pybgpstream_rib_peer_t;
+
+/** A route of a peer
+ *
+ * The pointers are only valid until the routing table is next changed.
+ */
+typedef struct {
+
+  /** Prefix of the route */
+  bgpstream_pfx_t prefix;
+
+  /** Time of the record that last announced the route */
+  uint32_t time;
+
+  /** Next hop (with an unknown version if there is none) */
+  bgpstream_ip_addr_t next_hop;
+
+  /** AS path, in the format of bgpstream_as_path_get_data */
+  const uint8_t *as_path_data;
+  uint16_t as_path_len;
+
+  /** Communities, as (asn << 16 | value), in ascending order */
+  const uint32_t *communities;
+  int communities_cnt;
+
+} pybgpstream_rib_route_t;
+
+/** Sizes of a routing table */
+typedef struct {
+
+  /** Number of peers, routes, trie nodes and distinct attribute sets */
+  size_t peers_cnt;
+  size_t routes_cnt;
+  size_t nodes_cnt;
+  size_t attrs_cnt;
+
+  /** Number of bytes of memory used by the peers, the tries and the
+      attribute table */
+  size_t peers_memory;
+  size_t tries_memory;
+  size_t attrs_memory;
+
+} pybgpstream_rib_info_t;
+
+/** Iterator over the routes of a peer, in prefix order (IPv4 first) */
+typedef struct {
+
+  /** Index of the peer */
+  int peer;
+
+  /** Trie (0 for IPv4, 1 for IPv6) being walked */
+  int trie;
+
+  /** Nodes left to visit in the trie */
+  uint32_t stack[130];
+  int depth;
+
+} pybgpstream_rib_iter_t;
+
+/** Create an empty routing table
+ *
+ * @return pointer to the table, or NULL if an error occurred
+ */
+pybgpstream_rib_t *pybgpstream_rib_create(void);
+
+/** Create an independent copy of the given routing table
+ *
+ * @return pointer to the copy, or NULL if an error occurred
+ */
+pybgpstream_rib_t *pybgpstream_rib_copy(const pybgpstream_rib_t *rib);
+
+/** Destroy the given routing table */
+void pybgpstream_rib_destroy(pybgpstream_rib_t *rib);
+
+/** Start applying the elems of a record to the given routing table
+ *
+ * @param rib           pointer to the table
+ * @param rec           pointer to the record
+ * @return 0 if successful, -1 if an error occurred
+ *
+ * The routes of a collector that were not refreshed by a RIB dump are
+ * removed when the last record of the dump is started. Starting the same
+ * record more than once has no further effect.
+ */
+int pybgpstream_rib_start_record(pybgpstream_rib_t *rib,
+                                 const bgpstream_record_t *rec);
+
+/** Apply an elem of the last record started to the given routing table
+ *
+ * @param rib           pointer to the table
+ * @param elem          pointer to the elem
+ * @return 1 if the elem was applied, 0 if its type is not handled, -1 if
+ *         an error occurred
+ *
+ * RIB and announcement elems replace the route of the peer for the prefix,
+ * withdrawal elems remove it, and peer state elems remove all the routes of
+ * the peer unless its new state is established.
+ */
+int pybgpstream_rib_apply_elem(pybgpstream_rib_t *rib,
+                               const bgpstream_elem_t *elem);
+
+/** Get the time of the last record started (0 if there was none) */
+uint32_t pybgpstream_rib_get_time(const pybgpstream_rib_t *rib);
+
+/** Get the number of routes of all the peers of the given table */
+size_t pybgpstream_rib_get_size(const pybgpstream_rib_t *rib);
+
+/** Get a number that changes every time the given table is changed */
+uint64_t pybgpstream_rib_get_version(const pybgpstream_rib_t *rib);
+
+/** Get the number of peers of the given table */
+int pybgpstream_rib_get_peers_cnt(const pybgpstream_rib_t *rib);
+
+/** Get a peer of the given table
+ *
+ * @param rib           pointer to the table
+ * @param idx           index of the peer (less than the number of peers)
+ * @param[out] peer     set to the peer
+ */
+void pybgpstream_rib_get_peer(const pybgpstream_rib_t *rib, int idx,
+                              pybgpstream_rib_peer_t *peer);
+
+/** Find a peer of the given table
+ *
+ * @return index of the peer, or -1 if it is not in the table
+ */
+int pybgpstream_rib_find_peer(const pybgpstream_rib_t *rib,
+                              const char *collector, uint32_t asn,
+                              const bgpstream_ip_addr_t *addr);
+
+/** Get the route of a peer for a prefix
+ *
+ * @param rib           pointer to the table
+ * @param peer          index of the peer
+ * @param pfx           prefix to look up
+ * @param[out] route    set to the route
+ * @return 1 if the peer has a route for exactly the prefix, 0 otherwise
+ */
+int pybgpstream_rib_lookup(const pybgpstream_rib_t *rib, int peer,
+                           const bgpstream_pfx_t *pfx,
+                           pybgpstream_rib_route_t *route);
+
+/** Get the most specific route of a peer that covers a prefix
+ *
+ * @param rib           pointer to the table
+ * @param peer          index of the peer
+ * @param pfx           prefix (or full-length address) to look up
+ * @param[out] route    set to the route
+ * @return 1 if the peer has a route covering the prefix, 0 otherwise
+ */
+int pybgpstream_rib_longest_match(const pybgpstream_rib_t *rib, int peer,
+                                  const bgpstream_pfx_t *pfx,
+                                  pybgpstream_rib_route_t *route);
+
+/** Initialize an iterator over the routes of a peer */
+void pybgpstream_rib_iter_init(const pybgpstream_rib_t *rib,
+                               pybgpstream_rib_iter_t *iter, int peer);
+
+/** Get the next route of an iterator
+ *
+ * @param rib           pointer to the table
+ * @param iter          pointer to the iterator
+ * @param[out] route    set to the next route
+ * @return 1 if a route was returned, 0 if there are no more routes
+ *
+ * The iterator must not be used once the table has been changed.
+ */
+int pybgpstream_rib_iter_next(const pybgpstream_rib_t *rib,
+                              pybgpstream_rib_iter_t *iter,
+                              pybgpstream_rib_route_t *route);
+
+/** Get the sizes and memory usage of the given table */
+void pybgpstream_rib_get_info(const pybgpstream_rib_t *rib,
+                              pybgpstream_rib_info_t *info);
+
+#endif /* ___PYBGPSTREAM_RIB_H */
@@ -0,0 +1,770 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_routingtable.h"
+#include "_pybgpstream_bgpelem.h"
+#include "_pybgpstream_module.h"
+#include "pyutils.h"
+#include <Python.h>
+#include <stdio.h>
+#include <string.h>
+
+#define RoutingTableDocstring "RoutingTable object"
+
+typedef struct {
+  PyObject_HEAD
+
+    /* Table whose routes are iterated over */
+    RoutingTableObject *table;
+
+    /* Position in the table */
+    pybgpstream_rib_iter_t iter;
+
+    /* Version of the table when the iterator was created */
+    uint64_t version;
+
+    /* AS path that routes are decoded into */
+    bgpstream_as_path_t *path;
+
+} RoutingTableIterObject;
+
+static PyTypeObject RoutingTableType;
+
+static void RoutingTable_lock(RoutingTableObject *self)
+{
+  if (pthread_mutex_trylock(&self->lock) != 0) {
+    Py_BEGIN_ALLOW_THREADS;
+    pthread_mutex_lock(&self->lock);
+    Py_END_ALLOW_THREADS;
+  }
+}
+
+static void RoutingTable_unlock(RoutingTableObject *self)
+{
+  pthread_mutex_unlock(&self->lock);
+}
+
+static PyObject *get_addr_pystr(const bgpstream_ip_addr_t *addr)
+{
+  if (addr->version != BGPSTREAM_ADDR_VERSION_IPV4 &&
+      addr->version != BGPSTREAM_ADDR_VERSION_IPV6) {
+    Py_RETURN_NONE;
+  }
+  return get_ip_pystr((bgpstream_ip_addr_t *)addr);
+}
+
+static PyObject *get_aspath_pystr(bgpstream_as_path_t *path,
+                                  const pybgpstream_rib_route_t *route)
+{
+  char buf[4096] = "";
+  char *bufp;
+  PyObject *pystr;
+  int len;
+
+  if (bgpstream_as_path_populate_from_data(path, route->as_path_data,
+                                           route->as_path_len) != 0) {
+    return PyErr_NoMemory();
+  }
+  if ((len = bgpstream_as_path_snprintf(buf, sizeof(buf), path)) <
+      (int)sizeof(buf)) {
+    return PYSTR_FROMSTR(buf);
+  }
+  if ((bufp = malloc(len + 1)) == NULL) {
+    return PyErr_NoMemory();
+  }
+  bgpstream_as_path_snprintf(bufp, len + 1, path);
+  pystr = PYSTR_FROMSTR(bufp);
+  free(bufp);
+  return pystr;
+}
+
+static PyObject *get_communities_pyset(const pybgpstream_rib_route_t *route)
+{
+  PyObject *set;
+  PyObject *pystr;
+  char buf[16];
+  int err;
+  int i;
+
+  if ((set = PySet_New(NULL)) == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < route->communities_cnt; i++) {
+    snprintf(buf, sizeof(buf), "%u:%u", route->communities[i] >> 16,
+             route->communities[i] & 0xffff);
+    if ((pystr = PYSTR_FROMSTR(buf)) == NULL) {
+      Py_DECREF(set);
+      return NULL;
+    }
+    err = PySet_Add(set, pystr);
+    Py_DECREF(pystr);
+    if (err != 0) {
+      Py_DECREF(set);
+      return NULL;
+    }
+  }
+  return set;
+}
+
+/* build the dict of a route, with the same keys as the elem fields */
+static PyObject *get_route_pydict(const pybgpstream_rib_route_t *route,
+                                  bgpstream_as_path_t *path)
+{
+  char pfx_str[INET6_ADDRSTRLEN + 3] = "";
+
+  bgpstream_pfx_snprintf(pfx_str, sizeof(pfx_str),
+                         (bgpstream_pfx_t *)&route->prefix);
+  return Py_BuildValue("{s:s,s:N,s:N,s:N,s:k}", "prefix", pfx_str,
+                       "next-hop", get_addr_pystr(&route->next_hop),
+                       "as-path", get_aspath_pystr(path, route),
+                       "communities", get_communities_pyset(route), "time",
+                       (unsigned long)route->time);
+}
+
+static PyObject *get_peer_pytuple(const pybgpstream_rib_peer_t *peer)
+{
+  return Py_BuildValue("(skN)", peer->collector, (unsigned long)peer->asn,
+                       get_addr_pystr(&peer->addr));
+}
+
+/* parse a prefix, or an address (as a full-length prefix) if allowed */
+static int parse_pfx(const char *str, int allow_addr, bgpstream_pfx_t *pfx)
+{
+  memset(pfx, 0, sizeof(bgpstream_pfx_t));
+  if (strchr(str, '/') != NULL) {
+    if (bgpstream_str2pfx(str, pfx) != NULL) {
+      return 0;
+    }
+  } else if (allow_addr && bgpstream_str2addr(str, &pfx->address) != NULL) {
+    pfx->mask_len =
+      (pfx->address.version == BGPSTREAM_ADDR_VERSION_IPV4) ? 32 : 128;
+    return 0;
+  }
+  PyErr_Format(PyExc_ValueError, "Invalid %s: %s",
+               allow_addr ? "address or prefix" : "prefix", str);
+  return -1;
+}
+
+/* find the peer given as a (collector, peer_asn, peer_address) tuple (the
+   table must be locked) */
+static int find_peer(RoutingTableObject *self, PyObject *peer)
+{
+  const char *collector;
+  unsigned long asn;
+  const char *addr_str;
+  bgpstream_ip_addr_t addr;
+  int idx;
+
+  if (!PyTuple_Check(peer) ||
+      !PyArg_ParseTuple(peer, "sks", &collector, &asn, &addr_str)) {
+    PyErr_Clear();
+    PyErr_SetString(PyExc_TypeError,
+                    "Peer must be a (collector, peer_asn, peer_address) "
+                    "tuple");
+    return -1;
+  }
+  memset(&addr, 0, sizeof(addr));
+  if (bgpstream_str2addr(addr_str, &addr) == NULL) {
+    PyErr_Format(PyExc_ValueError, "Invalid peer address: %s", addr_str);
+    return -1;
+  }
+  if ((idx = pybgpstream_rib_find_peer(self->rib, collector, (uint32_t)asn,
+                                       &addr)) < 0) {
+    PyErr_SetObject(PyExc_KeyError, peer);
+  }
+  return idx;
+}
+
+static void RoutingTable_dealloc(RoutingTableObject *self)
+{
+  pybgpstream_rib_destroy(self->rib);
+  pybgpstream_detached_record_destroy(self->pending);
+  pthread_mutex_destroy(&self->lock);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *RoutingTable_new(PyTypeObject *type, PyObject *args,
+                                  PyObject *kwds)
+{
+  RoutingTableObject *self;
+
+  self = (RoutingTableObject *)type->tp_alloc(type, 0);
+  if (self == NULL) {
+    return NULL;
+  }
+  pthread_mutex_init(&self->lock, NULL);
+
+  if ((self->rib = pybgpstream_rib_create()) == NULL) {
+    Py_DECREF(self);
+    return PyErr_NoMemory();
+  }
+
+  return (PyObject *)self;
+}
+
+/** Apply an elem to the table */
+static PyObject *RoutingTable_apply(RoutingTableObject *self, PyObject *args)
+{
+  /* args: elem (BGPElem) */
+  BGPElemObject *elem;
+  int ret;
+
+  if (!PyArg_ParseTuple(args, "O!", _pybgpstream_bgpstream_get_BGPElemType(),
+                        &elem)) {
+    return NULL;
+  }
+  if (elem->elem == NULL || elem->record == NULL ||
+      elem->record->rec == NULL) {
+    PyErr_SetString(PyExc_ValueError, "Elem does not belong to a record");
+    return NULL;
+  }
+
+  RoutingTable_lock(self);
+  if ((ret = pybgpstream_rib_start_record(self->rib, elem->record->rec)) ==
+      0) {
+    ret = pybgpstream_rib_apply_elem(self->rib, elem->elem);
+  }
+  RoutingTable_unlock(self);
+
+  if (ret < 0) {
+    return PyErr_NoMemory();
+  }
+  return PyBool_FromLong(ret);
+}
+
+/* look up a prefix (exactly, or its longest match) in the routes of one or
+   all peers */
+static PyObject *find_routes(RoutingTableObject *self, PyObject *args,
+                             PyObject *kwds, int longest)
+{
+  /* args: prefix (str), peer (tuple) */
+  static char *kwlist[] = {"prefix", "peer", NULL};
+  const char *pfx_str;
+  PyObject *peer = Py_None;
+  PyObject *result = NULL;
+  PyObject *key;
+  PyObject *value;
+  bgpstream_as_path_t *path;
+  bgpstream_pfx_t pfx;
+  pybgpstream_rib_peer_t peer_info;
+  pybgpstream_rib_route_t route;
+  int peers_cnt;
+  int found;
+  int idx;
+  int err;
+  int i;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|O", kwlist, &pfx_str,
+                                   &peer) ||
+      parse_pfx(pfx_str, longest, &pfx) != 0) {
+    return NULL;
+  }
+  if ((path = bgpstream_as_path_create()) == NULL) {
+    return PyErr_NoMemory();
+  }
+
+  RoutingTable_lock(self);
+
+  if (peer != Py_None) {
+    if ((idx = find_peer(self, peer)) >= 0) {
+      found = longest ?
+        pybgpstream_rib_longest_match(self->rib, idx, &pfx, &route) :
+        pybgpstream_rib_lookup(self->rib, idx, &pfx, &route);
+      if (found) {
+        result = get_route_pydict(&route, path);
+      } else {
+        Py_INCREF(Py_None);
+        result = Py_None;
+      }
+    }
+    goto done;
+  }
+
+  if ((result = PyDict_New()) == NULL) {
+    goto done;
+  }
+  peers_cnt = pybgpstream_rib_get_peers_cnt(self->rib);
+  for (i = 0; i < peers_cnt; i++) {
+    found = longest ?
+      pybgpstream_rib_longest_match(self->rib, i, &pfx, &route) :
+      pybgpstream_rib_lookup(self->rib, i, &pfx, &route);
+    if (!found) {
+      continue;
+    }
+    pybgpstream_rib_get_peer(self->rib, i, &peer_info);
+    key = get_peer_pytuple(&peer_info);
+    value = get_route_pydict(&route, path);
+    err = (key == NULL || value == NULL ||
+           PyDict_SetItem(result, key, value) != 0);
+    Py_XDECREF(key);
+    Py_XDECREF(value);
+    if (err) {
+      Py_CLEAR(result);
+      goto done;
+    }
+  }
+
+done:
+  RoutingTable_unlock(self);
+  bgpstream_as_path_destroy(path);
+  return result;
+}
+
+/** Get the routes of one or all peers for exactly a prefix */
+static PyObject *RoutingTable_lookup(RoutingTableObject *self, PyObject *args,
+                                     PyObject *kwds)
+{
+  return find_routes(self, args, kwds, 0);
+}
+
+/** Get the most specific routes of one or all peers covering a prefix */
+static PyObject *RoutingTable_longest_match(RoutingTableObject *self,
+                                            PyObject *args, PyObject *kwds)
+{
+  return find_routes(self, args, kwds, 1);
+}
+
+/** Iterate over the routes of a peer */
+static PyObject *RoutingTable_get_routes(RoutingTableObject *self,
+                                         PyObject *args)
+{
+  /* args: peer (tuple) */
+  PyObject *peer;
+  RoutingTableIterObject *it;
+  int idx;
+
+  if (!PyArg_ParseTuple(args, "O", &peer)) {
+    return NULL;
+  }
+  it = PyObject_New(RoutingTableIterObject,
+                    _pybgpstream_bgpstream_get_RoutingTableIterType());
+  if (it == NULL) {
+    return NULL;
+  }
+  it->table = NULL;
+  if ((it->path = bgpstream_as_path_create()) == NULL) {
+    Py_DECREF(it);
+    return PyErr_NoMemory();
+  }
+
+  RoutingTable_lock(self);
+  if ((idx = find_peer(self, peer)) >= 0) {
+    pybgpstream_rib_iter_init(self->rib, &it->iter, idx);
+    it->version = pybgpstream_rib_get_version(self->rib);
+  }
+  RoutingTable_unlock(self);
+
+  if (idx < 0) {
+    Py_DECREF(it);
+    return NULL;
+  }
+  Py_INCREF(self);
+  it->table = self;
+  return (PyObject *)it;
+}
+
+/** Get the peers of the table */
+static PyObject *RoutingTable_get_peers(RoutingTableObject *self)
+{
+  PyObject *result;
+  PyObject *key;
+  PyObject *value;
+  pybgpstream_rib_peer_t peer;
+  char state[128];
+  int peers_cnt;
+  int err;
+  int i;
+
+  if ((result = PyDict_New()) == NULL) {
+    return NULL;
+  }
+
+  RoutingTable_lock(self);
+  peers_cnt = pybgpstream_rib_get_peers_cnt(self->rib);
+  for (i = 0; i < peers_cnt; i++) {
+    pybgpstream_rib_get_peer(self->rib, i, &peer);
+    bgpstream_elem_peerstate_snprintf(state, sizeof(state), peer.state);
+    key = get_peer_pytuple(&peer);
+    value = Py_BuildValue("{s:N,s:n}", "state", _pybgpstream_intern_str(state),
+                          "routes", (Py_ssize_t)peer.routes_cnt);
+    err = (key == NULL || value == NULL ||
+           PyDict_SetItem(result, key, value) != 0);
+    Py_XDECREF(key);
+    Py_XDECREF(value);
+    if (err) {
+      Py_CLEAR(result);
+      break;
+    }
+  }
+  RoutingTable_unlock(self);
+
+  return result;
+}
+
+/** Get an independent copy of the table */
+static PyObject *RoutingTable_snapshot(RoutingTableObject *self)
+{
+  RoutingTableObject *copy;
+  pybgpstream_rib_t *rib;
+
+  if ((copy = (RoutingTableObject *)PyObject_CallObject(
+         (PyObject *)Py_TYPE(self), NULL)) == NULL) {
+    return NULL;
+  }
+
+  Py_BEGIN_ALLOW_THREADS;
+  pthread_mutex_lock(&self->lock);
+  rib = pybgpstream_rib_copy(self->rib);
+  pthread_mutex_unlock(&self->lock);
+  Py_END_ALLOW_THREADS;
+
+  if (rib == NULL) {
+    Py_DECREF(copy);
+    return PyErr_NoMemory();
+  }
+  pybgpstream_rib_destroy(copy->rib);
+  copy->rib = rib;
+  return (PyObject *)copy;
+}
+
+/** Get the sizes and memory usage of the table */
+static PyObject *RoutingTable_get_stats(RoutingTableObject *self)
+{
+  pybgpstream_rib_info_t info;
+
+  RoutingTable_lock(self);
+  pybgpstream_rib_get_info(self->rib, &info);
+  RoutingTable_unlock(self);
+
+  return Py_BuildValue("{s:n,s:n,s:n,s:n,s:{s:n,s:n,s:n}}", "peers",
+                       (Py_ssize_t)info.peers_cnt, "routes",
+                       (Py_ssize_t)info.routes_cnt, "nodes",
+                       (Py_ssize_t)info.nodes_cnt, "attributes",
+                       (Py_ssize_t)info.attrs_cnt, "memory", "peers",
+                       (Py_ssize_t)info.peers_memory, "tries",
+                       (Py_ssize_t)info.tries_memory, "attributes",
+                       (Py_ssize_t)info.attrs_memory);
+}
+
+static Py_ssize_t RoutingTable_len(RoutingTableObject *self)
+{
+  Py_ssize_t len;
+
+  RoutingTable_lock(self);
+  len = (Py_ssize_t)pybgpstream_rib_get_size(self->rib);
+  RoutingTable_unlock(self);
+  return len;
+}
+
+static PyObject *RoutingTable_get_memory(RoutingTableObject *self,
+                                         void *closure)
+{
+  pybgpstream_rib_info_t info;
+
+  RoutingTable_lock(self);
+  pybgpstream_rib_get_info(self->rib, &info);
+  RoutingTable_unlock(self);
+  return PyLong_FromSize_t(info.peers_memory + info.tries_memory +
+                           info.attrs_memory);
+}
+
+static PyObject *RoutingTable_get_time(RoutingTableObject *self,
+                                       void *closure)
+{
+  uint32_t time;
+
+  RoutingTable_lock(self);
+  time = pybgpstream_rib_get_time(self->rib);
+  RoutingTable_unlock(self);
+  return PyLong_FromUnsignedLong(time);
+}
+
+static PyMethodDef RoutingTable_methods[] = {
+
+  {"apply", (PyCFunction)RoutingTable_apply, METH_VARARGS,
+   "Apply an elem to the table"},
+
+  {"lookup", (PyCFunction)RoutingTable_lookup, METH_VARARGS | METH_KEYWORDS,
+   "Get the routes of one or all peers for exactly the given prefix"},
+
+  {"longest_match", (PyCFunction)RoutingTable_longest_match,
+   METH_VARARGS | METH_KEYWORDS,
+   "Get the most specific routes of one or all peers that cover the given "
+   "address or prefix"},
+
+  {"get_routes", (PyCFunction)RoutingTable_get_routes, METH_VARARGS,
+   "Iterate over the routes of a peer, in prefix order"},
+
+  {"get_peers", (PyCFunction)RoutingTable_get_peers, METH_NOARGS,
+   "Get the peers of the table, with their state and number of routes"},
+
+  {"snapshot", (PyCFunction)RoutingTable_snapshot, METH_NOARGS,
+   "Get an independent copy of the table"},
+
+  {"get_stats", (PyCFunction)RoutingTable_get_stats, METH_NOARGS,
+   "Get the sizes and memory usage of the table"},
+
+  {NULL} /* Sentinel */
+};
+
+static PyGetSetDef RoutingTable_getsetters[] = {
+
+  {"memory", (getter)RoutingTable_get_memory, NULL,
+   "Number of bytes of memory used by the table", NULL},
+
+  {"time", (getter)RoutingTable_get_time, NULL,
+   "Time of the last record applied to the table", NULL},
+
+  {NULL} /* Sentinel */
+};
+
+static PySequenceMethods RoutingTable_as_sequence = {
+  (lenfunc)RoutingTable_len, /* sq_length */
+};
+
+static PyTypeObject RoutingTableType = {
+  PyVarObject_HEAD_INIT(NULL, 0) "_pybgpstream.RoutingTable", /* tp_name */
+  sizeof(RoutingTableObject),            /* tp_basicsize */
+  0,                                     /* tp_itemsize */
+  (destructor)RoutingTable_dealloc,      /* tp_dealloc */
+  0,                                     /* tp_print */
+  0,                                     /* tp_getattr */
+  0,                                     /* tp_setattr */
+  0,                                     /* tp_compare */
+  0,                                     /* tp_repr */
+  0,                                     /* tp_as_number */
+  &RoutingTable_as_sequence,             /* tp_as_sequence */
+  0,                                     /* tp_as_mapping */
+  0,                                     /* tp_hash */
+  0,                                     /* tp_call */
+  0,                                     /* tp_str */
+  0,                                     /* tp_getattro */
+  0,                                     /* tp_setattro */
+  0,                                     /* tp_as_buffer */
+  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /* tp_flags */
+  RoutingTableDocstring,                 /* tp_doc */
+  0,                                     /* tp_traverse */
+  0,                                     /* tp_clear */
+  0,                                     /* tp_richcompare */
+  0,                                     /* tp_weaklistoffset */
+  0,                                     /* tp_iter */
+  0,                                     /* tp_iternext */
+  RoutingTable_methods,                  /* tp_methods */
+  0,                                     /* tp_members */
+  RoutingTable_getsetters,               /* tp_getset */
+  0,                                     /* tp_base */
+  0,                                     /* tp_dict */
+  0,                                     /* tp_descr_get */
+  0,                                     /* tp_descr_set */
+  0,                                     /* tp_dictoffset */
+  0,                                     /* tp_init */
+  0,                                     /* tp_alloc */
+  RoutingTable_new,                      /* tp_new */
+};
+
+PyTypeObject *_pybgpstream_bgpstream_get_RoutingTableType()
+{
+  return &RoutingTableType;
+}
+
+/* ========== ITERATOR ========== */
+
+static void RoutingTableIter_dealloc(RoutingTableIterObject *self)
+{
+  Py_XDECREF(self->table);
+  bgpstream_as_path_destroy(self->path);
+  PyObject_Del(self);
+}
+
+static PyObject *RoutingTableIter_iternext(RoutingTableIterObject *self)
+{
+  RoutingTableObject *table = self->table;
+  pybgpstream_rib_route_t route;
+  PyObject *result = NULL;
+
+  if (table == NULL) {
+    return NULL;
+  }
+
+  RoutingTable_lock(table);
+  if (pybgpstream_rib_get_version(table->rib) != self->version) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "RoutingTable changed during iteration");
+  } else if (pybgpstream_rib_iter_next(table->rib, &self->iter, &route)) {
+    result = get_route_pydict(&route, self->path);
+  }
+  RoutingTable_unlock(table);
+
+  if (result == NULL && !PyErr_Occurred()) {
+    /* the end was reached */
+    Py_CLEAR(self->table);
+  }
+  return result;
+}
+
+static PyTypeObject RoutingTableIterType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "_pybgpstream.RoutingTableIterator",     /* tp_name */
+  sizeof(RoutingTableIterObject),          /* tp_basicsize */
+  0,                                       /* tp_itemsize */
+  (destructor)RoutingTableIter_dealloc,    /* tp_dealloc */
+  0,                                       /* tp_print */
+  0,                                       /* tp_getattr */
+  0,                                       /* tp_setattr */
+  0,                                       /* tp_compare */
+  0,                                       /* tp_repr */
+  0,                                       /* tp_as_number */
+  0,                                       /* tp_as_sequence */
+  0,                                       /* tp_as_mapping */
+  0,                                       /* tp_hash */
+  0,                                       /* tp_call */
+  0,                                       /* tp_str */
+  0,                                       /* tp_getattro */
+  0,                                       /* tp_setattro */
+  0,                                       /* tp_as_buffer */
+  Py_TPFLAGS_DEFAULT,                      /* tp_flags */
+  "Iterator over the routes of a peer",    /* tp_doc */
+  0,                                       /* tp_traverse */
+  0,                                       /* tp_clear */
+  0,                                       /* tp_richcompare */
+  0,                                       /* tp_weaklistoffset */
+  PyObject_SelfIter,                       /* tp_iter */
+  (iternextfunc)RoutingTableIter_iternext, /* tp_iternext */
+};
+
+PyTypeObject *_pybgpstream_bgpstream_get_RoutingTableIterType()
+{
+  return &RoutingTableIterType;
+}
+
+/* ========== STREAM UPDATES ========== */
+
+/* apply the elems of a detached record */
+static int apply_detached(pybgpstream_rib_t *rib,
+                          pybgpstream_detached_record_t *drec,
+                          unsigned long long *cnt)
+{
+  bgpstream_elem_t *elem;
+  int ret;
+
+  if (pybgpstream_rib_start_record(rib, &drec->rec) != 0) {
+    return -1;
+  }
+  while (pybgpstream_detached_record_get_next_elem(drec, &elem) > 0) {
+    if ((ret = pybgpstream_rib_apply_elem(rib, elem)) < 0) {
+      return -1;
+    }
+    *cnt += ret;
+  }
+  return 0;
+}
+
+/* apply the rest of the stream (no Python API calls) */
+static int update(RoutingTableObject *self, pybgpstream_reader_t *reader,
+                  long long until, unsigned long long *cnt, const char **err)
+{
+  bgpstream_elem_t *elem;
+  int ret;
+
+  if (self->pending != NULL) {
+    if (until >= 0 && self->pending->rec.time_sec > until) {
+      return 0;
+    }
+    ret = apply_detached(self->rib, self->pending, cnt);
+    pybgpstream_detached_record_destroy(self->pending);
+    self->pending = NULL;
+    if (ret != 0) {
+      *err = "Could not apply elem";
+      return -1;
+    }
+  }
+
+  while ((ret = pybgpstream_reader_next_record(reader)) > 0) {
+    if (reader->rec->status != BGPSTREAM_RECORD_STATUS_VALID_RECORD) {
+      continue;
+    }
+
+    if (until >= 0 && reader->rec->time_sec > until) {
+      /* records cannot be put back into the stream, so the table keeps it
+         until it is next updated */
+      if (reader->drec != NULL) {
+        self->pending = reader->drec;
+        reader->drec = NULL;
+        reader->rec = NULL;
+      } else if ((self->pending = pybgpstream_detached_record_create(
+                    reader->rec, reader->filter)) == NULL) {
+        *err = "Could not copy record";
+        return -1;
+      }
+      return 0;
+    }
+
+    if (pybgpstream_rib_start_record(self->rib, reader->rec) != 0) {
+      *err = "Could not apply record";
+      return -1;
+    }
+    while ((ret = pybgpstream_reader_next_elem(reader, &elem)) > 0) {
+      if ((ret = pybgpstream_rib_apply_elem(self->rib, elem)) < 0) {
+        *err = "Could not apply elem";
+        return -1;
+      }
+      *cnt += ret;
+    }
+    if (ret < 0) {
+      *err = "Could not get next elem";
+      return -1;
+    }
+  }
+  if (ret < 0) {
+    *err = "Could not get next record (is the stream started?)";
+    return -1;
+  }
+
+  return 0;
+}
+
+PyObject *_pybgpstream_routingtable_update(PyObject *table,
+                                           pybgpstream_reader_t *reader,
+                                           long long until)
+{
+  RoutingTableObject *self = (RoutingTableObject *)table;
+  unsigned long long cnt = 0;
+  const char *err = NULL;
+  int ret;
+
+  Py_BEGIN_ALLOW_THREADS;
+  pthread_mutex_lock(&self->lock);
+  ret = update(self, reader, until, &cnt, &err);
+  pthread_mutex_unlock(&self->lock);
+  pybgpstream_reader_clear(reader);
+  Py_END_ALLOW_THREADS;
+
+  if (ret != 0) {
+    PyErr_SetString(PyExc_RuntimeError, err);
+    return NULL;
+  }
+  return PyLong_FromUnsignedLongLong(cnt);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_ROUTINGTABLE_H
+#define ___PYBGPSTREAM_ROUTINGTABLE_H
+
+#include "_pybgpstream_detached.h"
+#include "_pybgpstream_reader.h"
+#include "_pybgpstream_rib.h"
+#include <Python.h>
+#include <pthread.h>
+
+typedef struct {
+  PyObject_HEAD
+
+    /* Routes of every peer */
+    pybgpstream_rib_t *rib;
+
+    /* First record past the end time of the last update from a stream,
+       applied at the start of the next update (NULL if there is none) */
+    pybgpstream_detached_record_t *pending;
+
+    /* Protects rib and pending, which are updated with the GIL released */
+    pthread_mutex_t lock;
+
+} RoutingTableObject;
+
+/** Expose the RoutingTableType structure */
+PyTypeObject *_pybgpstream_bgpstream_get_RoutingTableType(void);
+
+/** Expose the type of the iterators returned by RoutingTable.get_routes */
+PyTypeObject *_pybgpstream_bgpstream_get_RoutingTableIterType(void);
+
+/** Apply the rest of a stream to a routing table
+ *
+ * @param table         RoutingTable object to update
+ * @param reader        pointer to the reader to drain
+ * @param until         time of the last records to apply (the first record
+ *                      past it is kept by the table for the next update),
+ *                      or -1 to apply the whole stream
+ * @return new reference to the number of elems applied, or NULL if an error
+ *         occurred
+ *
+ * Records are read and applied with the GIL released.
+ */
+PyObject *_pybgpstream_routingtable_update(PyObject *table,
+                                           pybgpstream_reader_t *reader,
+                                           long long until);
+
+#endif /* ___PYBGPSTREAM_ROUTINGTABLE_H */
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_stats.h"
+#include <stdlib.h>
+
+/* names of the status counters, in the same order as status_idx */
+static const char *status_names[PYBGPSTREAM_STATS_STATUS_CNT] = {
+  "valid",            "filtered-source",  "empty-source",
+  "corrupted-source", "corrupted-record", "unknown",
+};
+
+static int status_idx(bgpstream_record_status_t status)
+{
+  switch (status) {
+  case BGPSTREAM_RECORD_STATUS_VALID_RECORD:
+    return 0;
+  case BGPSTREAM_RECORD_STATUS_FILTERED_SOURCE:
+    return 1;
+  case BGPSTREAM_RECORD_STATUS_EMPTY_SOURCE:
+    return 2;
+  case BGPSTREAM_RECORD_STATUS_CORRUPTED_SOURCE:
+    return 3;
+  case BGPSTREAM_RECORD_STATUS_CORRUPTED_RECORD:
+    return 4;
+  default:
+    return 5;
+  }
+}
+
+pybgpstream_stats_t *pybgpstream_stats_create(void)
+{
+  pybgpstream_stats_t *stats;
+
+  if ((stats = calloc(1, sizeof(pybgpstream_stats_t))) == NULL) {
+    return NULL;
+  }
+  stats->refcnt = 1;
+  stats->start_ns = pybgpstream_stats_now();
+  return stats;
+}
+
+void pybgpstream_stats_incref(pybgpstream_stats_t *stats)
+{
+  __atomic_fetch_add(&stats->refcnt, 1, __ATOMIC_RELAXED);
+}
+
+void pybgpstream_stats_decref(pybgpstream_stats_t *stats)
+{
+  if (stats != NULL &&
+      __atomic_sub_fetch(&stats->refcnt, 1, __ATOMIC_ACQ_REL) == 0) {
+    free(stats);
+  }
+}
+
+void pybgpstream_stats_add_record(pybgpstream_stats_t *stats,
+                                  const bgpstream_record_t *rec)
+{
+  PYBGPSTREAM_STATS_ADD(stats, records, 1);
+  PYBGPSTREAM_STATS_ADD(stats, status[status_idx(rec->status)], 1);
+}
+
+#define LOAD(counter)                                                          \
+  copy->counter = __atomic_load_n(&stats->counter, __ATOMIC_RELAXED)
+
+void pybgpstream_stats_get(pybgpstream_stats_t *stats,
+                           pybgpstream_stats_t *copy)
+{
+  int i;
+
+  copy->refcnt = 0;
+  copy->start_ns = stats->start_ns;
+  LOAD(records);
+  LOAD(elems);
+  for (i = 0; i < PYBGPSTREAM_STATS_STATUS_CNT; i++) {
+    LOAD(status[i]);
+  }
+  LOAD(read_ns);
+  LOAD(convert_ns);
+  LOAD(record_objects);
+  LOAD(elem_objects);
+  LOAD(field_objects);
+}
+
+const char *pybgpstream_stats_status_name(int idx)
+{
+  return status_names[idx];
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_STATS_H
+#define ___PYBGPSTREAM_STATS_H
+
+#include <bgpstream.h>
+#include <stdint.h>
+#include <time.h>
+
+/** Number of record status counters (the last one counts any status that
+    has no counter of its own) */
+#define PYBGPSTREAM_STATS_STATUS_CNT 6
+
+/** Counters and timers of a stream
+ *
+ * Records and elems of the stream hold a reference to the statistics of
+ * the stream they were read from (which they may outlive), and update them
+ * from whichever thread uses them, so counters must only be updated with
+ * PYBGPSTREAM_STATS_ADD.
+ */
+typedef struct pybgpstream_stats {
+
+  /** Number of references held (by the stream and its records) */
+  int refcnt;
+
+  /** Time the statistics were created at (in ns, see
+      pybgpstream_stats_now) */
+  uint64_t start_ns;
+
+  /** Number of records read from the stream */
+  uint64_t records;
+
+  /** Number of elems read from the records of the stream */
+  uint64_t elems;
+
+  /** Number of records read, by status */
+  uint64_t status[PYBGPSTREAM_STATS_STATUS_CNT];
+
+  /** Time spent reading records and elems (in libbgpstream, or waiting for
+      the prefetch thread or cache), in ns */
+  uint64_t read_ns;
+
+  /** Time spent building Python objects for records, elems and their
+      fields, in ns */
+  uint64_t convert_ns;
+
+  /** Number of BGPRecord objects created */
+  uint64_t record_objects;
+
+  /** Number of BGPElem objects created */
+  uint64_t elem_objects;
+
+  /** Number of field values (and field dicts) of elems created */
+  uint64_t field_objects;
+
+} pybgpstream_stats_t;
+
+/** Add n to the given counter of stats */
+#define PYBGPSTREAM_STATS_ADD(stats, counter, n)                               \
+  __atomic_fetch_add(&(stats)->counter, (n), __ATOMIC_RELAXED)
+
+/** Get the current time of the monotonic clock, in ns */
+static inline uint64_t pybgpstream_stats_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** Create statistics with all counters at zero
+ *
+ * @return pointer to the statistics (with a single reference), or NULL if
+ *         an error occurred
+ */
+pybgpstream_stats_t *pybgpstream_stats_create(void);
+
+/** Add a reference to the given statistics */
+void pybgpstream_stats_incref(pybgpstream_stats_t *stats);
+
+/** Drop a reference to the given statistics, freeing them once there are
+    no references left (stats may be NULL) */
+void pybgpstream_stats_decref(pybgpstream_stats_t *stats);
+
+/** Count a record that was read from the stream
+ *
+ * @param stats         pointer to the statistics
+ * @param rec           pointer to the record
+ */
+void pybgpstream_stats_add_record(pybgpstream_stats_t *stats,
+                                  const bgpstream_record_t *rec);
+
+/** Get a copy of the counters of the given statistics
+ *
+ * @param stats         pointer to the statistics
+ * @param[out] copy     filled with the current counters
+ */
+void pybgpstream_stats_get(pybgpstream_stats_t *stats,
+                           pybgpstream_stats_t *copy);
+
+/** Get the name of a record status counter
+ *
+ * @param idx           index of the counter (< PYBGPSTREAM_STATS_STATUS_CNT)
+ * @return the name of the status, as returned by BGPRecord.status
+ */
+const char *pybgpstream_stats_status_name(int idx);
+
+#endif /* ___PYBGPSTREAM_STATS_H */
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_topology.h"
+#include "_pybgpstream_u64set.h"
+#include "pyutils.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+
+  /** PYBGPSTREAM_TOPOLOGY_* flags */
+  int flags;
+
+  /** Adjacencies, keyed (lower ASN << 32) | higher ASN */
+  pybgpstream_u64set_t edges;
+
+  /** Per-adjacency data, indexed like edges.keys */
+  uint64_t *counts;
+  uint32_t *first_seen;
+  size_t data_alloc;
+
+  /** Observing peers, keyed (adjacency index << 32) | peer ASN */
+  pybgpstream_u64set_t edge_peers;
+
+  /** Observing peers grouped by adjacency (built once all paths are read):
+      the peers of adjacency i are peers[peer_offsets[i]:peer_offsets[i+1]] */
+  uint64_t *peer_offsets;
+  uint32_t *peers;
+
+} topology_t;
+
+static void topology_clear(topology_t *topo)
+{
+  pybgpstream_u64set_clear(&topo->edges);
+  pybgpstream_u64set_clear(&topo->edge_peers);
+  free(topo->counts);
+  free(topo->first_seen);
+  free(topo->peer_offsets);
+  free(topo->peers);
+  memset(topo, 0, sizeof(*topo));
+}
+
+static int grow_data(topology_t *topo)
+{
+  size_t new_alloc = topo->edges.keys_alloc;
+  void *tmp;
+
+  if ((topo->flags & PYBGPSTREAM_TOPOLOGY_COUNTS) != 0) {
+    if ((tmp = realloc(topo->counts, sizeof(uint64_t) * new_alloc)) ==
+        NULL) {
+      return -1;
+    }
+    topo->counts = tmp;
+  }
+  if ((topo->flags & PYBGPSTREAM_TOPOLOGY_FIRST_SEEN) != 0) {
+    if ((tmp = realloc(topo->first_seen, sizeof(uint32_t) * new_alloc)) ==
+        NULL) {
+      return -1;
+    }
+    topo->first_seen = tmp;
+  }
+  topo->data_alloc = new_alloc;
+  return 0;
+}
+
+static int add_edge(topology_t *topo, uint32_t a, uint32_t b,
+                    uint32_t time_sec, uint32_t peer_asn)
+{
+  uint64_t key = (a < b) ? (((uint64_t)a << 32) | b) :
+                           (((uint64_t)b << 32) | a);
+  uint32_t idx;
+  int ret;
+
+  if ((ret = pybgpstream_u64set_add(&topo->edges, key, &idx)) < 0) {
+    return -1;
+  }
+  if (topo->flags == 0) {
+    return 0;
+  }
+
+  if (ret == 1) {
+    if (idx >= topo->data_alloc && grow_data(topo) != 0) {
+      return -1;
+    }
+    if (topo->counts != NULL) {
+      topo->counts[idx] = 0;
+    }
+    if (topo->first_seen != NULL) {
+      topo->first_seen[idx] = time_sec;
+    }
+  }
+  if (topo->counts != NULL) {
+    topo->counts[idx]++;
+  }
+  if (topo->first_seen != NULL && time_sec < topo->first_seen[idx]) {
+    topo->first_seen[idx] = time_sec;
+  }
+  if ((topo->flags & PYBGPSTREAM_TOPOLOGY_PEERS) != 0 &&
+      pybgpstream_u64set_add(&topo->edge_peers,
+                             ((uint64_t)idx << 32) | peer_asn, NULL) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+static int add_path(topology_t *topo, bgpstream_as_path_t *path,
+                    uint32_t time_sec, uint32_t peer_asn)
+{
+  bgpstream_as_path_iter_t iter;
+  bgpstream_as_path_seg_t *seg;
+  uint32_t asn;
+  uint32_t prev = 0;
+  int have_prev = 0;
+
+  bgpstream_as_path_iter_reset(&iter);
+  while ((seg = bgpstream_as_path_get_next_seg(path, &iter)) != NULL) {
+    if (seg->type != BGPSTREAM_AS_PATH_SEG_ASN) {
+      /* sets and confederations are not adjacent to anything */
+      have_prev = 0;
+      continue;
+    }
+    asn = ((bgpstream_as_path_seg_asn_t *)seg)->asn;
+    /* prepended hops are not adjacencies */
+    if (have_prev && asn != prev &&
+        add_edge(topo, prev, asn, time_sec, peer_asn) != 0) {
+      return -1;
+    }
+    prev = asn;
+    have_prev = 1;
+  }
+  return 0;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* group the observing peers by adjacency (sorted by ASN) */
+static int group_peers(topology_t *topo)
+{
+  size_t n = topo->edges.cnt;
+  uint64_t *pos = NULL;
+  uint64_t key;
+  size_t i;
+
+  if ((topo->peer_offsets = calloc(n + 1, sizeof(uint64_t))) == NULL ||
+      (topo->peers = malloc(sizeof(uint32_t) *
+                            (topo->edge_peers.cnt + 1))) == NULL ||
+      (pos = malloc(sizeof(uint64_t) * (n + 1))) == NULL) {
+    free(pos);
+    return -1;
+  }
+
+  for (i = 0; i < topo->edge_peers.cnt; i++) {
+    topo->peer_offsets[(topo->edge_peers.keys[i] >> 32) + 1]++;
+  }
+  for (i = 0; i < n; i++) {
+    topo->peer_offsets[i + 1] += topo->peer_offsets[i];
+  }
+  memcpy(pos, topo->peer_offsets, sizeof(uint64_t) * (n + 1));
+  for (i = 0; i < topo->edge_peers.cnt; i++) {
+    key = topo->edge_peers.keys[i];
+    topo->peers[pos[key >> 32]++] = (uint32_t)key;
+  }
+  for (i = 0; i < n; i++) {
+    qsort(&topo->peers[topo->peer_offsets[i]],
+          topo->peer_offsets[i + 1] - topo->peer_offsets[i],
+          sizeof(uint32_t), compare_u32);
+  }
+
+  free(pos);
+  pybgpstream_u64set_clear(&topo->edge_peers);
+  return 0;
+}
+
+static int extract(topology_t *topo, pybgpstream_reader_t *reader,
+                   const char **err)
+{
+  bgpstream_elem_t *elem;
+  int ret;
+
+  while ((ret = pybgpstream_reader_next_record(reader)) > 0) {
+    if (reader->rec->status != BGPSTREAM_RECORD_STATUS_VALID_RECORD) {
+      continue;
+    }
+    while ((ret = pybgpstream_reader_next_elem(reader, &elem)) > 0) {
+      if ((elem->type != BGPSTREAM_ELEM_TYPE_RIB &&
+           elem->type != BGPSTREAM_ELEM_TYPE_ANNOUNCEMENT) ||
+          elem->as_path == NULL) {
+        continue;
+      }
+      if (add_path(topo, elem->as_path, reader->rec->time_sec,
+                   elem->peer_asn) != 0) {
+        *err = "Could not add AS adjacency";
+        return -1;
+      }
+    }
+    if (ret < 0) {
+      *err = "Could not get next elem";
+      return -1;
+    }
+  }
+  if (ret < 0) {
+    *err = "Could not get next record (is the stream started?)";
+    return -1;
+  }
+
+  if ((topo->flags & PYBGPSTREAM_TOPOLOGY_PEERS) != 0 &&
+      group_peers(topo) != 0) {
+    *err = "Could not group observing peers";
+    return -1;
+  }
+  return 0;
+}
+
+static PyObject *get_peers_pyfrozenset(topology_t *topo, size_t idx)
+{
+  PyObject *peers;
+  PyObject *asn;
+  uint64_t i;
+
+  if ((peers = PyFrozenSet_New(NULL)) == NULL) {
+    return NULL;
+  }
+  for (i = topo->peer_offsets[idx]; i < topo->peer_offsets[idx + 1]; i++) {
+    if ((asn = PyLong_FromUnsignedLong(topo->peers[i])) == NULL ||
+        PySet_Add(peers, asn) != 0) {
+      Py_XDECREF(asn);
+      Py_DECREF(peers);
+      return NULL;
+    }
+    Py_DECREF(asn);
+  }
+  return peers;
+}
+
+static PyObject *get_edge_data_pytuple(topology_t *topo, size_t idx)
+{
+  PyObject *count = Py_None;
+  PyObject *first_seen = Py_None;
+  PyObject *peers = Py_None;
+
+  Py_INCREF(count);
+  Py_INCREF(first_seen);
+  Py_INCREF(peers);
+  if (topo->counts != NULL) {
+    Py_DECREF(count);
+    count = PyLong_FromUnsignedLongLong(topo->counts[idx]);
+  }
+  if (topo->first_seen != NULL) {
+    Py_DECREF(first_seen);
+    first_seen = PyLong_FromUnsignedLong(topo->first_seen[idx]);
+  }
+  if (topo->peer_offsets != NULL) {
+    Py_DECREF(peers);
+    peers = get_peers_pyfrozenset(topo, idx);
+  }
+  if (count == NULL || first_seen == NULL || peers == NULL) {
+    Py_XDECREF(count);
+    Py_XDECREF(first_seen);
+    Py_XDECREF(peers);
+    return NULL;
+  }
+  return Py_BuildValue("(NNN)", count, first_seen, peers);
+}
+
+static PyObject *build_pyobjs(topology_t *topo)
+{
+  PyObject *result;
+  PyObject *edge;
+  PyObject *data;
+  uint64_t key;
+  size_t i;
+  int err;
+
+  result = (topo->flags == 0) ? PySet_New(NULL) : PyDict_New();
+  if (result == NULL) {
+    return NULL;
+  }
+
+  for (i = 0; i < topo->edges.cnt; i++) {
+    key = topo->edges.keys[i];
+    edge = Py_BuildValue("(kk)", (unsigned long)(key >> 32),
+                         (unsigned long)(key & 0xffffffff));
+    if (topo->flags == 0) {
+      err = (edge == NULL || PySet_Add(result, edge) != 0);
+    } else {
+      data = get_edge_data_pytuple(topo, i);
+      err = (edge == NULL || data == NULL ||
+             PyDict_SetItem(result, edge, data) != 0);
+      Py_XDECREF(data);
+    }
+    Py_XDECREF(edge);
+    if (err) {
+      Py_DECREF(result);
+      return NULL;
+    }
+  }
+  return result;
+}
+
+/* Wrap the given bytes object in a memoryview of items of the given struct
+   format (steals the reference to the bytes object). Python 2 has no typed
+   memoryviews, so the bytes object is returned as is. */
+static PyObject *get_buffer_pyobj(PyObject *bytes, const char *format)
+{
+#if PY_MAJOR_VERSION > 2
+  PyObject *view;
+  PyObject *typed;
+
+  if (bytes == NULL) {
+    return NULL;
+  }
+  view = PyMemoryView_FromObject(bytes);
+  Py_DECREF(bytes);
+  if (view == NULL) {
+    return NULL;
+  }
+  typed = PyObject_CallMethod(view, "cast", "s", format);
+  Py_DECREF(view);
+  return typed;
+#else
+  (void)format;
+  return bytes;
+#endif
+}
+
+/* like add_to_dict, but also handles a failure to build the value */
+static int add_buffer_to_dict(PyObject *dict, const char *key,
+                              PyObject *buffer)
+{
+  return (buffer == NULL) ? -1 : add_to_dict(dict, key, buffer);
+}
+
+static PyObject *build_buffers(topology_t *topo)
+{
+  PyObject *result;
+  PyObject *bytes;
+  uint32_t *asns;
+  uint64_t key;
+  size_t n = topo->edges.cnt;
+  size_t i;
+
+  if ((result = PyDict_New()) == NULL) {
+    return NULL;
+  }
+
+  if ((bytes = PYBYTES_FROMSTRANDSIZE(NULL, sizeof(uint32_t) * n * 2)) ==
+      NULL) {
+    goto err;
+  }
+  asns = (uint32_t *)PyBytes_AS_STRING(bytes);
+  for (i = 0; i < n; i++) {
+    key = topo->edges.keys[i];
+    asns[i * 2] = (uint32_t)(key >> 32);
+    asns[i * 2 + 1] = (uint32_t)key;
+  }
+  if (add_buffer_to_dict(result, "edges", get_buffer_pyobj(bytes, "I")) != 0) {
+    goto err;
+  }
+
+  if (topo->counts != NULL &&
+      add_buffer_to_dict(result, "counts",
+                  get_buffer_pyobj(PYBYTES_FROMSTRANDSIZE(
+                                     (const char *)topo->counts,
+                                     sizeof(uint64_t) * n),
+                                   "Q")) != 0) {
+    goto err;
+  }
+  if (topo->first_seen != NULL &&
+      add_buffer_to_dict(result, "first_seen",
+                  get_buffer_pyobj(PYBYTES_FROMSTRANDSIZE(
+                                     (const char *)topo->first_seen,
+                                     sizeof(uint32_t) * n),
+                                   "I")) != 0) {
+    goto err;
+  }
+  if (topo->peer_offsets != NULL &&
+      (add_buffer_to_dict(result, "peer_offsets",
+                   get_buffer_pyobj(PYBYTES_FROMSTRANDSIZE(
+                                      (const char *)topo->peer_offsets,
+                                      sizeof(uint64_t) * (n + 1)),
+                                    "Q")) != 0 ||
+       add_buffer_to_dict(result, "peers",
+                   get_buffer_pyobj(PYBYTES_FROMSTRANDSIZE(
+                                      (const char *)topo->peers,
+                                      sizeof(uint32_t) *
+                                        topo->peer_offsets[n]),
+                                    "I")) != 0)) {
+    goto err;
+  }
+
+  return result;
+
+err:
+  Py_DECREF(result);
+  return NULL;
+}
+
+PyObject *_pybgpstream_topology_run(pybgpstream_reader_t *reader, int flags,
+                                    int as_buffers)
+{
+  topology_t topo;
+  const char *err = NULL;
+  PyObject *result;
+  int ret;
+
+  memset(&topo, 0, sizeof(topo));
+  topo.flags = flags;
+
+  Py_BEGIN_ALLOW_THREADS;
+  ret = extract(&topo, reader, &err);
+  pybgpstream_reader_clear(reader);
+  Py_END_ALLOW_THREADS;
+
+  if (ret != 0) {
+    topology_clear(&topo);
+    PyErr_SetString(PyExc_RuntimeError, err);
+    return NULL;
+  }
+
+  result = as_buffers ? build_buffers(&topo) : build_pyobjs(&topo);
+  topology_clear(&topo);
+  return result;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_TOPOLOGY_H
+#define ___PYBGPSTREAM_TOPOLOGY_H
+
+#include "_pybgpstream_reader.h"
+#include <Python.h>
+
+/** Optional per-adjacency data to collect */
+#define PYBGPSTREAM_TOPOLOGY_COUNTS 0x01
+#define PYBGPSTREAM_TOPOLOGY_FIRST_SEEN 0x02
+#define PYBGPSTREAM_TOPOLOGY_PEERS 0x04
+
+/** Extract the AS adjacencies found in the AS paths of the rest of a stream
+ *
+ * @param reader        pointer to the reader to drain
+ * @param flags         PYBGPSTREAM_TOPOLOGY_* flags of the data to collect
+ * @param as_buffers    whether to return the adjacencies as flat buffers
+ * @return new reference to the adjacencies, or NULL if an error occurred
+ *
+ * Adjacencies are taken from consecutive ASN hops of the AS paths of RIB
+ * and announcement elems of valid records, ignoring prepending; AS sets and
+ * confederation segments break the path. Each adjacency is stored as a
+ * (lower ASN, higher ASN) pair. With no flags and no buffers the result is
+ * a set of pairs; with flags it is a dict mapping each pair to a
+ * (count, first_seen, peers) tuple (with None for the data not collected).
+ * With buffers the result is a dict of buffers, as documented for
+ * BGPStream.get_as_topology. All the work except building the result is
+ * done with the GIL released.
+ */
+PyObject *_pybgpstream_topology_run(pybgpstream_reader_t *reader, int flags,
+                                    int as_buffers);
+
+#endif /* ___PYBGPSTREAM_TOPOLOGY_H */
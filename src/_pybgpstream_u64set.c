@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "_pybgpstream_u64set.h"
+#include <stdlib.h>
+
+/* the splitmix64 finalizer, which spreads ASN pairs well */
+static uint64_t key_hash(uint64_t key)
+{
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+
+static uint32_t *find_slot(pybgpstream_u64set_t *set, uint64_t key)
+{
+  size_t mask = set->slots_alloc - 1;
+  size_t i = key_hash(key) & mask;
+  while (set->slots[i] != 0 && set->keys[set->slots[i] - 1] != key) {
+    i = (i + 1) & mask;
+  }
+  return &set->slots[i];
+}
+
+static int grow(pybgpstream_u64set_t *set)
+{
+  size_t new_alloc = (set->slots_alloc == 0) ? 1024 : set->slots_alloc * 2;
+  uint32_t *new_slots;
+  uint64_t *new_keys;
+  size_t i;
+
+  if ((new_slots = calloc(new_alloc, sizeof(uint32_t))) == NULL) {
+    return -1;
+  }
+  if ((new_keys = realloc(set->keys, sizeof(uint64_t) * new_alloc / 2)) ==
+      NULL) {
+    free(new_slots);
+    return -1;
+  }
+  free(set->slots);
+  set->keys = new_keys;
+  set->keys_alloc = new_alloc / 2;
+  set->slots = new_slots;
+  set->slots_alloc = new_alloc;
+
+  for (i = 0; i < set->cnt; i++) {
+    *find_slot(set, set->keys[i]) = (uint32_t)(i + 1);
+  }
+  return 0;
+}
+
+void pybgpstream_u64set_init(pybgpstream_u64set_t *set)
+{
+  set->keys = NULL;
+  set->cnt = 0;
+  set->keys_alloc = 0;
+  set->slots = NULL;
+  set->slots_alloc = 0;
+}
+
+void pybgpstream_u64set_clear(pybgpstream_u64set_t *set)
+{
+  free(set->keys);
+  free(set->slots);
+  pybgpstream_u64set_init(set);
+}
+
+int pybgpstream_u64set_add(pybgpstream_u64set_t *set, uint64_t key,
+                           uint32_t *idx)
+{
+  uint32_t *slot;
+
+  if (set->slots_alloc != 0) {
+    slot = find_slot(set, key);
+    if (*slot != 0) {
+      if (idx != NULL) {
+        *idx = *slot - 1;
+      }
+      return 0;
+    }
+  }
+
+  /* keep the table at most half full */
+  if (set->cnt == set->keys_alloc) {
+    if (set->cnt >= UINT32_MAX - 1 || grow(set) != 0) {
+      return -1;
+    }
+  }
+  slot = find_slot(set, key);
+  set->keys[set->cnt] = key;
+  *slot = (uint32_t)(set->cnt + 1);
+  if (idx != NULL) {
+    *idx = (uint32_t)set->cnt;
+  }
+  set->cnt++;
+  return 1;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ___PYBGPSTREAM_U64SET_H
+#define ___PYBGPSTREAM_U64SET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** A compact open-addressing hash set of 64-bit keys
+ *
+ * Keys are stored densely in insertion order, and the hash table only holds
+ * 32-bit indexes into that array, so each key costs 8 bytes plus (at most)
+ * two table slots. The index of a key can be used to keep per-key data in
+ * parallel arrays. None of these functions touch the Python API.
+ */
+typedef struct pybgpstream_u64set {
+
+  /** Keys, in insertion order */
+  uint64_t *keys;
+
+  /** Number of keys */
+  size_t cnt;
+
+  /** Number of keys allocated */
+  size_t keys_alloc;
+
+  /** Hash table of key indexes + 1 (0 marks an empty slot) */
+  uint32_t *slots;
+
+  /** Number of slots (always a power of two) */
+  size_t slots_alloc;
+
+} pybgpstream_u64set_t;
+
+/** Initialize the given (empty) set */
+void pybgpstream_u64set_init(pybgpstream_u64set_t *set);
+
+/** Free all memory used by the given set */
+void pybgpstream_u64set_clear(pybgpstream_u64set_t *set);
+
+/** Add a key to the given set
+ *
+ * @param set           pointer to the set
+ * @param key           key to add
+ * @param[out] idx      set to the index of the key (if not NULL)
+ * @return 1 if the key was added, 0 if it was already present, -1 if an
+ *         error occurred
+ */
+int pybgpstream_u64set_add(pybgpstream_u64set_t *set, uint64_t key,
+                           uint32_t *idx);
+
+#endif /* ___PYBGPSTREAM_U64SET_H */
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "_pybgpstream_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+uint32_t pybgpstream_hash(const void *data, size_t len)
+{
+  const uint8_t *p = data;
+  uint32_t hash = 2166136261u;
+  while (len-- > 0) {
+    hash = (hash ^ *p++) * 16777619u;
+  }
+  return hash;
+}
+
+uint64_t pybgpstream_hash64(const void *data, size_t len)
+{
+  const uint8_t *p = data;
+  uint64_t hash = 14695981039346656037ULL;
+  while (len-- > 0) {
+    hash = (hash ^ *p++) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+void pybgpstream_names_clear(pybgpstream_names_t *names)
+{
+  int i;
+  for (i = 0; i < names->cnt; i++) {
+    free(names->names[i]);
+  }
+  free(names->names);
+  memset(names, 0, sizeof(*names));
+}
+
+int pybgpstream_names_copy(pybgpstream_names_t *dst,
+                           const pybgpstream_names_t *src)
+{
+  if (src->cnt == 0) {
+    return 0;
+  }
+  if ((dst->names = malloc(sizeof(char *) * src->cnt)) == NULL) {
+    return -1;
+  }
+  dst->alloc = src->cnt;
+  for (dst->cnt = 0; dst->cnt < src->cnt; dst->cnt++) {
+    if ((dst->names[dst->cnt] = strdup(src->names[dst->cnt])) == NULL) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int pybgpstream_names_get_idx(pybgpstream_names_t *names, const char *name,
+                              int max)
+{
+  char **tmp;
+  int alloc;
+  int i;
+
+  for (i = names->cnt - 1; i >= 0; i--) {
+    if (strcmp(names->names[i], name) == 0) {
+      return i;
+    }
+  }
+  if (names->cnt >= max) {
+    return -1;
+  }
+  if (names->cnt == names->alloc) {
+    alloc = (names->alloc == 0) ? 16 : names->alloc * 2;
+    if ((tmp = realloc(names->names, sizeof(char *) * alloc)) == NULL) {
+      return -1;
+    }
+    names->names = tmp;
+    names->alloc = alloc;
+  }
+  if ((names->names[names->cnt] = strdup(name)) == NULL) {
+    return -1;
+  }
+  return names->cnt++;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 The Regents of the University of California.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef ___PYBGPSTREAM_UTILS_H
+#define ___PYBGPSTREAM_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Hash some bytes (32-bit FNV-1a)
+ *
+ * @param data          pointer to the bytes to hash
+ * @param len           number of bytes
+ * @return the hash of the bytes
+ */
+uint32_t pybgpstream_hash(const void *data, size_t len);
+
+/** Hash some bytes (64-bit FNV-1a), for hashes that are kept on disk */
+uint64_t pybgpstream_hash64(const void *data, size_t len);
+
+/** A table of distinct names (e.g. of projects and collectors)
+ *
+ * Names are kept in insertion order, so their index can be used to keep
+ * per-name data in parallel arrays. Lookups are linear: streams only have a
+ * handful of distinct names, and the most recent one is searched first. A
+ * zeroed structure is an empty table. None of these functions touch the
+ * Python API.
+ */
+typedef struct pybgpstream_names {
+
+  /** Owned copies of the names */
+  char **names;
+
+  /** Number of names */
+  int cnt;
+
+  /** Number of names allocated */
+  int alloc;
+
+} pybgpstream_names_t;
+
+/** Free all memory used by the given table, and empty it */
+void pybgpstream_names_clear(pybgpstream_names_t *names);
+
+/** Copy a table into an empty one
+ *
+ * @param dst           pointer to the (empty) table to copy to
+ * @param src           pointer to the table to copy
+ * @return 0 if the table was copied, -1 if an error occurred (dst must
+ *         still be cleared)
+ */
+int pybgpstream_names_copy(pybgpstream_names_t *dst,
+                           const pybgpstream_names_t *src);
+
+/** Get the index of a name, adding it if needed
+ *
+ * @param names         pointer to the table
+ * @param name          name to look up
+ * @param max           maximum number of names in the table
+ * @return the index of the name, or -1 if the table is full or an error
+ *         occurred
+ */
+int pybgpstream_names_get_idx(pybgpstream_names_t *names, const char *name,
+                              int max);
+
+#endif /* ___PYBGPSTREAM_UTILS_H */
@@ -28,6 +28,7 @@
 #define ___PYUTILS_H
 
 #include <Python.h>
+#include <bgpstream.h>
 
 #ifndef PyVarObject_HEAD_INIT
 #define PyVarObject_HEAD_INIT(type, size) PyObject_HEAD_INIT(type) size,
@@ -43,14 +44,58 @@
 #define Py_TYPE(ob) (((PyObject *)(ob))->ob_type)
 #endif
 
+/* Critical sections lock an object on free-threaded builds (and are no-ops
+   when there is a GIL). They only exist as of Python 3.13. */
+#ifndef Py_BEGIN_CRITICAL_SECTION
+#define Py_BEGIN_CRITICAL_SECTION(op) {
+#define Py_END_CRITICAL_SECTION() }
+#endif
+
+/* Mutex for state shared between objects (e.g. free lists), which is only
+   needed on free-threaded builds. A zeroed mutex is unlocked. */
+#ifdef Py_GIL_DISABLED
+#define PYBGPSTREAM_MUTEX PyMutex
+#define PYBGPSTREAM_MUTEX_LOCK(m) PyMutex_Lock(m)
+#define PYBGPSTREAM_MUTEX_UNLOCK(m) PyMutex_Unlock(m)
+#else
+#define PYBGPSTREAM_MUTEX char
+#define PYBGPSTREAM_MUTEX_LOCK(m) ((void)(m))
+#define PYBGPSTREAM_MUTEX_UNLOCK(m) ((void)(m))
+#endif
+
 #if PY_MAJOR_VERSION > 2
 #define PYSTR_FROMSTR(str) PyUnicode_FromString(str)
 #define PYNUM_FROMLONG(num) PyLong_FromLong(num)
+#define PYBYTES_FROMSTRANDSIZE(str, len) PyBytes_FromStringAndSize(str, len)
+#define PYSTR_FORMAT(fmt, args) PyUnicode_Format(fmt, args)
+#define PYSTR_EQUALS(obj, str)                                                 \
+  (PyUnicode_Check(obj) && PyUnicode_CompareWithASCIIString(obj, str) == 0)
+#define PYSTR_ASSTR(obj) PyUnicode_AsUTF8(obj)
 #else
 #define PYSTR_FROMSTR(str) PyString_FromString(str)
 #define PYNUM_FROMLONG(num) PyInt_FromLong(num)
+#define PYBYTES_FROMSTRANDSIZE(str, len) PyString_FromStringAndSize(str, len)
+#define PYSTR_FORMAT(fmt, args) PyString_Format(fmt, args)
+#define PYSTR_EQUALS(obj, str)                                                 \
+  (PyString_Check(obj) && strcmp(PyString_AS_STRING(obj), str) == 0)
+#define PYSTR_ASSTR(obj) PyString_AsString(obj)
 #endif
 
+/** Representation used for IP address and prefix values */
+typedef enum {
+
+  /** Strings in presentation format (e.g. "192.0.2.0/24") */
+  PYBGPSTREAM_ADDR_FORMAT_STR = 0,
+
+  /** Packed (network byte order) bytes, and (bytes, masklen) for prefixes */
+  PYBGPSTREAM_ADDR_FORMAT_BYTES = 1,
+
+  /** (int, version) for addresses, and (int, masklen, version) for
+      prefixes */
+  PYBGPSTREAM_ADDR_FORMAT_INT = 2,
+
+} pybgpstream_addr_format_t;
+
 static inline int add_to_dict(PyObject *dict, const char *key_str,
                               PyObject *value)
 {
@@ -61,6 +106,35 @@ static inline int add_to_dict(PyObject *dict, const char *key_str,
   return err;
 }
 
+/** Get a tuple with the values of the given attributes of an object
+ *
+ * @param obj           object to get the attributes of
+ * @param names         NULL-terminated array of attribute names
+ * @return new reference to a tuple, or NULL if an error occurred
+ */
+static inline PyObject *get_attrs_pytuple(PyObject *obj, const char **names)
+{
+  PyObject *tuple;
+  PyObject *value;
+  Py_ssize_t cnt = 0;
+  Py_ssize_t i;
+
+  while (names[cnt] != NULL) {
+    cnt++;
+  }
+  if ((tuple = PyTuple_New(cnt)) == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < cnt; i++) {
+    if ((value = PyObject_GetAttrString(obj, names[i])) == NULL) {
+      Py_DECREF(tuple);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(tuple, i, value);
+  }
+  return tuple;
+}
+
 static inline PyObject *get_ip_pystr(bgpstream_ip_addr_t *ip)
 {
   char ip_str[INET6_ADDRSTRLEN] = "";
@@ -68,4 +142,87 @@ static inline PyObject *get_ip_pystr(bgpstream_ip_addr_t *ip)
   return PYSTR_FROMSTR(ip_str);
 }
 
+static inline int get_ip_version(bgpstream_ip_addr_t *ip)
+{
+  switch (ip->version) {
+  case BGPSTREAM_ADDR_VERSION_IPV4:
+    return 4;
+  case BGPSTREAM_ADDR_VERSION_IPV6:
+    return 6;
+  default:
+    return 0;
+  }
+}
+
+static inline PyObject *get_ip_pybytes(bgpstream_ip_addr_t *ip)
+{
+  switch (ip->version) {
+  case BGPSTREAM_ADDR_VERSION_IPV4:
+    return PYBYTES_FROMSTRANDSIZE((const char *)&ip->bs_ipv4.addr, 4);
+  case BGPSTREAM_ADDR_VERSION_IPV6:
+    return PYBYTES_FROMSTRANDSIZE((const char *)&ip->bs_ipv6.addr, 16);
+  default:
+    Py_RETURN_NONE;
+  }
+}
+
+/* unsigned integer value of the address (in host byte order) */
+static inline PyObject *get_ip_pyint(bgpstream_ip_addr_t *ip)
+{
+  const uint8_t *bytes;
+  uint64_t hi = 0, lo = 0;
+  PyObject *pyhi, *pylo, *shift, *tmp, *num;
+  int i;
+
+  if (ip->version == BGPSTREAM_ADDR_VERSION_IPV4) {
+    return PyLong_FromUnsignedLong(ntohl(ip->bs_ipv4.addr.s_addr));
+  }
+
+  bytes = (const uint8_t *)&ip->bs_ipv6.addr;
+  for (i = 0; i < 8; i++) {
+    hi = (hi << 8) | bytes[i];
+    lo = (lo << 8) | bytes[i + 8];
+  }
+  if (hi == 0) {
+    return PyLong_FromUnsignedLongLong(lo);
+  }
+
+  /* (hi << 64) | lo */
+  pyhi = PyLong_FromUnsignedLongLong(hi);
+  pylo = PyLong_FromUnsignedLongLong(lo);
+  shift = PYNUM_FROMLONG(64);
+  num = NULL;
+  if (pyhi != NULL && pylo != NULL && shift != NULL &&
+      (tmp = PyNumber_Lshift(pyhi, shift)) != NULL) {
+    num = PyNumber_Or(tmp, pylo);
+    Py_DECREF(tmp);
+  }
+  Py_XDECREF(pyhi);
+  Py_XDECREF(pylo);
+  Py_XDECREF(shift);
+  return num;
+}
+
+/* build an address value in the given representation */
+static inline PyObject *get_ip_pyobj(bgpstream_ip_addr_t *ip,
+                                     pybgpstream_addr_format_t format)
+{
+  int version;
+
+  switch (format) {
+  case PYBGPSTREAM_ADDR_FORMAT_BYTES:
+    return get_ip_pybytes(ip);
+
+  case PYBGPSTREAM_ADDR_FORMAT_INT:
+    if ((version = get_ip_version(ip)) == 0) {
+      Py_RETURN_NONE;
+    }
+    return Py_BuildValue("(Ni)", get_ip_pyint(ip), version);
+
+  case PYBGPSTREAM_ADDR_FORMAT_STR:
+  default:
+    return get_ip_pystr(ip);
+  }
+}
+
 #endif